@@ -0,0 +1,268 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : arm_decoder.h
+// Date : October 16, 2026
+// Description : Shared ARM and THUMB instruction decoder
+//
+// Classifies ARM and THUMB opcodes for the GBA ARM7, NDS ARM7, and NDS ARM9
+// Lookup tables are generated at compile time from the same classification rules
+
+#ifndef GBE_ARM_DECODER
+#define GBE_ARM_DECODER
+
+#include <array>
+
+#include "common.h"
+
+//Decoder feature flags
+#define ARM_DECODE_ARMV4 0x00
+#define ARM_DECODE_ARMV5 0x01
+#define ARM_DECODE_SMUL 0x02
+
+//Table entry for keys that need every bit of the opcode to classify
+#define ARM_DECODE_FULL 0xFF
+
+namespace arm_decoder
+{
+	/****** Classifies a THUMB instruction using all 16 bits ******/
+	template <typename op_type, u32 flags>
+	constexpr op_type classify_thumb(u16 opcode)
+	{
+		if(((opcode >> 13) == 0) && (((opcode >> 11) & 0x7) != 0x3)) { return op_type::THUMB_1; }
+		if(((opcode >> 11) & 0x1F) == 0x3) { return op_type::THUMB_2; }
+		if((opcode >> 13) == 0x1) { return op_type::THUMB_3; }
+		if(((opcode >> 10) & 0x3F) == 0x10) { return op_type::THUMB_4; }
+		if(((opcode >> 10) & 0x3F) == 0x11) { return op_type::THUMB_5; }
+		if((opcode >> 11) == 0x9) { return op_type::THUMB_6; }
+		if((opcode >> 12) == 0x5) { return (opcode & 0x200) ? op_type::THUMB_8 : op_type::THUMB_7; }
+		if(((opcode >> 13) & 0x7) == 0x3) { return op_type::THUMB_9; }
+		if((opcode >> 12) == 0x8) { return op_type::THUMB_10; }
+		if((opcode >> 12) == 0x9) { return op_type::THUMB_11; }
+		if((opcode >> 12) == 0xA) { return op_type::THUMB_12; }
+		if((opcode >> 8) == 0xB0) { return op_type::THUMB_13; }
+		if((opcode >> 12) == 0xB) { return op_type::THUMB_14; }
+		if((opcode >> 12) == 0xC) { return op_type::THUMB_15; }
+		if((opcode >> 12) == 0xD) { return op_type::THUMB_16; }
+		if((opcode >> 11) == 0x1C) { return op_type::THUMB_18; }
+		if((opcode >> 11) >= 0x1E) { return op_type::THUMB_19; }
+
+		//BLX suffix
+		if constexpr((flags & ARM_DECODE_ARMV5) != 0)
+		{
+			if((opcode & 0xF800) == 0xE800) { return op_type::THUMB_19; }
+		}
+
+		return op_type::UNDEFINED;
+	}
+
+	/****** Classifies an ARM instruction using all 32 bits ******/
+	template <typename op_type, u32 flags>
+	constexpr op_type classify_arm(u32 opcode)
+	{
+		if(((opcode >> 8) & 0xFFFFF) == 0x12FFF) { return op_type::ARM_3; }
+		if(((opcode >> 25) & 0x7) == 0x5) { return op_type::ARM_4; }
+
+		//PSR transfers share their encoding space with swaps, halfword transfers, and ARMv5 extensions
+		if((opcode & 0xD900000) == 0x1000000)
+		{
+			if constexpr((flags & ARM_DECODE_ARMV5) != 0)
+			{
+				if((((opcode >> 16) & 0xFFF) == 0x16F) && (((opcode >> 4) & 0xFF) == 0xF1)) { return op_type::ARM_CLZ; }
+				if((((opcode >> 24) & 0xF) == 0x1) && (((opcode >> 4) & 0xFF) == 0x5)) { return op_type::ARM_QADD_QSUB; }
+			}
+
+			if((opcode & 0x80) && (opcode & 0x10) && ((opcode & 0x2000000) == 0))
+			{
+				return (((opcode >> 5) & 0x3) == 0) ? op_type::ARM_12 : op_type::ARM_10;
+			}
+
+			if constexpr((flags & ARM_DECODE_SMUL) != 0)
+			{
+				if((opcode & 0x80) && ((opcode & 0x2000000) == 0)) { return op_type::ARM_7; }
+			}
+
+			return op_type::ARM_6;
+		}
+
+		if(((opcode >> 26) & 0x3) == 0x0)
+		{
+			if((opcode & 0x80) && ((opcode & 0x10) == 0))
+			{
+				if(opcode & 0x2000000) { return op_type::ARM_5; }
+				if((opcode & 0x100000) && (((opcode >> 23) & 0x3) == 0x2)) { return op_type::ARM_5; }
+				if(((opcode >> 23) & 0x3) != 0x2) { return op_type::ARM_5; }
+
+				return op_type::ARM_7;
+			}
+
+			if((opcode & 0x80) && (opcode & 0x10))
+			{
+				if(((opcode >> 4) & 0xF) == 0x9)
+				{
+					if(opcode & 0x2000000) { return op_type::ARM_5; }
+					if(((opcode >> 23) & 0x3) == 0x2) { return op_type::ARM_12; }
+
+					return op_type::ARM_7;
+				}
+
+				return (opcode & 0x2000000) ? op_type::ARM_5 : op_type::ARM_10;
+			}
+
+			return op_type::ARM_5;
+		}
+
+		if(((opcode >> 26) & 0x3) == 0x1) { return op_type::ARM_9; }
+		if(((opcode >> 25) & 0x7) == 0x4) { return op_type::ARM_11; }
+		if(((opcode >> 24) & 0xF) == 0xF) { return op_type::ARM_13; }
+
+		//Coprocessor instructions
+		if constexpr((flags & ARM_DECODE_ARMV5) != 0)
+		{
+			if(((opcode >> 24) & 0xF) == 0xE) { return (opcode & 0x10) ? op_type::ARM_COP_REG_TRANSFER : op_type::ARM_COP_DATA_OP; }
+			if(((opcode >> 25) & 0x7) == 0x6) { return op_type::ARM_COP_DATA_TRANSFER; }
+		}
+
+		return op_type::UNDEFINED;
+	}
+
+	/****** Builds the THUMB table, keyed on bits 15-6 ******/
+	template <typename op_type, u32 flags>
+	constexpr std::array<u8, 1024> build_thumb_table()
+	{
+		std::array<u8, 1024> table {};
+
+		for(u32 key = 0; key < 1024; key++)
+		{
+			u8 low = u8(classify_thumb<op_type, flags>(key << 6));
+			u8 high = u8(classify_thumb<op_type, flags>((key << 6) | 0x3F));
+
+			table[key] = (low == high) ? low : ARM_DECODE_FULL;
+		}
+
+		return table;
+	}
+
+	/****** Builds the ARM table, keyed on bits 27-20 and 7-4 ******/
+	template <typename op_type, u32 flags>
+	constexpr std::array<u8, 4096> build_arm_table()
+	{
+		std::array<u8, 4096> table {};
+
+		for(u32 key = 0; key < 4096; key++)
+		{
+			u32 opcode = ((key & 0xFF0) << 16) | ((key & 0xF) << 4);
+
+			//Every rule compares whole nibbles outside of the key against all 0s or all 1s
+			//Keys where those nibbles change the result fall back to a full decode (BX, CLZ, QADD, QSUB)
+			u8 low = u8(classify_arm<op_type, flags>(opcode));
+			u8 high = u8(classify_arm<op_type, flags>(opcode | 0xF00FFF0F));
+
+			table[key] = (low == high) ? low : ARM_DECODE_FULL;
+		}
+
+		return table;
+	}
+
+	template <typename op_type, u32 flags>
+	struct tables
+	{
+		static constexpr std::array<u8, 1024> thumb = build_thumb_table<op_type, flags>();
+		static constexpr std::array<u8, 4096> arm = build_arm_table<op_type, flags>();
+	};
+
+	/****** Decodes a THUMB instruction ******/
+	template <typename op_type, u32 flags>
+	inline op_type decode_thumb(u16 opcode)
+	{
+		u8 operation = tables<op_type, flags>::thumb[opcode >> 6];
+		return (operation == ARM_DECODE_FULL) ? classify_thumb<op_type, flags>(opcode) : op_type(operation);
+	}
+
+	/****** Decodes an ARM instruction ******/
+	template <typename op_type, u32 flags>
+	inline op_type decode_arm(u32 opcode)
+	{
+		u8 operation = tables<op_type, flags>::arm[((opcode >> 16) & 0xFF0) | ((opcode >> 4) & 0xF)];
+		return (operation == ARM_DECODE_FULL) ? classify_arm<op_type, flags>(opcode) : op_type(operation);
+	}
+
+	/****** Checks whether an executed instruction only reads memory or works on registers - Used to find idle loops ******/
+	template <typename op_type>
+	constexpr bool is_idle_op(op_type operation, u32 opcode)
+	{
+		switch(operation)
+		{
+			//THUMB ALU operations and branches
+			case op_type::THUMB_1:
+			case op_type::THUMB_2:
+			case op_type::THUMB_3:
+			case op_type::THUMB_4:
+			case op_type::THUMB_6:
+			case op_type::THUMB_12:
+			case op_type::THUMB_13:
+			case op_type::THUMB_18:
+				return true;
+
+			//THUMB hi register operations - Anything except BX, BLX, or writing to PC
+			case op_type::THUMB_5:
+				if(((opcode >> 8) & 0x3) == 0x3) { return false; }
+				return ((((opcode >> 8) & 0x3) == 0x1) || (((opcode & 0x7) | ((opcode >> 4) & 0x8)) != 15));
+
+			//THUMB loads
+			case op_type::THUMB_7:
+			case op_type::THUMB_9:
+			case op_type::THUMB_10:
+			case op_type::THUMB_11:
+			case op_type::THUMB_15:
+				return ((opcode & 0x800) != 0);
+
+			//THUMB loads - Only STRH stores
+			case op_type::THUMB_8:
+				return ((opcode & 0xC00) != 0);
+
+			//THUMB conditional branches - Except SWI
+			case op_type::THUMB_16:
+				return (((opcode >> 8) & 0xF) != 0xF);
+
+			//ARM branches - Except BL and BLX
+			case op_type::ARM_4:
+				return (((opcode & 0x1000000) == 0) && ((opcode >> 28) != 0xF));
+
+			//ARM data processing - Except writing to PC
+			case op_type::ARM_5:
+				return (((opcode >> 12) & 0xF) != 15);
+
+			//ARM PSR transfers - MRS only
+			case op_type::ARM_6:
+				return ((opcode & 0x200000) == 0);
+
+			//ARM multiplies
+			case op_type::ARM_7:
+				return true;
+
+			//ARM loads - Except loading PC
+			case op_type::ARM_9:
+			case op_type::ARM_10:
+				return ((opcode & 0x100000) && (((opcode >> 12) & 0xF) != 15));
+
+			//ARM block loads - Except loading PC or user registers
+			case op_type::ARM_11:
+				return ((opcode & 0x100000) && ((opcode & 0x408000) == 0));
+
+			default:
+				return false;
+		}
+	}
+
+	/****** Checks whether a taken branch could close an idle loop ******/
+	template <typename op_type>
+	constexpr bool is_loop_branch(op_type operation, u32 opcode)
+	{
+		if((operation == op_type::THUMB_16) || (operation == op_type::THUMB_18)) { return true; }
+		return ((operation == op_type::ARM_4) && ((opcode & 0x1000000) == 0) && ((opcode >> 28) != 0xF));
+	}
+}
+
+#endif // GBE_ARM_DECODER
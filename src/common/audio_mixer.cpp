@@ -0,0 +1,130 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : audio_mixer.cpp
+// Date : October 16, 2026
+// Description : Software audio mixer
+//
+// Provides preallocated per-channel buffers for SDL audio callbacks
+// Mixes channels with integer gains, no allocation happens on the audio thread
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "audio_mixer.h"
+
+#ifdef __SSE2__
+
+/****** Scales the even 32-bit lanes of a sample vector by an unsigned 8.24 multiplier ******/
+static inline __m128i scale_even_lanes(__m128i magnitude, __m128i sign, __m128i scale)
+{
+	//Exact 64-bit products of each sample's magnitude
+	__m128i product = _mm_mul_epu32(magnitude, scale);
+
+	//Negative samples round away from zero here, so negating afterwards floors like an arithmetic shift
+	product = _mm_add_epi64(product, _mm_and_si128(sign, _mm_set_epi32(0, 0xFFFFFF, 0, 0xFFFFFF)));
+	product = _mm_srli_epi64(product, 24);
+
+	//Anything that doesn't fit in 31 bits saturates later anyway
+	__m128i fits = _mm_cmpeq_epi32(_mm_srli_epi64(product, 31), _mm_setzero_si128());
+	fits = _mm_shuffle_epi32(fits, _MM_SHUFFLE(2, 2, 0, 0));
+	product = _mm_or_si128(_mm_and_si128(fits, product), _mm_andnot_si128(fits, _mm_set1_epi32(0x7FFFFFFF)));
+
+	return _mm_and_si128(product, _mm_set_epi32(0, -1, 0, -1));
+}
+
+/****** Scales 4 samples by an unsigned 8.24 multiplier, matching (sample * scale) >> 24 ******/
+static inline __m128i scale_samples(__m128i sample, __m128i scale)
+{
+	__m128i sign = _mm_srai_epi32(sample, 31);
+	__m128i magnitude = _mm_sub_epi32(_mm_xor_si128(sample, sign), sign);
+
+	__m128i even = scale_even_lanes(magnitude, sign, scale);
+	__m128i odd = scale_even_lanes(_mm_srli_epi64(magnitude, 32), _mm_srli_epi64(sign, 32), scale);
+	__m128i result = _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+
+	//Restore the sign
+	return _mm_sub_epi32(_mm_xor_si128(result, sign), sign);
+}
+
+#endif
+
+/****** Audio Mixer Constructor ******/
+audio_mixer::audio_mixer()
+{
+	max_length = 0;
+}
+
+/****** Audio Mixer Destructor ******/
+audio_mixer::~audio_mixer() { }
+
+/****** Allocates buffers for a number of channels, each holding up to a given number of samples ******/
+void audio_mixer::init(u32 channel_count, u32 length)
+{
+	max_length = length;
+
+	channel_buffer.assign((channel_count * length), 0);
+	accumulator.assign(length, 0);
+}
+
+/****** Resets the mixed output ******/
+void audio_mixer::clear(u32 length)
+{
+	s32* acc = &accumulator[0];
+	for(u32 x = 0; x < length; x++) { acc[x] = 0; }
+}
+
+/****** Adds 16-bit samples to the mixed output, scaled by an integer gain ******/
+void audio_mixer::add(const s16* source, u32 length, s32 gain)
+{
+	s32* acc = &accumulator[0];
+	for(u32 x = 0; x < length; x++) { acc[x] += (source[x] * gain); }
+}
+
+/****** Adds 32-bit samples to the mixed output, scaled by an integer gain ******/
+void audio_mixer::add(const s32* source, u32 length, s32 gain)
+{
+	s32* acc = &accumulator[0];
+	for(u32 x = 0; x < length; x++) { acc[x] += (source[x] * gain); }
+}
+
+/****** Writes the mixed output as 16-bit samples, multiplied by gain / divisor ******/
+void audio_mixer::output(s16* stream, u32 length, s32 gain, s32 divisor)
+{
+	if(divisor == 0) { return; }
+
+	//Fold the gain and divisor into a single 8.24 fixed-point multiplier
+	s64 scale = ((s64)gain << 24) / divisor;
+	const s32* acc = &accumulator[0];
+	u32 x = 0;
+
+	#ifdef __SSE2__
+
+	//Scale 8 samples at a time with exact integer math, so results match the scalar path bit-for-bit
+	if((scale >= 0) && (scale <= 0xFFFFFFFF))
+	{
+		__m128i vec_scale = _mm_set_epi32(0, (u32)scale, 0, (u32)scale);
+
+		for(; (x + 8) <= length; x += 8)
+		{
+			__m128i low = scale_samples(_mm_loadu_si128((const __m128i*)&acc[x]), vec_scale);
+			__m128i high = scale_samples(_mm_loadu_si128((const __m128i*)&acc[x + 4]), vec_scale);
+
+			_mm_storeu_si128((__m128i*)&stream[x], _mm_packs_epi32(low, high));
+		}
+	}
+
+	#endif
+
+	for(; x < length; x++)
+	{
+		s64 out_sample = (acc[x] * scale) >> 24;
+
+		if(out_sample > 32767) { out_sample = 32767; }
+		else if(out_sample < -32768) { out_sample = -32768; }
+
+		stream[x] = out_sample;
+	}
+}
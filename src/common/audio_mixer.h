@@ -0,0 +1,46 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : audio_mixer.h
+// Date : October 16, 2026
+// Description : Software audio mixer
+//
+// Provides preallocated per-channel buffers for SDL audio callbacks
+// Mixes channels with integer gains, no allocation happens on the audio thread
+
+#ifndef GBE_AUDIO_MIXER
+#define GBE_AUDIO_MIXER
+
+#include <vector>
+
+#include "common.h"
+
+class audio_mixer
+{
+	public:
+
+	audio_mixer();
+	~audio_mixer();
+
+	//Allocates all buffers - Must be called before the audio device starts
+	void init(u32 channel_count, u32 length);
+
+	u32 get_max_length() const { return max_length; }
+
+	s16* get_channel(u32 id) { return &channel_buffer[id * max_length]; }
+	s32* get_accumulator() { return &accumulator[0]; }
+
+	void clear(u32 length);
+	void add(const s16* source, u32 length, s32 gain);
+	void add(const s32* source, u32 length, s32 gain);
+	void output(s16* stream, u32 length, s32 gain, s32 divisor);
+
+	private:
+
+	std::vector<s16> channel_buffer;
+	std::vector<s32> accumulator;
+	u32 max_length;
+};
+
+#endif // GBE_AUDIO_MIXER
@@ -0,0 +1,347 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : avi_reader.cpp
+// Date : October 16, 2026
+// Description : Streaming AVI reader
+//
+// Parses RIFF AVI headers and the idx1 index, then reads individual chunks from disk on demand
+// Only the chunk table stays in memory, not the video data itself
+
+#include <iostream>
+
+#include "avi_reader.h"
+
+//FOURCCs as little-endian 32-bit values
+#define AVI_FOURCC_RIFF 0x46464952
+#define AVI_FOURCC_AVI 0x20495641
+#define AVI_FOURCC_LIST 0x5453494C
+#define AVI_FOURCC_HDRL 0x6C726468
+#define AVI_FOURCC_STRL 0x6C727473
+#define AVI_FOURCC_STRH 0x68727473
+#define AVI_FOURCC_STRF 0x66727473
+#define AVI_FOURCC_MOVI 0x69766F6D
+#define AVI_FOURCC_IDX1 0x31786469
+#define AVI_FOURCC_VIDS 0x73646976
+#define AVI_FOURCC_AUDS 0x73647561
+
+//Upper half of stream chunk IDs, e.g. 00dc, 00db, 01wb
+#define AVI_CHUNK_DC 0x6364
+#define AVI_CHUNK_DB 0x6264
+#define AVI_CHUNK_WB 0x6277
+
+/****** AVI reader constructor ******/
+avi_reader::avi_reader()
+{
+	lock = SDL_CreateMutex();
+	file_size = 0;
+	movi_start = 0;
+	movi_end = 0;
+	video_stream = -1;
+	audio_stream = -1;
+	audio_channels = 0;
+	audio_sample_rate = 0;
+}
+
+/****** AVI reader destructor ******/
+avi_reader::~avi_reader()
+{
+	close();
+
+	if(lock != NULL) { SDL_DestroyMutex(lock); }
+	lock = NULL;
+}
+
+/****** Opens an AVI file and builds its chunk table ******/
+bool avi_reader::open(std::string filename)
+{
+	close();
+
+	file.open(filename.c_str(), std::ios::binary);
+
+	if(!file.is_open())
+	{
+		std::cout<<"GBE::Error - Could not open AVI file " << filename << "\n";
+		return false;
+	}
+
+	file.seekg(0, file.end);
+	file_size = file.tellg();
+	file.seekg(0, file.beg);
+
+	if((file_size < 12) || (read_u32(0) != AVI_FOURCC_RIFF) || (read_u32(8) != AVI_FOURCC_AVI))
+	{
+		std::cout<<"GBE::Error - " << filename << " is not a valid AVI file\n";
+		close();
+		return false;
+	}
+
+	u32 end = read_u32(4) + 8;
+	if((end > file_size) || (end < 8)) { end = file_size; }
+
+	bool has_index = false;
+	u32 pos = 12;
+
+	//Walk top-level chunks - Only headers and the index are read here
+	while((pos + 8) <= end)
+	{
+		u32 id = read_u32(pos);
+		u32 size = read_u32(pos + 4);
+		u32 data = pos + 8;
+
+		if((data + size) < data) { break; }
+
+		if((id == AVI_FOURCC_LIST) && (size >= 4))
+		{
+			u32 type = read_u32(data);
+
+			if(type == AVI_FOURCC_HDRL) { parse_hdrl(data + 4, data + size); }
+
+			else if(type == AVI_FOURCC_MOVI)
+			{
+				movi_start = data;
+				movi_end = ((data + size) > file_size) ? file_size : (data + size);
+			}
+		}
+
+		else if(id == AVI_FOURCC_IDX1) { has_index = parse_idx1(data, size); }
+
+		pos = data + size + (size & 0x1);
+	}
+
+	if(movi_start == 0)
+	{
+		std::cout<<"GBE::Error - No movi list found in " << filename << "\n";
+		close();
+		return false;
+	}
+
+	//Without a usable index, walk the chunk headers in the movi list instead
+	if(!has_index) { parse_movi(movi_start + 4, movi_end); }
+
+	return true;
+}
+
+/****** Closes the current AVI file ******/
+void avi_reader::close()
+{
+	if(file.is_open()) { file.close(); }
+	file.clear();
+
+	file_size = 0;
+	movi_start = 0;
+	movi_end = 0;
+	video_stream = -1;
+	audio_stream = -1;
+	audio_channels = 0;
+	audio_sample_rate = 0;
+
+	video_chunks.clear();
+	audio_chunks.clear();
+}
+
+/****** Reads the compressed data for one video frame ******/
+bool avi_reader::read_frame(u32 frame, std::vector<u8>& data)
+{
+	if(frame >= video_chunks.size()) { return false; }
+
+	data.resize(video_chunks[frame].size);
+	if(data.empty()) { return true; }
+
+	return read_bytes(video_chunks[frame].offset, &data[0], data.size());
+}
+
+/****** Reads every audio chunk back to back ******/
+bool avi_reader::read_audio(std::vector<u8>& data)
+{
+	data.resize(get_audio_size());
+	u32 pos = 0;
+
+	for(u32 x = 0; x < audio_chunks.size(); x++)
+	{
+		if(!audio_chunks[x].size) { continue; }
+		if(!read_bytes(audio_chunks[x].offset, &data[pos], audio_chunks[x].size)) { return false; }
+		pos += audio_chunks[x].size;
+	}
+
+	return true;
+}
+
+/****** Returns the total size of all audio chunks ******/
+u32 avi_reader::get_audio_size() const
+{
+	u32 total = 0;
+	for(u32 x = 0; x < audio_chunks.size(); x++) { total += audio_chunks[x].size; }
+	return total;
+}
+
+/****** Reads bytes from the file ******/
+bool avi_reader::read_bytes(u32 offset, u8* data, u32 length)
+{
+	if(((offset + length) > file_size) || ((offset + length) < offset)) { return false; }
+
+	SDL_LockMutex(lock);
+
+	file.clear();
+	file.seekg(offset, file.beg);
+	file.read((char*)data, length);
+	bool result = (file.gcount() == length);
+
+	SDL_UnlockMutex(lock);
+
+	return result;
+}
+
+/****** Reads a little-endian 32-bit value from the file ******/
+u32 avi_reader::read_u32(u32 offset)
+{
+	u8 data[4];
+	if(!read_bytes(offset, data, 4)) { return 0; }
+
+	return (data[3] << 24) | (data[2] << 16) | (data[1] << 8) | data[0];
+}
+
+/****** Parses stream headers to find the video and audio streams ******/
+void avi_reader::parse_hdrl(u32 start, u32 end)
+{
+	s32 stream_index = -1;
+	u32 stream_type = 0;
+
+	u32 pos = start;
+
+	while((pos + 8) <= end)
+	{
+		u32 id = read_u32(pos);
+		u32 size = read_u32(pos + 4);
+		u32 data = pos + 8;
+
+		if((data + size) < data) { return; }
+
+		//Each strl list describes one stream, in stream number order
+		if((id == AVI_FOURCC_LIST) && (size >= 4) && (read_u32(data) == AVI_FOURCC_STRL))
+		{
+			stream_index++;
+			stream_type = 0;
+
+			u32 sub_pos = data + 4;
+			u32 sub_end = data + size;
+
+			while((sub_pos + 8) <= sub_end)
+			{
+				u32 sub_id = read_u32(sub_pos);
+				u32 sub_size = read_u32(sub_pos + 4);
+				u32 sub_data = sub_pos + 8;
+
+				if((sub_data + sub_size) < sub_data) { break; }
+
+				if((sub_id == AVI_FOURCC_STRH) && (sub_size >= 4))
+				{
+					stream_type = read_u32(sub_data);
+
+					if((stream_type == AVI_FOURCC_VIDS) && (video_stream < 0)) { video_stream = stream_index; }
+					else if((stream_type == AVI_FOURCC_AUDS) && (audio_stream < 0)) { audio_stream = stream_index; }
+				}
+
+				//WAVEFORMATEX - Only PCM audio is usable
+				else if((sub_id == AVI_FOURCC_STRF) && (sub_size >= 8) && (stream_type == AVI_FOURCC_AUDS) && (audio_stream == stream_index))
+				{
+					u32 format = read_u32(sub_data);
+
+					if((format & 0xFFFF) == 0x01)
+					{
+						audio_channels = (format >> 16);
+						audio_sample_rate = read_u32(sub_data + 4);
+					}
+				}
+
+				sub_pos = sub_data + sub_size + (sub_size & 0x1);
+			}
+		}
+
+		pos = data + size + (size & 0x1);
+	}
+}
+
+/****** Builds the chunk table from the idx1 index ******/
+bool avi_reader::parse_idx1(u32 start, u32 size)
+{
+	u32 count = size / 16;
+	if(!count) { return false; }
+
+	std::vector<u8> index(count * 16);
+	if(!read_bytes(start, &index[0], index.size())) { return false; }
+
+	//Offsets are normally relative to the movi FOURCC, but some muxers write absolute file offsets
+	u32 first_id = (index[3] << 24) | (index[2] << 16) | (index[1] << 8) | index[0];
+	u32 first_offset = (index[11] << 24) | (index[10] << 16) | (index[9] << 8) | index[8];
+	u32 base = 0;
+
+	if((movi_start != 0) && (read_u32(movi_start + first_offset) == first_id)) { base = movi_start; }
+	else if(read_u32(first_offset) == first_id) { base = 0; }
+	else { return false; }
+
+	for(u32 x = 0; x < count; x++)
+	{
+		u8* entry = &index[x * 16];
+
+		u32 id = (entry[3] << 24) | (entry[2] << 16) | (entry[1] << 8) | entry[0];
+		u32 offset = (entry[11] << 24) | (entry[10] << 16) | (entry[9] << 8) | entry[8];
+		u32 length = (entry[15] << 24) | (entry[14] << 16) | (entry[13] << 8) | entry[12];
+
+		add_chunk(id, base + offset + 8, length);
+	}
+
+	return true;
+}
+
+/****** Builds the chunk table by walking the movi list ******/
+void avi_reader::parse_movi(u32 start, u32 end)
+{
+	u32 pos = start;
+
+	while((pos + 8) <= end)
+	{
+		u32 id = read_u32(pos);
+		u32 size = read_u32(pos + 4);
+		u32 data = pos + 8;
+
+		if((data + size) < data) { return; }
+
+		//Chunks may be grouped into rec lists
+		if((id == AVI_FOURCC_LIST) && (size >= 4)) { parse_movi(data + 4, data + size); }
+		else { add_chunk(id, data, size); }
+
+		pos = data + size + (size & 0x1);
+	}
+}
+
+/****** Adds a chunk to the video or audio table if it belongs to either stream ******/
+void avi_reader::add_chunk(u32 id, u32 offset, u32 size)
+{
+	if(((offset + size) > file_size) || ((offset + size) < offset)) { return; }
+
+	u8 digit_1 = (id & 0xFF) - 0x30;
+	u8 digit_2 = ((id >> 8) & 0xFF) - 0x30;
+	if((digit_1 > 9) || (digit_2 > 9)) { return; }
+
+	s32 stream = (digit_1 * 10) + digit_2;
+	u16 type = (id >> 16);
+
+	chunk_entry entry;
+	entry.offset = offset;
+	entry.size = size;
+
+	//Fall back to the first stream of each kind if headers did not describe it
+	if((type == AVI_CHUNK_DC) || (type == AVI_CHUNK_DB))
+	{
+		if(video_stream < 0) { video_stream = stream; }
+		if(stream == video_stream) { video_chunks.push_back(entry); }
+	}
+
+	else if(type == AVI_CHUNK_WB)
+	{
+		if(audio_stream < 0) { audio_stream = stream; }
+		if(stream == audio_stream) { audio_chunks.push_back(entry); }
+	}
+}
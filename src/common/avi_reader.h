@@ -0,0 +1,76 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : avi_reader.h
+// Date : October 16, 2026
+// Description : Streaming AVI reader
+//
+// Parses RIFF AVI headers and the idx1 index, then reads individual chunks from disk on demand
+// Only the chunk table stays in memory, not the video data itself
+
+#ifndef GBE_AVI_READER
+#define GBE_AVI_READER
+
+#include <SDL2/SDL.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+class avi_reader
+{
+	public:
+
+	avi_reader();
+	~avi_reader();
+
+	avi_reader(const avi_reader&) = delete;
+	avi_reader& operator=(const avi_reader&) = delete;
+
+	bool open(std::string filename);
+	void close();
+
+	bool read_frame(u32 frame, std::vector<u8>& data);
+	bool read_audio(std::vector<u8>& data);
+
+	u32 get_frame_count() const { return video_chunks.size(); }
+	u32 get_audio_size() const;
+
+	//PCM audio format from the audio stream header, zero if missing or not PCM
+	u16 audio_channels;
+	u32 audio_sample_rate;
+
+	private:
+
+	struct chunk_entry
+	{
+		u32 offset;
+		u32 size;
+	};
+
+	bool read_bytes(u32 offset, u8* data, u32 length);
+	u32 read_u32(u32 offset);
+
+	void parse_hdrl(u32 start, u32 end);
+	bool parse_idx1(u32 start, u32 size);
+	void parse_movi(u32 start, u32 end);
+	void add_chunk(u32 id, u32 offset, u32 size);
+
+	std::ifstream file;
+	u32 file_size;
+	u32 movi_start;
+	u32 movi_end;
+
+	s32 video_stream;
+	s32 audio_stream;
+
+	std::vector<chunk_entry> video_chunks;
+	std::vector<chunk_entry> audio_chunks;
+
+	//Chunks may be read from a decoder thread and the emulation thread
+	SDL_mutex* lock;
+};
+
+#endif // GBE_AVI_READER
@@ -0,0 +1,390 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : backup_journal.cpp
+// Date : October 16, 2026
+// Description : Battery save journal
+//
+// Appends changed parts of battery saves to a journal file on a background thread while a game runs
+// The journal is folded back into the save file when it grows too large, or when the next session loads it after a crash
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+#include "backup_journal.h"
+#include "util.h"
+
+//Journal file layout - "GBEJ", the save size, then records of offset, length, data, and CRC32
+//The first record always holds the whole save, so the journal never depends on the save file being intact
+#define BACKUP_JOURNAL_MAGIC 0x4A454247
+
+/****** Backup journal constructor ******/
+backup_journal::backup_journal()
+{
+	active = false;
+	dirty = false;
+	baseline = false;
+	restart = false;
+	flush_needed = false;
+	last_sync = 0;
+	journal_size = 0;
+
+	thread = NULL;
+	lock = NULL;
+	work_ready = NULL;
+	quit = false;
+}
+
+/****** Backup journal destructor ******/
+backup_journal::~backup_journal()
+{
+	stop();
+}
+
+/****** Starts journaling a save file - The first sync afterwards takes the whole save as a starting point ******/
+void backup_journal::start(std::string filename)
+{
+	stop();
+
+	save_file = filename;
+	journal_file = filename + ".journal";
+
+	image.clear();
+	dirty_blocks.clear();
+	pending.clear();
+
+	dirty = false;
+	baseline = false;
+	restart = true;
+	flush_needed = false;
+	last_sync = SDL_GetTicks();
+	journal_size = 0;
+	quit = false;
+
+	lock = SDL_CreateMutex();
+	work_ready = SDL_CreateCond();
+
+	if((lock != NULL) && (work_ready != NULL)) { thread = SDL_CreateThread(flusher_main, "backup_journal", this); }
+
+	if(thread == NULL)
+	{
+		std::cout<<"GBE::Warning - Could not create save journal thread : " << SDL_GetError() << "\n";
+		stop();
+		return;
+	}
+
+	active = true;
+}
+
+/****** Writes anything still pending to the journal, then stops the flusher thread ******/
+void backup_journal::stop()
+{
+	if(thread != NULL)
+	{
+		SDL_LockMutex(lock);
+		quit = true;
+		SDL_CondSignal(work_ready);
+		SDL_UnlockMutex(lock);
+
+		SDL_WaitThread(thread, NULL);
+		thread = NULL;
+	}
+
+	if(work_ready != NULL) { SDL_DestroyCond(work_ready); }
+	if(lock != NULL) { SDL_DestroyMutex(lock); }
+
+	work_ready = NULL;
+	lock = NULL;
+	active = false;
+}
+
+/****** Deletes the journal - Call stop() first, then this once the full save file has been written ******/
+void backup_journal::finish()
+{
+	//The flusher may still be folding the journal into the save file, never let it run past the final save
+	stop();
+
+	if(!journal_file.empty()) { std::remove(journal_file.c_str()); }
+	journal_file = "";
+}
+
+/****** Starts copying changed blocks from the save - Returns false if there is nothing to do yet ******/
+bool backup_journal::begin_sync(u32 size)
+{
+	if((!active) || (!size)) { return false; }
+
+	bool resized = (size != image.size());
+
+	//Batch writes together, a game saving usually writes a lot over several frames
+	if(!resized)
+	{
+		if(!dirty) { return false; }
+		if((SDL_GetTicks() - last_sync) < BACKUP_JOURNAL_INTERVAL) { return false; }
+	}
+
+	last_sync = SDL_GetTicks();
+
+	SDL_LockMutex(lock);
+
+	//A new or resized save replaces the journal, starting with a copy of the whole save
+	if(resized)
+	{
+		image.resize(size);
+		pending.clear();
+
+		baseline = true;
+		restart = true;
+		flush_needed = dirty;
+	}
+
+	return true;
+}
+
+/****** Copies changed blocks from one part of the save, recording each block that really changed ******/
+void backup_journal::sync_segment(u32 offset, const u8* data, u32 length)
+{
+	if((offset >= image.size()) || (!length)) { return; }
+	if(length > (image.size() - offset)) { length = image.size() - offset; }
+
+	if(baseline)
+	{
+		memcpy(&image[offset], data, length);
+		return;
+	}
+
+	u32 pos = 0;
+
+	while(pos < length)
+	{
+		u32 address = offset + pos;
+		u32 block = (address >> BACKUP_JOURNAL_BLOCK_SHIFT);
+		u32 chunk = BACKUP_JOURNAL_BLOCK_SIZE - (address & (BACKUP_JOURNAL_BLOCK_SIZE - 1));
+		if(chunk > (length - pos)) { chunk = length - pos; }
+
+		if((block < dirty_blocks.size()) && (dirty_blocks[block]) && (memcmp(&image[address], data + pos, chunk) != 0))
+		{
+			memcpy(&image[address], data + pos, chunk);
+			add_record(address, data + pos, chunk);
+			flush_needed = true;
+		}
+
+		pos += chunk;
+	}
+}
+
+/****** Finishes a sync and wakes the flusher if anything changed ******/
+void backup_journal::end_sync()
+{
+	if(!active) { return; }
+
+	for(u32 x = 0; x < dirty_blocks.size(); x++) { dirty_blocks[x] = 0; }
+
+	dirty = false;
+	baseline = false;
+
+	if(flush_needed) { SDL_CondSignal(work_ready); }
+
+	SDL_UnlockMutex(lock);
+}
+
+/****** Queues one record for the flusher ******/
+void backup_journal::add_record(u32 offset, const u8* data, u32 length)
+{
+	u32 start = pending.size();
+
+	pending.resize(start + 8 + length + 4);
+	u8* record = &pending[start];
+
+	memcpy(record, &offset, 4);
+	memcpy(record + 4, &length, 4);
+	memcpy(record + 8, data, length);
+
+	u32 crc = util::get_crc32(record, 8 + length);
+	memcpy(record + 8 + length, &crc, 4);
+}
+
+/****** Flusher thread - Appends records to the journal, starts new journals, and folds large ones into the save file ******/
+int backup_journal::flusher_main(void* ptr)
+{
+	backup_journal* journal = (backup_journal*)ptr;
+
+	std::vector<u8> records;
+	std::vector<u8> save_copy;
+
+	SDL_LockMutex(journal->lock);
+
+	while(true)
+	{
+		if(!journal->flush_needed)
+		{
+			if(journal->quit) { break; }
+
+			SDL_CondWait(journal->work_ready, journal->lock);
+			continue;
+		}
+
+		journal->flush_needed = false;
+
+		bool rewrite = journal->restart;
+		bool compact = (!rewrite) && ((journal->journal_size + journal->pending.size()) > ((journal->image.size() * 2) + 0x10000));
+
+		records.clear();
+		records.swap(journal->pending);
+
+		//New journals begin with the whole save, compaction writes the whole save, both use a copy that matches every record so far
+		if(rewrite || compact) { save_copy = journal->image; }
+
+		journal->restart = compact;
+
+		SDL_UnlockMutex(journal->lock);
+
+		if(compact)
+		{
+			//Bring the journal up to date first - If the session dies before the journal is removed, recovery then rewrites the same data
+			append_records(journal->journal_file, records);
+
+			//The next flush starts a fresh journal
+			if(write_save(journal->save_file, save_copy)) { std::remove(journal->journal_file.c_str()); }
+			journal->journal_size = 0;
+		}
+
+		else if(rewrite)
+		{
+			std::ofstream file(journal->journal_file.c_str(), std::ios::binary | std::ios::trunc);
+
+			u32 header[2] = { BACKUP_JOURNAL_MAGIC, u32(save_copy.size()) };
+			u32 base[2] = { 0, u32(save_copy.size()) };
+			u32 crc = util::update_crc32(util::get_crc32((u8*)base, 8), &save_copy[0], save_copy.size());
+
+			file.write((char*)header, 8);
+			file.write((char*)base, 8);
+			file.write((char*)&save_copy[0], save_copy.size());
+			file.write((char*)&crc, 4);
+			file.close();
+
+			if(!file.good()) { std::cout<<"GBE::Warning - Could not write save journal " << journal->journal_file << "\n"; }
+			journal->journal_size = 20 + save_copy.size();
+		}
+
+		else if(!records.empty())
+		{
+			append_records(journal->journal_file, records);
+			journal->journal_size += records.size();
+		}
+
+		SDL_LockMutex(journal->lock);
+	}
+
+	SDL_UnlockMutex(journal->lock);
+	return 0;
+}
+
+/****** Appends queued records to the end of a journal ******/
+void backup_journal::append_records(std::string filename, const std::vector<u8>& records)
+{
+	if(records.empty()) { return; }
+
+	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::app);
+	file.write((char*)&records[0], records.size());
+	file.close();
+
+	if(!file.good()) { std::cout<<"GBE::Warning - Could not write save journal " << filename << "\n"; }
+}
+
+/****** Replaces a save file without ever leaving a partially written one behind ******/
+bool backup_journal::write_save(std::string filename, const std::vector<u8>& data)
+{
+	std::string temp_file = filename + ".tmp";
+	std::ofstream file(temp_file.c_str(), std::ios::binary | std::ios::trunc);
+
+	if(!file.is_open()) { return false; }
+
+	if(!data.empty()) { file.write((char*)&data[0], data.size()); }
+	file.close();
+
+	if(!file.good())
+	{
+		std::remove(temp_file.c_str());
+		return false;
+	}
+
+	//Some systems refuse to rename over an existing file
+	if(std::rename(temp_file.c_str(), filename.c_str()) != 0)
+	{
+		std::remove(filename.c_str());
+
+		if(std::rename(temp_file.c_str(), filename.c_str()) != 0)
+		{
+			std::remove(temp_file.c_str());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/****** Folds a journal left behind by a crashed session into its save file - Returns true if the save file was updated ******/
+bool backup_journal::recover(std::string filename)
+{
+	std::string journal_name = filename + ".journal";
+	std::ifstream file(journal_name.c_str(), std::ios::binary);
+
+	if(!file.is_open()) { return false; }
+
+	u32 header[2] = { 0, 0 };
+	file.read((char*)header, 8);
+
+	std::vector<u8> data;
+	std::vector<u8> record;
+	u32 record_count = 0;
+
+	if((file.good()) && (header[0] == BACKUP_JOURNAL_MAGIC) && (header[1] != 0) && (header[1] <= 0x10000000))
+	{
+		data.resize(header[1], 0);
+
+		//Apply records in order, stopping at the first one cut short by the crash
+		while(true)
+		{
+			u32 info[2] = { 0, 0 };
+			file.read((char*)info, 8);
+
+			if(!file.good()) { break; }
+			if((info[1] == 0) || (info[1] > data.size()) || (info[0] > (data.size() - info[1]))) { break; }
+
+			//The first record must cover the whole save
+			if((record_count == 0) && ((info[0] != 0) || (info[1] != data.size()))) { break; }
+
+			record.resize(8 + info[1]);
+			memcpy(&record[0], info, 8);
+			file.read((char*)&record[8], info[1]);
+
+			u32 crc = 0;
+			file.read((char*)&crc, 4);
+
+			if((!file.good()) || (crc != util::get_crc32(&record[0], record.size()))) { break; }
+
+			memcpy(&data[info[0]], &record[8], info[1]);
+			record_count++;
+		}
+	}
+
+	file.close();
+
+	bool result = false;
+
+	if(record_count != 0)
+	{
+		result = write_save(filename, data);
+
+		if(result) { std::cout<<"GBE::Recovered save data from journal " << journal_name << "\n"; }
+		else { std::cout<<"GBE::Error - Could not recover save data from journal " << journal_name << "\n"; }
+	}
+
+	//Keep the journal if it could not be applied, otherwise it is no longer needed
+	if((result) || (record_count == 0)) { std::remove(journal_name.c_str()); }
+
+	return result;
+}
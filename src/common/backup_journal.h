@@ -0,0 +1,89 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : backup_journal.h
+// Date : October 16, 2026
+// Description : Battery save journal
+//
+// Appends changed parts of battery saves to a journal file on a background thread while a game runs
+// The journal is folded back into the save file when it grows too large, or when the next session loads it after a crash
+
+#ifndef GBE_BACKUP_JOURNAL
+#define GBE_BACKUP_JOURNAL
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+//Size of the blocks tracked as dirty, in bytes
+#define BACKUP_JOURNAL_BLOCK_SHIFT 8
+#define BACKUP_JOURNAL_BLOCK_SIZE (1 << BACKUP_JOURNAL_BLOCK_SHIFT)
+
+//Minimum time between journal updates, in milliseconds
+#define BACKUP_JOURNAL_INTERVAL 1000
+
+class backup_journal
+{
+	public:
+
+	backup_journal();
+	~backup_journal();
+
+	backup_journal(const backup_journal&) = delete;
+	backup_journal& operator=(const backup_journal&) = delete;
+
+	static bool recover(std::string filename);
+
+	void start(std::string filename);
+	void stop();
+	void finish();
+
+	//Marks part of the save as changed - Only records positions, the data itself is read during syncs
+	void mark(u32 offset, u32 length)
+	{
+		if((!active) || (!length)) { return; }
+
+		u32 last_block = (offset + length - 1) >> BACKUP_JOURNAL_BLOCK_SHIFT;
+		if(last_block >= dirty_blocks.size()) { dirty_blocks.resize(last_block + 1, 0); }
+
+		for(u32 x = (offset >> BACKUP_JOURNAL_BLOCK_SHIFT); x <= last_block; x++) { dirty_blocks[x] = 1; }
+		dirty = true;
+	}
+
+	bool begin_sync(u32 size);
+	void sync_segment(u32 offset, const u8* data, u32 length);
+	void end_sync();
+
+	private:
+
+	static int flusher_main(void* ptr);
+	static bool write_save(std::string filename, const std::vector<u8>& data);
+	static void append_records(std::string filename, const std::vector<u8>& records);
+
+	void add_record(u32 offset, const u8* data, u32 length);
+
+	std::string save_file;
+	std::string journal_file;
+
+	std::vector<u8> image;
+	std::vector<u8> dirty_blocks;
+	std::vector<u8> pending;
+
+	bool active;
+	bool dirty;
+	bool baseline;
+	bool restart;
+	bool flush_needed;
+	u32 last_sync;
+	u32 journal_size;
+
+	SDL_Thread* thread;
+	SDL_mutex* lock;
+	SDL_cond* work_ready;
+	bool quit;
+};
+
+#endif // GBE_BACKUP_JOURNAL
@@ -85,6 +85,7 @@ namespace config
 	u32 hotkey_camera = SDLK_p;
 	u32 hotkey_swap_screen = SDLK_F4;
 	u32 hotkey_shift_screen = SDLK_F3;
+	u32 hotkey_rewind = SDLK_BACKSPACE;
 
 	//Default joystick dead-zone
 	u32 dead_zone = 16000;
@@ -103,7 +104,7 @@ namespace config
 	float motion_scaler = 10.0;
 
 	u32 flags = 0x4;
-	bool pause_emu = false;
+	std::atomic<bool> pause_emu(false);
 	bool use_bios = false;
 	bool use_firmware = false;
 	bool no_cart = false;
@@ -120,9 +121,17 @@ namespace config
 	bool use_opengl = false;
 	bool turbo = false;
 
+	//Headless batch execution
+	bool headless = false;
+	u32 headless_frames = 0;
+	u64 headless_cycles = 0;
+
 	std::string vertex_shader = "vertex.vs";
 	std::string fragment_shader = "fragment.fs";
 
+	//Apply the fragment shader's effect on the CPU when not using OpenGL
+	bool use_sw_filters = false;
+
 	u8 scaling_factor = 1;
 	u8 old_scaling_factor = 1;
 
@@ -175,6 +184,10 @@ namespace config
 	//Max FPS
 	u16 max_fps = 0;
 
+	//Rewind buffer size in MB (0 disables rewind) and the number of frames between rewind states
+	u32 rewind_buffer_size = 0;
+	u32 rewind_interval = 1;
+
 	//Legacy save size
 	bool use_legacy_save_size = false;
 
@@ -238,6 +251,12 @@ namespace config
 	//CPU overclocking flags
 	u32 oc_flags = 0;
 
+	//Fast-forward CPU cores through idle loops
+	bool use_idle_loop_detection = true;
+
+	//Render NDS 2D Engine B on its own thread
+	bool nds_threaded_2d = false;
+
 	//IR database index
 	u32 ir_db_index = 0;
 
@@ -801,6 +820,36 @@ bool parse_cli_args()
 				}
 			}
 
+			//Run without a window, audio device, or frame limiter
+			else if(config::cli_args[x] == "--headless") { config::headless = true; }
+
+			//Set headless frame budget
+			else if(config::cli_args[x] == "--frames")
+			{
+				if((++x) == config::cli_args.size()) { std::cout<<"GBE::Error - No frame count set\n"; }
+
+				else
+				{
+					u32 output = 0;
+					util::from_str(config::cli_args[x], output);
+					config::headless_frames = output;
+				}
+			}
+
+			//Set headless cycle budget
+			else if(config::cli_args[x] == "--cycles")
+			{
+				if((++x) == config::cli_args.size()) { std::cout<<"GBE::Error - No cycle count set\n"; }
+
+				else
+				{
+					std::stringstream temp(config::cli_args[x]);
+					u64 output = 0;
+					if(!(temp >> output)) { std::cout<<"GBE::Error - Could not parse cycle count " << config::cli_args[x] << "\n"; }
+					config::headless_cycles = output;
+				}
+			}
+
 			//Override default audio driver
 			else if((config::cli_args[x] == "-ad") || (config::cli_args[x] == "--audio-driver"))
 			{
@@ -918,6 +967,9 @@ bool parse_cli_args()
 			//Use OpenGL for screen drawing
 			else if(config::cli_args[x] == "--opengl") { config::use_opengl = true; }
 
+			//Use software versions of the scaling filters and shaders
+			else if(config::cli_args[x] == "--sw-filters") { config::use_sw_filters = true; }
+
 			//Use Gameshark or Game Genie cheats
 			else if(config::cli_args[x] == "--cheats") { config::use_cheats = true; }
 
@@ -971,6 +1023,12 @@ bool parse_cli_args()
 			//Ignore Illegal Opcodes
 			else if(config::cli_args[x] == "--ignore-illegal-opcodes") { config::ignore_illegal_opcodes = true; }
 
+			//Disable idle loop detection
+			else if(config::cli_args[x] == "--no-idle-loop-detection") { config::use_idle_loop_detection = false; }
+
+			//Enable threaded NDS 2D rendering
+			else if(config::cli_args[x] == "--nds-threaded-2d") { config::nds_threaded_2d = true; }
+
 			//Auto Generate AM3 SmartMedia ID
 			else if(config::cli_args[x] == "--auto-gen-smid") { config::auto_gen_am3_id = true; }
 
@@ -1006,6 +1064,7 @@ bool parse_cli_args()
 				std::cout<<"--agb-glucoboy \t\t\t Use GBA Glucoboy cart\n";
 				std::cout<<"--agb-tv-tuner \t\t\t Use Agatsuma TV Tuner cart\n";
 				std::cout<<"--opengl \t\t\t\t Use OpenGL for screen drawing and scaling\n";
+				std::cout<<"--sw-filters \t\t\t\t Apply the fragment shader's filter in software without OpenGL\n";
 				std::cout<<"--cheats \t\t\t\t Use Gameshark or Game Genie cheats\n";
 				std::cout<<"--patch \t\t\t\t Use a patch file for the ROM\n";
 				std::cout<<"--2x, --3x, --4x, --5x, --6x \t\t Scale screen by a given factor (OpenGL only)\n";
@@ -1026,10 +1085,15 @@ bool parse_cli_args()
 				std::cout<<"--turbo-file-memcard \t\t\t Enable memory card for Turbo File\n";
 				std::cout<<"--turbo-file-protect \t\t\t Enable write-proection for Turbo File\n";
 				std::cout<<"--ignore-illegal-opcodes \t\t\t Ignore Illegal CPU instructions when running\n";
+				std::cout<<"--no-idle-loop-detection \t\t\t Run every iteration of idle loops instead of skipping them\n";
+				std::cout<<"--nds-threaded-2d \t\t\t Render the NDS sub screen on another thread\n";
 				std::cout<<"--auto-gen-smid \t\t\t\t Automatically generate 16-byte SmartMedia ID for AM3\n";
 				std::cout<<"--use-am3-folder \t\t\t\t Use folder of AM3 files instead of SmartMedia image\n";
 				std::cout<<"--save-import \t\t\t\t Import save from specified file\n";
 				std::cout<<"--save-export \t\t\t\t Export save to specified file\n";
+				std::cout<<"--headless \t\t\t\t Run without window, audio, or frame limit, then print hashes\n";
+				std::cout<<"--frames [N] \t\t\t\t Stop headless mode after N frames\n";
+				std::cout<<"--cycles [N] \t\t\t\t Stop headless mode after N CPU cycles\n";
 				std::cout<<"-h, --help \t\t\t\t Print these help messages\n";
 				return false;
 			}
@@ -1041,6 +1105,13 @@ bool parse_cli_args()
 			}
 		}
 
+		//Headless mode has no way to quit on its own without a budget
+		if((config::headless) && (config::headless_frames == 0) && (config::headless_cycles == 0))
+		{
+			std::cout<<"GBE::Error - Headless mode requires --frames or --cycles\n";
+			return false;
+		}
+
 		return true;
 	}
 }
@@ -1276,6 +1347,9 @@ bool parse_ini_file()
 		//Use OpenGL
 		if(!parse_ini_bool(ini_item, "#use_opengl", config::use_opengl, ini_opts, x)) { return false; }
 
+		//Software filters
+		if(!parse_ini_bool(ini_item, "#use_software_filters", config::use_sw_filters, ini_opts, x)) { return false; }
+
 		//Fragment shader
 		if(ini_item == "#fragment_shader")
 		{
@@ -1315,6 +1389,15 @@ bool parse_ini_file()
 		//Max FPS
 		if(!parse_ini_number(ini_item, "#max_fps", config::max_fps, ini_opts, x, 0, 65535)) { return false; }
 
+		//Rewind buffer size
+		if(!parse_ini_number(ini_item, "#rewind_buffer_size", config::rewind_buffer_size, ini_opts, x, 0, 2048)) { return false; }
+
+		//Rewind interval
+		if(!parse_ini_number(ini_item, "#rewind_interval", config::rewind_interval, ini_opts, x, 1, 600)) { return false; }
+
+		//Rewind hotkey
+		if(!parse_ini_number(ini_item, "#hotkey_rewind", config::hotkey_rewind, ini_opts, x, 1, 0xFFFFFFFF)) { return false; }
+
 		//Use gamepad dead zone
 		if(!parse_ini_number(ini_item, "#dead_zone", config::dead_zone, ini_opts, x, 0, 32767)) { return false; }
 
@@ -1399,6 +1482,12 @@ bool parse_ini_file()
 
 		//CPU overclocking flags
 		if(!parse_ini_number(ini_item, "#oc_flags", config::oc_flags, ini_opts, x, 0, 3)) { return false; }
+
+		//Idle loop detection
+		if(!parse_ini_bool(ini_item, "#use_idle_loop_detection", config::use_idle_loop_detection, ini_opts, x)) { return false; }
+
+		//Threaded NDS 2D rendering
+		if(!parse_ini_bool(ini_item, "#nds_threaded_2d", config::nds_threaded_2d, ini_opts, x)) { return false; }
 			
 		//Emulated DMG-on-GBC palette
 		if(!parse_ini_number(ini_item, "#dmg_on_gbc_pal", config::dmg_gbc_pal, ini_opts, x, 1, 16)) { return false; }
@@ -2227,6 +2316,15 @@ bool save_ini_file()
 			output_lines[line_pos] = "[#use_opengl:" + val + "]";
 		}
 
+		//Software filters
+		else if(ini_item == "#use_software_filters")
+		{
+			line_pos = output_count[x];
+			std::string val = (config::use_sw_filters) ? "1" : "0";
+
+			output_lines[line_pos] = "[#use_software_filters:" + val + "]";
+		}
+
 		//Use gamepad dead zone
 		else if(ini_item == "#dead_zone")
 		{
@@ -2378,6 +2476,24 @@ bool save_ini_file()
 			output_lines[line_pos] = "[#oc_flags:" + val + "]";
 		}
 
+		//Idle loop detection
+		else if(ini_item == "#use_idle_loop_detection")
+		{
+			line_pos = output_count[x];
+			std::string val = (config::use_idle_loop_detection) ? "1" : "0";
+
+			output_lines[line_pos] = "[#use_idle_loop_detection:" + val + "]";
+		}
+
+		//Threaded NDS 2D rendering
+		else if(ini_item == "#nds_threaded_2d")
+		{
+			line_pos = output_count[x];
+			std::string val = (config::nds_threaded_2d) ? "1" : "0";
+
+			output_lines[line_pos] = "[#nds_threaded_2d:" + val + "]";
+		}
+
 		//Emulated DMG-on-GBC palette
 		else if(ini_item == "#dmg_on_gbc_pal")
 		{
@@ -2432,6 +2548,30 @@ bool save_ini_file()
 			output_lines[line_pos] = "[#max_fps:" + util::to_str(config::max_fps) + "]";
 		}
 
+		//Rewind buffer size
+		else if(ini_item == "#rewind_buffer_size")
+		{
+			line_pos = output_count[x];
+
+			output_lines[line_pos] = "[#rewind_buffer_size:" + util::to_str(config::rewind_buffer_size) + "]";
+		}
+
+		//Rewind interval
+		else if(ini_item == "#rewind_interval")
+		{
+			line_pos = output_count[x];
+
+			output_lines[line_pos] = "[#rewind_interval:" + util::to_str(config::rewind_interval) + "]";
+		}
+
+		//Rewind hotkey
+		else if(ini_item == "#hotkey_rewind")
+		{
+			line_pos = output_count[x];
+
+			output_lines[line_pos] = "[#hotkey_rewind:" + util::to_str(config::hotkey_rewind) + "]";
+		}
+
 		//Keyboard controls
 		else if(ini_item == "#gbe_key_controls")
 		{
@@ -3039,11 +3179,16 @@ bool generate_ini_file()
 	ini_contents += "[#use_opengl]\n\n";
 	ini_contents += "[#vertex_shader]\n\n";
 	ini_contents += "[#fragment_shader]\n\n";
+	ini_contents += "[#use_software_filters]\n\n";
 	ini_contents += "[#scaling_factor]\n\n";
 	ini_contents += "[#maintain_aspect_ratio]\n\n";
 	ini_contents += "[#max_fps]\n\n";
+	ini_contents += "[#rewind_buffer_size]\n\n";
+	ini_contents += "[#rewind_interval]\n\n";
 	ini_contents += "[#rtc_offset]\n\n";
 	ini_contents += "[#oc_flags]\n\n";
+	ini_contents += "[#use_idle_loop_detection]\n\n";
+	ini_contents += "[#nds_threaded_2d]\n\n";
 	ini_contents += "[#dead_zone]\n\n";
 	ini_contents += "[#volume]\n\n";
 	ini_contents += "[#mute]\n\n";
@@ -3065,6 +3210,7 @@ bool generate_ini_file()
 	ini_contents += "[#motion_scaler]\n\n";
 	ini_contents += "[#use_ddr_mapping]\n\n";
 	ini_contents += "[#hotkeys]\n\n";
+	ini_contents += "[#hotkey_rewind]\n\n";
 	ini_contents += "[#manifest_path]\n\n";
 	ini_contents += "[#dump_bg_path]\n\n";
 	ini_contents += "[#dump_obj_path]\n\n";
@@ -16,6 +16,7 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <atomic>
 
 #include "common.h"
 
@@ -130,6 +131,7 @@ namespace config
 	extern u32 hotkey_camera;
 	extern u32 hotkey_swap_screen;
 	extern u32 hotkey_shift_screen;
+	extern u32 hotkey_rewind;
 	extern u32 dead_zone;
 	extern int joy_id;
 	extern int joy_sdl_id;
@@ -141,7 +143,8 @@ namespace config
 	extern float motion_scaler;
 
 	extern u32 flags;
-	extern bool pause_emu;
+	//Written by the GUI thread and read by the emulation thread
+	extern std::atomic<bool> pause_emu;
 	extern bool use_bios;
 	extern bool use_firmware;
 	extern bool no_cart;
@@ -156,6 +159,9 @@ namespace config
 	extern bool use_opengl;
 	extern bool use_debugger;
 	extern bool turbo;
+	extern bool headless;
+	extern u32 headless_frames;
+	extern u64 headless_cycles;
 	extern u8 scaling_factor;
 	extern u8 old_scaling_factor;
 	extern std::stringstream title;
@@ -211,6 +217,7 @@ namespace config
 
 	extern std::string vertex_shader;
 	extern std::string fragment_shader;
+	extern bool use_sw_filters;
 
 	extern bool request_resize;
 	extern s8 resize_mode;
@@ -218,11 +225,16 @@ namespace config
 	extern u8 lcd_config;
 	extern u16 max_fps;
 
+	extern u32 rewind_buffer_size;
+	extern u32 rewind_interval;
+
 	extern u32 DMG_BG_PAL[4];
 	extern u32 DMG_OBJ_PAL[4][2];
 
 	extern u16 rtc_offset[6];
 	extern u32 oc_flags;
+	extern bool use_idle_loop_detection;
+	extern bool nds_threaded_2d;
 	extern u32 ir_db_index;
 
 	extern u16 battle_chip_id;
@@ -17,6 +17,8 @@
 #include <vector>
 
 #include "common/common.h"
+#include "common/save_state.h"
+#include "common/rewind_buffer.h"
 
 class core_emu
 {
@@ -38,6 +40,8 @@ class core_emu
 	virtual void feed_key_input(int sdl_key, bool pressed) = 0;
 	virtual	void save_state(u8 slot) = 0;
 	virtual	void load_state(u8 slot) = 0;
+	virtual bool serialize_state(save_state_buffer& state) = 0;
+	virtual bool deserialize_state(save_state_buffer& state) = 0;
 
 	//Core debugging
 	virtual	void debug_step() = 0;
@@ -64,6 +68,9 @@ class core_emu
 
 	bool running;
 	SDL_Event event;
+
+	//Per-frame states used to step emulation backwards
+	rewind_buffer rewind;
 	
 	struct debugging
 	{
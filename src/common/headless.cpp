@@ -0,0 +1,132 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : headless.cpp
+// Date : October 16, 2026
+// Description : Headless batch execution
+//
+// Runs any core without a window, audio device, or frame limiter until a frame or cycle budget is spent
+// Reports hashes of the last frame, all generated audio, and the save file for regression testing
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+
+#include "headless.h"
+#include "config.h"
+#include "core_emu.h"
+#include "util.h"
+
+namespace headless
+{
+	core_emu* current_core = NULL;
+
+	u32 frames_run = 0;
+	u64 cycles_run = 0;
+	u32 frame_crc32 = 0;
+
+	//Audio is pulled once per frame from the core's callback instead of an audio device
+	SDL_AudioSpec audio_spec;
+	bool audio_ready = false;
+	std::vector<u8> audio_buffer;
+	u64 audio_pending = 0;
+	u64 audio_bytes = 0;
+	u32 audio_crc32 = 0;
+
+	/****** Sets up headless mode for a core before it starts ******/
+	void init(core_emu* core)
+	{
+		current_core = core;
+
+		frames_run = 0;
+		cycles_run = 0;
+		frame_crc32 = 0;
+
+		audio_ready = false;
+		audio_pending = 0;
+		audio_bytes = 0;
+		audio_crc32 = 0;
+
+		//No window, OpenGL, microphone, or frame limiter
+		config::sdl_render = false;
+		config::use_opengl = false;
+		config::use_microphone = false;
+		config::turbo = true;
+		config::osd_count = 0;
+
+		//Every finished frame comes through the external rendering path
+		config::render_external_sw = render_frame;
+
+		std::cout<<"GBE::Running headless";
+		if(config::headless_frames) { std::cout<<" - " << std::dec << config::headless_frames << " frames"; }
+		if(config::headless_cycles) { std::cout<<" - " << std::dec << config::headless_cycles << " cycles"; }
+		std::cout<<"\n";
+	}
+
+	/****** Replaces SDL_OpenAudio - Keeps the core's callback so audio can be generated without a device ******/
+	int open_audio(SDL_AudioSpec* spec)
+	{
+		if(!config::headless) { return SDL_OpenAudio(spec, NULL); }
+
+		audio_spec = *spec;
+		audio_buffer.assign(audio_spec.samples * audio_spec.channels * 2, 0);
+		audio_ready = (audio_spec.callback != NULL) && (audio_spec.samples != 0);
+
+		return 0;
+	}
+
+	/****** Receives each finished frame from a core ******/
+	void render_frame(std::vector<u32>& buffer)
+	{
+		frames_run++;
+		frame_crc32 = buffer.empty() ? 0 : util::get_crc32((u8*)&buffer[0], buffer.size() * 4);
+
+		//Pull as many audio buffers as 1/60th of a second of output requires, same as an audio device would
+		if(audio_ready)
+		{
+			audio_pending += audio_spec.freq;
+
+			while(audio_pending >= (audio_spec.samples * 60))
+			{
+				audio_pending -= (audio_spec.samples * 60);
+				audio_spec.callback(audio_spec.userdata, &audio_buffer[0], audio_buffer.size());
+
+				audio_crc32 = util::update_crc32(audio_crc32, &audio_buffer[0], audio_buffer.size());
+				audio_bytes += audio_buffer.size();
+			}
+		}
+
+		if((config::headless_frames) && (frames_run >= config::headless_frames)) { current_core->running = false; }
+	}
+
+	/****** Counts emulated CPU cycles ******/
+	void add_cycles(u32 cycles)
+	{
+		cycles_run += cycles;
+		if((config::headless_cycles) && (cycles_run >= config::headless_cycles)) { current_core->running = false; }
+	}
+
+	/****** Prints results after the core has shut down and written its save data ******/
+	void report()
+	{
+		std::cout<<"HEADLESS::Frames : " << std::dec << frames_run << "\n";
+		std::cout<<"HEADLESS::Cycles : " << std::dec << cycles_run << "\n";
+		std::cout<<"HEADLESS::Frame CRC32 : 0x" << std::hex << std::setw(8) << std::setfill('0') << frame_crc32 << "\n";
+		std::cout<<"HEADLESS::Audio CRC32 : 0x" << std::hex << std::setw(8) << std::setfill('0') << audio_crc32;
+		std::cout<<" (" << std::dec << audio_bytes << " bytes)\n";
+
+		std::ifstream save(config::save_file.c_str(), std::ios::binary);
+
+		if(save.is_open())
+		{
+			save.close();
+			std::cout<<"HEADLESS::Save CRC32 : 0x" << std::hex << std::setw(8) << std::setfill('0') << util::get_file_crc32(config::save_file);
+			std::cout<<" (" << config::save_file << ")\n";
+		}
+
+		else { std::cout<<"HEADLESS::Save CRC32 : None\n"; }
+
+		std::cout<<std::dec;
+	}
+}
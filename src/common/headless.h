@@ -0,0 +1,31 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : headless.h
+// Date : October 16, 2026
+// Description : Headless batch execution
+//
+// Runs any core without a window, audio device, or frame limiter until a frame or cycle budget is spent
+// Reports hashes of the last frame, all generated audio, and the save file for regression testing
+
+#ifndef GBE_HEADLESS
+#define GBE_HEADLESS
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+#include "common.h"
+
+class core_emu;
+
+namespace headless
+{
+	void init(core_emu* core);
+	int open_audio(SDL_AudioSpec* spec);
+	void render_frame(std::vector<u32>& buffer);
+	void add_cycles(u32 cycles);
+	void report();
+}
+
+#endif // GBE_HEADLESS
@@ -0,0 +1,137 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : mapped_file.cpp
+// Date : October 16, 2026
+// Description : Memory mapped ROM files
+//
+// Maps ROM files directly into memory instead of reading them into private buffers
+// Every process running the same ROM shares the same physical pages until one of them writes to a page
+// Systems without mmap fall back to reading the file into an allocated buffer
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define GBE_USE_MMAP
+#endif
+
+#include "mapped_file.h"
+
+/****** Mapped file constructor ******/
+mapped_file::mapped_file()
+{
+	buffer = NULL;
+	file_size = 0;
+	map_length = 0;
+	mapped = false;
+}
+
+/****** Mapped file destructor ******/
+mapped_file::~mapped_file()
+{
+	close();
+}
+
+/****** Maps a file - Length is the file size, or max_length if non-zero, plus padding ******/
+/****** Anything past the end of the file reads as zero, writable mappings are copy-on-write and never change the file ******/
+bool mapped_file::open(std::string filename, u32 max_length, u32 padding, bool writable)
+{
+	close();
+
+	#ifdef GBE_USE_MMAP
+
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	struct stat file_stat;
+
+	if((fd >= 0) && (fstat(fd, &file_stat) == 0))
+	{
+		u64 real_size = file_stat.st_size;
+		if((max_length != 0) && (real_size > max_length)) { real_size = max_length; }
+
+		file_size = real_size;
+		map_length = ((max_length != 0) ? max_length : file_size) + padding;
+
+		int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+
+		//Reserve the whole length with zero pages first, then lay the file over the start of it
+		//Pages past the end of the file would otherwise fault when touched
+		void* base = NULL;
+		if(map_length != 0) { base = mmap(NULL, map_length, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0); }
+
+		if((base != MAP_FAILED) && (base != NULL))
+		{
+			if((file_size == 0) || (mmap(base, file_size, prot, MAP_PRIVATE | MAP_FIXED, fd, 0) != MAP_FAILED))
+			{
+				::close(fd);
+
+				buffer = (u8*)base;
+				mapped = true;
+				return true;
+			}
+
+			munmap(base, map_length);
+		}
+	}
+
+	if(fd >= 0) { ::close(fd); }
+
+	buffer = NULL;
+	file_size = 0;
+	map_length = 0;
+
+	#endif
+
+	//Fall back to reading the whole file
+	std::ifstream file(filename.c_str(), std::ios::binary);
+
+	if(!file.is_open()) { return false; }
+
+	file.seekg(0, file.end);
+	u64 real_size = file.tellg();
+	file.seekg(0, file.beg);
+
+	if((max_length != 0) && (real_size > max_length)) { real_size = max_length; }
+
+	file_size = real_size;
+	map_length = ((max_length != 0) ? max_length : file_size) + padding;
+
+	buffer = (u8*)calloc((map_length != 0) ? map_length : 1, 1);
+
+	if(buffer == NULL)
+	{
+		std::cout<<"GBE::Error - Could not allocate memory for " << filename << "\n";
+		file_size = map_length = 0;
+		return false;
+	}
+
+	file.read((char*)buffer, file_size);
+	file.close();
+
+	return true;
+}
+
+/****** Unmaps or frees the file ******/
+void mapped_file::close()
+{
+	if(buffer != NULL)
+	{
+		#ifdef GBE_USE_MMAP
+		if(mapped) { munmap(buffer, map_length); }
+		else { free(buffer); }
+		#else
+		free(buffer);
+		#endif
+	}
+
+	buffer = NULL;
+	file_size = 0;
+	map_length = 0;
+	mapped = false;
+}
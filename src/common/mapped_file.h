@@ -0,0 +1,51 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : mapped_file.h
+// Date : October 16, 2026
+// Description : Memory mapped ROM files
+//
+// Maps ROM files directly into memory instead of reading them into private buffers
+// Every process running the same ROM shares the same physical pages until one of them writes to a page
+// Systems without mmap fall back to reading the file into an allocated buffer
+
+#ifndef GBE_MAPPED_FILE
+#define GBE_MAPPED_FILE
+
+#include <string>
+
+#include "common.h"
+
+class mapped_file
+{
+	public:
+
+	mapped_file();
+	~mapped_file();
+
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+
+	bool open(std::string filename, u32 max_length, u32 padding, bool writable);
+	void close();
+	void clear() { close(); }
+
+	u8* data() const { return buffer; }
+	u32 size() const { return file_size; }
+	u32 length() const { return map_length; }
+	bool empty() const { return (file_size == 0); }
+	bool is_mapped() const { return mapped; }
+
+	u8& operator[](u32 address) { return buffer[address]; }
+	u8 operator[](u32 address) const { return buffer[address]; }
+
+	private:
+
+	u8* buffer;
+	u32 file_size;
+	u32 map_length;
+	bool mapped;
+};
+
+#endif // GBE_MAPPED_FILE
@@ -0,0 +1,311 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : media_converter.cpp
+// Date : October 16, 2026
+// Description : Background media conversion
+//
+// Runs external media conversion commands on a worker thread instead of the emulation thread
+// Converted files are cached on disk, keyed by the CRC32 of the source file and the command used
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+
+#include "media_converter.h"
+#include "config.h"
+#include "util.h"
+
+/****** Media converter constructor ******/
+media_converter::media_converter()
+{
+	request_count = 0;
+	thread = NULL;
+	thread_attempted = false;
+	quit = false;
+
+	lock = SDL_CreateMutex();
+	work_ready = SDL_CreateCond();
+}
+
+/****** Media converter destructor ******/
+media_converter::~media_converter()
+{
+	stop();
+
+	if(work_ready != NULL) { SDL_DestroyCond(work_ready); }
+	if(lock != NULL) { SDL_DestroyMutex(lock); }
+
+	work_ready = NULL;
+	lock = NULL;
+}
+
+/****** Starts the worker thread the first time a conversion is needed ******/
+bool media_converter::start()
+{
+	if(thread != NULL) { return true; }
+	if(thread_attempted) { return false; }
+
+	thread_attempted = true;
+
+	if((lock != NULL) && (work_ready != NULL)) { thread = SDL_CreateThread(worker_main, "media_converter", this); }
+
+	//Conversions requested for playback still run, but on the calling thread
+	if(thread == NULL)
+	{
+		std::cout<<"GBE::Warning - Could not create media conversion thread : " << SDL_GetError() << "\n";
+		return false;
+	}
+
+	return true;
+}
+
+/****** Stops the worker thread - Waits for any conversion command that is already running ******/
+void media_converter::stop()
+{
+	if(thread == NULL) { return; }
+
+	SDL_LockMutex(lock);
+	quit = true;
+	SDL_CondSignal(work_ready);
+	SDL_UnlockMutex(lock);
+
+	SDL_WaitThread(thread, NULL);
+	thread = NULL;
+}
+
+/****** Requests a file for playback - Moves it ahead of any other queued conversion ******/
+media_convert_status media_converter::request(std::string filename, std::string command, std::string& out_file)
+{
+	bool threaded = start();
+
+	if(threaded) { SDL_LockMutex(lock); }
+
+	s32 index = find_job(filename, command);
+	request_count++;
+
+	if(index < 0) { index = add_job(filename, command, request_count); }
+
+	//Queued files jump ahead of prefetches, failed files get another try
+	else if((jobs[index].status == MEDIA_CONVERT_QUEUED) || (jobs[index].status == MEDIA_CONVERT_FAILED))
+	{
+		jobs[index].status = MEDIA_CONVERT_QUEUED;
+		jobs[index].priority = request_count;
+	}
+
+	if(threaded)
+	{
+		SDL_CondSignal(work_ready);
+		SDL_UnlockMutex(lock);
+		return get_status(filename, command, out_file);
+	}
+
+	if(jobs[index].status == MEDIA_CONVERT_QUEUED)
+	{
+		jobs[index].status = convert(jobs[index]) ? MEDIA_CONVERT_DONE : MEDIA_CONVERT_FAILED;
+	}
+
+	out_file = jobs[index].out_file;
+	return jobs[index].status;
+}
+
+/****** Returns the current status of a requested file ******/
+media_convert_status media_converter::get_status(std::string filename, std::string command, std::string& out_file)
+{
+	media_convert_status result = MEDIA_CONVERT_FAILED;
+
+	if(lock != NULL) { SDL_LockMutex(lock); }
+
+	s32 index = find_job(filename, command);
+
+	if(index >= 0)
+	{
+		result = jobs[index].status;
+		out_file = jobs[index].out_file;
+	}
+
+	if(lock != NULL) { SDL_UnlockMutex(lock); }
+
+	return result;
+}
+
+/****** Queues a file that will probably be played soon, after any requested files ******/
+void media_converter::prefetch(std::string filename, std::string command)
+{
+	//Never convert on the calling thread just for a prefetch
+	if(!start()) { return; }
+
+	SDL_LockMutex(lock);
+
+	if(find_job(filename, command) < 0)
+	{
+		add_job(filename, command, 0);
+		SDL_CondSignal(work_ready);
+	}
+
+	SDL_UnlockMutex(lock);
+}
+
+/****** Finds a job for a file and command ******/
+s32 media_converter::find_job(std::string filename, std::string command)
+{
+	for(u32 x = 0; x < jobs.size(); x++)
+	{
+		if((jobs[x].source == filename) && (jobs[x].command == command)) { return x; }
+	}
+
+	return -1;
+}
+
+/****** Adds a new job to the queue ******/
+u32 media_converter::add_job(std::string filename, std::string command, u32 priority)
+{
+	job new_job;
+	new_job.source = filename;
+	new_job.command = command;
+	new_job.cache_prefix = config::temp_media_file + "_cache_";
+	new_job.out_file = "";
+	new_job.status = MEDIA_CONVERT_QUEUED;
+	new_job.priority = priority;
+
+	jobs.push_back(new_job);
+	return (jobs.size() - 1);
+}
+
+/****** Worker thread - Converts queued files, highest priority first ******/
+int media_converter::worker_main(void* ptr)
+{
+	media_converter* converter = (media_converter*)ptr;
+
+	SDL_LockMutex(converter->lock);
+
+	while(!converter->quit)
+	{
+		s32 target = -1;
+
+		for(u32 x = 0; x < converter->jobs.size(); x++)
+		{
+			if(converter->jobs[x].status != MEDIA_CONVERT_QUEUED) { continue; }
+			if((target < 0) || (converter->jobs[x].priority > converter->jobs[target].priority)) { target = x; }
+		}
+
+		if(target < 0)
+		{
+			SDL_CondWait(converter->work_ready, converter->lock);
+			continue;
+		}
+
+		//Work on a copy, the job list may grow while the command runs
+		converter->jobs[target].status = MEDIA_CONVERT_ACTIVE;
+		job current = converter->jobs[target];
+
+		SDL_UnlockMutex(converter->lock);
+		bool converted = convert(current);
+		SDL_LockMutex(converter->lock);
+
+		converter->jobs[target].out_file = current.out_file;
+		converter->jobs[target].status = converted ? MEDIA_CONVERT_DONE : MEDIA_CONVERT_FAILED;
+	}
+
+	SDL_UnlockMutex(converter->lock);
+	return 0;
+}
+
+/****** Converts one file, or finds its previous conversion in the cache ******/
+bool media_converter::convert(job& current)
+{
+	std::ifstream file(current.source.c_str(), std::ios::binary);
+
+	if(!file.is_open())
+	{
+		std::cout<<"GBE::Error - Could not open media file " << current.source << "\n";
+		return false;
+	}
+
+	//Key the cache on the file's contents rather than its name, so edited files are converted again
+	std::vector<u8> data(0x10000);
+	u32 file_crc = 0;
+
+	while(file)
+	{
+		file.read((char*)&data[0], data.size());
+		u32 length = file.gcount();
+
+		if(!length) { break; }
+		file_crc = util::update_crc32(file_crc, &data[0], length);
+	}
+
+	file.close();
+
+	u32 cmd_crc = current.command.empty() ? 0 : util::get_crc32((u8*)&current.command[0], current.command.size());
+
+	std::stringstream key;
+	key << std::hex << std::uppercase << std::setfill('0') << std::setw(8) << file_crc << std::setw(8) << cmd_crc;
+
+	current.out_file = current.cache_prefix + key.str() + ".wav";
+
+	//Use cached file if a previous conversion finished
+	std::ifstream cached_file(current.out_file.c_str(), std::ios::binary | std::ios::ate);
+
+	if((cached_file.is_open()) && (cached_file.tellg() > 0)) { return true; }
+
+	cached_file.close();
+
+	//Convert to a temporary file first, so an interrupted conversion never looks like a cached one
+	std::string temp_file = current.cache_prefix + key.str() + "_part.wav";
+	std::string sys_cmd = current.command;
+
+	//Delete any existing temporary media file in case audio conversion command complains
+	std::remove(temp_file.c_str());
+
+	//Replace %in and %out with proper parameters
+	std::string search_str = "%in";
+	std::size_t pos = sys_cmd.find(search_str);
+
+	if(pos != std::string::npos)
+	{
+		std::string start = sys_cmd.substr(0, pos);
+		std::string end = sys_cmd.substr(pos + 3);
+		sys_cmd = start + current.source + end;
+	}
+
+	search_str = "%out";
+	pos = sys_cmd.find(search_str);
+
+	if(pos != std::string::npos)
+	{
+		std::string start = sys_cmd.substr(0, pos);
+		std::string end = sys_cmd.substr(pos + 4);
+		sys_cmd = start + temp_file + end;
+	}
+
+	//Check for a command processor on system and run audio conversion command
+	if(!system(NULL))
+	{
+		std::cout<<"GBE::Error - No command processor available to convert media file " << current.source << "\n";
+		return false;
+	}
+
+	std::cout<<"GBE::Converting media file " << current.source << "\n";
+	system(sys_cmd.c_str());
+
+	std::ifstream temp(temp_file.c_str(), std::ios::binary | std::ios::ate);
+	bool converted = ((temp.is_open()) && (temp.tellg() > 0));
+	temp.close();
+
+	std::remove(current.out_file.c_str());
+
+	if((!converted) || (std::rename(temp_file.c_str(), current.out_file.c_str()) != 0))
+	{
+		std::cout<<"GBE::Error - Conversion of media file " << current.source << " failed\n";
+		std::remove(temp_file.c_str());
+		return false;
+	}
+
+	std::cout<<"GBE::Conversion complete\n";
+	return true;
+}
@@ -0,0 +1,73 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : media_converter.h
+// Date : October 16, 2026
+// Description : Background media conversion
+//
+// Runs external media conversion commands on a worker thread instead of the emulation thread
+// Converted files are cached on disk, keyed by the CRC32 of the source file and the command used
+
+#ifndef GBE_MEDIA_CONVERTER
+#define GBE_MEDIA_CONVERTER
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+enum media_convert_status
+{
+	MEDIA_CONVERT_QUEUED,
+	MEDIA_CONVERT_ACTIVE,
+	MEDIA_CONVERT_DONE,
+	MEDIA_CONVERT_FAILED,
+};
+
+class media_converter
+{
+	public:
+
+	media_converter();
+	~media_converter();
+
+	media_converter(const media_converter&) = delete;
+	media_converter& operator=(const media_converter&) = delete;
+
+	media_convert_status request(std::string filename, std::string command, std::string& out_file);
+	media_convert_status get_status(std::string filename, std::string command, std::string& out_file);
+	void prefetch(std::string filename, std::string command);
+	void stop();
+
+	private:
+
+	struct job
+	{
+		std::string source;
+		std::string command;
+		std::string cache_prefix;
+		std::string out_file;
+		media_convert_status status;
+		u32 priority;
+	};
+
+	s32 find_job(std::string filename, std::string command);
+	u32 add_job(std::string filename, std::string command, u32 priority);
+	bool start();
+
+	static int worker_main(void* ptr);
+	static bool convert(job& current);
+
+	std::vector<job> jobs;
+	u32 request_count;
+
+	SDL_Thread* thread;
+	bool thread_attempted;
+	SDL_mutex* lock;
+	SDL_cond* work_ready;
+	bool quit;
+};
+
+#endif // GBE_MEDIA_CONVERTER
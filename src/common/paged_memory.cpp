@@ -0,0 +1,174 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : paged_memory.cpp
+// Date : October 16, 2026
+// Description : Paged memory map
+//
+// Replaces flat memory maps covering an entire address space
+// Known regions (RAM, VRAM, ROM, etc) are backed by right-sized buffers, mirrors can share buffers
+// Any other page is only allocated once it is accessed
+
+#include <cstdlib>
+#include <iostream>
+
+#include "paged_memory.h"
+
+/****** Paged Memory Map Constructor ******/
+paged_memory_map::paged_memory_map()
+{
+	page_table.resize(1, NULL);
+	page_index_mask = 0;
+	address_space = 0;
+}
+
+/****** Paged Memory Map Destructor ******/
+paged_memory_map::~paged_memory_map()
+{
+	clear();
+}
+
+/****** Releases all pages and sets up an empty address space of the given size ******/
+void paged_memory_map::reset(u32 map_size)
+{
+	clear();
+
+	u32 page_count = 1;
+	while((page_count << MEM_PAGE_SHIFT) < map_size) { page_count <<= 1; }
+
+	page_table.clear();
+	page_table.resize(page_count, NULL);
+	page_index_mask = page_count - 1;
+	address_space = map_size;
+}
+
+/****** Releases all pages - The address space itself is kept ******/
+void paged_memory_map::clear()
+{
+	for(u32 x = 0; x < allocations.size(); x++) { free(allocations[x]); }
+	allocations.clear();
+
+	for(u32 x = 0; x < page_table.size(); x++) { page_table[x] = NULL; }
+}
+
+/****** Backs a range of addresses with a single contiguous buffer ******/
+void paged_memory_map::map_region(u32 address, u32 length)
+{
+	u32 first_page = (address >> MEM_PAGE_SHIFT);
+	u32 page_count = (length + MEM_PAGE_MASK) >> MEM_PAGE_SHIFT;
+
+	//Zero-filled allocation, large regions are only committed by the OS once touched
+	u8* buffer = (u8*)calloc(page_count, MEM_PAGE_SIZE);
+
+	if(buffer == NULL)
+	{
+		std::cout<<"MMU::Error - Could not allocate memory region at 0x" << std::hex << address << "\n";
+		abort();
+	}
+
+	allocations.push_back(buffer);
+
+	for(u32 x = 0; x < page_count; x++)
+	{
+		page_table[(first_page + x) & page_index_mask] = buffer + (x << MEM_PAGE_SHIFT);
+	}
+}
+
+/****** Makes a range of addresses share the buffer of a previously mapped range ******/
+void paged_memory_map::map_mirror(u32 address, u32 length, u32 source)
+{
+	u32 first_page = (address >> MEM_PAGE_SHIFT);
+	u32 source_page = (source >> MEM_PAGE_SHIFT);
+	u32 page_count = (length + MEM_PAGE_MASK) >> MEM_PAGE_SHIFT;
+
+	for(u32 x = 0; x < page_count; x++)
+	{
+		u32 index = (source_page + x) & page_index_mask;
+		if(page_table[index] == NULL) { allocate_page(index << MEM_PAGE_SHIFT); }
+
+		page_table[(first_page + x) & page_index_mask] = page_table[index];
+	}
+}
+
+/****** Backs a range of addresses with a buffer owned elsewhere, such as a mapped file ******/
+void paged_memory_map::map_external(u32 address, u32 length, u8* buffer)
+{
+	u32 first_page = (address >> MEM_PAGE_SHIFT);
+	u32 page_count = (length + MEM_PAGE_MASK) >> MEM_PAGE_SHIFT;
+
+	for(u32 x = 0; x < page_count; x++)
+	{
+		page_table[(first_page + x) & page_index_mask] = buffer + (x << MEM_PAGE_SHIFT);
+	}
+}
+
+/****** Backs any pages in a range that are still unmapped - Accesses from other threads then never allocate ******/
+void paged_memory_map::map_gaps(u32 address, u32 length)
+{
+	u32 first_page = (address >> MEM_PAGE_SHIFT);
+	u32 page_count = (length + MEM_PAGE_MASK) >> MEM_PAGE_SHIFT;
+	u32 gap_count = 0;
+
+	for(u32 x = 0; x < page_count; x++)
+	{
+		if(page_table[(first_page + x) & page_index_mask] == NULL) { gap_count++; }
+	}
+
+	if(!gap_count) { return; }
+
+	u8* buffer = (u8*)calloc(gap_count, MEM_PAGE_SIZE);
+
+	if(buffer == NULL)
+	{
+		std::cout<<"MMU::Error - Could not allocate memory region at 0x" << std::hex << address << "\n";
+		abort();
+	}
+
+	allocations.push_back(buffer);
+
+	for(u32 x = 0; x < page_count; x++)
+	{
+		u32 index = (first_page + x) & page_index_mask;
+
+		if(page_table[index] == NULL)
+		{
+			page_table[index] = buffer;
+			buffer += MEM_PAGE_SIZE;
+		}
+	}
+}
+
+/****** Allocates a zero-filled page on first access ******/
+u8* paged_memory_map::allocate_page(u32 address)
+{
+	u8* page = (u8*)calloc(1, MEM_PAGE_SIZE);
+
+	if(page == NULL)
+	{
+		std::cout<<"MMU::Error - Could not allocate memory page at 0x" << std::hex << address << "\n";
+		abort();
+	}
+
+	allocations.push_back(page);
+	page_table[(address >> MEM_PAGE_SHIFT) & page_index_mask] = page;
+
+	return page;
+}
+
+/****** Returns a pointer to bytes spanning several pages, or NULL if those pages aren't one contiguous buffer ******/
+u8* paged_memory_map::get_spanning_ptr(u32 address, u32 length) const
+{
+	u32 first_page = (address >> MEM_PAGE_SHIFT);
+	u32 last_page = ((address + length - 1) >> MEM_PAGE_SHIFT);
+
+	u8* start = page_table[first_page & page_index_mask];
+	if(start == NULL) { return NULL; }
+
+	for(u32 x = first_page + 1; x <= last_page; x++)
+	{
+		if(page_table[x & page_index_mask] != (start + ((x - first_page) << MEM_PAGE_SHIFT))) { return NULL; }
+	}
+
+	return start + (address & MEM_PAGE_MASK);
+}
@@ -0,0 +1,98 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : paged_memory.h
+// Date : October 16, 2026
+// Description : Paged memory map
+//
+// Replaces flat memory maps covering an entire address space
+// Known regions (RAM, VRAM, ROM, etc) are backed by right-sized buffers, mirrors can share buffers
+// Any other page is only allocated once it is accessed
+
+#ifndef GBE_PAGED_MEMORY
+#define GBE_PAGED_MEMORY
+
+#include <vector>
+#include <cstddef>
+
+#include "common.h"
+
+#define MEM_PAGE_SHIFT 16
+#define MEM_PAGE_SIZE (1 << MEM_PAGE_SHIFT)
+#define MEM_PAGE_MASK (MEM_PAGE_SIZE - 1)
+
+class paged_memory_map
+{
+	public:
+
+	paged_memory_map();
+	~paged_memory_map();
+
+	paged_memory_map(const paged_memory_map&) = delete;
+	paged_memory_map& operator=(const paged_memory_map&) = delete;
+
+	void reset(u32 map_size);
+	void clear();
+	void map_region(u32 address, u32 length);
+	void map_mirror(u32 address, u32 length, u32 source);
+	void map_external(u32 address, u32 length, u8* buffer);
+	void map_gaps(u32 address, u32 length);
+
+	u32 size() const { return address_space; }
+
+	//Returns the buffer backing a page or NULL if the page has not been accessed yet
+	u8* get_page(u32 address) const { return page_table[(address >> MEM_PAGE_SHIFT) & page_index_mask]; }
+
+	//Returns a pointer to length bytes starting at address - Allocates unmapped pages on demand
+	//Returns NULL if the bytes run into a page that isn't part of the same buffer
+	u8* get_region_ptr(u32 address, u32 length)
+	{
+		u8* page = page_table[(address >> MEM_PAGE_SHIFT) & page_index_mask];
+		if(page == NULL) { page = allocate_page(address); }
+
+		u32 offset = (address & MEM_PAGE_MASK);
+		if((offset + length) <= MEM_PAGE_SIZE) { return page + offset; }
+
+		return get_spanning_ptr(address, length);
+	}
+
+	//Read-only region access - Also returns NULL if any page is unmapped
+	const u8* get_region_ptr(u32 address, u32 length) const
+	{
+		u8* page = page_table[(address >> MEM_PAGE_SHIFT) & page_index_mask];
+		if(page == NULL) { return NULL; }
+
+		u32 offset = (address & MEM_PAGE_MASK);
+		if((offset + length) <= MEM_PAGE_SIZE) { return page + offset; }
+
+		return get_spanning_ptr(address, length);
+	}
+
+	//Byte access - Allocates unmapped pages on demand
+	u8& operator[](u32 address)
+	{
+		u8* page = page_table[(address >> MEM_PAGE_SHIFT) & page_index_mask];
+		if(page == NULL) { page = allocate_page(address); }
+		return page[address & MEM_PAGE_MASK];
+	}
+
+	//Read-only byte access - Unmapped pages read as zero
+	u8 operator[](u32 address) const
+	{
+		u8* page = page_table[(address >> MEM_PAGE_SHIFT) & page_index_mask];
+		return (page != NULL) ? page[address & MEM_PAGE_MASK] : 0;
+	}
+
+	private:
+
+	u8* allocate_page(u32 address);
+	u8* get_spanning_ptr(u32 address, u32 length) const;
+
+	std::vector<u8*> page_table;
+	std::vector<u8*> allocations;
+	u32 page_index_mask;
+	u32 address_space;
+};
+
+#endif // GBE_PAGED_MEMORY
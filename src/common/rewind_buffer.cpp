@@ -0,0 +1,116 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : rewind_buffer.cpp
+// Date : October 16, 2026
+// Description : Rewind buffer
+//
+// Captures the state of a core every few frames and keeps them within a fixed memory budget
+// Only the newest state is kept whole, every older state is an XOR delta against the state after it
+
+#include "rewind_buffer.h"
+#include "core_emu.h"
+#include "config.h"
+
+/****** Rewind Buffer Constructor ******/
+rewind_buffer::rewind_buffer()
+{
+	memory_usage = 0;
+	frame_counter = 0;
+	active = false;
+}
+
+/****** Rewind Buffer Destructor ******/
+rewind_buffer::~rewind_buffer() { }
+
+/****** Called once per frame - Captures a new state or steps back while rewinding ******/
+void rewind_buffer::update(core_emu* core)
+{
+	if(config::rewind_buffer_size == 0)
+	{
+		if(!current.data.empty()) { clear(); }
+		return;
+	}
+
+	if(active)
+	{
+		step_back(core);
+		return;
+	}
+
+	frame_counter++;
+	if(frame_counter < config::rewind_interval) { return; }
+	frame_counter = 0;
+
+	if(!core->serialize_state(scratch)) { return; }
+
+	//Store the previous state as the runs that turn the new state back into it
+	if(!current.data.empty())
+	{
+		std::vector<u8> delta;
+		u32 previous_size = current.data.size();
+
+		delta.resize(4);
+		delta[0] = (previous_size & 0xFF);
+		delta[1] = ((previous_size >> 8) & 0xFF);
+		delta[2] = ((previous_size >> 16) & 0xFF);
+		delta[3] = ((previous_size >> 24) & 0xFF);
+
+		save_state_buffer::encode_xor_runs(current.data, scratch.data, delta);
+
+		memory_usage += delta.size();
+		deltas.push_front(std::vector<u8>());
+		deltas.front().swap(delta);
+	}
+
+	current.data.swap(scratch.data);
+
+	trim(config::rewind_buffer_size << 20);
+}
+
+/****** Restores the state captured before the current one ******/
+bool rewind_buffer::step_back(core_emu* core)
+{
+	if(deltas.empty()) { return false; }
+
+	std::vector<u8>& delta = deltas.front();
+	u32 previous_size = delta[0] | (delta[1] << 8) | (delta[2] << 16) | (delta[3] << 24);
+
+	current.data.resize(previous_size, 0);
+
+	if(!save_state_buffer::decode_xor_runs(delta.data() + 4, delta.size() - 4, current.data))
+	{
+		clear();
+		return false;
+	}
+
+	memory_usage -= delta.size();
+	deltas.pop_front();
+
+	frame_counter = 0;
+
+	return core->deserialize_state(current);
+}
+
+/****** Discards all rewind states ******/
+void rewind_buffer::clear()
+{
+	deltas.clear();
+	current.data.clear();
+	memory_usage = 0;
+	frame_counter = 0;
+}
+
+/****** Returns the number of states that can be stepped back to ******/
+u32 rewind_buffer::get_count() const { return deltas.size(); }
+
+/****** Drops the oldest states until everything fits within the budget ******/
+void rewind_buffer::trim(u32 budget)
+{
+	while(!deltas.empty() && ((memory_usage + current.data.size()) > budget))
+	{
+		memory_usage -= deltas.back().size();
+		deltas.pop_back();
+	}
+}
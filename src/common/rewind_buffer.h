@@ -0,0 +1,55 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : rewind_buffer.h
+// Date : October 16, 2026
+// Description : Rewind buffer
+//
+// Captures the state of a core every few frames and keeps them within a fixed memory budget
+// Only the newest state is kept whole, every older state is an XOR delta against the state after it
+
+#ifndef GBE_REWIND_BUFFER
+#define GBE_REWIND_BUFFER
+
+#include <deque>
+#include <vector>
+
+#include "common.h"
+#include "save_state.h"
+
+class core_emu;
+
+class rewind_buffer
+{
+	public:
+
+	rewind_buffer();
+	~rewind_buffer();
+
+	void update(core_emu* core);
+	bool step_back(core_emu* core);
+	void clear();
+
+	void set_active(bool enable) { active = enable; }
+	bool is_active() const { return active; }
+
+	u32 get_count() const;
+	u32 get_memory_usage() const { return memory_usage + current.data.size(); }
+
+	private:
+
+	void trim(u32 budget);
+
+	//Newest delta is at the front
+	std::deque< std::vector<u8> > deltas;
+
+	save_state_buffer current;
+	save_state_buffer scratch;
+
+	u32 memory_usage;
+	u32 frame_counter;
+	bool active;
+};
+
+#endif // GBE_REWIND_BUFFER
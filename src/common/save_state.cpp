@@ -0,0 +1,386 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : save_state.cpp
+// Date : October 16, 2026
+// Description : In-memory save states
+//
+// Serializes emulator components into a single contiguous buffer
+// Buffers carry a versioned header and a section table so components can be located independently
+// Save state files are simply these buffers written to disk
+// States can also be stored as an XOR delta against a base snapshot
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "save_state.h"
+#include "util.h"
+
+/****** Save State Buffer Constructor ******/
+save_state_buffer::save_state_buffer()
+{
+	system_type = 0;
+	position = 0;
+	limit = 0;
+	legacy = false;
+	error = false;
+}
+
+/****** Save State Buffer Destructor ******/
+save_state_buffer::~save_state_buffer() { }
+
+/****** Starts a new save state - Previously allocated memory is reused ******/
+void save_state_buffer::begin_write(u32 system)
+{
+	data.clear();
+	sections.clear();
+
+	system_type = system;
+	error = false;
+
+	//Reserve space for the header, filled in once all sections are written
+	data.resize(STATE_HEADER_SIZE, 0);
+}
+
+/****** Starts a new section - Ends any previous section ******/
+void save_state_buffer::begin_section(u32 section)
+{
+	if(!sections.empty()) { sections.back().length = data.size() - sections.back().offset; }
+
+	section_entry entry;
+	entry.id = section;
+	entry.offset = data.size();
+	entry.length = 0;
+
+	sections.push_back(entry);
+}
+
+/****** Appends data to the current section ******/
+void save_state_buffer::write(const void* src, u32 length)
+{
+	if(length == 0) { return; }
+
+	u32 offset = data.size();
+	data.resize(offset + length);
+	memcpy(&data[offset], src, length);
+}
+
+/****** Finishes a save state by writing the section table and header ******/
+void save_state_buffer::end_write()
+{
+	if(!sections.empty()) { sections.back().length = data.size() - sections.back().offset; }
+
+	u32 table_offset = data.size();
+	data.resize(table_offset + (sections.size() * 12));
+
+	for(u32 x = 0; x < sections.size(); x++)
+	{
+		put_u32(table_offset + (x * 12), sections[x].id);
+		put_u32(table_offset + (x * 12) + 4, sections[x].offset);
+		put_u32(table_offset + (x * 12) + 8, sections[x].length);
+	}
+
+	put_u32(0, STATE_MAGIC);
+	put_u32(4, STATE_VERSION);
+	put_u32(8, system_type);
+	put_u32(12, sections.size());
+	put_u32(16, table_offset);
+}
+
+/****** Validates a save state before reading any sections ******/
+bool save_state_buffer::begin_read(u32 system)
+{
+	sections.clear();
+	position = 0;
+	limit = data.size();
+	error = false;
+
+	//Deltas must be expanded against their base snapshot first
+	if(is_delta())
+	{
+		std::cout<<"GBE::Error - Save state delta was not applied to a base snapshot\n";
+		return false;
+	}
+
+	//States without a header are treated as the older format, components stored back to back
+	if((data.size() < STATE_HEADER_SIZE) || (get_u32(0) != STATE_MAGIC))
+	{
+		legacy = true;
+		return true;
+	}
+
+	legacy = false;
+
+	if(get_u32(4) != STATE_VERSION)
+	{
+		std::cout<<"GBE::Error - Unsupported save state version " << std::dec << get_u32(4) << "\n";
+		return false;
+	}
+
+	if(get_u32(8) != system)
+	{
+		std::cout<<"GBE::Error - Save state is for a different system\n";
+		return false;
+	}
+
+	u32 section_count = get_u32(12);
+	u32 table_offset = get_u32(16);
+
+	//Make sure the section table and every section lies within the buffer
+	if((table_offset > data.size()) || (section_count > ((data.size() - table_offset) / 12)))
+	{
+		std::cout<<"GBE::Error - Save state section table is corrupted\n";
+		return false;
+	}
+
+	for(u32 x = 0; x < section_count; x++)
+	{
+		section_entry entry;
+		entry.id = get_u32(table_offset + (x * 12));
+		entry.offset = get_u32(table_offset + (x * 12) + 4);
+		entry.length = get_u32(table_offset + (x * 12) + 8);
+
+		if((entry.offset > table_offset) || (entry.length > (table_offset - entry.offset)))
+		{
+			std::cout<<"GBE::Error - Save state section table is corrupted\n";
+			return false;
+		}
+
+		sections.push_back(entry);
+	}
+
+	return true;
+}
+
+/****** Moves reading to the start of a section ******/
+bool save_state_buffer::find_section(u32 section)
+{
+	//Older states are read sequentially
+	if(legacy) { return true; }
+
+	for(u32 x = 0; x < sections.size(); x++)
+	{
+		if(sections[x].id == section)
+		{
+			position = sections[x].offset;
+			limit = sections[x].offset + sections[x].length;
+			return true;
+		}
+	}
+
+	std::cout<<"GBE::Error - Save state is missing section " << std::dec << section << "\n";
+	return false;
+}
+
+/****** Reads data from the current section ******/
+bool save_state_buffer::read(void* dst, u32 length)
+{
+	if(length == 0) { return true; }
+
+	if((position > limit) || (length > (limit - position)))
+	{
+		error = true;
+		return false;
+	}
+
+	memcpy(dst, &data[position], length);
+	position += length;
+
+	return true;
+}
+
+/****** Writes the save state to a file ******/
+bool save_state_buffer::save_file(std::string filename)
+{
+	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+
+	if(!file.is_open()) { return false; }
+
+	if(!data.empty()) { file.write((char*)&data[0], data.size()); }
+
+	file.close();
+	return true;
+}
+
+/****** Reads a save state from a file ******/
+bool save_state_buffer::load_file(std::string filename)
+{
+	std::ifstream file(filename.c_str(), std::ios::binary);
+
+	if(!file.is_open()) { return false; }
+
+	//Get file size
+	file.seekg(0, file.end);
+	u32 file_size = file.tellg();
+	file.seekg(0, file.beg);
+
+	data.resize(file_size);
+	if(file_size) { file.read((char*)&data[0], file_size); }
+
+	file.close();
+	return true;
+}
+
+/****** Encodes this state as an XOR delta against a base snapshot ******/
+void save_state_buffer::make_delta(const save_state_buffer& base, std::vector<u8>& delta) const
+{
+	u32 base_size = base.data.size();
+
+	delta.clear();
+	delta.resize(STATE_DELTA_HEADER_SIZE, 0);
+
+	put_u32(delta, 0, STATE_DELTA_MAGIC);
+	put_u32(delta, 4, base_size);
+	put_u32(delta, 8, base_size ? util::get_crc32((u8*)&base.data[0], base_size) : 0);
+	put_u32(delta, 12, data.size());
+
+	encode_xor_runs(data, base.data, delta);
+}
+
+/****** Expands a delta stored in this buffer using its base snapshot ******/
+bool save_state_buffer::apply_delta(const save_state_buffer& base)
+{
+	if(!is_delta()) { return true; }
+
+	u32 base_size = get_u32(4);
+	u32 base_crc = get_u32(8);
+	u32 size = get_u32(12);
+
+	if((base_size != base.data.size()) || (base_crc != (base_size ? util::get_crc32((u8*)&base.data[0], base_size) : 0)))
+	{
+		std::cout<<"GBE::Error - Save state delta does not match the base snapshot\n";
+		return false;
+	}
+
+	std::vector<u8> result(base.data);
+	result.resize(size, 0);
+
+	if(!decode_xor_runs(data.data() + STATE_DELTA_HEADER_SIZE, data.size() - STATE_DELTA_HEADER_SIZE, result))
+	{
+		std::cout<<"GBE::Error - Save state delta is corrupted\n";
+		return false;
+	}
+
+	data.swap(result);
+	return true;
+}
+
+/****** Appends runs of bytes that differ between two buffers, XORed together ******/
+void save_state_buffer::encode_xor_runs(const std::vector<u8>& src, const std::vector<u8>& base, std::vector<u8>& runs)
+{
+	u32 size = src.size();
+	u32 common_size = (size < base.size()) ? size : base.size();
+	u32 pos = 0;
+
+	//Each run is the number of unchanged bytes to skip, the number of changed bytes, then the changed bytes XOR base
+	//Bytes past the end of the base compare against zero
+	while(pos < size)
+	{
+		u32 skip_start = pos;
+
+		//Skip unchanged bytes, 8 at a time where possible
+		while((pos + 8) <= common_size)
+		{
+			u64 new_word, old_word;
+			memcpy(&new_word, &src[pos], 8);
+			memcpy(&old_word, &base[pos], 8);
+
+			if(new_word != old_word) { break; }
+			pos += 8;
+		}
+
+		while((pos < common_size) && (src[pos] == base[pos])) { pos++; }
+		while((pos >= common_size) && (pos < size) && (src[pos] == 0)) { pos++; }
+
+		if(pos >= size) { break; }
+
+		//Grab changed bytes until a long enough run of unchanged bytes shows up
+		u32 run_start = pos;
+		u32 run_end = pos;
+
+		while((pos < size) && ((pos - run_end) < STATE_DELTA_MIN_MATCH))
+		{
+			u8 old_byte = (pos < common_size) ? base[pos] : 0;
+			if(src[pos] != old_byte) { run_end = pos + 1; }
+			pos++;
+		}
+
+		pos = run_end;
+
+		u32 offset = runs.size();
+		runs.resize(offset + 8 + (run_end - run_start));
+
+		put_u32(runs, offset, run_start - skip_start);
+		put_u32(runs, offset + 4, run_end - run_start);
+
+		for(u32 x = run_start; x < run_end; x++)
+		{
+			u8 old_byte = (x < common_size) ? base[x] : 0;
+			runs[offset + 8 + (x - run_start)] = src[x] ^ old_byte;
+		}
+	}
+}
+
+/****** Applies XOR runs to a buffer in place ******/
+bool save_state_buffer::decode_xor_runs(const u8* runs, u32 length, std::vector<u8>& dst)
+{
+	u32 size = dst.size();
+	u32 pos = 0;
+	u32 run_pos = 0;
+
+	while(run_pos < length)
+	{
+		if((length - run_pos) < 8) { return false; }
+
+		u32 skip = runs[run_pos] | (runs[run_pos + 1] << 8) | (runs[run_pos + 2] << 16) | (runs[run_pos + 3] << 24);
+		u32 count = runs[run_pos + 4] | (runs[run_pos + 5] << 8) | (runs[run_pos + 6] << 16) | (runs[run_pos + 7] << 24);
+		run_pos += 8;
+
+		//Make sure each run lies within both buffers
+		if((skip > (size - pos)) || (count > (size - pos - skip)) || (count > (length - run_pos))) { return false; }
+
+		pos += skip;
+
+		for(u32 x = 0; x < count; x++) { dst[pos + x] ^= runs[run_pos + x]; }
+
+		pos += count;
+		run_pos += count;
+	}
+
+	return true;
+}
+
+/****** Checks whether this buffer holds a delta rather than a full state ******/
+bool save_state_buffer::is_delta() const
+{
+	return ((data.size() >= STATE_DELTA_HEADER_SIZE) && (get_u32(data, 0) == STATE_DELTA_MAGIC));
+}
+
+/****** Returns the CRC32 of the base snapshot a delta was made against, or 0 for full states ******/
+u32 save_state_buffer::get_delta_base_crc() const
+{
+	return is_delta() ? get_u32(8) : 0;
+}
+
+/****** Stores a 32-bit value in the buffer (little-endian) ******/
+void save_state_buffer::put_u32(u32 offset, u32 value) { put_u32(data, offset, value); }
+
+/****** Grabs a 32-bit value from the buffer (little-endian) ******/
+u32 save_state_buffer::get_u32(u32 offset) const { return get_u32(data, offset); }
+
+/****** Stores a 32-bit value in a given buffer (little-endian) ******/
+void save_state_buffer::put_u32(std::vector<u8>& buffer, u32 offset, u32 value)
+{
+	buffer[offset] = (value & 0xFF);
+	buffer[offset + 1] = ((value >> 8) & 0xFF);
+	buffer[offset + 2] = ((value >> 16) & 0xFF);
+	buffer[offset + 3] = ((value >> 24) & 0xFF);
+}
+
+/****** Grabs a 32-bit value from a given buffer (little-endian) ******/
+u32 save_state_buffer::get_u32(const std::vector<u8>& buffer, u32 offset)
+{
+	return (buffer[offset] | (buffer[offset + 1] << 8) | (buffer[offset + 2] << 16) | (buffer[offset + 3] << 24));
+}
@@ -0,0 +1,160 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : save_state.h
+// Date : October 16, 2026
+// Description : In-memory save states
+//
+// Serializes emulator components into a single contiguous buffer
+// Buffers carry a versioned header and a section table so components can be located independently
+// Save state files are simply these buffers written to disk
+// States can also be stored as an XOR delta against a base snapshot
+
+#ifndef GBE_SAVE_STATE
+#define GBE_SAVE_STATE
+
+#include <string>
+#include <vector>
+#include <queue>
+
+#include "common.h"
+
+//"GBE+" in little-endian
+#define STATE_MAGIC 0x2B454247
+#define STATE_VERSION 1
+#define STATE_HEADER_SIZE 20
+
+//"GBD+" in little-endian
+#define STATE_DELTA_MAGIC 0x2B444247
+#define STATE_DELTA_HEADER_SIZE 16
+
+//Number of matching bytes that ends a run of changed bytes in a delta
+#define STATE_DELTA_MIN_MATCH 16
+
+enum state_system_types
+{
+	STATE_SYSTEM_DMG = 1,
+	STATE_SYSTEM_SGB = 2,
+	STATE_SYSTEM_AGB = 3,
+	STATE_SYSTEM_NTR = 4,
+	STATE_SYSTEM_MIN = 5,
+};
+
+enum state_section_types
+{
+	STATE_SECTION_CPU = 1,
+	STATE_SECTION_MMU = 2,
+	STATE_SECTION_APU = 3,
+	STATE_SECTION_LCD = 4,
+};
+
+class save_state_buffer
+{
+	public:
+
+	save_state_buffer();
+	~save_state_buffer();
+
+	//Writing
+	void begin_write(u32 system);
+	void begin_section(u32 section);
+	void write(const void* src, u32 length);
+	void end_write();
+
+	//Reading
+	bool begin_read(u32 system);
+	bool find_section(u32 section);
+	bool read(void* dst, u32 length);
+	bool good() const { return !error; }
+
+	//Containers are stored as an element count followed by the elements themselves
+	template <typename T> void write_vector(const std::vector<T>& src)
+	{
+		u32 count = src.size();
+		write(&count, sizeof(count));
+		if(count) { write(&src[0], count * sizeof(T)); }
+	}
+
+	template <typename T> bool read_vector(std::vector<T>& dst)
+	{
+		u32 count = 0;
+		if(!read(&count, sizeof(count))) { return false; }
+		if(count > ((limit - position) / sizeof(T))) { error = true; return false; }
+
+		dst.resize(count);
+		return (count) ? read(&dst[0], count * sizeof(T)) : true;
+	}
+
+	template <typename T> void write_queue(std::queue<T> src)
+	{
+		u32 count = src.size();
+		write(&count, sizeof(count));
+
+		while(!src.empty())
+		{
+			write(&src.front(), sizeof(T));
+			src.pop();
+		}
+	}
+
+	template <typename T> bool read_queue(std::queue<T>& dst)
+	{
+		u32 count = 0;
+		if(!read(&count, sizeof(count))) { return false; }
+		if(count > ((limit - position) / sizeof(T))) { error = true; return false; }
+
+		dst = std::queue<T>();
+
+		for(u32 x = 0; x < count; x++)
+		{
+			T value;
+			read(&value, sizeof(T));
+			dst.push(value);
+		}
+
+		return good();
+	}
+
+	//File I/O
+	bool save_file(std::string filename);
+	bool load_file(std::string filename);
+
+	//Delta compression against a base snapshot
+	void make_delta(const save_state_buffer& base, std::vector<u8>& delta) const;
+	bool apply_delta(const save_state_buffer& base);
+	bool is_delta() const;
+	u32 get_delta_base_crc() const;
+
+	//XOR run encoding shared by deltas and rewind states
+	static void encode_xor_runs(const std::vector<u8>& src, const std::vector<u8>& base, std::vector<u8>& runs);
+	static bool decode_xor_runs(const u8* runs, u32 length, std::vector<u8>& dst);
+
+	//Raw serialized data
+	std::vector<u8> data;
+
+	private:
+
+	struct section_entry
+	{
+		u32 id;
+		u32 offset;
+		u32 length;
+	};
+
+	std::vector<section_entry> sections;
+
+	u32 system_type;
+	u32 position;
+	u32 limit;
+	bool legacy;
+	bool error;
+
+	void put_u32(u32 offset, u32 value);
+	u32 get_u32(u32 offset) const;
+
+	static void put_u32(std::vector<u8>& buffer, u32 offset, u32 value);
+	static u32 get_u32(const std::vector<u8>& buffer, u32 offset);
+};
+
+#endif // GBE_SAVE_STATE
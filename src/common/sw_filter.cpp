@@ -0,0 +1,1143 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : sw_filter.cpp
+// Date : October 16, 2026
+// Description : Software screen filters
+//
+// CPU versions of the scaling filters and effects normally done by GLSL shaders
+// Frames are filtered on a background thread, rows are split across a worker pool
+
+#include <iostream>
+#include <cstring>
+#include <cmath>
+
+#include "sw_filter.h"
+#include "config.h"
+
+//Pick the widest vector instructions the compiler targets, plain integers otherwise
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SW_FILTER_AVX2
+#define SW_FILTER_LANES 8
+typedef __m256i vec_u32;
+typedef __m256 vec_f32;
+
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define SW_FILTER_SSE2
+#define SW_FILTER_LANES 4
+typedef __m128i vec_u32;
+typedef __m128 vec_f32;
+
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SW_FILTER_NEON
+#define SW_FILTER_LANES 4
+typedef uint32x4_t vec_u32;
+typedef float32x4_t vec_f32;
+
+#else
+#define SW_FILTER_LANES 1
+typedef u32 vec_u32;
+typedef float vec_f32;
+#endif
+
+/****** Loads pixels ******/
+static inline vec_u32 vec_load(const u32* src)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_loadu_si256((const __m256i*)src);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_loadu_si128((const __m128i*)src);
+	#elif defined(SW_FILTER_NEON)
+	return vld1q_u32(src);
+	#else
+	return *src;
+	#endif
+}
+
+/****** Stores pixels ******/
+static inline void vec_store(u32* dst, vec_u32 value)
+{
+	#if defined(SW_FILTER_AVX2)
+	_mm256_storeu_si256((__m256i*)dst, value);
+	#elif defined(SW_FILTER_SSE2)
+	_mm_storeu_si128((__m128i*)dst, value);
+	#elif defined(SW_FILTER_NEON)
+	vst1q_u32(dst, value);
+	#else
+	*dst = value;
+	#endif
+}
+
+/****** Sets every lane to the same value ******/
+static inline vec_u32 vec_set(u32 value)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_set1_epi32(value);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_set1_epi32(value);
+	#elif defined(SW_FILTER_NEON)
+	return vdupq_n_u32(value);
+	#else
+	return value;
+	#endif
+}
+
+/****** Bitwise OR ******/
+static inline vec_u32 vec_or(vec_u32 a, vec_u32 b)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_or_si256(a, b);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_or_si128(a, b);
+	#elif defined(SW_FILTER_NEON)
+	return vorrq_u32(a, b);
+	#else
+	return (a | b);
+	#endif
+}
+
+/****** Clears the bits of a value that are set in a mask ******/
+static inline vec_u32 vec_andnot(vec_u32 mask, vec_u32 value)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_andnot_si256(mask, value);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_andnot_si128(mask, value);
+	#elif defined(SW_FILTER_NEON)
+	return vbicq_u32(value, mask);
+	#else
+	return (value & ~mask);
+	#endif
+}
+
+/****** Compares pixels - Lanes are all 1s when equal ******/
+static inline vec_u32 vec_eq(vec_u32 a, vec_u32 b)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_cmpeq_epi32(a, b);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_cmpeq_epi32(a, b);
+	#elif defined(SW_FILTER_NEON)
+	return vceqq_u32(a, b);
+	#else
+	return (a == b) ? 0xFFFFFFFF : 0;
+	#endif
+}
+
+/****** Picks a where the mask is set, b otherwise ******/
+static inline vec_u32 vec_select(vec_u32 mask, vec_u32 a, vec_u32 b)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_or_si256(_mm256_and_si256(mask, a), _mm256_andnot_si256(mask, b));
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	#elif defined(SW_FILTER_NEON)
+	return vbslq_u32(mask, a, b);
+	#else
+	return (a & mask) | (b & ~mask);
+	#endif
+}
+
+/****** Averages each color channel of two pixels, rounding up ******/
+static inline vec_u32 vec_avg(vec_u32 a, vec_u32 b)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_avg_epu8(a, b);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_avg_epu8(a, b);
+	#elif defined(SW_FILTER_NEON)
+	return vreinterpretq_u32_u8(vrhaddq_u8(vreinterpretq_u8_u32(a), vreinterpretq_u8_u32(b)));
+	#else
+	return (a | b) - (((a ^ b) >> 1) & 0x7F7F7F7F);
+	#endif
+}
+
+/****** Adds color channels, saturating at 0xFF ******/
+static inline vec_u32 vec_adds(vec_u32 a, vec_u32 b)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_adds_epu8(a, b);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_adds_epu8(a, b);
+	#elif defined(SW_FILTER_NEON)
+	return vreinterpretq_u32_u8(vqaddq_u8(vreinterpretq_u8_u32(a), vreinterpretq_u8_u32(b)));
+	#else
+	u32 result = 0;
+
+	for(u32 shift = 0; shift < 32; shift += 8)
+	{
+		u32 sum = ((a >> shift) & 0xFF) + ((b >> shift) & 0xFF);
+		result |= ((sum > 0xFF) ? 0xFF : sum) << shift;
+	}
+
+	return result;
+	#endif
+}
+
+/****** Subtracts color channels, saturating at 0 ******/
+static inline vec_u32 vec_subs(vec_u32 a, vec_u32 b)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_subs_epu8(a, b);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_subs_epu8(a, b);
+	#elif defined(SW_FILTER_NEON)
+	return vreinterpretq_u32_u8(vqsubq_u8(vreinterpretq_u8_u32(a), vreinterpretq_u8_u32(b)));
+	#else
+	u32 result = 0;
+
+	for(u32 shift = 0; shift < 32; shift += 8)
+	{
+		u32 a_byte = ((a >> shift) & 0xFF);
+		u32 b_byte = ((b >> shift) & 0xFF);
+		result |= ((a_byte > b_byte) ? (a_byte - b_byte) : 0) << shift;
+	}
+
+	return result;
+	#endif
+}
+
+/****** Interleaves the first halves of two vectors - a0, b0, a1, b1... ******/
+static inline vec_u32 vec_zip_lo(vec_u32 a, vec_u32 b)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_permute2x128_si256(_mm256_unpacklo_epi32(a, b), _mm256_unpackhi_epi32(a, b), 0x20);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_unpacklo_epi32(a, b);
+	#elif defined(SW_FILTER_NEON)
+	return vzipq_u32(a, b).val[0];
+	#else
+	return a;
+	#endif
+}
+
+/****** Interleaves the second halves of two vectors ******/
+static inline vec_u32 vec_zip_hi(vec_u32 a, vec_u32 b)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_permute2x128_si256(_mm256_unpacklo_epi32(a, b), _mm256_unpackhi_epi32(a, b), 0x31);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_unpackhi_epi32(a, b);
+	#elif defined(SW_FILTER_NEON)
+	return vzipq_u32(a, b).val[1];
+	#else
+	return b;
+	#endif
+}
+
+/****** Loads floats ******/
+static inline vec_f32 vecf_load(const float* src)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_loadu_ps(src);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_loadu_ps(src);
+	#elif defined(SW_FILTER_NEON)
+	return vld1q_f32(src);
+	#else
+	return *src;
+	#endif
+}
+
+/****** Stores floats ******/
+static inline void vecf_store(float* dst, vec_f32 value)
+{
+	#if defined(SW_FILTER_AVX2)
+	_mm256_storeu_ps(dst, value);
+	#elif defined(SW_FILTER_SSE2)
+	_mm_storeu_ps(dst, value);
+	#elif defined(SW_FILTER_NEON)
+	vst1q_f32(dst, value);
+	#else
+	*dst = value;
+	#endif
+}
+
+/****** Sets every lane to the same float ******/
+static inline vec_f32 vecf_set(float value)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_set1_ps(value);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_set1_ps(value);
+	#elif defined(SW_FILTER_NEON)
+	return vdupq_n_f32(value);
+	#else
+	return value;
+	#endif
+}
+
+/****** Float addition ******/
+static inline vec_f32 vecf_add(vec_f32 a, vec_f32 b)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_add_ps(a, b);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_add_ps(a, b);
+	#elif defined(SW_FILTER_NEON)
+	return vaddq_f32(a, b);
+	#else
+	return (a + b);
+	#endif
+}
+
+/****** Float subtraction ******/
+static inline vec_f32 vecf_sub(vec_f32 a, vec_f32 b)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_sub_ps(a, b);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_sub_ps(a, b);
+	#elif defined(SW_FILTER_NEON)
+	return vsubq_f32(a, b);
+	#else
+	return (a - b);
+	#endif
+}
+
+/****** Float multiplication ******/
+static inline vec_f32 vecf_mul(vec_f32 a, vec_f32 b)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_mul_ps(a, b);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_mul_ps(a, b);
+	#elif defined(SW_FILTER_NEON)
+	return vmulq_f32(a, b);
+	#else
+	return (a * b);
+	#endif
+}
+
+/****** Float absolute value ******/
+static inline vec_f32 vecf_abs(vec_f32 value)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value);
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+	#elif defined(SW_FILTER_NEON)
+	return vabsq_f32(value);
+	#else
+	return std::fabs(value);
+	#endif
+}
+
+/****** Compares floats - Lanes are all 1s when a < b ******/
+static inline vec_u32 vecf_lt(vec_f32 a, vec_f32 b)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_LT_OQ));
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_castps_si128(_mm_cmplt_ps(a, b));
+	#elif defined(SW_FILTER_NEON)
+	return vcltq_f32(a, b);
+	#else
+	return (a < b) ? 0xFFFFFFFF : 0;
+	#endif
+}
+
+/****** Compares floats - Lanes are all 1s when a <= b ******/
+static inline vec_u32 vecf_le(vec_f32 a, vec_f32 b)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_LE_OQ));
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_castps_si128(_mm_cmple_ps(a, b));
+	#elif defined(SW_FILTER_NEON)
+	return vcleq_f32(a, b);
+	#else
+	return (a <= b) ? 0xFFFFFFFF : 0;
+	#endif
+}
+
+/****** Extracts one 8-bit color channel as floats ******/
+template <u32 shift>
+static inline vec_f32 vecf_channel(vec_u32 value)
+{
+	#if defined(SW_FILTER_AVX2)
+	return _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(value, shift), _mm256_set1_epi32(0xFF)));
+	#elif defined(SW_FILTER_SSE2)
+	return _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(value, shift), _mm_set1_epi32(0xFF)));
+	#elif defined(SW_FILTER_NEON)
+	if constexpr(shift == 0) { return vcvtq_f32_u32(vandq_u32(value, vdupq_n_u32(0xFF))); }
+	else { return vcvtq_f32_u32(vandq_u32(vshrq_n_u32(value, shift), vdupq_n_u32(0xFF))); }
+	#else
+	return (float)((value >> shift) & 0xFF);
+	#endif
+}
+
+/****** Weighted YUV distance between two colors, same as the xBR shaders ******/
+static inline vec_f32 color_dist(vec_u32 a, vec_u32 b)
+{
+	vec_f32 r = vecf_abs(vecf_sub(vecf_channel<16>(a), vecf_channel<16>(b)));
+	vec_f32 g = vecf_abs(vecf_sub(vecf_channel<8>(a), vecf_channel<8>(b)));
+	vec_f32 bl = vecf_abs(vecf_sub(vecf_channel<0>(a), vecf_channel<0>(b)));
+
+	vec_f32 y = vecf_add(vecf_add(vecf_mul(r, vecf_set(0.299f)), vecf_mul(g, vecf_set(0.587f))), vecf_mul(bl, vecf_set(0.114f)));
+	vec_f32 u = vecf_add(vecf_sub(vecf_mul(bl, vecf_set(0.5f)), vecf_mul(r, vecf_set(0.169f))), vecf_mul(g, vecf_set(-0.331f)));
+	vec_f32 v = vecf_sub(vecf_sub(vecf_mul(r, vecf_set(0.5f)), vecf_mul(g, vecf_set(0.419f))), vecf_mul(bl, vecf_set(0.081f)));
+
+	vec_f32 result = vecf_mul(y, vecf_set(48.0f));
+	result = vecf_add(result, vecf_mul(vecf_abs(u), vecf_set(7.0f)));
+	return vecf_add(result, vecf_mul(vecf_abs(v), vecf_set(6.0f)));
+}
+
+/****** Loads the color distance between two neighboring pixels, positions are relative to the current pixel ******/
+static inline vec_f32 xbr_dist(const float* const* maps, u32 pitch, u32 index, s32 x1, s32 y1, s32 x2, s32 y2)
+{
+	s32 x = (x1 < x2) ? x1 : x2;
+	s32 y = (y1 < y2) ? y1 : y2;
+	u8 map = 0;
+
+	if(y1 == y2) { map = 0; }
+	else if(x1 == x2) { map = 1; }
+	else if((x2 - x1) == (y2 - y1)) { map = 2; }
+
+	//Lower-left distances are stored with the upper pixel
+	else
+	{
+		map = 3;
+		x++;
+	}
+
+	return vecf_load(maps[map] + index + (y * (s32)pitch) + x);
+}
+
+/****** Software filter constructor ******/
+sw_filter::sw_filter()
+{
+	filter_type = SW_FILTER_NONE;
+	scale = 1;
+	src_width = 0;
+	src_height = 0;
+	out_width = 0;
+	out_height = 0;
+
+	frame_pending = false;
+	frame_ready = false;
+
+	pass_type = PASS_SCALE2X;
+	pass_src = NULL;
+	pass_width = 0;
+	pass_height = 0;
+	pass_rows = 0;
+	pass_dst = NULL;
+	pass_pitch = 0;
+
+	on_frame = NULL;
+	thread = NULL;
+	lock = NULL;
+	work_ready = NULL;
+	quit = false;
+}
+
+/****** Software filter destructor ******/
+sw_filter::~sw_filter()
+{
+	stop();
+}
+
+/****** Returns the software filter matching a fragment shader ******/
+u8 sw_filter::get_type(std::string shader)
+{
+	std::size_t pos = shader.find_last_of("/\\");
+	if(pos != std::string::npos) { shader = shader.substr(pos + 1); }
+
+	if(shader == "scale2x.fs") { return SW_FILTER_SCALE2X; }
+	else if(shader == "scale3x.fs") { return SW_FILTER_SCALE3X; }
+	else if(shader == "2xBR.fs") { return SW_FILTER_XBR_2X; }
+	else if(shader == "4xBR.fs") { return SW_FILTER_XBR_4X; }
+	else if(shader == "lcd_mode.fs") { return SW_FILTER_LCD; }
+	else if(shader == "tv_mode.fs") { return SW_FILTER_TV; }
+	else if(shader == "gba_gamma.fs") { return SW_FILTER_GBA_GAMMA; }
+	else if(shader == "gbc_gamma.fs") { return SW_FILTER_GBC_GAMMA; }
+
+	return SW_FILTER_NONE;
+}
+
+/****** Returns how much a filter scales the screen ******/
+u32 sw_filter::get_scale(u8 type)
+{
+	u32 factor = (config::scaling_factor > SW_FILTER_MAX_SCALE) ? SW_FILTER_MAX_SCALE : config::scaling_factor;
+
+	switch(type)
+	{
+		case SW_FILTER_SCALE2X:
+		case SW_FILTER_XBR_2X:
+			return 2;
+
+		case SW_FILTER_SCALE3X:
+			return 3;
+
+		case SW_FILTER_XBR_4X:
+			return 4;
+
+		//LCD grid and TV scanlines need at least 2 output pixels per source pixel
+		case SW_FILTER_LCD:
+		case SW_FILTER_TV:
+			return (factor < 2) ? 2 : factor;
+
+		case SW_FILTER_GBA_GAMMA:
+		case SW_FILTER_GBC_GAMMA:
+			return (factor < 1) ? 1 : factor;
+	}
+
+	return 1;
+}
+
+/****** Allocates buffers and starts the filter thread for a given screen size ******/
+bool sw_filter::start(u8 type, u32 width, u32 height, frame_func func)
+{
+	stop();
+
+	//Rows must hold at least one full vector
+	if((type == SW_FILTER_NONE) || (width < 8) || (height == 0)) { return false; }
+
+	filter_type = type;
+	scale = get_scale(type);
+	src_width = width;
+	src_height = height;
+	out_width = width * scale;
+	out_height = height * scale;
+
+	u32 padded_size = (width + (SW_FILTER_PAD * 2)) * (height + (SW_FILTER_PAD * 2));
+	pending.assign(padded_size, 0xFF000000);
+	work.assign(padded_size, 0xFF000000);
+
+	back.assign((out_width * out_height), 0xFF000000);
+	ready.assign((out_width * out_height), 0xFF000000);
+	front.assign((out_width * out_height), 0xFF000000);
+
+	//4xBR runs its second pass on a 2x frame
+	if((type == SW_FILTER_XBR_2X) || (type == SW_FILTER_XBR_4X))
+	{
+		u32 map_size = padded_size;
+
+		if(type == SW_FILTER_XBR_4X)
+		{
+			map_size = ((width * 2) + (SW_FILTER_PAD * 2)) * ((height * 2) + (SW_FILTER_PAD * 2));
+			xbr_frame.assign(map_size, 0xFF000000);
+		}
+
+		for(u32 x = 0; x < 4; x++) { xbr_maps[x].assign(map_size, 0.0f); }
+	}
+
+	if(type == SW_FILTER_LCD) { previous.assign((width * height), 0xFF000000); }
+	if((type == SW_FILTER_GBA_GAMMA) || (type == SW_FILTER_GBC_GAMMA)) { build_gamma_lut(); }
+
+	frame_pending = false;
+	frame_ready = false;
+	on_frame = func;
+	quit = false;
+
+	//The emulation thread keeps one core, the filter thread only waits while the workers run
+	u32 cpu_count = SDL_GetCPUCount();
+	u32 worker_count = (cpu_count > 2) ? (cpu_count - 1) : 0;
+	if(worker_count > SW_FILTER_MAX_WORKERS) { worker_count = SW_FILTER_MAX_WORKERS; }
+
+	workers.start(worker_count, "sw_filter");
+
+	lock = SDL_CreateMutex();
+	work_ready = SDL_CreateCond();
+
+	if((lock != NULL) && (work_ready != NULL)) { thread = SDL_CreateThread(filter_main, "sw_filter", this); }
+
+	if(thread == NULL)
+	{
+		std::cout<<"GBE::Warning - Could not create software filter thread : " << SDL_GetError() << "\n";
+		stop();
+		return false;
+	}
+
+	return true;
+}
+
+/****** Stops the filter thread and its workers ******/
+void sw_filter::stop()
+{
+	if(thread != NULL)
+	{
+		SDL_LockMutex(lock);
+		quit = true;
+		SDL_CondSignal(work_ready);
+		SDL_UnlockMutex(lock);
+
+		SDL_WaitThread(thread, NULL);
+		thread = NULL;
+	}
+
+	workers.stop();
+
+	if(work_ready != NULL) { SDL_DestroyCond(work_ready); }
+	if(lock != NULL) { SDL_DestroyMutex(lock); }
+
+	work_ready = NULL;
+	lock = NULL;
+	filter_type = SW_FILTER_NONE;
+}
+
+/****** Copies a new frame for filtering - Replaces any frame the filter thread has not started yet ******/
+void sw_filter::submit(const u32* pixels)
+{
+	if(thread == NULL) { return; }
+
+	u32 pitch = src_width + (SW_FILTER_PAD * 2);
+
+	SDL_LockMutex(lock);
+
+	for(u32 y = 0; y < src_height; y++)
+	{
+		memcpy(&pending[((y + SW_FILTER_PAD) * pitch) + SW_FILTER_PAD], pixels + (y * src_width), (src_width * 4));
+	}
+
+	frame_pending = true;
+	SDL_CondSignal(work_ready);
+	SDL_UnlockMutex(lock);
+}
+
+/****** Draws the newest filtered frame to a surface - Centered if the surface is larger, cropped if smaller ******/
+void sw_filter::present(SDL_Surface* target)
+{
+	if((thread == NULL) || (target == NULL)) { return; }
+
+	SDL_LockMutex(lock);
+
+	if(frame_ready)
+	{
+		ready.swap(front);
+		frame_ready = false;
+	}
+
+	SDL_UnlockMutex(lock);
+
+	u32 width = ((u32)target->w < out_width) ? target->w : out_width;
+	u32 height = ((u32)target->h < out_height) ? target->h : out_height;
+	u32 dst_x = ((u32)target->w > out_width) ? ((target->w - out_width) >> 1) : 0;
+	u32 dst_y = ((u32)target->h > out_height) ? ((target->h - out_height) >> 1) : 0;
+
+	if(SDL_MUSTLOCK(target)) { SDL_LockSurface(target); }
+
+	for(u32 y = 0; y < height; y++)
+	{
+		u8* line = (u8*)target->pixels + ((dst_y + y) * target->pitch) + (dst_x * 4);
+		memcpy(line, &front[y * out_width], (width * 4));
+	}
+
+	if(SDL_MUSTLOCK(target)) { SDL_UnlockSurface(target); }
+}
+
+/****** Filter thread - Filters the newest submitted frame, skipping any that arrive while busy ******/
+int sw_filter::filter_main(void* ptr)
+{
+	sw_filter* filter = (sw_filter*)ptr;
+
+	SDL_LockMutex(filter->lock);
+
+	while(!filter->quit)
+	{
+		if(!filter->frame_pending)
+		{
+			SDL_CondWait(filter->work_ready, filter->lock);
+			continue;
+		}
+
+		filter->pending.swap(filter->work);
+		filter->frame_pending = false;
+
+		SDL_UnlockMutex(filter->lock);
+
+		filter->process();
+		if(filter->on_frame != NULL) { filter->on_frame(&filter->back[0], filter->out_width, filter->out_height); }
+
+		SDL_LockMutex(filter->lock);
+
+		filter->back.swap(filter->ready);
+		filter->frame_ready = true;
+	}
+
+	SDL_UnlockMutex(filter->lock);
+	return 0;
+}
+
+/****** Runs every pass of the current filter on the work frame ******/
+void sw_filter::process()
+{
+	pad_image(&work[0], src_width, src_height);
+
+	switch(filter_type)
+	{
+		case SW_FILTER_SCALE2X:
+			run_pass(PASS_SCALE2X, &work[0], src_width, src_height, &back[0], out_width);
+			break;
+
+		case SW_FILTER_SCALE3X:
+			run_pass(PASS_SCALE3X, &work[0], src_width, src_height, &back[0], out_width);
+			break;
+
+		case SW_FILTER_XBR_2X:
+			run_pass(PASS_XBR_MAPS, &work[0], src_width, src_height, NULL, 0);
+			run_pass(PASS_XBR, &work[0], src_width, src_height, &back[0], out_width);
+			break;
+
+		//Run 2xBR twice, the first pass writes inside the border of the padded 2x frame
+		case SW_FILTER_XBR_4X:
+			{
+				u32 xbr_pitch = (src_width * 2) + (SW_FILTER_PAD * 2);
+				u32* xbr_start = &xbr_frame[(SW_FILTER_PAD * xbr_pitch) + SW_FILTER_PAD];
+
+				run_pass(PASS_XBR_MAPS, &work[0], src_width, src_height, NULL, 0);
+				run_pass(PASS_XBR, &work[0], src_width, src_height, xbr_start, xbr_pitch);
+
+				pad_image(&xbr_frame[0], (src_width * 2), (src_height * 2));
+
+				run_pass(PASS_XBR_MAPS, &xbr_frame[0], (src_width * 2), (src_height * 2), NULL, 0);
+				run_pass(PASS_XBR, &xbr_frame[0], (src_width * 2), (src_height * 2), &back[0], out_width);
+			}
+
+			break;
+
+		case SW_FILTER_LCD:
+			run_pass(PASS_LCD, &work[0], src_width, src_height, &back[0], out_width);
+			break;
+
+		case SW_FILTER_TV:
+			run_pass(PASS_TV, &work[0], src_width, src_height, &back[0], out_width);
+			break;
+
+		case SW_FILTER_GBA_GAMMA:
+		case SW_FILTER_GBC_GAMMA:
+			run_pass(PASS_GAMMA, &work[0], src_width, src_height, &back[0], out_width);
+			break;
+	}
+}
+
+/****** Splits one pass over a padded image into tasks of several rows, then waits for all of them ******/
+void sw_filter::run_pass(u8 pass, const u32* src, u32 width, u32 height, u32* dst, u32 dst_pitch)
+{
+	pass_type = pass;
+	pass_src = src;
+	pass_width = width;
+	pass_height = height;
+	pass_dst = dst;
+	pass_pitch = dst_pitch;
+
+	//Distance maps cover the border as well, except for the last row
+	pass_rows = (pass == PASS_XBR_MAPS) ? (height + (SW_FILTER_PAD * 2) - 1) : height;
+
+	workers.dispatch(run_task, this, ((pass_rows + SW_FILTER_TASK_ROWS - 1) / SW_FILTER_TASK_ROWS));
+	workers.wait();
+}
+
+/****** Worker task - Runs the current pass on a block of rows ******/
+void sw_filter::run_task(void* data, u32 index)
+{
+	sw_filter* filter = (sw_filter*)data;
+
+	u32 start = index * SW_FILTER_TASK_ROWS;
+	u32 end = start + SW_FILTER_TASK_ROWS;
+	if(end > filter->pass_rows) { end = filter->pass_rows; }
+
+	switch(filter->pass_type)
+	{
+		case PASS_SCALE2X: filter->scale2x_rows(start, end); break;
+		case PASS_SCALE3X: filter->scale3x_rows(start, end); break;
+		case PASS_XBR_MAPS: filter->xbr_map_rows(start, end); break;
+		case PASS_XBR: filter->xbr_rows(start, end); break;
+		case PASS_LCD: filter->lcd_rows(start, end); break;
+		case PASS_TV: filter->tv_rows(start, end); break;
+		case PASS_GAMMA: filter->gamma_rows(start, end); break;
+	}
+}
+
+/****** Fills the border around an image by repeating its edge pixels ******/
+void sw_filter::pad_image(u32* image, u32 width, u32 height)
+{
+	u32 pitch = width + (SW_FILTER_PAD * 2);
+
+	for(u32 y = SW_FILTER_PAD; y < (height + SW_FILTER_PAD); y++)
+	{
+		u32* row = image + (y * pitch);
+
+		for(u32 x = 0; x < SW_FILTER_PAD; x++)
+		{
+			row[x] = row[SW_FILTER_PAD];
+			row[SW_FILTER_PAD + width + x] = row[SW_FILTER_PAD + width - 1];
+		}
+	}
+
+	for(u32 y = 0; y < SW_FILTER_PAD; y++)
+	{
+		memcpy(image + (y * pitch), image + (SW_FILTER_PAD * pitch), (pitch * 4));
+		memcpy(image + ((SW_FILTER_PAD + height + y) * pitch), image + ((SW_FILTER_PAD + height - 1) * pitch), (pitch * 4));
+	}
+}
+
+/****** Builds a table converting every 15-bit color for the GBA or GBC gamma filters ******/
+void sw_filter::build_gamma_lut()
+{
+	gamma_lut.assign(0x8000, 0xFF000000);
+
+	for(u32 index = 0; index < 0x8000; index++)
+	{
+		u32 r = ((index >> 10) & 0x1F);
+		u32 g = ((index >> 5) & 0x1F);
+		u32 b = (index & 0x1F);
+
+		u32 out_r = 0;
+		u32 out_g = 0;
+		u32 out_b = 0;
+
+		//Color correction formula courtesy of Talarubi and byuu
+		if(filter_type == SW_FILTER_GBA_GAMMA)
+		{
+			double lr = pow((r / 31.0), 4.0);
+			double lg = pow((g / 31.0), 4.0);
+			double lb = pow((b / 31.0), 4.0);
+
+			double fr = pow(((50.0 * lg) + (255.0 * lr)) / 255.0, (1.0 / 2.2));
+			double fg = pow(((30.0 * lb) + (230.0 * lg) + (10.0 * lr)) / 255.0, (1.0 / 2.2));
+			double fb = pow(((220.0 * lb) + (10.0 * lg) + (50.0 * lr)) / 255.0, (1.0 / 2.2));
+
+			out_r = (fr > 1.0) ? 255 : (fr * 255.0);
+			out_g = (fg > 1.0) ? 255 : (fg * 255.0);
+			out_b = (fb > 1.0) ? 255 : (fb * 255.0);
+		}
+
+		else
+		{
+			u32 rf = (r * 26) + (g * 4) + (b * 2);
+			u32 gf = (g * 24) + (b * 8);
+			u32 bf = (r * 6) + (g * 4) + (b * 22);
+
+			out_r = ((rf > 960) ? 960 : rf) / 4;
+			out_g = ((gf > 960) ? 960 : gf) / 4;
+			out_b = ((bf > 960) ? 960 : bf) / 4;
+		}
+
+		gamma_lut[index] = 0xFF000000 | (out_r << 16) | (out_g << 8) | out_b;
+	}
+}
+
+//Vector loops below step back for the last group in a row instead of running past the end
+//Pixels in the overlap are simply calculated twice
+
+/****** Scale2x - Expands each pixel into 2x2 based on its 4 direct neighbors ******/
+void sw_filter::scale2x_rows(u32 start, u32 end)
+{
+	u32 pitch = pass_width + (SW_FILTER_PAD * 2);
+
+	for(u32 y = start; y < end; y++)
+	{
+		const u32* row = pass_src + ((y + SW_FILTER_PAD) * pitch) + SW_FILTER_PAD;
+		const u32* above = row - pitch;
+		const u32* below = row + pitch;
+
+		u32* out_0 = pass_dst + (y * 2 * pass_pitch);
+		u32* out_1 = out_0 + pass_pitch;
+
+		for(u32 x = 0; x < pass_width; x += SW_FILTER_LANES)
+		{
+			if((x + SW_FILTER_LANES) > pass_width) { x = pass_width - SW_FILTER_LANES; }
+
+			vec_u32 b = vec_load(above + x);
+			vec_u32 d = vec_load(row + x - 1);
+			vec_u32 e = vec_load(row + x);
+			vec_u32 f = vec_load(row + x + 1);
+			vec_u32 h = vec_load(below + x);
+
+			//Only expand when B != H and D != F
+			vec_u32 skip = vec_or(vec_eq(b, h), vec_eq(d, f));
+
+			vec_u32 e0 = vec_select(vec_andnot(skip, vec_eq(d, b)), d, e);
+			vec_u32 e1 = vec_select(vec_andnot(skip, vec_eq(b, f)), f, e);
+			vec_u32 e2 = vec_select(vec_andnot(skip, vec_eq(d, h)), d, e);
+			vec_u32 e3 = vec_select(vec_andnot(skip, vec_eq(h, f)), f, e);
+
+			vec_store(out_0 + (x * 2), vec_zip_lo(e0, e1));
+			vec_store(out_0 + (x * 2) + SW_FILTER_LANES, vec_zip_hi(e0, e1));
+			vec_store(out_1 + (x * 2), vec_zip_lo(e2, e3));
+			vec_store(out_1 + (x * 2) + SW_FILTER_LANES, vec_zip_hi(e2, e3));
+		}
+	}
+}
+
+/****** Scale3x - Expands each pixel into 3x3 based on all 8 neighbors ******/
+void sw_filter::scale3x_rows(u32 start, u32 end)
+{
+	u32 pitch = pass_width + (SW_FILTER_PAD * 2);
+	u32 block[9][SW_FILTER_LANES];
+
+	for(u32 y = start; y < end; y++)
+	{
+		const u32* row = pass_src + ((y + SW_FILTER_PAD) * pitch) + SW_FILTER_PAD;
+		const u32* above = row - pitch;
+		const u32* below = row + pitch;
+
+		u32* out = pass_dst + (y * 3 * pass_pitch);
+
+		for(u32 x = 0; x < pass_width; x += SW_FILTER_LANES)
+		{
+			if((x + SW_FILTER_LANES) > pass_width) { x = pass_width - SW_FILTER_LANES; }
+
+			vec_u32 a = vec_load(above + x - 1);
+			vec_u32 b = vec_load(above + x);
+			vec_u32 c = vec_load(above + x + 1);
+			vec_u32 d = vec_load(row + x - 1);
+			vec_u32 e = vec_load(row + x);
+			vec_u32 f = vec_load(row + x + 1);
+			vec_u32 g = vec_load(below + x - 1);
+			vec_u32 h = vec_load(below + x);
+			vec_u32 i = vec_load(below + x + 1);
+
+			vec_u32 db = vec_eq(d, b);
+			vec_u32 bf = vec_eq(b, f);
+			vec_u32 dh = vec_eq(d, h);
+			vec_u32 hf = vec_eq(h, f);
+
+			//Corners that form an edge - D = B, B = F, D = H, and H = F, without the edge continuing past them
+			vec_u32 top_left = vec_andnot(vec_or(bf, dh), db);
+			vec_u32 top_right = vec_andnot(vec_or(db, hf), bf);
+			vec_u32 bottom_left = vec_andnot(vec_or(db, hf), dh);
+			vec_u32 bottom_right = vec_andnot(vec_or(dh, bf), hf);
+
+			vec_u32 ea = vec_eq(e, a);
+			vec_u32 ec = vec_eq(e, c);
+			vec_u32 eg = vec_eq(e, g);
+			vec_u32 ei = vec_eq(e, i);
+
+			vec_store(block[0], vec_select(top_left, d, e));
+			vec_store(block[1], vec_select(vec_or(vec_andnot(ec, top_left), vec_andnot(ea, top_right)), b, e));
+			vec_store(block[2], vec_select(top_right, f, e));
+			vec_store(block[3], vec_select(vec_or(vec_andnot(eg, top_left), vec_andnot(ea, bottom_left)), d, e));
+			vec_store(block[4], e);
+			vec_store(block[5], vec_select(vec_or(vec_andnot(ei, top_right), vec_andnot(ec, bottom_right)), f, e));
+			vec_store(block[6], vec_select(bottom_left, d, e));
+			vec_store(block[7], vec_select(vec_or(vec_andnot(ei, bottom_left), vec_andnot(eg, bottom_right)), h, e));
+			vec_store(block[8], vec_select(bottom_right, f, e));
+
+			for(u32 lane = 0; lane < SW_FILTER_LANES; lane++)
+			{
+				u32* out_block = out + ((x + lane) * 3);
+
+				for(u32 sub_y = 0; sub_y < 3; sub_y++)
+				{
+					out_block[0] = block[(sub_y * 3)][lane];
+					out_block[1] = block[(sub_y * 3) + 1][lane];
+					out_block[2] = block[(sub_y * 3) + 2][lane];
+					out_block += pass_pitch;
+				}
+			}
+		}
+	}
+}
+
+/****** Calculates the color distance maps used by 2xBR - Rows and columns include the border ******/
+void sw_filter::xbr_map_rows(u32 start, u32 end)
+{
+	u32 pitch = pass_width + (SW_FILTER_PAD * 2);
+	u32 width = pitch - 1;
+
+	for(u32 y = start; y < end; y++)
+	{
+		const u32* row = pass_src + (y * pitch);
+		const u32* below = row + pitch;
+
+		float* right_map = &xbr_maps[0][y * pitch];
+		float* lower_map = &xbr_maps[1][y * pitch];
+		float* lower_right_map = &xbr_maps[2][y * pitch];
+		float* lower_left_map = &xbr_maps[3][y * pitch];
+
+		//The first lower-left distance reads the end of the row above, it is never used
+		for(u32 x = 0; x < width; x += SW_FILTER_LANES)
+		{
+			if((x + SW_FILTER_LANES) > width) { x = width - SW_FILTER_LANES; }
+
+			vec_u32 pixel = vec_load(row + x);
+
+			vecf_store(right_map + x, color_dist(pixel, vec_load(row + x + 1)));
+			vecf_store(lower_map + x, color_dist(pixel, vec_load(below + x)));
+			vecf_store(lower_right_map + x, color_dist(pixel, vec_load(below + x + 1)));
+			vecf_store(lower_left_map + x, color_dist(pixel, vec_load(below + x - 1)));
+		}
+	}
+}
+
+/****** 2xBR - Blends each quarter of a pixel along edges found by comparing color distances ******/
+void sw_filter::xbr_rows(u32 start, u32 end)
+{
+	u32 pitch = pass_width + (SW_FILTER_PAD * 2);
+	const float* maps[4] = { &xbr_maps[0][0], &xbr_maps[1][0], &xbr_maps[2][0], &xbr_maps[3][0] };
+	vec_f32 four = vecf_set(4.0f);
+
+	#define XBR_DIST(x1, y1, x2, y2) xbr_dist(maps, pitch, index, x1, y1, x2, y2)
+
+	for(u32 y = start; y < end; y++)
+	{
+		u32* out_0 = pass_dst + (y * 2 * pass_pitch);
+		u32* out_1 = out_0 + pass_pitch;
+
+		for(u32 x = 0; x < pass_width; x += SW_FILTER_LANES)
+		{
+			if((x + SW_FILTER_LANES) > pass_width) { x = pass_width - SW_FILTER_LANES; }
+
+			u32 index = ((y + SW_FILTER_PAD) * pitch) + SW_FILTER_PAD + x;
+
+			vec_u32 b = vec_load(pass_src + index - pitch);
+			vec_u32 d = vec_load(pass_src + index - 1);
+			vec_u32 e = vec_load(pass_src + index);
+			vec_u32 f = vec_load(pass_src + index + 1);
+			vec_u32 h = vec_load(pass_src + index + pitch);
+
+			//Distances shared by several quarters - E to its neighbors, and around the diamond of B, D, F, and H
+			vec_f32 e_a = XBR_DIST(0, 0, -1, -1);
+			vec_f32 e_c = XBR_DIST(0, 0, 1, -1);
+			vec_f32 e_g = XBR_DIST(0, 0, -1, 1);
+			vec_f32 e_i = XBR_DIST(0, 0, 1, 1);
+			vec_f32 d_b = XBR_DIST(-1, 0, 0, -1);
+			vec_f32 b_f = XBR_DIST(0, -1, 1, 0);
+			vec_f32 d_h = XBR_DIST(-1, 0, 0, 1);
+			vec_f32 f_h = XBR_DIST(1, 0, 0, 1);
+			vec_f32 e_d = XBR_DIST(0, 0, -1, 0);
+			vec_f32 e_b = XBR_DIST(0, 0, 0, -1);
+			vec_f32 e_f = XBR_DIST(0, 0, 1, 0);
+			vec_f32 e_h = XBR_DIST(0, 0, 0, 1);
+
+			//E0 - Top left
+			vec_f32 red = vecf_add(vecf_add(e_g, e_c), vecf_add(XBR_DIST(-1, -1, -2, 0), XBR_DIST(-1, -1, 0, -2)));
+			vec_f32 blue = vecf_add(vecf_add(d_h, XBR_DIST(-1, 0, -2, -1)), vecf_add(b_f, XBR_DIST(0, -1, -1, -2)));
+			vec_u32 edge = vecf_lt(vecf_add(red, vecf_mul(d_b, four)), vecf_add(blue, vecf_mul(e_a, four)));
+			vec_u32 blend = vec_select(vecf_le(e_d, e_b), vec_avg(e, d), vec_avg(e, b));
+			vec_u32 e0 = vec_select(edge, blend, e);
+
+			//E1 - Top right
+			red = vecf_add(vecf_add(e_i, e_a), vecf_add(XBR_DIST(1, -1, 0, -2), XBR_DIST(1, -1, 2, 0)));
+			blue = vecf_add(vecf_add(f_h, XBR_DIST(1, 0, 2, -1)), vecf_add(d_b, XBR_DIST(0, -1, 1, -2)));
+			edge = vecf_lt(vecf_add(red, vecf_mul(b_f, four)), vecf_add(blue, vecf_mul(e_c, four)));
+			blend = vec_select(vecf_le(e_b, e_f), vec_avg(e, b), vec_avg(e, f));
+			vec_u32 e1 = vec_select(edge, blend, e);
+
+			//E2 - Bottom left
+			red = vecf_add(vecf_add(e_a, e_i), vecf_add(XBR_DIST(-1, 1, -2, 0), XBR_DIST(-1, 1, 0, 2)));
+			blue = vecf_add(vecf_add(d_b, XBR_DIST(-1, 0, -2, 1)), vecf_add(f_h, XBR_DIST(0, 1, -1, 2)));
+			edge = vecf_lt(vecf_add(red, vecf_mul(d_h, four)), vecf_add(blue, vecf_mul(e_g, four)));
+			blend = vec_select(vecf_le(e_d, e_h), vec_avg(e, d), vec_avg(e, h));
+			vec_u32 e2 = vec_select(edge, blend, e);
+
+			//E3 - Bottom right
+			red = vecf_add(vecf_add(e_c, e_g), vecf_add(XBR_DIST(1, 1, 2, 0), XBR_DIST(1, 1, 0, 2)));
+			blue = vecf_add(vecf_add(d_h, XBR_DIST(0, 1, 1, 2)), vecf_add(b_f, XBR_DIST(1, 0, 2, 1)));
+			edge = vecf_lt(vecf_add(red, vecf_mul(f_h, four)), vecf_add(blue, vecf_mul(e_i, four)));
+			blend = vec_select(vecf_le(e_f, e_h), vec_avg(e, f), vec_avg(e, h));
+			vec_u32 e3 = vec_select(edge, blend, e);
+
+			vec_store(out_0 + (x * 2), vec_zip_lo(e0, e1));
+			vec_store(out_0 + (x * 2) + SW_FILTER_LANES, vec_zip_hi(e0, e1));
+			vec_store(out_1 + (x * 2), vec_zip_lo(e2, e3));
+			vec_store(out_1 + (x * 2) + SW_FILTER_LANES, vec_zip_hi(e2, e3));
+		}
+	}
+
+	#undef XBR_DIST
+}
+
+/****** LCD mode - Blends in the last frame for ghosting, then darkens the top and left edges of every pixel ******/
+void sw_filter::lcd_rows(u32 start, u32 end)
+{
+	u32 pitch = pass_width + (SW_FILTER_PAD * 2);
+	vec_u32 grid = vec_set(0x00262626);
+
+	u32 lit[SW_FILTER_LANES];
+	u32 dark[SW_FILTER_LANES];
+
+	for(u32 y = start; y < end; y++)
+	{
+		const u32* row = pass_src + ((y + SW_FILTER_PAD) * pitch) + SW_FILTER_PAD;
+		u32* last = &previous[y * pass_width];
+		u32* out = pass_dst + (y * scale * pass_pitch);
+
+		for(u32 x = 0; x < pass_width; x += SW_FILTER_LANES)
+		{
+			if((x + SW_FILTER_LANES) > pass_width) { x = pass_width - SW_FILTER_LANES; }
+
+			vec_u32 color = vec_avg(vec_load(row + x), vec_load(last + x));
+
+			vec_store(lit, color);
+			vec_store(dark, vec_subs(color, grid));
+
+			for(u32 lane = 0; lane < SW_FILTER_LANES; lane++)
+			{
+				u32* out_block = out + ((x + lane) * scale);
+
+				for(u32 sub_x = 0; sub_x < scale; sub_x++) { out_block[sub_x] = dark[lane]; }
+
+				for(u32 sub_y = 1; sub_y < scale; sub_y++)
+				{
+					out_block += pass_pitch;
+					out_block[0] = dark[lane];
+					for(u32 sub_x = 1; sub_x < scale; sub_x++) { out_block[sub_x] = lit[lane]; }
+				}
+			}
+		}
+
+		//Only update the last frame once the whole row is done, overlapping groups still need it
+		memcpy(last, row, (pass_width * 4));
+	}
+}
+
+/****** TV mode - Blurs each pixel with its right neighbor and brightens every other line ******/
+void sw_filter::tv_rows(u32 start, u32 end)
+{
+	u32 pitch = pass_width + (SW_FILTER_PAD * 2);
+	vec_u32 glow = vec_set(((start & 0x1) ? 0x00262626 : 0));
+	u32 lit[SW_FILTER_LANES];
+
+	for(u32 y = start; y < end; y++)
+	{
+		const u32* row = pass_src + ((y + SW_FILTER_PAD) * pitch) + SW_FILTER_PAD;
+		u32* out = pass_dst + (y * scale * pass_pitch);
+
+		for(u32 x = 0; x < pass_width; x += SW_FILTER_LANES)
+		{
+			if((x + SW_FILTER_LANES) > pass_width) { x = pass_width - SW_FILTER_LANES; }
+
+			vec_store(lit, vec_adds(vec_avg(vec_load(row + x), vec_load(row + x + 1)), glow));
+
+			for(u32 lane = 0; lane < SW_FILTER_LANES; lane++)
+			{
+				u32* out_block = out + ((x + lane) * scale);
+				for(u32 sub_x = 0; sub_x < scale; sub_x++) { out_block[sub_x] = lit[lane]; }
+			}
+		}
+
+		for(u32 sub_y = 1; sub_y < scale; sub_y++) { memcpy(out + (sub_y * pass_pitch), out, (pass_width * scale * 4)); }
+
+		glow = vec_set(((y & 0x1) ? 0 : 0x00262626));
+	}
+}
+
+/****** GBA and GBC gamma - Converts colors through a table, then scales without filtering ******/
+void sw_filter::gamma_rows(u32 start, u32 end)
+{
+	u32 pitch = pass_width + (SW_FILTER_PAD * 2);
+
+	for(u32 y = start; y < end; y++)
+	{
+		const u32* row = pass_src + ((y + SW_FILTER_PAD) * pitch) + SW_FILTER_PAD;
+		u32* out = pass_dst + (y * scale * pass_pitch);
+
+		for(u32 x = 0; x < pass_width; x++)
+		{
+			u32 pixel = row[x];
+			u32 color = gamma_lut[((pixel >> 9) & 0x7C00) | ((pixel >> 6) & 0x3E0) | ((pixel >> 3) & 0x1F)];
+
+			for(u32 sub_x = 0; sub_x < scale; sub_x++) { out[(x * scale) + sub_x] = color; }
+		}
+
+		for(u32 sub_y = 1; sub_y < scale; sub_y++) { memcpy(out + (sub_y * pass_pitch), out, (pass_width * scale * 4)); }
+	}
+}
@@ -0,0 +1,151 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : sw_filter.h
+// Date : October 16, 2026
+// Description : Software screen filters
+//
+// CPU versions of the scaling filters and effects normally done by GLSL shaders
+// Frames are filtered on a background thread, rows are split across a worker pool
+
+#ifndef GBE_SW_FILTER
+#define GBE_SW_FILTER
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "worker_pool.h"
+
+//Border of repeated edge pixels around source images, enough for xBR's 5x5 neighborhood
+#define SW_FILTER_PAD 2
+
+//Source rows handed to each worker task
+#define SW_FILTER_TASK_ROWS 16
+
+#define SW_FILTER_MAX_SCALE 4
+#define SW_FILTER_MAX_WORKERS 4
+
+enum sw_filter_types
+{
+	SW_FILTER_NONE,
+	SW_FILTER_SCALE2X,
+	SW_FILTER_SCALE3X,
+	SW_FILTER_XBR_2X,
+	SW_FILTER_XBR_4X,
+	SW_FILTER_LCD,
+	SW_FILTER_TV,
+	SW_FILTER_GBA_GAMMA,
+	SW_FILTER_GBC_GAMMA,
+};
+
+class sw_filter
+{
+	public:
+
+	//Called on the filter thread with every finished frame
+	typedef void (*frame_func)(const u32* pixels, u32 width, u32 height);
+
+	sw_filter();
+	~sw_filter();
+
+	sw_filter(const sw_filter&) = delete;
+	sw_filter& operator=(const sw_filter&) = delete;
+
+	static u8 get_type(std::string shader);
+	static u32 get_scale(u8 type);
+
+	bool start(u8 type, u32 width, u32 height, frame_func func = NULL);
+	void stop();
+
+	bool is_active() const { return (thread != NULL); }
+	u8 get_current_type() const { return filter_type; }
+	u32 get_source_width() const { return src_width; }
+	u32 get_source_height() const { return src_height; }
+	u32 get_width() const { return out_width; }
+	u32 get_height() const { return out_height; }
+
+	void submit(const u32* pixels);
+	void present(SDL_Surface* target);
+
+	private:
+
+	enum pass_types
+	{
+		PASS_SCALE2X,
+		PASS_SCALE3X,
+		PASS_XBR_MAPS,
+		PASS_XBR,
+		PASS_LCD,
+		PASS_TV,
+		PASS_GAMMA,
+	};
+
+	static int filter_main(void* ptr);
+	static void run_task(void* data, u32 index);
+
+	void process();
+	void run_pass(u8 pass, const u32* src, u32 width, u32 height, u32* dst, u32 dst_pitch);
+	void pad_image(u32* image, u32 width, u32 height);
+	void build_gamma_lut();
+
+	void scale2x_rows(u32 start, u32 end);
+	void scale3x_rows(u32 start, u32 end);
+	void xbr_map_rows(u32 start, u32 end);
+	void xbr_rows(u32 start, u32 end);
+	void lcd_rows(u32 start, u32 end);
+	void tv_rows(u32 start, u32 end);
+	void gamma_rows(u32 start, u32 end);
+
+	u8 filter_type;
+	u32 scale;
+	u32 src_width;
+	u32 src_height;
+	u32 out_width;
+	u32 out_height;
+
+	//Padded source frames - The newest submitted frame and the one being filtered
+	std::vector<u32> pending;
+	std::vector<u32> work;
+
+	//Padded 2x frame between the two xBR passes of 4xBR
+	std::vector<u32> xbr_frame;
+
+	//Color distances between each pixel and its right, lower, lower-right, and lower-left neighbors
+	std::vector<float> xbr_maps[4];
+
+	//Last source frame, blended in for LCD ghosting
+	std::vector<u32> previous;
+
+	//15-bit color to 32-bit color
+	std::vector<u32> gamma_lut;
+
+	//Filtered frames - Written by the filter thread, newest finished, and shown
+	std::vector<u32> back;
+	std::vector<u32> ready;
+	std::vector<u32> front;
+
+	bool frame_pending;
+	bool frame_ready;
+
+	//Current pass
+	u8 pass_type;
+	const u32* pass_src;
+	u32 pass_width;
+	u32 pass_height;
+	u32 pass_rows;
+	u32* pass_dst;
+	u32 pass_pitch;
+
+	worker_pool workers;
+	frame_func on_frame;
+
+	SDL_Thread* thread;
+	SDL_mutex* lock;
+	SDL_cond* work_ready;
+	bool quit;
+};
+
+#endif // GBE_SW_FILTER
@@ -399,30 +399,43 @@ u32 reflect(u32 src, u8 bit)
 	return out;
 }
 
-/****** Sets up the CRC lookup table ******/
+/****** Sets up the CRC lookup table - Only builds it once, since other threads may be using it ******/
 void init_crc32_table()
 {
-	for(int x = 0; x < 256; x++)
+	static const bool table_ready = []()
 	{
-		crc32_table[x] = (reflect(x, 7) << 24);
-
-		for(int y = 0; y < 8; y++)
+		for(int x = 0; x < 256; x++)
 		{
-			crc32_table[x] = (crc32_table[x] << 1) ^ (crc32_table[x] & (1 << 31) ? poly32 : 0);
+			u32 value = (reflect(x, 7) << 24);
+
+			for(int y = 0; y < 8; y++)
+			{
+				value = (value << 1) ^ (value & (1 << 31) ? poly32 : 0);
+			}
+
+			crc32_table[x] = reflect(value, 31);
 		}
 
-		crc32_table[x] = reflect(crc32_table[x], 31);
-	}
+		return true;
+	}();
+
+	(void)table_ready;
 }
 
 /****** Return CRC32 for given data ******/
 u32 get_crc32(u8* data, u32 length)
+{
+	return update_crc32(0, data, length);
+}
+
+/****** Continues a CRC32 over more data - Pass 0 for the first block ******/
+u32 update_crc32(u32 crc, u8* data, u32 length)
 {
 	init_crc32_table();
 
-	u32 crc32 = 0xFFFFFFFF;
+	u32 crc32 = crc ^ 0xFFFFFFFF;
 
-	for(int x = 0; x < length; x++)
+	for(u32 x = 0; x < length; x++)
 	{
 		crc32 = (crc32 >> 8) ^ crc32_table[(crc32 & 0xFF) ^ (*data)];
 		data++;
@@ -0,0 +1,171 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : worker_pool.cpp
+// Date : October 16, 2026
+// Description : Worker thread pool
+//
+// Small pool of SDL threads that runs numbered tasks in the background
+// Tasks are dispatched as a batch, the caller waits on the whole batch before touching shared data
+
+#include <iostream>
+#include <string>
+
+#include "worker_pool.h"
+
+/****** Worker pool constructor ******/
+worker_pool::worker_pool()
+{
+	lock = NULL;
+	work_ready = NULL;
+	work_done = NULL;
+
+	current_func = NULL;
+	current_data = NULL;
+	task_count = 0;
+	next_task = 0;
+	tasks_done = 0;
+	busy = false;
+	quit = false;
+}
+
+/****** Worker pool destructor ******/
+worker_pool::~worker_pool()
+{
+	stop();
+}
+
+/****** Starts worker threads - With zero threads, tasks run on the calling thread ******/
+bool worker_pool::start(u32 count, const char* name)
+{
+	stop();
+
+	if(count == 0) { return true; }
+
+	lock = SDL_CreateMutex();
+	work_ready = SDL_CreateCond();
+	work_done = SDL_CreateCond();
+
+	if((lock == NULL) || (work_ready == NULL) || (work_done == NULL))
+	{
+		std::cout<<"GBE::Error - Could not create worker pool synchronization objects : " << SDL_GetError() << "\n";
+		stop();
+		return false;
+	}
+
+	quit = false;
+
+	for(u32 x = 0; x < count; x++)
+	{
+		std::string thread_name = std::string(name) + "_" + std::to_string(x);
+		SDL_Thread* thread = SDL_CreateThread(worker_main, thread_name.c_str(), this);
+
+		//Fall back to fewer threads if some could not be created
+		if(thread == NULL)
+		{
+			std::cout<<"GBE::Warning - Could not create worker thread : " << SDL_GetError() << "\n";
+			break;
+		}
+
+		threads.push_back(thread);
+	}
+
+	if(threads.empty())
+	{
+		stop();
+		return false;
+	}
+
+	return true;
+}
+
+/****** Stops all worker threads after they finish any dispatched tasks ******/
+void worker_pool::stop()
+{
+	if(lock != NULL)
+	{
+		wait();
+
+		SDL_LockMutex(lock);
+		quit = true;
+		SDL_CondBroadcast(work_ready);
+		SDL_UnlockMutex(lock);
+	}
+
+	for(u32 x = 0; x < threads.size(); x++) { SDL_WaitThread(threads[x], NULL); }
+	threads.clear();
+
+	if(work_done != NULL) { SDL_DestroyCond(work_done); }
+	if(work_ready != NULL) { SDL_DestroyCond(work_ready); }
+	if(lock != NULL) { SDL_DestroyMutex(lock); }
+
+	work_done = NULL;
+	work_ready = NULL;
+	lock = NULL;
+	busy = false;
+}
+
+/****** Runs func(data, index) for every index in 0 to task_count - 1, returns before tasks finish ******/
+void worker_pool::dispatch(task_func func, void* data, u32 task_count)
+{
+	wait();
+
+	//No worker threads, run everything immediately
+	if(threads.empty())
+	{
+		for(u32 x = 0; x < task_count; x++) { func(data, x); }
+		return;
+	}
+
+	SDL_LockMutex(lock);
+
+	current_func = func;
+	current_data = data;
+	this->task_count = task_count;
+	next_task = 0;
+	tasks_done = 0;
+	busy = true;
+
+	SDL_CondBroadcast(work_ready);
+	SDL_UnlockMutex(lock);
+}
+
+/****** Blocks until every dispatched task has finished ******/
+void worker_pool::wait()
+{
+	if(!busy) { return; }
+
+	SDL_LockMutex(lock);
+	while(tasks_done < task_count) { SDL_CondWait(work_done, lock); }
+	busy = false;
+	SDL_UnlockMutex(lock);
+}
+
+/****** Main loop for worker threads ******/
+int worker_pool::worker_main(void* ptr)
+{
+	worker_pool* pool = (worker_pool*)ptr;
+
+	SDL_LockMutex(pool->lock);
+
+	while(true)
+	{
+		while(!pool->quit && (pool->next_task >= pool->task_count)) { SDL_CondWait(pool->work_ready, pool->lock); }
+		if(pool->quit) { break; }
+
+		u32 index = pool->next_task++;
+		task_func func = pool->current_func;
+		void* data = pool->current_data;
+
+		SDL_UnlockMutex(pool->lock);
+		func(data, index);
+		SDL_LockMutex(pool->lock);
+
+		pool->tasks_done++;
+		if(pool->tasks_done == pool->task_count) { SDL_CondSignal(pool->work_done); }
+	}
+
+	SDL_UnlockMutex(pool->lock);
+	return 0;
+}
@@ -0,0 +1,59 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : worker_pool.h
+// Date : October 16, 2026
+// Description : Worker thread pool
+//
+// Small pool of SDL threads that runs numbered tasks in the background
+// Tasks are dispatched as a batch, the caller waits on the whole batch before touching shared data
+
+#ifndef GBE_WORKER_POOL
+#define GBE_WORKER_POOL
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+#include "common.h"
+
+class worker_pool
+{
+	public:
+
+	typedef void (*task_func)(void* data, u32 index);
+
+	worker_pool();
+	~worker_pool();
+
+	worker_pool(const worker_pool&) = delete;
+	worker_pool& operator=(const worker_pool&) = delete;
+
+	bool start(u32 count, const char* name);
+	void stop();
+
+	void dispatch(task_func func, void* data, u32 task_count);
+	void wait();
+
+	u32 get_count() const { return threads.size(); }
+	bool is_busy() const { return busy; }
+
+	private:
+
+	static int worker_main(void* ptr);
+
+	std::vector<SDL_Thread*> threads;
+	SDL_mutex* lock;
+	SDL_cond* work_ready;
+	SDL_cond* work_done;
+
+	task_func current_func;
+	void* current_data;
+	u32 task_count;
+	u32 next_task;
+	u32 tasks_done;
+	bool busy;
+	bool quit;
+};
+
+#endif // GBE_WORKER_POOL
@@ -12,6 +12,7 @@
 #include <cmath>
 
 #include "apu.h"
+#include "common/headless.h"
 
 /****** APU Constructor ******/
 DMG_APU::DMG_APU()
@@ -94,8 +95,8 @@ bool DMG_APU::init()
 		putenv(const_cast<char*>(env_var.c_str()));
 	}
 
-	//Initialize audio subsystem
-	if(SDL_InitSubSystem(SDL_INIT_AUDIO) == -1)
+	//Initialize audio subsystem - Headless mode pulls samples without an audio device
+	if((!config::headless) && (SDL_InitSubSystem(SDL_INIT_AUDIO) == -1))
 	{
 		std::cout<<"APU::Error - Could not initialize SDL audio\n";
 		return false;
@@ -109,8 +110,11 @@ bool DMG_APU::init()
     	desired_spec.callback = dmg_audio_callback;
     	desired_spec.userdata = this;
 
+	//Allocate mixing buffers up front - Sound Channels 1-4 are generated at 4x the output rate
+	mixer.init(4, (desired_spec.samples * 4));
+
     	//Open SDL audio for desired specifications
-	if(SDL_OpenAudio(&desired_spec, NULL) < 0) 
+	if(headless::open_audio(&desired_spec) < 0) 
 	{ 
 		std::cout<<"APU::Failed to open audio\n";
 		return false; 
@@ -128,19 +132,13 @@ bool DMG_APU::init()
 }
 
 /****** Read APU data from save state ******/
-bool DMG_APU::apu_read(u32 offset, std::string filename)
+bool DMG_APU::apu_read(save_state_buffer& state)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary);
-	
-	if(!file.is_open()) { return false; }
-
-	//Go to offset
-	file.seekg(offset);
+	//Serialize APU data from file stream - Lock out the audio callback while the data is replaced
+	SDL_LockAudio();
+	state.read((char*)&apu_stat, sizeof(apu_stat));
+	SDL_UnlockAudio();
 
-	//Serialize APU data from file stream
-	file.read((char*)&apu_stat, sizeof(apu_stat));
-
-	file.close();
 
 	//Sanitize APU data
 	if(apu_stat.noise_prescalar == 0) { apu_stat.noise_prescalar = 1; }
@@ -161,20 +159,15 @@ bool DMG_APU::apu_read(u32 offset, std::string filename)
 	apu_stat.channel[2].raw_frequency &= 0x7FF;
 	apu_stat.channel[3].raw_frequency &= 0x7FF;
 
-	return true;
+	return state.good();
 }
 
 /****** Write APU data to save state ******/
-bool DMG_APU::apu_write(std::string filename)
+bool DMG_APU::apu_write(save_state_buffer& state)
 {
-	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::app);
-	
-	if(!file.is_open()) { return false; }
-
 	//Serialize APU data to file stream
-	file.write((char*)&apu_stat, sizeof(apu_stat));
+	state.write((char*)&apu_stat, sizeof(apu_stat));
 
-	file.close();
 	return true;
 }
 
@@ -585,37 +578,45 @@ void DMG_APU::generate_channel_4_samples(s16* stream, int length)
 void dmg_audio_callback(void* _apu, u8 *_stream, int _length)
 {
 	s16* stream = (s16*) _stream;
-	int length = _length/2;
+	u32 length = _length/2;
 	length *= 4;
 
 	//Set correct length for stereo
 	if(config::use_stereo) { length /= 2; }
 
-	std::vector<s16> channel_1_stream(length);
-	std::vector<s16> channel_2_stream(length);
-	std::vector<s16> channel_3_stream(length);
-	std::vector<s16> channel_4_stream(length);
-
 	DMG_APU* apu_link = (DMG_APU*) _apu;
-	apu_link->generate_channel_1_samples(&channel_1_stream[0], length);
-	apu_link->generate_channel_2_samples(&channel_2_stream[0], length);
-	apu_link->generate_channel_3_samples(&channel_3_stream[0], length);
-	apu_link->generate_channel_4_samples(&channel_4_stream[0], length);
+	audio_mixer& mixer = apu_link->mixer;
 
-	double volume_ratio = apu_link->apu_stat.channel_master_volume / 128.0;
+	//Only mix as many samples as the preallocated buffers hold, silence anything else
+	if(length > mixer.get_max_length())
+	{
+		for(u32 x = 0; x < (_length/2); x++) { stream[x] = 0; }
+		length = mixer.get_max_length();
+	}
 
-	//Custom software mixing
-	for(u32 x = 0; x < length; x++)
+	s16* channel_1_stream = mixer.get_channel(0);
+	s16* channel_2_stream = mixer.get_channel(1);
+	s16* channel_3_stream = mixer.get_channel(2);
+	s16* channel_4_stream = mixer.get_channel(3);
+
+	apu_link->generate_channel_1_samples(channel_1_stream, length);
+	apu_link->generate_channel_2_samples(channel_2_stream, length);
+	apu_link->generate_channel_3_samples(channel_3_stream, length);
+	apu_link->generate_channel_4_samples(channel_4_stream, length);
+
+	//Master volume is out of 128, SO1 and SO2 volumes are converted to 8.8 fixed-point
+	//Together with dividing by the total amount of channels, final samples are shifted down by 17
+	s32 left_volume = apu_link->apu_stat.channel_master_volume * s32(apu_link->apu_stat.channel_left_volume * 256.0);
+	s32 right_volume = apu_link->apu_stat.channel_master_volume * s32(apu_link->apu_stat.channel_right_volume * 256.0);
+
+	//Custom software mixing - Only the last of every 4 samples is output
+	for(u32 x = 3; x < length; x += 4)
 	{
 		//Mono audio
 		if(!config::use_stereo)
 		{
 			s32 out_sample = channel_1_stream[x] + channel_2_stream[x] + channel_3_stream[x] + channel_4_stream[x];
-			out_sample *= volume_ratio;
-			out_sample *= apu_link->apu_stat.channel_left_volume;
-			out_sample /= 4;
-
-			stream[x / 4] = out_sample;
+			stream[x / 4] = ((s64)out_sample * left_volume) >> 17;
 		}
 
 		//Stereo audio
@@ -630,11 +631,7 @@ void dmg_audio_callback(void* _apu, u8 *_stream, int _length)
 			s32 ch4 = apu_link->apu_stat.channel[3].so1_output ? channel_4_stream[x] : -32768;
 
 			s32 out_sample = ch1 + ch2 + ch3 + ch4;
-			out_sample *= volume_ratio;
-			out_sample *= apu_link->apu_stat.channel_left_volume;
-			out_sample /= 4;
-
-			stream[index] = out_sample;
+			stream[index] = ((s64)out_sample * left_volume) >> 17;
 
 			//Right sample
 			ch1 = apu_link->apu_stat.channel[0].so2_output ? channel_1_stream[x] : -32768;
@@ -643,11 +640,8 @@ void dmg_audio_callback(void* _apu, u8 *_stream, int _length)
 			ch4 = apu_link->apu_stat.channel[3].so2_output ? channel_4_stream[x] : -32768;
 
 			out_sample = ch1 + ch2 + ch3 + ch4;
-			out_sample *= volume_ratio;
-			out_sample *= apu_link->apu_stat.channel_right_volume;
-			out_sample /= 4;
-
-			stream[index + 1] = out_sample;
+			stream[index + 1] = ((s64)out_sample * right_volume) >> 17;
 		}
 	} 
+
 }
@@ -15,6 +15,7 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_audio.h>
 #include "mmu.h"
+#include "common/audio_mixer.h"
 
 class DMG_APU
 {
@@ -27,6 +28,9 @@ class DMG_APU
 
 	SDL_AudioSpec desired_spec;
 
+	//Preallocated buffers for the audio callback
+	audio_mixer mixer;
+
 	DMG_APU();
 	~DMG_APU();
 
@@ -34,8 +38,8 @@ class DMG_APU
 	void reset();
 
 	//Serialize data for save state loading/saving
-	bool apu_read(u32 offset, std::string filename);
-	bool apu_write(std::string filename);
+	bool apu_read(save_state_buffer& state);
+	bool apu_write(save_state_buffer& state);
 	u32 size();
 
 	void generate_channel_1_samples(s16* stream, int length);
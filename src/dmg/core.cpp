@@ -19,6 +19,7 @@
 #endif
 
 #include "common/util.h"
+#include "common/headless.h"
 
 #include "core.h"
 
@@ -138,6 +139,9 @@ void DMG_core::reset()
 	//Re-read BIOS file
 	if((config::use_bios) && (!read_bios(config::bios_file))) { can_reset = false; }
 
+	//Older rewind states belong to the previous session
+	rewind.clear();
+
 	//Start everything all over again
 	if(can_reset) { start(); }
 	else { running = false; }
@@ -151,32 +155,20 @@ void DMG_core::load_state(u8 slot)
 	std::string state_file = config::rom_file + ".ss";
 	state_file += id;
 
-	u32 offset = 0;
+	save_state_buffer state;
 
 	//Check if save state is accessible
-	std::ifstream test(state_file.c_str());
-	
-	if(!test.good())
+	if(!state.load_file(state_file))
 	{
 		config::osd_message = "INVALID SAVE STATE " + util::to_str(slot);
 		config::osd_count = 180;
 		return;
 	}
 
-	//Offset 0, size 43
-	if(!core_cpu.cpu_read(offset, state_file)) { return; }
-	offset += core_cpu.size();	
-
-	//Offset 43, size 213047
-	if(!core_mmu.mmu_read(offset, state_file)) { return; }
-	offset += core_mmu.size();
+	if(!deserialize_state(state)) { return; }
 
-	//Offset 213090, size 320
-	if(!core_cpu.controllers.audio.apu_read(offset, state_file)) { return; }
-	offset += core_cpu.controllers.audio.size();
-
-	//Offset 213410
-	if(!core_cpu.controllers.video.lcd_read(offset, state_file)) { return; }
+	//Don't rewind past the loaded state
+	rewind.clear();
 
 	std::cout<<"GBE::Loaded state " << state_file << "\n";
 
@@ -193,10 +185,10 @@ void DMG_core::save_state(u8 slot)
 	std::string state_file = config::rom_file + ".ss";
 	state_file += id;
 
-	if(!core_cpu.cpu_write(state_file)) { return; }
-	if(!core_mmu.mmu_write(state_file)) { return; }
-	if(!core_cpu.controllers.audio.apu_write(state_file)) { return; }
-	if(!core_cpu.controllers.video.lcd_write(state_file)) { return; }
+	save_state_buffer state;
+
+	if(!serialize_state(state)) { return; }
+	if(!state.save_file(state_file)) { return; }
 
 	std::cout<<"GBE::Saved state " << state_file << "\n";
 
@@ -205,18 +197,63 @@ void DMG_core::save_state(u8 slot)
 	config::osd_count = 180;
 }
 
+/****** Saves the current state of the core to a memory buffer ******/
+bool DMG_core::serialize_state(save_state_buffer& state)
+{
+	state.begin_write(STATE_SYSTEM_DMG);
+
+	state.begin_section(STATE_SECTION_CPU);
+	if(!core_cpu.cpu_write(state)) { return false; }
+
+	state.begin_section(STATE_SECTION_MMU);
+	if(!core_mmu.mmu_write(state)) { return false; }
+
+	state.begin_section(STATE_SECTION_APU);
+	if(!core_cpu.controllers.audio.apu_write(state)) { return false; }
+
+	state.begin_section(STATE_SECTION_LCD);
+	if(!core_cpu.controllers.video.lcd_write(state)) { return false; }
+
+	state.end_write();
+	return true;
+}
+
+/****** Loads the state of the core from a memory buffer ******/
+bool DMG_core::deserialize_state(save_state_buffer& state)
+{
+	if(!state.begin_read(STATE_SYSTEM_DMG)) { return false; }
+
+	if((!state.find_section(STATE_SECTION_CPU)) || (!core_cpu.cpu_read(state))) { return false; }
+	if((!state.find_section(STATE_SECTION_MMU)) || (!core_mmu.mmu_read(state))) { return false; }
+	if((!state.find_section(STATE_SECTION_APU)) || (!core_cpu.controllers.audio.apu_read(state))) { return false; }
+	if((!state.find_section(STATE_SECTION_LCD)) || (!core_cpu.controllers.video.lcd_read(state))) { return false; }
+
+	return true;
+}
+
 /****** Run the core in a loop until exit ******/
 void DMG_core::run_core()
 {
 	if(config::gb_type == 2) { core_cpu.reg.a = 0x11; }
 
+	bool rewind_frame = false;
+
 	//Begin running the core
 	while(running)
 	{
+		//Capture or restore rewind states once per frame
+		if(core_cpu.controllers.video.lcd_stat.current_scanline == 144)
+		{
+			if(!rewind_frame) { rewind.update(this); }
+			rewind_frame = true;
+		}
+
+		else { rewind_frame = false; }
+
 		//Handle SDL Events
 		if(core_cpu.controllers.video.lcd_stat.current_scanline == 144)
 		{
-			if(SDL_PollEvent(&event))
+			if((!config::headless) && SDL_PollEvent(&event))
 			{
 				//X out of a window
 				if(event.type == SDL_QUIT) { stop(); SDL_Quit(); }
@@ -298,6 +335,8 @@ void DMG_core::run_core()
 				}
 			}
 
+			if(config::headless) { headless::add_cycles(core_cpu.cycles); }
+
 			core_cpu.debug_cycles += core_cpu.cycles;
 			core_cpu.cycles = 0;
 
@@ -305,6 +344,8 @@ void DMG_core::run_core()
 			core_cpu.handle_interrupts();
 
 			if(db_unit.debug_mode) { debug_step(); }
+
+			u32 last_op_start = 0;
 	
 			//Halt CPU if necessary
 			if(core_cpu.halt == true)
@@ -326,10 +367,25 @@ void DMG_core::run_core()
 			}
 
 			//Process Opcodes
+			//Keep running until the LCD or timers change, or until the CPU does something the rest of the system must see right away
 			else 
 			{
-				core_cpu.opcode = core_mmu.read_u8(core_cpu.reg.pc++);
-				core_cpu.exec_op(core_cpu.opcode);
+				u32 block_cycles = ((core_cpu.controllers.serial_io.sio_stat.connected) || (db_unit.debug_mode)) ? 0 : core_cpu.get_event_cycles();
+				bool ime = core_cpu.interrupt;
+				core_mmu.io_written = false;
+
+				do
+				{
+					last_op_start = core_cpu.cycles;
+
+					u16 opcode_addr = core_cpu.reg.pc;
+					core_cpu.opcode = core_mmu.read_u8(core_cpu.reg.pc++);
+					core_cpu.exec_op(core_cpu.opcode);
+
+					if(config::use_idle_loop_detection) { core_cpu.check_idle_loop(opcode_addr); }
+				}
+				while((core_cpu.cycles < block_cycles) && (!core_mmu.io_written) && (!core_cpu.halt) && (!core_cpu.interrupt_delay)
+				&& (core_cpu.interrupt == ime) && (core_cpu.opcode != 0x10));
 			}
 
 			//Update LCD
@@ -348,13 +404,17 @@ void DMG_core::run_core()
 			//Update TIMA timer
 			if(core_mmu.memory_map[REG_TAC] & 0x4) 
 			{
+				u32 tima_cycles = core_cpu.cycles;
+
+				//Only the instruction that reset DIV counts towards the new TIMA period
 				if(core_mmu.div_reset)
 				{
 					core_mmu.div_reset = false;
 					core_cpu.tima_counter = 0;
+					tima_cycles -= last_op_start;
 				}
 
-				core_cpu.tima_counter += core_cpu.cycles;
+				core_cpu.tima_counter += tima_cycles;
 
 				switch(core_mmu.memory_map[REG_TAC] & 0x3)
 				{
@@ -798,6 +858,12 @@ void DMG_core::handle_hotkey(SDL_Event& event)
 		SDL_Quit();
 	}
 
+	//Rewind while the rewind hotkey is held
+	else if(((event.type == SDL_KEYDOWN) || (event.type == SDL_KEYUP)) && (event.key.keysym.sym == config::hotkey_rewind))
+	{
+		rewind.set_active(event.type == SDL_KEYDOWN);
+	}
+
 	//Mute or unmute sound on M
 	else if((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == config::hotkey_mute) && (!config::use_external_interfaces))
 	{
@@ -1069,6 +1135,9 @@ void DMG_core::handle_hotkey(int input, bool pressed)
 	//Toggle turbo off
 	else if((input == config::hotkey_turbo) && (!pressed)) { config::turbo = false; }
 
+	//Rewind while the rewind hotkey is held
+	else if(input == config::hotkey_rewind) { rewind.set_active(pressed); }
+
 	//GB Camera load/unload external picture into VRAM
 	else if((input == config::hotkey_camera) && (pressed))
 	{
@@ -1201,7 +1270,12 @@ u32 DMG_core::ex_get_reg(u8 reg_index)
 }
 
 /****** Read binary file to memory ******/
-bool DMG_core::read_file(std::string filename) { return core_mmu.read_file(filename); }
+bool DMG_core::read_file(std::string filename)
+{
+	//Rewind states from another ROM can't be restored
+	rewind.clear();
+	return core_mmu.read_file(filename);
+}
 
 /****** Read BIOS file into memory ******/
 bool DMG_core::read_bios(std::string filename) { return core_mmu.read_bios(config::bios_file); }
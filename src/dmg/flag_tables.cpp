@@ -0,0 +1,106 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : flag_tables.cpp
+// Date : October 16, 2026
+// Description : Game Boy CPU flag tables
+//
+// Precomputed results and flags for 8-bit ALU operations
+// Shared by the DMG/GBC and SGB CPU cores
+
+#include "flag_tables.h"
+
+namespace sm83_flags
+{
+	u8 add[0x20000];
+	u8 sub[0x20000];
+	u8 inc[0x100];
+	u8 dec[0x100];
+	u16 daa[0x800];
+	u16 rl[0x200];
+	u16 rr[0x200];
+	u16 rlc[0x100];
+	u16 rrc[0x100];
+
+	/****** Builds every table once before any core runs ******/
+	struct builder
+	{
+		builder()
+		{
+			for(u32 index = 0; index < 0x20000; index++)
+			{
+				u32 carry = index >> 16;
+				u32 a = (index >> 8) & 0xFF;
+				u32 b = index & 0xFF;
+
+				//Addition - Zero, Half-Carry, Carry
+				u8 flags = 0;
+				if(((a + b + carry) & 0xFF) == 0) { flags |= 0x80; }
+				if((a & 0xF) + (b & 0xF) + carry > 0xF) { flags |= 0x20; }
+				if(a + b + carry > 0xFF) { flags |= 0x10; }
+				add[index] = flags;
+
+				//Subtraction - Zero, Subtract, Half-Carry, Carry
+				flags = 0x40;
+				if(((a - b - carry) & 0xFF) == 0) { flags |= 0x80; }
+				if((a & 0xF) < ((b & 0xF) + carry)) { flags |= 0x20; }
+				if(a < (b + carry)) { flags |= 0x10; }
+				sub[index] = flags;
+			}
+
+			for(u32 value = 0; value < 0x100; value++)
+			{
+				u8 result = value + 1;
+				inc[value] = ((result == 0) ? 0x80 : 0) | (((result & 0xF) == 0) ? 0x20 : 0);
+
+				result = value - 1;
+				dec[value] = ((result == 0) ? 0x80 : 0) | 0x40 | (((result & 0xF) == 0xF) ? 0x20 : 0);
+
+				result = (value << 1) | (value >> 7);
+				rlc[value] = (((result == 0) ? 0x80 : 0) | ((value & 0x80) ? 0x10 : 0)) << 8 | result;
+
+				result = (value >> 1) | (value << 7);
+				rrc[value] = (((result == 0) ? 0x80 : 0) | ((value & 0x01) ? 0x10 : 0)) << 8 | result;
+
+				for(u32 carry = 0; carry < 2; carry++)
+				{
+					result = (value << 1) | carry;
+					rl[(carry << 8) | value] = (((result == 0) ? 0x80 : 0) | ((value & 0x80) ? 0x10 : 0)) << 8 | result;
+
+					result = (value >> 1) | (carry << 7);
+					rr[(carry << 8) | value] = (((result == 0) ? 0x80 : 0) | ((value & 0x01) ? 0x10 : 0)) << 8 | result;
+				}
+			}
+
+			//DAA only looks at N, H, and C, so Zero is rebuilt from the result
+			for(u32 index = 0; index < 0x800; index++)
+			{
+				u32 result = index & 0xFF;
+				u8 flags = ((index & 0x100) ? 0x10 : 0) | ((index & 0x200) ? 0x20 : 0) | ((index & 0x400) ? 0x40 : 0);
+
+				if(!(flags & 0x40))
+				{
+					if((flags & 0x20) || ((result & 0xF) > 0x09)) { result += 0x06; }
+					if((flags & 0x10) || (result > 0x9F)) { result += 0x60; }
+				}
+
+				else
+				{
+					if(flags & 0x20) { result = (result - 0x06) & 0xFF; }
+					if(flags & 0x10) { result -= 0x60; }
+				}
+
+				if(result & 0x100) { flags |= 0x10; }
+				result &= 0xFF;
+
+				flags &= ~0x20;
+				if(result == 0) { flags |= 0x80; }
+
+				daa[index] = (result << 8) | flags;
+			}
+		}
+	};
+
+	static builder tables;
+}
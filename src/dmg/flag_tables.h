@@ -0,0 +1,41 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : flag_tables.h
+// Date : October 16, 2026
+// Description : Game Boy CPU flag tables
+//
+// Precomputed results and flags for 8-bit ALU operations
+// Shared by the DMG/GBC and SGB CPU cores
+
+#ifndef GB_FLAG_TABLES
+#define GB_FLAG_TABLES
+
+#include "common.h"
+
+namespace sm83_flags
+{
+	//ADD and ADC - Flags, indexed by (carry << 16) | (a << 8) | b
+	extern u8 add[0x20000];
+
+	//SUB and SBC - Flags, indexed by (carry << 16) | (a << 8) | b
+	extern u8 sub[0x20000];
+
+	//INC and DEC - Flags without carry, indexed by the original value
+	extern u8 inc[0x100];
+	extern u8 dec[0x100];
+
+	//DAA - (Result << 8) | Flags, indexed by (N << 10) | (H << 9) | (C << 8) | a
+	extern u16 daa[0x800];
+
+	//RL and RR - (Flags << 8) | Result, indexed by (carry << 8) | value
+	extern u16 rl[0x200];
+	extern u16 rr[0x200];
+
+	//RLC and RRC - (Flags << 8) | Result, indexed by value
+	extern u16 rlc[0x100];
+	extern u16 rrc[0x100];
+}
+
+#endif // GB_FLAG_TABLES
@@ -219,22 +219,15 @@ bool DMG_LCD::init()
 }
 
 /****** Read LCD data from save state ******/
-bool DMG_LCD::lcd_read(u32 offset, std::string filename)
+bool DMG_LCD::lcd_read(save_state_buffer& state)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary);
-	
-	if(!file.is_open()) { return false; }
-
-	//Go to offset
-	file.seekg(offset);
-
 	//Serialize LCD data from file stream
-	file.read((char*)&lcd_stat, sizeof(lcd_stat));
+	state.read((char*)&lcd_stat, sizeof(lcd_stat));
 
 	//Serialize OBJ data from file stream
 	for(int x = 0; x < 40; x++)
 	{
-		file.read((char*)&obj[x], sizeof(obj[x]));
+		state.read((char*)&obj[x], sizeof(obj[x]));
 	}
 
 	//Sanitize LCD data
@@ -245,27 +238,21 @@ bool DMG_LCD::lcd_read(u32 offset, std::string filename)
 	lcd_stat.lcd_mode &= 0x3;
 	lcd_stat.hdma_type &= 0x1;
 	
-	file.close();
-	return true;
+	return state.good();
 }
 
 /****** Read LCD data from save state ******/
-bool DMG_LCD::lcd_write(std::string filename)
+bool DMG_LCD::lcd_write(save_state_buffer& state)
 {
-	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::app);
-	
-	if(!file.is_open()) { return false; }
-
 	//Serialize LCD data to file stream
-	file.write((char*)&lcd_stat, sizeof(lcd_stat));
+	state.write((char*)&lcd_stat, sizeof(lcd_stat));
 
 	//Serialize OBJ data to file stream
 	for(int x = 0; x < 40; x++)
 	{
-		file.write((char*)&obj[x], sizeof(obj[x]));
+		state.write((char*)&obj[x], sizeof(obj[x]));
 	}
 
-	file.close();
 	return true;
 }
 
@@ -36,8 +36,8 @@ class DMG_LCD
 	u32 get_scanline_pixel(u8 pixel);
 
 	//Serialize data for save state loading/saving
-	bool lcd_read(u32 offset, std::string filename);
-	bool lcd_write(std::string filename);
+	bool lcd_read(save_state_buffer& state);
+	bool lcd_write(save_state_buffer& state);
 
 	//Screen data
 	SDL_Window *window;
@@ -149,6 +149,9 @@ void DMG_MMU::reset()
 	debug_addr = 0;
 	#endif
 
+	io_written = false;
+	update_rom_window();
+
 	//Load Pocket Sonar data now
 	if(cart.sonar) { mbc1s_load_sonar_data(config::external_image_file); }
 
@@ -156,50 +159,43 @@ void DMG_MMU::reset()
 }
 
 /****** Read MMU data from save state ******/
-bool DMG_MMU::mmu_read(u32 offset, std::string filename)
+bool DMG_MMU::mmu_read(save_state_buffer& state)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary);
-	
-	if(!file.is_open()) { return false; }
-
-	//Go to offset
-	file.seekg(offset);
-
 	//Serialize DMG/GBC RAM from save state
 	u8* ex_ram = &memory_map[0x8000];
-	file.read((char*)ex_ram, 0x8000);
+	state.read((char*)ex_ram, 0x8000);
 
 	for(int x = 0; x < 0x2; x++)
 	{
 		ex_ram = &video_ram[x][0];
-		file.read((char*)ex_ram, 0x2000);
+		state.read((char*)ex_ram, 0x2000);
 	}
 
 	for(int x = 0; x < 0x8; x++)
 	{
 		ex_ram = &working_ram_bank[x][0];
-		file.read((char*)ex_ram, 0x1000);
+		state.read((char*)ex_ram, 0x1000);
 	}
 
 	for(int x = 0; x < 0x10; x++)
 	{
 		ex_ram = &random_access_bank[x][0];
-		file.read((char*)ex_ram, 0x2000);
+		state.read((char*)ex_ram, 0x2000);
 	}
 
 	//Serialize misc MMU data from save state
-	file.read((char*)&rom_bank, sizeof(rom_bank));
-	file.read((char*)&ram_bank, sizeof(ram_bank));
-	file.read((char*)&wram_bank, sizeof(wram_bank));
-	file.read((char*)&vram_bank, sizeof(vram_bank));
-	file.read((char*)&bank_bits, sizeof(bank_bits));
-	file.read((char*)&bank_mode, sizeof(bank_mode));
-	file.read((char*)&ram_banking_enabled, sizeof(ram_banking_enabled));
-	file.read((char*)&in_bios, sizeof(in_bios));
-	file.read((char*)&bios_type, sizeof(bios_type));
-	file.read((char*)&bios_size, sizeof(bios_size));
-	file.read((char*)&cart, sizeof(cart));
-	file.read((char*)&previous_value, sizeof(previous_value));
+	state.read((char*)&rom_bank, sizeof(rom_bank));
+	state.read((char*)&ram_bank, sizeof(ram_bank));
+	state.read((char*)&wram_bank, sizeof(wram_bank));
+	state.read((char*)&vram_bank, sizeof(vram_bank));
+	state.read((char*)&bank_bits, sizeof(bank_bits));
+	state.read((char*)&bank_mode, sizeof(bank_mode));
+	state.read((char*)&ram_banking_enabled, sizeof(ram_banking_enabled));
+	state.read((char*)&in_bios, sizeof(in_bios));
+	state.read((char*)&bios_type, sizeof(bios_type));
+	state.read((char*)&bios_size, sizeof(bios_size));
+	state.read((char*)&cart, sizeof(cart));
+	state.read((char*)&previous_value, sizeof(previous_value));
 
 	//Sanitize MMU data from save state
 	if((bios_size != 0x100) && (bios_size != 0x900)) { bios_size = 0x100; }
@@ -211,38 +207,34 @@ bool DMG_MMU::mmu_read(u32 offset, std::string filename)
 	bank_mode &= 0x1;
 	bank_bits &= 0xF;
 
-	file.close();
-	return true;
+	update_rom_window();
+
+	return state.good();
 }
 
 /****** Write MMU data to save state ******/
-bool DMG_MMU::mmu_write(std::string filename)
+bool DMG_MMU::mmu_write(save_state_buffer& state)
 {
-	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::app);
-	
-	if(!file.is_open()) { return false; }
-
 	//Serialize DMG/GBC RAM to save state
-	file.write(reinterpret_cast<char*> (&memory_map[0x8000]), 0x8000);
-	for(int x = 0; x < 0x2; x++) { file.write(reinterpret_cast<char*> (&video_ram[x][0]), 0x2000); }
-	for(int x = 0; x < 0x8; x++) { file.write(reinterpret_cast<char*> (&working_ram_bank[x][0]), 0x1000); }
-	for(int x = 0; x < 0x10; x++) { file.write(reinterpret_cast<char*> (&random_access_bank[x][0]), 0x2000); }
+	state.write(reinterpret_cast<char*> (&memory_map[0x8000]), 0x8000);
+	for(int x = 0; x < 0x2; x++) { state.write(reinterpret_cast<char*> (&video_ram[x][0]), 0x2000); }
+	for(int x = 0; x < 0x8; x++) { state.write(reinterpret_cast<char*> (&working_ram_bank[x][0]), 0x1000); }
+	for(int x = 0; x < 0x10; x++) { state.write(reinterpret_cast<char*> (&random_access_bank[x][0]), 0x2000); }
 
 	//Serialize misc MMU data to save state
-	file.write((char*)&rom_bank, sizeof(rom_bank));
-	file.write((char*)&ram_bank, sizeof(ram_bank));
-	file.write((char*)&wram_bank, sizeof(wram_bank));
-	file.write((char*)&vram_bank, sizeof(vram_bank));
-	file.write((char*)&bank_bits, sizeof(bank_bits));
-	file.write((char*)&bank_mode, sizeof(bank_mode));
-	file.write((char*)&ram_banking_enabled, sizeof(ram_banking_enabled));
-	file.write((char*)&in_bios, sizeof(in_bios));
-	file.write((char*)&bios_type, sizeof(bios_type));
-	file.write((char*)&bios_size, sizeof(bios_size));
-	file.write((char*)&cart, sizeof(cart));
-	file.write((char*)&previous_value, sizeof(previous_value));
+	state.write((char*)&rom_bank, sizeof(rom_bank));
+	state.write((char*)&ram_bank, sizeof(ram_bank));
+	state.write((char*)&wram_bank, sizeof(wram_bank));
+	state.write((char*)&vram_bank, sizeof(vram_bank));
+	state.write((char*)&bank_bits, sizeof(bank_bits));
+	state.write((char*)&bank_mode, sizeof(bank_mode));
+	state.write((char*)&ram_banking_enabled, sizeof(ram_banking_enabled));
+	state.write((char*)&in_bios, sizeof(in_bios));
+	state.write((char*)&bios_type, sizeof(bios_type));
+	state.write((char*)&bios_size, sizeof(bios_size));
+	state.write((char*)&cart, sizeof(cart));
+	state.write((char*)&previous_value, sizeof(previous_value));
 
-	file.close();
 	return true;
 }
 
@@ -278,6 +270,11 @@ u8 DMG_MMU::read_u8(u16 address)
 	debug_addr = address;
 	#endif
 
+	//Read directly from ROM when possible
+	#ifndef GBE_DEBUG
+	if((address <= 0x7FFF) && (rom_window[address >> 14] != NULL)) { return rom_window[address >> 14][address & 0x3FFF]; }
+	#endif
+
 	//Read from BIOS
 	if(in_bios)
 	{
@@ -293,6 +290,8 @@ u8 DMG_MMU::read_u8(u16 address)
 
 			//For DMG on GBC games, we switch back to DMG Mode (we just take the colors the BIOS gives us)
 			if((bios_size == 0x900) && (memory_map[ROM_COLOR] != 0x80) && (memory_map[ROM_COLOR] != 0xC0)) { config::gb_type = 1; }
+
+			update_rom_window();
 		}
 
 		else if(address < bios_size) { return bios[address]; }
@@ -383,6 +382,7 @@ u8 DMG_MMU::read_u8(u16 address)
 			sio_stat->shift_counter = 0;
 			sio_stat->shift_clock = 0;
 			sio_stat->shifts_left = 1;
+			io_written = true;
 		}
 
 		//If Bits 6 and 7 are not set, treat Bit 1 as HIGH
@@ -422,6 +422,9 @@ void DMG_MMU::write_u8(u16 address, u8 value)
 	debug_addr = address;
 	#endif
 
+	//I/O registers and IE, but not HRAM
+	if((address >= 0xFF00) && ((address < 0xFF80) || (address == 0xFFFF))) { io_written = true; }
+
 	if(cart.mbc_type != ROM_ONLY) 
 	{
 		mbc_write(address, value);
@@ -1532,6 +1535,52 @@ void DMG_MMU::mbc_write(u16 address, u8 value)
 			tama5_write(address, value);
 			break;
 	}
+
+	//Bank changes only happen through the ROM area
+	if(address <= 0x7FFF) { update_rom_window(); }
+}
+
+/****** Points the ROM windows at Bank 0 and the current switchable bank ******/
+void DMG_MMU::update_rom_window()
+{
+	rom_window[0] = NULL;
+	rom_window[1] = NULL;
+
+	//The BIOS overlays Bank 0, and multicarts remap Bank 0
+	if((in_bios) || (cart.multicart) || (memory_map.size() < 0x8000)) { return; }
+
+	u32 bank = 0;
+
+	switch(cart.mbc_type)
+	{
+		case ROM_ONLY:
+			bank = 1;
+			break;
+
+		case MBC1:
+			if(cart.sonar) { return; }
+
+			bank = ((bank_bits << 5) | rom_bank) & 0xFF;
+			if((bank == 0x20) || (bank == 0x40) || (bank == 0x60)) { bank++; }
+			if((bank_mode == 1) || (memory_map[ROM_ROMSIZE] < 0x5)) { bank &= 0x1F; }
+			break;
+
+		case MBC2:
+		case MBC3:
+		case MBC5:
+			bank = rom_bank;
+			break;
+
+		//Every other MBC has extra handling for ROM reads
+		default:
+			return;
+	}
+
+	rom_window[0] = &memory_map[0];
+
+	//Banks 0 and 1 are read from the memory map, everything else from its own bank
+	if(bank < 2) { rom_window[1] = &memory_map[0x4000]; }
+	else if(((bank - 2) < read_only_bank.size()) && (read_only_bank[bank - 2].size() >= 0x4000)) { rom_window[1] = &read_only_bank[bank - 2][0]; }
 }
 
 /****** GBC General Purpose DMA ******/
@@ -2102,6 +2151,8 @@ bool DMG_MMU::read_file(std::string filename)
 	//Load backup save data if applicable
         load_backup(config::save_file);
 
+	update_rom_window();
+
 	return true;
 }
 
@@ -18,6 +18,7 @@
 
 #include "common.h"
 #include "common/config.h"
+#include "common/save_state.h"
 #include "gamepad.h"
 #include "lcd_data.h"
 #include "apu_data.h"
@@ -67,6 +68,12 @@ class DMG_MMU
 	u8 bank_mode;
 	bool ram_banking_enabled;
 
+	//Direct pointers to ROM Bank 0 and the current switchable ROM bank - NULL when reads need full handling
+	u8* rom_window[2];
+
+	//Set whenever the CPU touches I/O registers, so the CPU can stop running ahead of other hardware
+	bool io_written;
+
 	//BIOS controls
 	bool in_bios;
 	u8 bios_type;
@@ -166,6 +173,8 @@ class DMG_MMU
 	void write_u8(u16 address, u8 value);
 	void write_u16(u16 address, u16 value);
 
+	void update_rom_window();
+
 	//GBC DMAs
 	void hdma();
 	void gdma();
@@ -237,8 +246,8 @@ class DMG_MMU
 	void set_sio_data(dmg_sio_data* ex_sio_stat);
 
 	//Serialize data for save state loading/saving
-	bool mmu_read(u32 offset, std::string filename);
-	bool mmu_write(std::string filename);
+	bool mmu_read(save_state_buffer& state);
+	bool mmu_write(save_state_buffer& state);
 	u32 size();
 
 	private:
@@ -9,6 +9,7 @@
 // Emulates the GB Z80 in software
 
 #include "z80.h"
+#include "flag_tables.h"
 
 /****** Z80 Constructor ******/
 Z80::Z80() 
@@ -54,6 +55,10 @@ void Z80::reset()
 	double_speed = false;
 	skip_instruction = false;
 
+	idle_loop.start = idle_loop.end = 0;
+	idle_loop.valid = false;
+	idle_loop.pure = true;
+
 	mem = NULL;
 
 	std::cout<<"CPU::Initialized\n";
@@ -89,91 +94,84 @@ void Z80::reset_bios()
 	double_speed = false;
 	skip_instruction = false;
 
+	idle_loop.start = idle_loop.end = 0;
+	idle_loop.valid = false;
+	idle_loop.pure = true;
+
 	mem = NULL;
 
 	std::cout<<"CPU::Initialized\n";
 }
 
 /****** Read CPU data from save state ******/
-bool Z80::cpu_read(u32 offset, std::string filename)
+bool Z80::cpu_read(save_state_buffer& state)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary);
-	
-	if(!file.is_open()) { return false; }
-
-	//Go to offset
-	file.seekg(offset);
-
 	//Serialize CPU registers data to file stream
-	file.read((char*)&reg.a, sizeof(reg.a));
-	file.read((char*)&reg.b, sizeof(reg.b));
-	file.read((char*)&reg.c, sizeof(reg.c));
-	file.read((char*)&reg.d, sizeof(reg.d));
-	file.read((char*)&reg.e, sizeof(reg.e));
-	file.read((char*)&reg.h, sizeof(reg.h));
-	file.read((char*)&reg.l, sizeof(reg.l));
-	file.read((char*)&reg.f, sizeof(reg.f));
-	file.read((char*)&reg.pc, sizeof(reg.pc));
-	file.read((char*)&reg.sp, sizeof(reg.sp));
+	state.read((char*)&reg.a, sizeof(reg.a));
+	state.read((char*)&reg.b, sizeof(reg.b));
+	state.read((char*)&reg.c, sizeof(reg.c));
+	state.read((char*)&reg.d, sizeof(reg.d));
+	state.read((char*)&reg.e, sizeof(reg.e));
+	state.read((char*)&reg.h, sizeof(reg.h));
+	state.read((char*)&reg.l, sizeof(reg.l));
+	state.read((char*)&reg.f, sizeof(reg.f));
+	state.read((char*)&reg.pc, sizeof(reg.pc));
+	state.read((char*)&reg.sp, sizeof(reg.sp));
 
 	//Serialize CPU clock data to file stream
-	file.read((char*)&cpu_clock_m, sizeof(cpu_clock_m));
-	file.read((char*)&cpu_clock_t, sizeof(cpu_clock_t));
-	file.read((char*)&div_counter, sizeof(div_counter));
-	file.read((char*)&tima_counter, sizeof(tima_counter));
-	file.read((char*)&tima_speed, sizeof(tima_speed));
-	file.read((char*)&cycles, sizeof(cycles));
+	state.read((char*)&cpu_clock_m, sizeof(cpu_clock_m));
+	state.read((char*)&cpu_clock_t, sizeof(cpu_clock_t));
+	state.read((char*)&div_counter, sizeof(div_counter));
+	state.read((char*)&tima_counter, sizeof(tima_counter));
+	state.read((char*)&tima_speed, sizeof(tima_speed));
+	state.read((char*)&cycles, sizeof(cycles));
 	
 	//Serialize misc CPU data to filestream
-	file.read((char*)&running, sizeof(running));
-	file.read((char*)&halt, sizeof(halt));
-	file.read((char*)&pause, sizeof(pause));
-	file.read((char*)&interrupt, sizeof(interrupt));
-	file.read((char*)&double_speed, sizeof(double_speed));
-	file.read((char*)&interrupt_delay, sizeof(interrupt_delay));
-	file.read((char*)&skip_instruction, sizeof(skip_instruction));
-
-	file.close();
-	return true;
+	state.read((char*)&running, sizeof(running));
+	state.read((char*)&halt, sizeof(halt));
+	state.read((char*)&pause, sizeof(pause));
+	state.read((char*)&interrupt, sizeof(interrupt));
+	state.read((char*)&double_speed, sizeof(double_speed));
+	state.read((char*)&interrupt_delay, sizeof(interrupt_delay));
+	state.read((char*)&skip_instruction, sizeof(skip_instruction));
+
+	idle_loop.valid = false;
+
+	return state.good();
 }
 
 /****** Write CPU data to save state ******/
-bool Z80::cpu_write(std::string filename)
+bool Z80::cpu_write(save_state_buffer& state)
 {
-	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
-	
-	if(!file.is_open()) { return false; }
-
 	//Serialize CPU registers data to file stream
-	file.write((char*)&reg.a, sizeof(reg.a));
-	file.write((char*)&reg.b, sizeof(reg.b));
-	file.write((char*)&reg.c, sizeof(reg.c));
-	file.write((char*)&reg.d, sizeof(reg.d));
-	file.write((char*)&reg.e, sizeof(reg.e));
-	file.write((char*)&reg.h, sizeof(reg.h));
-	file.write((char*)&reg.l, sizeof(reg.l));
-	file.write((char*)&reg.f, sizeof(reg.f));
-	file.write((char*)&reg.pc, sizeof(reg.pc));
-	file.write((char*)&reg.sp, sizeof(reg.sp));
+	state.write((char*)&reg.a, sizeof(reg.a));
+	state.write((char*)&reg.b, sizeof(reg.b));
+	state.write((char*)&reg.c, sizeof(reg.c));
+	state.write((char*)&reg.d, sizeof(reg.d));
+	state.write((char*)&reg.e, sizeof(reg.e));
+	state.write((char*)&reg.h, sizeof(reg.h));
+	state.write((char*)&reg.l, sizeof(reg.l));
+	state.write((char*)&reg.f, sizeof(reg.f));
+	state.write((char*)&reg.pc, sizeof(reg.pc));
+	state.write((char*)&reg.sp, sizeof(reg.sp));
 
 	//Serialize CPU clock data to file stream
-	file.write((char*)&cpu_clock_m, sizeof(cpu_clock_m));
-	file.write((char*)&cpu_clock_t, sizeof(cpu_clock_t));
-	file.write((char*)&div_counter, sizeof(div_counter));
-	file.write((char*)&tima_counter, sizeof(tima_counter));
-	file.write((char*)&tima_speed, sizeof(tima_speed));
-	file.write((char*)&cycles, sizeof(cycles));
+	state.write((char*)&cpu_clock_m, sizeof(cpu_clock_m));
+	state.write((char*)&cpu_clock_t, sizeof(cpu_clock_t));
+	state.write((char*)&div_counter, sizeof(div_counter));
+	state.write((char*)&tima_counter, sizeof(tima_counter));
+	state.write((char*)&tima_speed, sizeof(tima_speed));
+	state.write((char*)&cycles, sizeof(cycles));
 	
 	//Serialize misc CPU data to filestream
-	file.write((char*)&running, sizeof(running));
-	file.write((char*)&halt, sizeof(halt));
-	file.write((char*)&pause, sizeof(pause));
-	file.write((char*)&interrupt, sizeof(interrupt));
-	file.write((char*)&double_speed, sizeof(double_speed));
-	file.write((char*)&interrupt_delay, sizeof(interrupt_delay));
-	file.write((char*)&skip_instruction, sizeof(skip_instruction));
-
-	file.close();
+	state.write((char*)&running, sizeof(running));
+	state.write((char*)&halt, sizeof(halt));
+	state.write((char*)&pause, sizeof(pause));
+	state.write((char*)&interrupt, sizeof(interrupt));
+	state.write((char*)&double_speed, sizeof(double_speed));
+	state.write((char*)&interrupt_delay, sizeof(interrupt_delay));
+	state.write((char*)&skip_instruction, sizeof(skip_instruction));
+
 	return true;
 }
 
@@ -211,6 +209,127 @@ u32 Z80::size()
 	return cpu_size;
 }
 
+/****** Checks whether the opcode at an address is safe to repeat inside an idle loop ******/
+bool Z80::is_idle_opcode(u16 addr)
+{
+	switch(opcode)
+	{
+		//Memory writes
+		case 0x02: case 0x08: case 0x12: case 0x22: case 0x32: case 0x34: case 0x35: case 0x36:
+		case 0x70: case 0x71: case 0x72: case 0x73: case 0x74: case 0x75: case 0x77:
+		case 0xC5: case 0xD5: case 0xE0: case 0xE2: case 0xE5: case 0xEA: case 0xF5:
+
+		//Calls, returns, and restarts
+		case 0xC0: case 0xC4: case 0xC7: case 0xC8: case 0xC9: case 0xCC: case 0xCD: case 0xCF:
+		case 0xD0: case 0xD4: case 0xD7: case 0xD8: case 0xD9: case 0xDC: case 0xDF:
+		case 0xE7: case 0xE9: case 0xEF: case 0xF7: case 0xFF:
+
+		//STOP, HALT, DI, EI, and illegal opcodes
+		case 0x10: case 0x76: case 0xF3: case 0xFB:
+		case 0xD3: case 0xDB: case 0xDD: case 0xE3: case 0xE4: case 0xEB: case 0xEC: case 0xED: case 0xF4: case 0xFC: case 0xFD:
+			return false;
+
+		//CB opcodes - Only BIT leaves (HL) untouched
+		case 0xCB:
+		{
+			u8 cb_opcode = mem->read_u8(addr + 1);
+			return (((cb_opcode & 0x7) != 0x6) || ((cb_opcode >= 0x40) && (cb_opcode < 0x80)));
+		}
+
+		default:
+			return true;
+	}
+}
+
+/****** Stretches an idle loop up to the next LCD or timer change when a short loop repeats without changing anything ******/
+void Z80::check_idle_loop(u16 addr)
+{
+	if(!is_idle_opcode(addr))
+	{
+		idle_loop.pure = false;
+		return;
+	}
+
+	//Only look at jumps that were taken - JR e, JR cc, JP nn, JP cc
+	bool jump = (opcode == 0x18) || ((opcode & 0xE7) == 0x20) || (opcode == 0xC3) || ((opcode & 0xE7) == 0xC2);
+	if((!jump) || (reg.pc == u16(addr + ((opcode & 0x80) ? 3 : 2)))) { return; }
+
+	//Only short backward jumps ending an iteration that just read memory and worked on registers count
+	if((!idle_loop.pure) || (reg.pc > addr) || ((addr - reg.pc) > Z80_IDLE_LOOP_SIZE))
+	{
+		idle_loop.valid = false;
+		idle_loop.pure = true;
+		return;
+	}
+
+	u16 regs[5] = { reg.af, reg.bc, reg.de, reg.hl, reg.sp };
+
+	bool repeated = (idle_loop.valid) && (idle_loop.start == reg.pc) && (idle_loop.end == addr) && (idle_loop.ime == interrupt);
+	for(u32 x = 0; (repeated) && (x < 5); x++) { repeated = (regs[x] == idle_loop.regs[x]); }
+
+	idle_loop.pure = true;
+
+	//A different loop or a loop still changing registers - Remember this iteration and compare against the next one
+	if(!repeated)
+	{
+		for(u32 x = 0; x < 5; x++) { idle_loop.regs[x] = regs[x]; }
+		idle_loop.start = reg.pc;
+		idle_loop.end = addr;
+		idle_loop.ime = interrupt;
+		idle_loop.valid = true;
+		return;
+	}
+
+	u32 idle_cycles = get_event_cycles();
+
+	//Let this iteration's last instruction take until then, the core loop runs the LCD and timers right afterwards
+	if(idle_cycles > cycles) { cycles = idle_cycles; }
+}
+
+/****** Returns the cycles left until the next DIV or TIMA increment, or the next LCD mode or scanline - 0 when those need updating after every instruction ******/
+u32 Z80::get_event_cycles()
+{
+	//Serial transfers and pending timer or LCD resets are handled cycle by cycle, so leave those alone
+	if((controllers.serial_io.sio_stat.connected) || (controllers.serial_io.sio_stat.shifts_left != 0)) { return 0; }
+	if((interrupt_delay) || (controllers.video.lcd_stat.on_off) || (div_counter >= 256)) { return 0; }
+
+	u32 event_cycles = 256 - div_counter;
+
+	//Use the speed TAC selects right now, the core loop only updates tima_speed after running an instruction
+	if(mem->memory_map[REG_TAC] & 0x4)
+	{
+		u32 speed = 1024;
+
+		switch(mem->memory_map[REG_TAC] & 0x3)
+		{
+			case 0x01: speed = 16; break;
+			case 0x02: speed = 64; break;
+			case 0x03: speed = 256; break;
+		}
+
+		if((mem->div_reset) || (tima_counter >= speed)) { return 0; }
+		if((speed - tima_counter) < event_cycles) { event_cycles = speed - tima_counter; }
+	}
+
+	if(controllers.video.lcd_stat.lcd_enable)
+	{
+		u32 lcd_cycles = 0;
+		u32 line_pos = controllers.video.lcd_stat.lcd_clock % 456;
+
+		if(controllers.video.lcd_stat.lcd_clock >= 65664) { lcd_cycles = 456 - (controllers.video.lcd_stat.vblank_clock % 456); }
+		else if(line_pos < 80) { lcd_cycles = 80 - line_pos; }
+		else if(line_pos < 252) { lcd_cycles = 252 - line_pos; }
+		else { lcd_cycles = 456 - line_pos; }
+
+		//The LCD runs at half the CPU clock in double speed mode, and slower still when overclocking
+		lcd_cycles <<= config::oc_flags;
+		if(double_speed) { lcd_cycles <<= 1; }
+		if(lcd_cycles < event_cycles) { event_cycles = lcd_cycles; }
+	}
+
+	return event_cycles;
+}
+
 /****** Handle Interrupts to Z80 ******/
 bool Z80::handle_interrupts()
 {
@@ -328,51 +447,20 @@ u8 Z80::swap(u8 reg_one)
 /****** 8-bit addition ******/
 u8 Z80::add_byte(u8 reg_one, u8 reg_two)
 {
-	reg.f = 0;
-
-	//Carry
-	if(reg_one + reg_two > 0xFF) { reg.f |= 0x10; }
-
-	//Half-Carry
-	if((reg_one & 0xF) + (reg_two & 0xF) > 0xF) { reg.f |= 0x20; }
-
-	//Zero
-	if(u8(reg_one + reg_two) == 0) { reg.f |= 0x80; }
+	u8 result = reg_one + reg_two;
+	reg.f = sm83_flags::add[(reg_one << 8) | reg_two];
 
-	return reg_one + reg_two;
+	return result;
 }
 
 /****** 8-bit addition - Carry ******/
 u8 Z80::add_carry(u8 reg_one, u8 reg_two)
 {
-	u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
-	u8 carry_set = 0;
-	u8 half_carry_set = 0;
-
-	u8 temp_1, temp_2 = 0;
-
-	temp_1 = reg_one + carry_flag;
-
-	if(reg_one + carry_flag > 0xFF) { carry_set = 1; }
-	if((reg_one & 0x0F) + (carry_flag & 0x0F) > 0x0F) { half_carry_set = 1; }
-
-	temp_2 = temp_1 + reg_two;
+	u32 carry_flag = (reg.f & 0x10) ? 1 : 0;
+	u8 result = reg_one + reg_two + carry_flag;
+	reg.f = sm83_flags::add[(carry_flag << 16) | (reg_one << 8) | reg_two];
 
-	if(temp_1 + reg_two > 0xFF) { carry_set = 1; }
-	if((temp_1 & 0x0F) + (reg_two & 0x0F) > 0x0F) { half_carry_set = 1; }
-
-	reg.f = 0;
-
-	//Carry
-	if(carry_set == 1) { reg.f |= 0x10; }
-
-	//Half Carry
-	if(half_carry_set == 1) { reg.f |= 0x20; }
-
-	//Zero
-	if(temp_2 == 0) { reg.f |= 0x80; }
-
-	return temp_2;
+	return result;
 }
 
 /****** 16-bit addition ******/
@@ -413,57 +501,20 @@ u16 Z80::add_signed_byte(u16 reg_one, u8 reg_two)
 /****** 8-bit subtraction ******/
 u8 Z80::sub_byte(u8 reg_one, u8 reg_two)
 {
-	reg.f = 0;
+	u8 result = reg_one - reg_two;
+	reg.f = sm83_flags::sub[(reg_one << 8) | reg_two];
 
-	//Carry
-	if(reg_one < reg_two) { reg.f |= 0x10; }
-
-	//Half Carry
-	if((reg_one & 0xF) < (reg_two & 0xF)) { reg.f |= 0x20; }
-
-	//Subtract
-	reg.f |= 0x40;
-
-	//Zero
-	if(u8(reg_one - reg_two) == 0) { reg.f |= 0x80; }
-
-	return reg_one - reg_two;
+	return result;
 }
 
 /****** 8-bit subtraction - Carry ******/
 u8 Z80::sub_carry(u8 reg_one, u8 reg_two)
 {
-	u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
-	u8 carry_set = 0;
-	u8 half_carry_set = 0;
-
-	u8 temp_1, temp_2 = 0;
-
-	temp_1 = reg_one - carry_flag;
+	u32 carry_flag = (reg.f & 0x10) ? 1 : 0;
+	u8 result = reg_one - reg_two - carry_flag;
+	reg.f = sm83_flags::sub[(carry_flag << 16) | (reg_one << 8) | reg_two];
 
-	if(reg_one < carry_flag) { carry_set = 1; }
-	if ((reg_one & 0x0F) < (carry_flag & 0x0F)) { half_carry_set = 1; }
-
-	temp_2 = temp_1 - reg_two;
-
-	if(temp_1 < reg_two) { carry_set = 1; }
-	if ((temp_1 & 0x0F) < (reg_two & 0x0F)) { half_carry_set = 1; }
-	
-	reg.f = 0;
-
-	//Carry
-	if(carry_set == 1) { reg.f |= 0x10; }
-
-	//Half Carry
-	if(half_carry_set == 1) { reg.f |= 0x20; }
-
-	//Subtract
-	reg.f |= 0x40;
-
-	//Zero
-	if(temp_2 == 0) { reg.f |= 0x80; }
-
-	return temp_2;
+	return result;
 }
 
 /****** 8-bit AND ******/
@@ -505,44 +556,15 @@ u8 Z80::xor_byte(u8 reg_one, u8 reg_two)
 /****** 8-bit increment ******/
 u8 Z80::inc_byte(u8 reg_one)
 {
-	u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
-	reg_one++;
-
-	reg.f = 0;
-
-	//Carry
-	if(carry_flag == 1) { reg.f |= 0x10; }
-
-	//Half Carry
-	if((reg_one & 0xF) == 0) { reg.f |= 0x20; }
-
-	//Zero
-	if(reg_one == 0) { reg.f |= 0x80; }
-
-	return reg_one;
+	reg.f = (reg.f & 0x10) | sm83_flags::inc[reg_one];
+	return reg_one + 1;
 }
 
 /****** 8-bit decrement ******/
 u8 Z80::dec_byte(u8 reg_one)
 {
-	u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
-	reg_one--;
-
-	reg.f = 0;
-
-	//Subtract
-	reg.f |= 0x40;
-
-	//Carry
-	if(carry_flag == 1) { reg.f |= 0x10; }
-
-	//Half Carry
-	if((reg_one & 0xF) == 0xF) { reg.f |= 0x20; }
-
-	//Zero
-	if(reg_one == 0) { reg.f |= 0x80; }
-
-	return reg_one;
+	reg.f = (reg.f & 0x10) | sm83_flags::dec[reg_one];
+	return reg_one - 1;
 }
 
 /****** Check bit ******/
@@ -578,72 +600,37 @@ u8 Z80::set(u8 reg_one, u8 set_bit)
 /****** Rotate byte left *****/
 u8 Z80::rotate_left(u8 reg_one)
 {
-	u8 old_carry = (reg.f & 0x10) ? 1 : 0;
-	reg.f = 0;
-	
-	u8 carry_flag = (reg_one & 0x80) >> 7;
-	reg_one = (reg_one << 1) + old_carry;
-
-	//Carry
-	if(carry_flag == 1) { reg.f |= 0x10; }
+	u16 result = sm83_flags::rl[((reg.f & 0x10) << 4) | reg_one];
+	reg.f = result >> 8;
 
-	//Zero
-	if(reg_one == 0) { reg.f |= 0x80; }
-
-	return reg_one;
+	return result;
 }
 
 /****** Rotate byte left through carry *****/
 u8 Z80::rotate_left_carry(u8 reg_one)
 {
-	reg.f = 0;	
-
-	u8 carry_flag = (reg_one & 0x80) >> 7;
-	reg_one = (reg_one << 1) + carry_flag;
+	u16 result = sm83_flags::rlc[reg_one];
+	reg.f = result >> 8;
 
-	//Carry
-	if(carry_flag == 1) { reg.f |= 0x10; }
-
-	//Zero
-	if(reg_one == 0) { reg.f |= 0x80; }
-	
-	return reg_one;
+	return result;
 }
 
 /****** Rotate byte right  ******/
 u8 Z80::rotate_right(u8 reg_one)
 {
-	u8 old_carry = (reg.f & 0x10) ? 1 : 0;
-	reg.f = 0;
-
-	u8 carry_flag = (reg_one & 0x01);
-	reg_one = (reg_one >> 1) + (old_carry << 7);
+	u16 result = sm83_flags::rr[((reg.f & 0x10) << 4) | reg_one];
+	reg.f = result >> 8;
 
-	//Carry
-	if(carry_flag == 1) { reg.f |= 0x10; }
-
-	//Zero
-	if(reg_one == 0) {reg.f |= 0x80; }
-
-	return reg_one;
+	return result;
 }
 
 /****** Rotate byte right through carry ******/
 u8 Z80::rotate_right_carry(u8 reg_one)
 {
-	reg.f = 0;
-
-	//Store 1st bit in Carry Flag
-	u8 carry_flag = (reg_one & 0x01);
-	reg_one = (reg_one >> 1) + (carry_flag << 7);
-
-	//Carry
-	if(carry_flag == 1) { reg.f |= 0x10; }
+	u16 result = sm83_flags::rrc[reg_one];
+	reg.f = result >> 8;
 
-	//Zero
-	if(reg_one == 0) {reg.f |= 0x80; }
-
-	return reg_one;
+	return result;
 }
 
 /****** Shift byte left into carry - Preserve sign ******/
@@ -698,33 +685,10 @@ u8 Z80::srl(u8 reg_one)
 /****** Decimal adjust accumulator ******/
 u8 Z80::daa()
 {
-	u32 reg_one = reg.a;
-	
-	//Add or subtract correction values based on Subtract Flag
-	if(!(reg.f & 0x40))
-	{
-		if((reg.f & 0x20) || ((reg_one & 0xF) > 0x09)) { reg_one += 0x06; }
-		if((reg.f & 0x10) || (reg_one > 0x9F)) { reg_one += 0x60; }
-	}
-
-	else 
-	{
-		if(reg.f & 0x20) { reg_one = (reg_one - 0x06) & 0xFF; }
-		if(reg.f & 0x10) { reg_one -= 0x60; }
-	}
+	u16 result = sm83_flags::daa[((reg.f & 0x70) << 4) | reg.a];
+	reg.f = result & 0xFF;
 
-	//Carry
-	if(reg_one & 0x100) { reg.f |= 0x10; }
-	reg_one &= 0xFF;
-
-	//Half-Carry
-	reg.f &= ~0x20;
-
-	//Zero
-	if(reg_one == 0) { reg.f |= 0x80; }
-	else { reg.f &= ~0x80; }
-	 
-	return reg_one;	
+	return (result >> 8);
 }
 
 /****** Execute 8-bit opcodes ******/
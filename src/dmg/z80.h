@@ -20,6 +20,9 @@
 #include "apu.h"
 #include "sio.h"
 
+//Largest backward jump (in bytes) treated as a possible idle loop
+#define Z80_IDLE_LOOP_SIZE 0x40
+
 class Z80
 {
 	public:
@@ -102,6 +105,17 @@ class Z80
 	bool double_speed;
 	bool skip_instruction;
 
+	//Idle loop detection - Last short backward jump, and the registers when it was taken
+	struct idle_loop_info
+	{
+		u16 start;
+		u16 end;
+		u16 regs[5];
+		bool ime;
+		bool valid;
+		bool pure;
+	} idle_loop;
+
 	//Audio-Video and other controllers
 	struct io_controllers
 	{
@@ -119,13 +133,20 @@ class Z80
 	void exec_op(u16 opcode);
 
 	//Serialize data for save state loading/saving
-	bool cpu_read(u32 offset, std::string filename);
-	bool cpu_write(std::string filename);
+	bool cpu_read(save_state_buffer& state);
+	bool cpu_write(save_state_buffer& state);
 	u32 size();
 
 	//Interrupt handling
 	bool handle_interrupts();
 
+	//Idle loop detection
+	bool is_idle_opcode(u16 addr);
+	void check_idle_loop(u16 addr);
+
+	//Cycles until the LCD or timers next need updating
+	u32 get_event_cycles();
+
 	inline void jr(u8 reg_one);
 
 	//Math functions
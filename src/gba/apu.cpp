@@ -12,6 +12,7 @@
 #include <cmath>
 
 #include "apu.h"
+#include "common/headless.h"
 
 /****** APU Constructor ******/
 AGB_APU::AGB_APU()
@@ -161,8 +162,8 @@ bool AGB_APU::init()
 		putenv(const_cast<char*>(env_var.c_str()));
 	}
 
-	//Initialize audio subsystem
-	if(SDL_InitSubSystem(SDL_INIT_AUDIO) == -1)
+	//Initialize audio subsystem - Headless mode pulls samples without an audio device
+	if((!config::headless) && (SDL_InitSubSystem(SDL_INIT_AUDIO) == -1))
 	{
 		std::cout<<"APU::Error - Could not initialize SDL audio\n";
 		return false;
@@ -176,8 +177,11 @@ bool AGB_APU::init()
     	desired_spec.callback = agb_audio_callback;
     	desired_spec.userdata = this;
 
+	//Allocate mixing buffers up front - Sound Channels 1-4, DMA Channels A and B, external audio
+	mixer.init(7, (desired_spec.samples * desired_spec.channels));
+
     	//Open SDL audio for desired specifications
-	if(SDL_OpenAudio(&desired_spec, NULL) < 0) 
+	if(headless::open_audio(&desired_spec) < 0) 
 	{ 
 		std::cout<<"APU::Failed to open audio\n";
 		init_status = false;
@@ -554,54 +558,52 @@ void AGB_APU::generate_ext_audio_hi_samples(s16* stream, int length)
 void agb_audio_callback(void* _apu, u8 *_stream, int _length)
 {
 	s16* stream = (s16*) _stream;
-	int length = _length/2;
-
-	std::vector<s16> channel_1_stream(length);
-	std::vector<s16> channel_2_stream(length);
-	std::vector<s16> channel_3_stream(length);
-	std::vector<s16> channel_4_stream(length);
-
-	std::vector<s16> dma_a_stream(length);
-	std::vector<s16> dma_b_stream(length);
-
-	std::vector<s16> ext_stream(length);
+	u32 length = _length/2;
 
 	AGB_APU* apu_link = (AGB_APU*) _apu;
-	apu_link->generate_channel_1_samples(&channel_1_stream[0], length);
-	apu_link->generate_channel_2_samples(&channel_2_stream[0], length);
-	apu_link->generate_channel_3_samples(&channel_3_stream[0], length);
-	apu_link->generate_channel_4_samples(&channel_4_stream[0], length);
-	apu_link->generate_dma_a_samples(&dma_a_stream[0], length);
-	apu_link->generate_dma_b_samples(&dma_b_stream[0], length);
-
-	double channel_ratio = apu_link->apu_stat.channel_master_volume / 128.0;
-	double dma_a_ratio = apu_link->apu_stat.dma[0].master_volume / 128.0;
-	double dma_b_ratio = apu_link->apu_stat.dma[1].master_volume / 128.0;
+	audio_mixer& mixer = apu_link->mixer;
 
-	double ext_ratio = apu_link->apu_stat.ext_audio.volume / 63.0;
-
-	//Custom software mixing
-	for(u32 x = 0; x < length; x++)
+	//Only mix as many samples as the preallocated buffers hold, silence anything else
+	if(length > mixer.get_max_length())
 	{
-		//Add Sound Channels 1-4 and multiply by volume ratio
-		s32 out_sample = (channel_1_stream[x] + channel_2_stream[x] + channel_3_stream[x] + channel_4_stream[x]) * channel_ratio;
+		for(u32 x = mixer.get_max_length(); x < length; x++) { stream[x] = 0; }
+		length = mixer.get_max_length();
+	}
 
-		//Add DMA Channels A and B and multiply by volume ratio
-		out_sample += (dma_a_stream[x] * dma_a_ratio) + (dma_b_stream[x] * dma_b_ratio);
+	apu_link->generate_channel_1_samples(mixer.get_channel(0), length);
+	apu_link->generate_channel_2_samples(mixer.get_channel(1), length);
+	apu_link->generate_channel_3_samples(mixer.get_channel(2), length);
+	apu_link->generate_channel_4_samples(mixer.get_channel(3), length);
+	apu_link->generate_dma_a_samples(mixer.get_channel(4), length);
+	apu_link->generate_dma_b_samples(mixer.get_channel(5), length);
 
-		//Divide final wave by total amount of channels
-		out_sample /= 6;
+	s32 channel_volume = apu_link->apu_stat.channel_master_volume;
+	s32 dma_a_volume = apu_link->apu_stat.dma[0].master_volume;
+	s32 dma_b_volume = apu_link->apu_stat.dma[1].master_volume;
+	s32 ext_volume = apu_link->apu_stat.ext_audio.volume;
 
-		stream[x] = out_sample;
-	}
+	//Custom software mixing
+	//Add Sound Channels 1-4 and DMA Channels A and B multiplied by their volumes (out of 128)
+	//Divide final wave by total amount of channels
+	mixer.clear(length);
+	mixer.add(mixer.get_channel(0), length, channel_volume);
+	mixer.add(mixer.get_channel(1), length, channel_volume);
+	mixer.add(mixer.get_channel(2), length, channel_volume);
+	mixer.add(mixer.get_channel(3), length, channel_volume);
+	mixer.add(mixer.get_channel(4), length, dma_a_volume);
+	mixer.add(mixer.get_channel(5), length, dma_b_volume);
+	mixer.output(stream, length, 1, (128 * 6));
 
 	//Mix in external audio if necessary
 	if(apu_link->apu_stat.ext_audio.playing)
 	{
+		s16* ext_stream = mixer.get_channel(6);
+		for(u32 x = 0; x < length; x++) { ext_stream[x] = 0; }
+
 		//Generate raw samples (high quality)
 		if(apu_link->apu_stat.ext_audio.use_headphones)
 		{
-			apu_link->generate_ext_audio_hi_samples(&ext_stream[0], length);
+			apu_link->generate_ext_audio_hi_samples(ext_stream, length);
 		}
 
 		//Generate GBA samples (low quality)
@@ -611,15 +613,11 @@ void agb_audio_callback(void* _apu, u8 *_stream, int _length)
 		}
 
 		//Custom software mixing
-		for(u32 x = 0; x < length; x++)
-		{
-			s32 out_sample = stream[x] + (ext_stream[x] * ext_ratio);
-			
-			//Divide final wave by total amount of channels
-			out_sample /= 2;
-
-			stream[x] = out_sample;
-		}
+		//Add external audio multiplied by its volume (out of 63), divide final wave by total amount of channels
+		mixer.clear(length);
+		mixer.add(stream, length, 63);
+		mixer.add(ext_stream, length, ext_volume);
+		mixer.output(stream, length, 1, (63 * 2));
 	}
 }
 
@@ -1242,33 +1240,22 @@ void AGB_APU::buffer_channel_4()
 }
 
 /****** Read APU data from save state ******/
-bool AGB_APU::apu_read(u32 offset, std::string filename)
+bool AGB_APU::apu_read(save_state_buffer& state)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary);
-	
-	if(!file.is_open()) { return false; }
+	//Serialize APU data from save state - Lock out the audio callback while the data is replaced
+	SDL_LockAudio();
+	state.read((char*)&apu_stat, sizeof(apu_stat));
+	SDL_UnlockAudio();
 
-	//Go to offset
-	file.seekg(offset);
-
-	//Serialize APU data from save state
-	file.read((char*)&apu_stat, sizeof(apu_stat));
-
-	file.close();
-	return true;
+	return state.good();
 }
 
 /****** Write APU data to save state ******/
-bool AGB_APU::apu_write(std::string filename)
+bool AGB_APU::apu_write(save_state_buffer& state)
 {
-	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::app);
-	
-	if(!file.is_open()) { return false; }
-
 	//Serialize APU data to save state
-	file.write((char*)&apu_stat, sizeof(apu_stat));
+	state.write((char*)&apu_stat, sizeof(apu_stat));
 
-	file.close();
 	return true;
 }
 
@@ -15,6 +15,7 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_audio.h>
 #include "mmu.h"
+#include "common/audio_mixer.h"
 
 class AGB_APU
 {
@@ -28,6 +29,9 @@ class AGB_APU
 	SDL_AudioSpec desired_spec;
 	SDL_AudioSpec microphone_spec;
 
+	//Preallocated buffers for the audio callback
+	audio_mixer mixer;
+
 	//Recording buffer for microphone input
 	std::vector<s16> mic_buffer;
 
@@ -52,8 +56,8 @@ class AGB_APU
 	void generate_ext_audio_hi_samples(s16* stream, int length);
 
 	//Serialize data for save state loading/saving
-	bool apu_read(u32 offset, std::string filename);
-	bool apu_write(std::string filename);
+	bool apu_read(save_state_buffer& state);
+	bool apu_write(save_state_buffer& state);
 	u32 size();
 };
 
@@ -81,6 +81,9 @@ void ARM7::reset()
 
 	system_cycles = 0;
 
+	scheduler.reset();
+	scheduler.schedule(AGB_EVENT_LCD, 1);
+
 	debug_message = 0xFF;
 	debug_code = 0;
 	debug_cycles = 0;
@@ -88,6 +91,10 @@ void ARM7::reset()
 	flush_pipeline();
 	mem = NULL;
 
+	idle_loop.start = idle_loop.end = 0;
+	idle_loop.valid = false;
+	idle_loop.pure = true;
+
 	std::cout<<"CPU::Initialized\n";
 }
 
@@ -306,6 +313,17 @@ void ARM7::set_spsr(u32 value)
 /****** Fetch ARM instruction ******/
 void ARM7::fetch()
 {
+	//IWRAM and ROM keep instructions that were already decoded at this address
+	AGB_MMU::decoded_instruction* entry = mem->get_code_entry(reg.r15);
+	bool thumb = (arm_mode == THUMB);
+
+	if((entry != NULL) && (entry->valid) && (entry->thumb == thumb))
+	{
+		instruction_pipeline[pipeline_pointer] = entry->opcode;
+		instruction_operation[pipeline_pointer] = arm_instructions(entry->operation);
+		instruction_idle[pipeline_pointer] = entry->idle;
+		return;
+	}
 
 	#ifdef GBE_FAST_FETCH
 
@@ -314,9 +332,6 @@ void ARM7::fetch()
 	{
 		//Read 16-bit THUMB instruction
 		instruction_pipeline[pipeline_pointer] = mem->read_u16_fast(reg.r15);
-
-		//Set the operation to perform as UNDEFINED until decoded
-		instruction_operation[pipeline_pointer] = UNDEFINED;
 	}
 
 	//Fetch ARM instructions
@@ -324,9 +339,6 @@ void ARM7::fetch()
 	{
 		//Read 32-bit ARM instruction
 		instruction_pipeline[pipeline_pointer] = mem->read_u32_fast(reg.r15);
-
-		//Set the operation to perform as UNDEFINED until decoded
-		instruction_operation[pipeline_pointer] = UNDEFINED;
 	}
 
 	#endif
@@ -338,9 +350,6 @@ void ARM7::fetch()
 	{
 		//Read 16-bit THUMB instruction
 		instruction_pipeline[pipeline_pointer] = mem->read_u16(reg.r15);
-
-		//Set the operation to perform as UNDEFINED until decoded
-		instruction_operation[pipeline_pointer] = UNDEFINED;
 	}
 
 	//Fetch ARM instructions
@@ -348,12 +357,24 @@ void ARM7::fetch()
 	{
 		//Read 32-bit ARM instruction
 		instruction_pipeline[pipeline_pointer] = mem->read_u32(reg.r15);
-
-		//Set the operation to perform as UNDEFINED until decoded
-		instruction_operation[pipeline_pointer] = UNDEFINED;
 	}
 
 	#endif
+
+	//Set the operation to perform as UNDEFINED until decoded
+	instruction_operation[pipeline_pointer] = UNDEFINED;
+
+	//Cacheable instructions are decoded right away, before anything can write over them, and remembered for the next fetch
+	if(entry != NULL)
+	{
+		decode_stage(pipeline_pointer);
+
+		entry->opcode = instruction_pipeline[pipeline_pointer];
+		entry->operation = instruction_operation[pipeline_pointer];
+		entry->idle = instruction_idle[pipeline_pointer];
+		entry->thumb = thumb;
+		entry->valid = true;
+	}
 }
 
 /****** Decode ARM instruction ******/
@@ -361,258 +382,28 @@ void ARM7::decode()
 {
 	u8 pipeline_id = (pipeline_pointer + 2) % 3;
 
-	if(instruction_operation[pipeline_id] == PIPELINE_FILL) { return; }
+	//Pipeline fills and instructions decoded when fetched need nothing else
+	if(instruction_operation[pipeline_id] != UNDEFINED) { return; }
 
+	decode_stage(pipeline_id);
+}
+
+/****** Decodes the instruction held in a pipeline stage ******/
+void ARM7::decode_stage(u8 pipeline_id)
+{
 	//Decode THUMB instructions
 	if(arm_mode == THUMB)
 	{
-		u16 current_instruction = instruction_pipeline[pipeline_id];
-		
-		if(((current_instruction >> 13) == 0) && (((current_instruction >> 11) & 0x7) != 0x3))
-		{
-			//THUMB_1
-			instruction_operation[pipeline_id] = THUMB_1;
-		}
-
-		else if(((current_instruction >> 11) & 0x1F) == 0x3)
-		{
-			//THUMB_2
-			instruction_operation[pipeline_id] = THUMB_2;
-		}
-
-		else if((current_instruction >> 13) == 0x1)
-		{
-			//THUMB_3
-			instruction_operation[pipeline_id] = THUMB_3;
-		}
-
-		else if(((current_instruction >> 10) & 0x3F) == 0x10)
-		{
-			//THUMB_4
-			instruction_operation[pipeline_id] = THUMB_4;
-		}
-
-		else if(((current_instruction >> 10) & 0x3F) == 0x11)
-		{
-			//THUMB_5
-			instruction_operation[pipeline_id] = THUMB_5;
-		}
-
-		else if((current_instruction >> 11) == 0x9)
-		{
-			//THUMB_6
-			instruction_operation[pipeline_id] = THUMB_6;
-		}
-
-		else if((current_instruction >> 12) == 0x5)
-		{
-			if(current_instruction & 0x200)
-			{
-				//THUMB_8
-				instruction_operation[pipeline_id] = THUMB_8;
-			}
-
-			else
-			{
-				//THUMB_7
-				instruction_operation[pipeline_id] = THUMB_7;
-			}
-		}
-
-		else if(((current_instruction >> 13) & 0x7) == 0x3)
-		{
-			//THUMB_9
-			instruction_operation[pipeline_id] = THUMB_9;
-		}
-
-		else if((current_instruction >> 12) == 0x8)
-		{
-			//THUMB_10
-			instruction_operation[pipeline_id] = THUMB_10;
-		}
-
-		else if((current_instruction >> 12) == 0x9)
-		{
-			//THUMB_11
-			instruction_operation[pipeline_id] = THUMB_11;
-		}
-
-		else if((current_instruction >> 12) == 0xA)
-		{
-			//THUMB_12
-			instruction_operation[pipeline_id] = THUMB_12;
-		}
-
-		else if((current_instruction >> 8) == 0xB0)
-		{
-			//THUMB_13
-			instruction_operation[pipeline_id] = THUMB_13;
-		}
-
-		else if((current_instruction >> 12) == 0xB)
-		{
-			//THUMB_14
-			instruction_operation[pipeline_id] = THUMB_14;
-		}
-
-		else if((current_instruction >> 12) == 0xC)
-		{
-			//THUMB_15
-			instruction_operation[pipeline_id] = THUMB_15;
-		}
-
-		else if((current_instruction >> 12) == 13)
-		{
-			//THUMB_16
-			instruction_operation[pipeline_id] = THUMB_16;
-		}
-
-		else if((current_instruction >> 11) == 0x1C)
-		{
-			//THUMB_18
-			instruction_operation[pipeline_id] = THUMB_18;
-		}
-
-		else if((current_instruction >> 11) >= 0x1E)
-		{
-			//THUMB_19
-			instruction_operation[pipeline_id] = THUMB_19;
-		}
+		instruction_operation[pipeline_id] = arm_decoder::decode_thumb<arm_instructions, ARM_DECODE_ARMV4>(instruction_pipeline[pipeline_id]);
 	}
 
 	//Decode ARM instructions
-	if(arm_mode == ARM)
+	else if(arm_mode == ARM)
 	{
-		u32 current_instruction = instruction_pipeline[pipeline_id];
-
-		if(((current_instruction >> 8) & 0xFFFFF) == 0x12FFF)
-		{
-			//ARM_3
-			instruction_operation[pipeline_id] = ARM_3;
-		}
-
-		else if(((current_instruction >> 25) & 0x7) == 0x5)
-		{
-			//ARM_4
-			instruction_operation[pipeline_id] = ARM_4;
-		}
-
-		//TODO - Move ARM_6 decoding to final stage of ARM_5 decoding
-		//TODO - Move ARM_12 deconding to final stage of ARM_10 decoding		
-
-		else if((current_instruction & 0xD900000) == 0x1000000) 
-		{
-
-			if((current_instruction & 0x80) && (current_instruction & 0x10) && ((current_instruction & 0x2000000) == 0))
-			{
-				if(((current_instruction >> 5) & 0x3) == 0) 
-				{ 
-					instruction_operation[pipeline_id] = ARM_12;
-				}
-
-				else 
-				{
-					instruction_operation[pipeline_id] = ARM_10;
-				}
-			}
-
-			else 
-			{
-				//ARM_6
-				instruction_operation[pipeline_id] = ARM_6;
-			}
-		}
-
-		else if(((current_instruction >> 26) & 0x3) == 0x0)
-		{
-			if((current_instruction & 0x80) && ((current_instruction & 0x10) == 0))
-			{
-				//ARM.5
-				if(current_instruction & 0x2000000)
-				{
-					instruction_operation[pipeline_id] = ARM_5;
-				}
-
-				//ARM.5
-				else if((current_instruction & 0x100000) && (((current_instruction >> 23) & 0x3) == 0x2))
-				{
-					instruction_operation[pipeline_id] = ARM_5;
-				}
-
-				//ARM.5
-				else if(((current_instruction >> 23) & 0x3) != 0x2)
-				{
-					instruction_operation[pipeline_id] = ARM_5;
-				}
-
-				//ARM.7
-				else
-				{
-					instruction_operation[pipeline_id] = ARM_7;
-				}
-			}
-
-			else if((current_instruction & 0x80) && (current_instruction & 0x10))
-			{
-				if(((current_instruction >> 4) & 0xF) == 0x9)
-				{
-					//ARM.5
-					if(current_instruction & 0x2000000)
-					{
-						instruction_operation[pipeline_id] = ARM_5;
-					}
-
-					//ARM.12
-					else if(((current_instruction >> 23) & 0x3) == 0x2)
-					{
-						instruction_operation[pipeline_id] = ARM_12;
-					}
-
-					//ARM.7
-					else
-					{
-						instruction_operation[pipeline_id] = ARM_7;
-					}
-				}
-
-				//ARM.5
-				else if(current_instruction & 0x2000000)
-				{
-					instruction_operation[pipeline_id] = ARM_5;
-				}
-
-				//ARM.10
-				else
-				{
-					instruction_operation[pipeline_id] = ARM_10;
-				}
-			}
-
-			//ARM.5
-			else
-			{
-				instruction_operation[pipeline_id] = ARM_5;
-			}
-		}
-
-		else if(((current_instruction >> 26) & 0x3) == 0x1)
-		{
-			//ARM_9
-			instruction_operation[pipeline_id] = ARM_9;
-		}
-
-		else if(((current_instruction >> 25) & 0x7) == 0x4)
-		{
-			//ARM_11
-			instruction_operation[pipeline_id] = ARM_11;
-		}
-
-		else if(((current_instruction >> 24) & 0xF) == 0xF)
-		{
-			//ARM_13
-			instruction_operation[pipeline_id] = ARM_13;
-		}
+		instruction_operation[pipeline_id] = arm_decoder::decode_arm<arm_instructions, ARM_DECODE_ARMV4>(instruction_pipeline[pipeline_id]);
 	}
+
+	instruction_idle[pipeline_id] = arm_decoder::is_idle_op<arm_instructions>(instruction_operation[pipeline_id], instruction_pipeline[pipeline_id]);
 }
 
 /****** Execute ARM instruction ******/
@@ -626,6 +417,10 @@ void ARM7::execute()
 		return; 
 	}
 
+	//Anything that could change memory or the CPU mode means the current loop is not just waiting
+	u32 current_addr = reg.r15 - ((arm_mode == ARM) ? 8 : 4);
+	if((config::use_idle_loop_detection) && (!is_idle_instruction(pipeline_id))) { idle_loop.pure = false; }
+
 	//Execute THUMB instruction
 	if(arm_mode == THUMB)
 	{
@@ -805,6 +600,84 @@ void ARM7::execute()
 		}
 	}
 
+	//Check for idle loops whenever a branch is taken
+	if((needs_flush) && (config::use_idle_loop_detection)) { check_idle_loop(current_addr, pipeline_id); }
+}
+
+/****** Checks whether an instruction is safe to repeat inside an idle loop ******/
+bool ARM7::is_idle_instruction(u8 pipeline_id) const
+{
+	//ARM instructions that fail their condition do nothing
+	if((arm_mode == ARM) && (!check_condition(instruction_pipeline[pipeline_id]))) { return true; }
+
+	return instruction_idle[pipeline_id];
+}
+
+/****** Fast-forwards to the next scheduled event when a short loop repeats without changing anything ******/
+void ARM7::check_idle_loop(u32 addr, u8 pipeline_id)
+{
+	u32 target = reg.r15;
+	bool loop_branch = arm_decoder::is_loop_branch<arm_instructions>(instruction_operation[pipeline_id], instruction_pipeline[pipeline_id]);
+
+	//Only short backward branches ending an iteration that just read memory and worked on registers count
+	if((!loop_branch) || (!idle_loop.pure) || (target > addr) || ((addr - target) > ARM7_IDLE_LOOP_SIZE))
+	{
+		idle_loop.valid = false;
+		idle_loop.pure = true;
+		mem->timer_polled = false;
+		return;
+	}
+
+	//Timer counters change between events whenever they are read, so note if this iteration polled one
+	bool timer_polled = mem->timer_polled;
+	mem->timer_polled = false;
+
+	u32 regs[16];
+	for(u32 x = 0; x < 15; x++) { regs[x] = get_reg(x); }
+	regs[15] = reg.cpsr;
+
+	bool repeated = (idle_loop.valid) && (idle_loop.start == target) && (idle_loop.end == addr);
+	for(u32 x = 0; (repeated) && (x < 16); x++) { repeated = (regs[x] == idle_loop.regs[x]); }
+
+	idle_loop.pure = true;
+
+	//A different loop or a loop still changing registers - Remember this iteration and compare against the next one
+	if(!repeated)
+	{
+		for(u32 x = 0; x < 16; x++) { idle_loop.regs[x] = regs[x]; }
+		idle_loop.start = target;
+		idle_loop.end = addr;
+		idle_loop.valid = true;
+		return;
+	}
+
+	//Identical iterations read identical values until the next LCD, timer, or DMA event, or until an IRQ, which only happen at events
+	//Special carts and serial devices can change what the loop reads without an event, so always run them normally
+	if((config::cart_type != NORMAL_CART) && (config::cart_type != AGB_RUMBLE)) { return; }
+	if(controllers.serial_io.sio_stat.connected) { return; }
+	if((controllers.serial_io.sio_stat.sio_type != NO_GBA_DEVICE) && (controllers.serial_io.sio_stat.sio_type != INVALID_GBA_DEVICE)) { return; }
+
+	if(!timer_polled)
+	{
+		skip_to_next_event();
+		return;
+	}
+
+	//Loops polling a timer only skip ahead to the next counter increment
+	u32 cycles = 1;
+	if(scheduler.next_event_time > scheduler.timestamp) { cycles = scheduler.next_event_time - scheduler.timestamp; }
+
+	for(u32 x = 0; x < 4; x++)
+	{
+		if((!controllers.timer[x].enable) || (controllers.timer[x].count_up)) { continue; }
+
+		mem->sync_timer(x);
+		u32 wait_cycles = controllers.timer[x].prescalar - controllers.timer[x].cycles;
+		if(wait_cycles < cycles) { cycles = wait_cycles; }
+	}
+
+	process_events(cycles);
+	system_cycles += cycles;
 }
 
 /****** Flush the pipeline - Called when branching or resetting ******/
@@ -814,6 +687,7 @@ void ARM7::flush_pipeline()
 	pipeline_pointer = 0;
 	instruction_pipeline[0] = instruction_pipeline[1] = instruction_pipeline[2] = 0;
 	instruction_operation[0] = instruction_operation[1] = instruction_operation[2] = PIPELINE_FILL;
+	instruction_idle[0] = instruction_idle[1] = instruction_idle[2] = false;
 }
 
 /****** Updates the PC after each fetch-decode-execute ******/
@@ -1464,7 +1338,7 @@ void ARM7::mem_check_8(u32 addr, u32& value, bool load_store)
 }
 
 
-/****** Runs audio and video controllers every clock cycle ******/
+/****** Runs audio and video controllers for the cycles used by a memory access ******/
 void ARM7::clock(u32 access_addr, bool first_access)
 {
 	//Determine cycles with Wait States + access timing
@@ -1489,71 +1363,198 @@ void ARM7::clock(u32 access_addr, bool first_access)
 	}
 
 	system_cycles += access_cycles;
+	debug_cycles += access_cycles;
+
+	//Run controllers up to the end of this access
+	process_events(access_cycles);
 
-	//Run controllers for each cycle		 
-	for(int x = 0; x < access_cycles; x++)
+	//Update sound samples for Play-Yan models + NMP when not using headphones
+	if(mem->play_yan.is_media_playing && !controllers.audio.apu_stat.ext_audio.use_headphones)
 	{
-		controllers.video.step();
-		clock_timers();
-		clock_dma();
-		debug_cycles++;
+		mem->play_yan.cycles += access_cycles;
 
-		//Generate audio buffers for PSG channels on VBlank
-		if(controllers.video.lcd_clock == 0)
+		if(mem->play_yan.cycles >= mem->play_yan.cycle_limit)
 		{
-			if(controllers.audio.apu_stat.psg_needs_fill) { controllers.audio.buffer_channels(); }
-			controllers.audio.apu_stat.psg_needs_fill = true;
-		}
+			u32 remaining_cycles = mem->play_yan.cycles - mem->play_yan.cycle_limit;
+			mem->play_yan.cycles = 0;
 
-		//Update sound samples for Play-Yan models + NMP when not using headphones
-		if(mem->play_yan.is_media_playing && !controllers.audio.apu_stat.ext_audio.use_headphones)
-		{
-			mem->play_yan.cycles++;
+			if(mem->play_yan.type == AGB_MMU::NINTENDO_MP3)
+			{
+				mem->play_yan.nmp_manual_cmd = 0x8100;
+				mem->play_yan.nmp_manual_irq = true;
+				mem->process_play_yan_irq();
+				mem->play_yan.nmp_manual_irq = false;
+			}
 
-			if(mem->play_yan.cycles == mem->play_yan.cycle_limit)
+			else
 			{
-				mem->play_yan.cycles = 0;
+				for(u32 x = 0; x < 8; x++) { mem->play_yan.irq_data[x] = 0; }
+				mem->play_yan.irq_data[0] = 0x80001000;
+				mem->play_yan.irq_data[3] = 0x4DBA0;
+				mem->play_yan.irq_data[4] = 0x480;
+				mem->play_yan_set_sound_samples();
+
+				mem->play_yan.card_addr = 0;
+				mem->play_yan.irq_delay = 1;
+				mem->process_play_yan_irq();
+			}
+
+			//Carry over any cycles past the limit
+			if(mem->play_yan.is_media_playing) { mem->play_yan.cycles += remaining_cycles; }
+		}
+	}
+}
+
+/****** Runs audio and video controllers for 1 cycle ******/
+void ARM7::clock()
+{
+	process_events(1);
+	system_cycles++;
+}
+
+/****** Runs any scheduled events due within the next number of cycles, then advances the system time ******/
+void ARM7::process_events(u32 cycles)
+{
+	u64 target_time = scheduler.timestamp + cycles;
+
+	while(scheduler.next_event_time <= target_time)
+	{
+		agb_event_types current_event = scheduler.get_next_event();
+		u32 elapsed_cycles = scheduler.event_time[current_event] - scheduler.event_base[current_event];
 
-				if(mem->play_yan.type == AGB_MMU::NINTENDO_MP3)
+		scheduler.timestamp = scheduler.event_time[current_event];
+		scheduler.cancel(current_event);
+
+		switch(current_event)
+		{
+			//LCD - Catch up on skipped cycles, then step
+			case AGB_EVENT_LCD:
+				controllers.video.lcd_clock += (elapsed_cycles - 1);
+				controllers.video.step();
+
+				//Generate audio buffers for PSG channels on VBlank
+				//The audio callback reads these buffers as well, so hold the audio lock while filling them
+				if(controllers.video.lcd_clock == 0)
 				{
-					mem->play_yan.nmp_manual_cmd = 0x8100;
-					mem->play_yan.nmp_manual_irq = true;
-					mem->process_play_yan_irq();
-					mem->play_yan.nmp_manual_irq = false;
+					SDL_LockAudio();
+					if(controllers.audio.apu_stat.psg_needs_fill) { controllers.audio.buffer_channels(); }
+					controllers.audio.apu_stat.psg_needs_fill = true;
+					SDL_UnlockAudio();
 				}
 
-				else
+				scheduler.schedule(AGB_EVENT_LCD, controllers.video.get_next_event());
+				break;
+
+			//Timers - Counter increments
+			case AGB_EVENT_TIMER_0:
+			case AGB_EVENT_TIMER_1:
+			case AGB_EVENT_TIMER_2:
+			case AGB_EVENT_TIMER_3:
+				clock_timer(current_event - AGB_EVENT_TIMER_0);
+				break;
+
+			//Timers - Control registers changed
+			case AGB_EVENT_TIMER_UPDATE:
+				schedule_timers();
+				break;
+
+			//DMA - Keep running every cycle while any channel is counting down or transferring
+			case AGB_EVENT_DMA:
+				clock_dma();
+
+				for(u32 x = 0; x < 4; x++)
 				{
-					for(u32 x = 0; x < 8; x++) { mem->play_yan.irq_data[x] = 0; }
-					mem->play_yan.irq_data[0] = 0x80001000;
-					mem->play_yan.irq_data[3] = 0x4DBA0;
-					mem->play_yan.irq_data[4] = 0x480;
-					mem->play_yan_set_sound_samples();
-
-					mem->play_yan.card_addr = 0;
-					mem->play_yan.irq_delay = 1;
-					mem->process_play_yan_irq();
+					if((mem->dma[x].enable) && (!dma_waiting(x)))
+					{
+						scheduler.schedule(AGB_EVENT_DMA, 1);
+						break;
+					}
 				}
-			}
+
+				break;
+
+			default: break;
 		}
 	}
+
+	scheduler.timestamp = target_time;
 }
 
-/****** Runs audio and video controllers every clock cycle ******/
-void ARM7::clock()
+/****** Runs the system until the next scheduled event - Used when the CPU is halted ******/
+void ARM7::skip_to_next_event()
 {
-	controllers.video.step();
-	clock_timers();
-	clock_dma();
+	u32 cycles = 1;
+
+	if(scheduler.next_event_time > scheduler.timestamp) { cycles = scheduler.next_event_time - scheduler.timestamp; }
+
+	process_events(cycles);
+	system_cycles += cycles;
+}
 
-	//Generate audio buffers for PSG channels on VBlank
-	if(controllers.video.lcd_clock == 0)
+/****** Rebuilds all scheduled events from the current state of each component ******/
+void ARM7::schedule_events()
+{
+	scheduler.reset();
+
+	scheduler.schedule(AGB_EVENT_LCD, controllers.video.get_next_event());
+	schedule_timers();
+
+	for(u32 x = 0; x < 4; x++)
 	{
-		if(controllers.audio.apu_stat.psg_needs_fill) { controllers.audio.buffer_channels(); }
-		controllers.audio.apu_stat.psg_needs_fill = true;
+		if(mem->dma[x].enable)
+		{
+			scheduler.schedule(AGB_EVENT_DMA, 1);
+			break;
+		}
 	}
+}
 
-	system_cycles++;
+/****** Schedules the next overflow for each enabled timer ******/
+void ARM7::schedule_timers()
+{
+	for(u32 x = 0; x < 4; x++)
+	{
+		agb_event_types timer_event = agb_event_types(AGB_EVENT_TIMER_0 + x);
+
+		//Timers due this cycle overflow before register changes apply, then reschedule themselves
+		if((scheduler.event_pending[timer_event]) && (scheduler.event_time[timer_event] <= scheduler.timestamp)) { continue; }
+
+		//Update counter and prescalar progress for timers that were already running
+		mem->sync_timer(x);
+		scheduler.cancel(timer_event);
+
+		//Count-up timers only change when the previous timer overflows
+		if((controllers.timer[x].enable) && (!controllers.timer[x].count_up))
+		{
+			u32 wait_cycles = ((0x10000 - controllers.timer[x].counter) * controllers.timer[x].prescalar) - controllers.timer[x].cycles;
+			scheduler.schedule(timer_event, wait_cycles);
+		}
+	}
+}
+
+/****** Brings any lazily updated component state up to the current time - Used before saving states ******/
+void ARM7::sync_events()
+{
+	if(scheduler.event_pending[AGB_EVENT_LCD])
+	{
+		controllers.video.lcd_clock += scheduler.get_elapsed(AGB_EVENT_LCD);
+		scheduler.rebase(AGB_EVENT_LCD);
+	}
+
+	for(u32 x = 0; x < 4; x++) { mem->sync_timer(x); }
+}
+
+/****** Returns true if a DMA channel is idle until the next HBlank ******/
+bool ARM7::dma_waiting(u8 id)
+{
+	if((mem->dma[id].delay != 0) || ((mem->dma[id].control & 0x8000) == 0)) { return false; }
+	if((((mem->dma[id].control >> 12) & 0x3) != 2) || (mem->dma[id].started)) { return false; }
+
+	//DMA3 handles EEPROM transfers regardless of start timing
+	if((id == 3) && (mem->dma[3].start_address >= 0xD000000) && (mem->dma[3].start_address <= 0xDFFFFFF)) { return false; }
+	if((id == 3) && (mem->dma[3].destination_address >= 0xD000000) && (mem->dma[3].destination_address <= 0xDFFFFFF)) { return false; }
+
+	return true;
 }
 
 /****** Runs DMA controllers every clock cycle ******/
@@ -1785,77 +1786,71 @@ void ARM7::clock_emulated_sio_device()
 	}
 }
 
-/****** Runs Timer controllers every clock cycle ******/
-void ARM7::clock_timers()
+/****** Handles a Timer overflow once the counter reaches its last increment ******/
+void ARM7::clock_timer(u8 x)
 {
-	for(int x = 0; x < 4; x++)
+	controllers.timer[x].cycles = 0;
+
+	if((!controllers.timer[x].enable) || (controllers.timer[x].count_up)) { return; }
+
+	timer_overflow(x);
+
+	//Schedule next overflow, the counter in between is worked out whenever it is read
+	scheduler.schedule(agb_event_types(AGB_EVENT_TIMER_0 + x), (0x10000 - controllers.timer[x].reload_value) * controllers.timer[x].prescalar);
+}
+
+/****** Reloads an overflowed Timer, then triggers interrupts, sound FIFOs, and count-up timers ******/
+void ARM7::timer_overflow(u8 x)
+{
+	controllers.timer[x].counter = controllers.timer[x].reload_value;
+
+	//Increment next timer if in count-up mode, which may overflow as well
+	if((x < 3) && (controllers.timer[x+1].enable) && (controllers.timer[x+1].count_up))
 	{
-		//See if this timer is enabled first
-		if(controllers.timer[x].enable)
-		{
-			controllers.timer[x].cycles++;
+		controllers.timer[x+1].counter++;
+		if(controllers.timer[x+1].counter == 0) { timer_overflow(x+1); }
+	}
 
-			//If the amount of cycles matches the prescalar, increment counter
-			if(controllers.timer[x].cycles == controllers.timer[x].prescalar)
-			{
-				controllers.timer[x].cycles = 0;
-				if(!controllers.timer[x].count_up)
-				{
-					controllers.timer[x].counter++;
+	//Interrupt
+	if(controllers.timer[x].interrupt)
+	{
+		mem->memory_map[REG_IF] |= (8 << x);
+	}
 
-					//If counter overflows, reload value, trigger interrupt if necessary
-					if(controllers.timer[x].counter == 0) 
-					{
-						controllers.timer[x].counter = controllers.timer[x].reload_value;
-
-						//Increment next timer if in count-up mode
-						if((x < 4) && (controllers.timer[x+1].count_up)) { controllers.timer[x+1].counter++; }
-
-						//Interrupt
-						if(controllers.timer[x].interrupt)
-						{
-							mem->memory_map[REG_IF] |= (8 << x);
-						}
-
-						//Timer 0 Audio FIFO A, DMA 1-2
-						if((x == 0) && (controllers.audio.apu_stat.dma[0].timer == 0) && (mem->dma[1].destination_address == FIFO_A) && (mem->dma[1].started)) 
-						{
-							controllers.audio.apu_stat.dma[0].buffer[controllers.audio.apu_stat.dma[0].counter++] = mem->memory_map[mem->dma[1].start_address++];
-							controllers.audio.apu_stat.dma[0].length++;
-
-							//Trigger DMA IRQ after 16th bit is transferred
-							if((mem->memory_map[REG_IE+1] & 0x2) && ((controllers.audio.apu_stat.dma[0].counter % 16) == 0)) { mem->memory_map[REG_IF+1] |= 0x2; }
-						}
-
-						if((x == 0) && (controllers.audio.apu_stat.dma[1].timer == 0) && (mem->dma[2].destination_address == FIFO_B) && (mem->dma[2].started)) 
-						{
-							controllers.audio.apu_stat.dma[1].buffer[controllers.audio.apu_stat.dma[1].counter++] = mem->memory_map[mem->dma[2].start_address++];
-							controllers.audio.apu_stat.dma[1].length++;
-
-							//Trigger DMA IRQ after 16th bit is transferred
-							if((mem->memory_map[REG_IE+1] & 0x4) && ((controllers.audio.apu_stat.dma[1].counter % 16) == 0)) { mem->memory_map[REG_IF+1] |= 0x4; }
-						}
-					
-						/*
-						else if((x == 0) && (controllers.audio.apu_stat.dma[0].timer == 0) && (mem->dma[2].destination_address == FIFO_A)) { }
-
-						//Timer 0 Audio FIFO B, DMA 1-2
-						else if((x == 0) && (controllers.audio.apu_stat.dma[1].timer == 0) && (mem->dma[1].destination_address == FIFO_B)) { }
-						else if((x == 0) && (controllers.audio.apu_stat.dma[1].timer == 0) && (mem->dma[2].destination_address == FIFO_B)) { }
-
-						//Timer 1 Audio FIFO A, DMA 1-2
-						else if((x == 1) && (controllers.audio.apu_stat.dma[0].timer == 1) && (mem->dma[1].destination_address == FIFO_A)) { }
-						else if((x == 1) && (controllers.audio.apu_stat.dma[0].timer == 1) && (mem->dma[2].destination_address == FIFO_A)) { }
-
-						//Timer 1 Audio FIFO B, DMA 1-2
-						else if((x == 1) && (controllers.audio.apu_stat.dma[1].timer == 1) && (mem->dma[1].destination_address == FIFO_B)) { }
-						else if((x == 1) && (controllers.audio.apu_stat.dma[1].timer == 1) && (mem->dma[2].destination_address == FIFO_B)) { }
-						*/
-					}
-				}
-			}
-		}
+	//Timer 0 Audio FIFO A, DMA 1-2
+	if((x == 0) && (controllers.audio.apu_stat.dma[0].timer == 0) && (mem->dma[1].destination_address == FIFO_A) && (mem->dma[1].started)) 
+	{
+		controllers.audio.apu_stat.dma[0].buffer[controllers.audio.apu_stat.dma[0].counter++] = mem->memory_map[mem->dma[1].start_address++];
+		controllers.audio.apu_stat.dma[0].length++;
+
+		//Trigger DMA IRQ after 16th bit is transferred
+		if((mem->memory_map[REG_IE+1] & 0x2) && ((controllers.audio.apu_stat.dma[0].counter % 16) == 0)) { mem->memory_map[REG_IF+1] |= 0x2; }
 	}
+
+	if((x == 0) && (controllers.audio.apu_stat.dma[1].timer == 0) && (mem->dma[2].destination_address == FIFO_B) && (mem->dma[2].started)) 
+	{
+		controllers.audio.apu_stat.dma[1].buffer[controllers.audio.apu_stat.dma[1].counter++] = mem->memory_map[mem->dma[2].start_address++];
+		controllers.audio.apu_stat.dma[1].length++;
+
+		//Trigger DMA IRQ after 16th bit is transferred
+		if((mem->memory_map[REG_IE+1] & 0x4) && ((controllers.audio.apu_stat.dma[1].counter % 16) == 0)) { mem->memory_map[REG_IF+1] |= 0x4; }
+	}
+				
+	/*
+	else if((x == 0) && (controllers.audio.apu_stat.dma[0].timer == 0) && (mem->dma[2].destination_address == FIFO_A)) { }
+
+	//Timer 0 Audio FIFO B, DMA 1-2
+	else if((x == 0) && (controllers.audio.apu_stat.dma[1].timer == 0) && (mem->dma[1].destination_address == FIFO_B)) { }
+	else if((x == 0) && (controllers.audio.apu_stat.dma[1].timer == 0) && (mem->dma[2].destination_address == FIFO_B)) { }
+
+	//Timer 1 Audio FIFO A, DMA 1-2
+	else if((x == 1) && (controllers.audio.apu_stat.dma[0].timer == 1) && (mem->dma[1].destination_address == FIFO_A)) { }
+	else if((x == 1) && (controllers.audio.apu_stat.dma[0].timer == 1) && (mem->dma[2].destination_address == FIFO_A)) { }
+
+	//Timer 1 Audio FIFO B, DMA 1-2
+	else if((x == 1) && (controllers.audio.apu_stat.dma[1].timer == 1) && (mem->dma[1].destination_address == FIFO_B)) { }
+	else if((x == 1) && (controllers.audio.apu_stat.dma[1].timer == 1) && (mem->dma[2].destination_address == FIFO_B)) { }
+	*/
 }
 
 /****** Jumps to or exits an interrupt ******/
@@ -1966,87 +1961,77 @@ void ARM7::handle_interrupt()
 }
 
 /****** Read CPU data from save state ******/
-bool ARM7::cpu_read(u32 offset, std::string filename)
+bool ARM7::cpu_read(save_state_buffer& state)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary);
-	
-	if(!file.is_open()) { return false; }
-
-	//Go to offset
-	file.seekg(offset);
-
 	//Serialize CPU registers data from file stream
-	file.read((char*)&reg, sizeof(reg));
+	state.read((char*)&reg, sizeof(reg));
 
 	//Serialize misc CPU data from file stream
-	file.read((char*)&current_cpu_mode, sizeof(current_cpu_mode));
-	file.read((char*)&arm_mode, sizeof(arm_mode));
-	file.read((char*)&bios_read_state, sizeof(bios_read_state));
-	file.read((char*)&running, sizeof(running));
-	file.read((char*)&needs_flush, sizeof(needs_flush));
-	file.read((char*)&needs_reset, sizeof(needs_reset));
-	file.read((char*)&in_interrupt, sizeof(in_interrupt));
-	file.read((char*)&sleep, sizeof(sleep));
-	file.read((char*)&swi_vblank_wait, sizeof(swi_vblank_wait));
-	file.read((char*)&instruction_pipeline[0], sizeof(instruction_pipeline[0]));
-	file.read((char*)&instruction_pipeline[1], sizeof(instruction_pipeline[1]));
-	file.read((char*)&instruction_pipeline[2], sizeof(instruction_pipeline[2]));
-	file.read((char*)&instruction_operation[0], sizeof(instruction_operation[0]));
-	file.read((char*)&instruction_operation[1], sizeof(instruction_operation[1]));
-	file.read((char*)&instruction_operation[2], sizeof(instruction_operation[2]));
-	file.read((char*)&pipeline_pointer, sizeof(pipeline_pointer));
-	file.read((char*)&debug_message, sizeof(debug_message));
-	file.read((char*)&debug_code, sizeof(debug_code));
-	file.read((char*)&debug_cycles, sizeof(debug_cycles));
+	state.read((char*)&current_cpu_mode, sizeof(current_cpu_mode));
+	state.read((char*)&arm_mode, sizeof(arm_mode));
+	state.read((char*)&bios_read_state, sizeof(bios_read_state));
+	state.read((char*)&running, sizeof(running));
+	state.read((char*)&needs_flush, sizeof(needs_flush));
+	state.read((char*)&needs_reset, sizeof(needs_reset));
+	state.read((char*)&in_interrupt, sizeof(in_interrupt));
+	state.read((char*)&sleep, sizeof(sleep));
+	state.read((char*)&swi_vblank_wait, sizeof(swi_vblank_wait));
+	state.read((char*)&instruction_pipeline[0], sizeof(instruction_pipeline[0]));
+	state.read((char*)&instruction_pipeline[1], sizeof(instruction_pipeline[1]));
+	state.read((char*)&instruction_pipeline[2], sizeof(instruction_pipeline[2]));
+	state.read((char*)&instruction_operation[0], sizeof(instruction_operation[0]));
+	state.read((char*)&instruction_operation[1], sizeof(instruction_operation[1]));
+	state.read((char*)&instruction_operation[2], sizeof(instruction_operation[2]));
+	state.read((char*)&pipeline_pointer, sizeof(pipeline_pointer));
+	state.read((char*)&debug_message, sizeof(debug_message));
+	state.read((char*)&debug_code, sizeof(debug_code));
+	state.read((char*)&debug_cycles, sizeof(debug_cycles));
+
+	for(u32 x = 0; x < 3; x++) { instruction_idle[x] = arm_decoder::is_idle_op<arm_instructions>(instruction_operation[x], instruction_pipeline[x]); }
+	idle_loop.valid = false;
 
 	//Serialize timers from save state
-	file.read((char*)&controllers.timer[0], sizeof(controllers.timer[0]));
-	file.read((char*)&controllers.timer[1], sizeof(controllers.timer[1]));
-	file.read((char*)&controllers.timer[2], sizeof(controllers.timer[2]));
-	file.read((char*)&controllers.timer[3], sizeof(controllers.timer[3]));
+	state.read((char*)&controllers.timer[0], sizeof(controllers.timer[0]));
+	state.read((char*)&controllers.timer[1], sizeof(controllers.timer[1]));
+	state.read((char*)&controllers.timer[2], sizeof(controllers.timer[2]));
+	state.read((char*)&controllers.timer[3], sizeof(controllers.timer[3]));
 
-	file.close();
-	return true;
+	return state.good();
 }
 
 /****** Write CPU data to save state ******/
-bool ARM7::cpu_write(std::string filename)
+bool ARM7::cpu_write(save_state_buffer& state)
 {
-	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
-	
-	if(!file.is_open()) { return false; }
-
 	//Serialize CPU registers data to save state
-	file.write((char*)&reg, sizeof(reg));
+	state.write((char*)&reg, sizeof(reg));
 
 	//Serialize misc CPU data to save state
-	file.write((char*)&current_cpu_mode, sizeof(current_cpu_mode));
-	file.write((char*)&arm_mode, sizeof(arm_mode));
-	file.write((char*)&bios_read_state, sizeof(bios_read_state));
-	file.write((char*)&running, sizeof(running));
-	file.write((char*)&needs_flush, sizeof(needs_flush));
-	file.write((char*)&needs_reset, sizeof(needs_reset));
-	file.write((char*)&in_interrupt, sizeof(in_interrupt));
-	file.write((char*)&sleep, sizeof(sleep));
-	file.write((char*)&swi_vblank_wait, sizeof(swi_vblank_wait));
-	file.write((char*)&instruction_pipeline[0], sizeof(instruction_pipeline[0]));
-	file.write((char*)&instruction_pipeline[1], sizeof(instruction_pipeline[1]));
-	file.write((char*)&instruction_pipeline[2], sizeof(instruction_pipeline[2]));
-	file.write((char*)&instruction_operation[0], sizeof(instruction_operation[0]));
-	file.write((char*)&instruction_operation[1], sizeof(instruction_operation[1]));
-	file.write((char*)&instruction_operation[2], sizeof(instruction_operation[2]));
-	file.write((char*)&pipeline_pointer, sizeof(pipeline_pointer));
-	file.write((char*)&debug_message, sizeof(debug_message));
-	file.write((char*)&debug_code, sizeof(debug_code));
-	file.write((char*)&debug_cycles, sizeof(debug_cycles));
+	state.write((char*)&current_cpu_mode, sizeof(current_cpu_mode));
+	state.write((char*)&arm_mode, sizeof(arm_mode));
+	state.write((char*)&bios_read_state, sizeof(bios_read_state));
+	state.write((char*)&running, sizeof(running));
+	state.write((char*)&needs_flush, sizeof(needs_flush));
+	state.write((char*)&needs_reset, sizeof(needs_reset));
+	state.write((char*)&in_interrupt, sizeof(in_interrupt));
+	state.write((char*)&sleep, sizeof(sleep));
+	state.write((char*)&swi_vblank_wait, sizeof(swi_vblank_wait));
+	state.write((char*)&instruction_pipeline[0], sizeof(instruction_pipeline[0]));
+	state.write((char*)&instruction_pipeline[1], sizeof(instruction_pipeline[1]));
+	state.write((char*)&instruction_pipeline[2], sizeof(instruction_pipeline[2]));
+	state.write((char*)&instruction_operation[0], sizeof(instruction_operation[0]));
+	state.write((char*)&instruction_operation[1], sizeof(instruction_operation[1]));
+	state.write((char*)&instruction_operation[2], sizeof(instruction_operation[2]));
+	state.write((char*)&pipeline_pointer, sizeof(pipeline_pointer));
+	state.write((char*)&debug_message, sizeof(debug_message));
+	state.write((char*)&debug_code, sizeof(debug_code));
+	state.write((char*)&debug_cycles, sizeof(debug_cycles));
 
 	//Serialize timers to save state
-	file.write((char*)&controllers.timer[0], sizeof(controllers.timer[0]));
-	file.write((char*)&controllers.timer[1], sizeof(controllers.timer[1]));
-	file.write((char*)&controllers.timer[2], sizeof(controllers.timer[2]));
-	file.write((char*)&controllers.timer[3], sizeof(controllers.timer[3]));
+	state.write((char*)&controllers.timer[0], sizeof(controllers.timer[0]));
+	state.write((char*)&controllers.timer[1], sizeof(controllers.timer[1]));
+	state.write((char*)&controllers.timer[2], sizeof(controllers.timer[2]));
+	state.write((char*)&controllers.timer[3], sizeof(controllers.timer[3]));
 
-	file.close();
 	return true;
 }
 
@@ -17,12 +17,16 @@
 #include <vector>
 
 #include "common.h"
+#include "common/arm_decoder.h"
 #include "timer.h"
 #include "mmu.h"
 #include "lcd.h"
 #include "apu.h"
 #include "sio.h"
+#include "scheduler.h"
 
+//Largest backward branch (in bytes) treated as a possible idle loop
+#define ARM7_IDLE_LOOP_SIZE 0x40
 
 class ARM7
 {
@@ -172,9 +176,20 @@ class ARM7
 
 	u32 instruction_pipeline[3];
 	arm_instructions instruction_operation[3];
+	bool instruction_idle[3];
 	u8 pipeline_pointer;
 	u32 system_cycles;
 
+	//Idle loop detection - Last short backward branch, and the registers when it was taken
+	struct idle_loop_info
+	{
+		u32 start;
+		u32 end;
+		u32 regs[16];
+		bool valid;
+		bool pure;
+	} idle_loop;
+
 	u8 debug_message;
 	u32 debug_code;
 	u32 debug_cycles;
@@ -190,15 +205,20 @@ class ARM7
 		std::vector<gba_timer> timer;
 	} controllers;
 
+	AGB_scheduler scheduler;
+
 	ARM7();
 	~ARM7();
 
 	//ARM pipelining functions
 	void fetch();
 	void decode();
+	void decode_stage(u8 pipeline_id);
 	void execute();
 	void update_pc();
 	void flush_pipeline();
+	bool is_idle_instruction(u8 pipeline_id) const;
+	void check_idle_loop(u32 addr, u8 pipeline_id);
 
 	void reset();
 
@@ -243,13 +263,23 @@ class ARM7
 	//System functions
 	void clock(u32 access_address, bool first_access);
 	void clock();
-	void clock_timers();
+	void clock_timer(u8 id);
+	void timer_overflow(u8 id);
 	void clock_dma();
 	void clock_sio();
 	void clock_emulated_sio_device();
 	void handle_interrupt();
 
+	//Scheduler functions
+	void process_events(u32 cycles);
+	void skip_to_next_event();
+	void schedule_events();
+	void schedule_timers();
+	void sync_events();
+	bool dma_waiting(u8 id);
+
 	//DMA functions
+	void dma_bulk_transfer(u8 id);
 	void dma0();
 	void dma1();
 	void dma2();
@@ -295,8 +325,8 @@ class ARM7
 	void swi_hardreset();
 
 	//Serialize data for save state loading/saving
-	bool cpu_read(u32 offset, std::string filename);
-	bool cpu_write(std::string filename);
+	bool cpu_read(save_state_buffer& state);
+	bool cpu_write(save_state_buffer& state);
 	u32 size();
 };
 		
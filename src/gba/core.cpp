@@ -19,6 +19,7 @@
 #endif
 
 #include "common/util.h"
+#include "common/headless.h"
 
 #include "core.h"
 
@@ -49,6 +50,9 @@ AGB_core::AGB_core()
 	//Link MMU and CPU's timers
 	core_mmu.timer = &core_cpu.controllers.timer;
 
+	//Link MMU and CPU's scheduler
+	core_mmu.scheduler = &core_cpu.scheduler;
+
 	db_unit.debug_mode = false;
 	db_unit.display_cycles = false;
 	db_unit.print_all = false;
@@ -133,10 +137,18 @@ void AGB_core::sleep()
 	core_cpu.controllers.video.clear_screen_buffer(0xFFFFFFFF);
 	core_cpu.controllers.video.update();
 
+	//Nothing can wake the system in headless mode, so stop there
+	if(config::headless)
+	{
+		running = false;
+		core_cpu.running = false;
+		return;
+	}
+
 	//Wait for exit sleep condition (Joypad, Game Pak, or SIO IRQ)
 	bool exit_sleep = false;
 
-	while(!exit_sleep)
+	while((!exit_sleep) && (running))
 	{
 		SDL_PollEvent(&event);
 
@@ -198,12 +210,18 @@ void AGB_core::reset()
 	//Link MMU and CPU's timers
 	core_mmu.timer = &core_cpu.controllers.timer;
 
+	//Link MMU and CPU's scheduler
+	core_mmu.scheduler = &core_cpu.scheduler;
+
 	//Re-read specified ROM file
 	if(!core_mmu.read_file(config::rom_file)) { can_reset = false; }
 
 	//Re-read BIOS file
 	if((config::use_bios) && (!read_bios(config::bios_file))) { can_reset = false; }
 
+	//Older rewind states belong to the previous session
+	rewind.clear();
+
 	//Start everything all over again
 	if(can_reset) { start(); }
 	else { running = false; }
@@ -217,28 +235,20 @@ void AGB_core::load_state(u8 slot)
 	std::string state_file = config::rom_file + ".ss";
 	state_file += id;
 
-	u32 offset = 0;
+	save_state_buffer state;
 
 	//Check if save state is accessible
-	std::ifstream test(state_file.c_str());
-	
-	if(!test.good())
+	if(!state.load_file(state_file))
 	{
 		config::osd_message = "INVALID SAVE STATE " + util::to_str(slot);
 		config::osd_count = 180;
 		return;
 	}
 
-	if(!core_cpu.cpu_read(offset, state_file)) { return; }
-	offset += core_cpu.size();
-
-	if(!core_mmu.mmu_read(offset, state_file)) { return; }
-	offset += core_mmu.size();
-
-	if(!core_cpu.controllers.audio.apu_read(offset, state_file)) { return; }
-	offset += core_cpu.controllers.audio.size();
+	if(!deserialize_state(state)) { return; }
 
-	if(!core_cpu.controllers.video.lcd_read(offset, state_file)) { return; }
+	//Don't rewind past the loaded state
+	rewind.clear();
 
 	std::cout<<"GBE::Loaded state " << state_file << "\n";
 
@@ -255,10 +265,10 @@ void AGB_core::save_state(u8 slot)
 	std::string state_file = config::rom_file + ".ss";
 	state_file += id;
 
-	if(!core_cpu.cpu_write(state_file)) { return; }
-	if(!core_mmu.mmu_write(state_file)) { return; }
-	if(!core_cpu.controllers.audio.apu_write(state_file)) { return; }
-	if(!core_cpu.controllers.video.lcd_write(state_file)) { return; }
+	save_state_buffer state;
+
+	if(!serialize_state(state)) { return; }
+	if(!state.save_file(state_file)) { return; }
 
 	std::cout<<"GBE::Saved state " << state_file << "\n";
 
@@ -267,14 +277,70 @@ void AGB_core::save_state(u8 slot)
 	config::osd_count = 180;
 }
 
+/****** Saves the current state of the core to a memory buffer ******/
+bool AGB_core::serialize_state(save_state_buffer& state)
+{
+	//Update any components that lag behind the scheduler before saving
+	core_cpu.sync_events();
+
+	state.begin_write(STATE_SYSTEM_AGB);
+
+	state.begin_section(STATE_SECTION_CPU);
+	if(!core_cpu.cpu_write(state)) { return false; }
+
+	state.begin_section(STATE_SECTION_MMU);
+	if(!core_mmu.mmu_write(state)) { return false; }
+
+	state.begin_section(STATE_SECTION_APU);
+	if(!core_cpu.controllers.audio.apu_write(state)) { return false; }
+
+	state.begin_section(STATE_SECTION_LCD);
+	if(!core_cpu.controllers.video.lcd_write(state)) { return false; }
+
+	state.end_write();
+	return true;
+}
+
+/****** Loads the state of the core from a memory buffer ******/
+bool AGB_core::deserialize_state(save_state_buffer& state)
+{
+	if(!state.begin_read(STATE_SYSTEM_AGB)) { return false; }
+
+	if((!state.find_section(STATE_SECTION_CPU)) || (!core_cpu.cpu_read(state))) { return false; }
+	if((!state.find_section(STATE_SECTION_MMU)) || (!core_mmu.mmu_read(state))) { return false; }
+	if((!state.find_section(STATE_SECTION_APU)) || (!core_cpu.controllers.audio.apu_read(state))) { return false; }
+	if((!state.find_section(STATE_SECTION_LCD)) || (!core_cpu.controllers.video.lcd_read(state))) { return false; }
+
+	//Rebuild scheduled events from the loaded state
+	core_cpu.schedule_events();
+
+	return true;
+}
+
 /****** Run the core in a loop until exit ******/
 void AGB_core::run_core()
 {
+	bool rewind_frame = false;
+
 	//Begin running the core
 	while(running)
 	{
+		//Capture or restore rewind states once per frame, then journal any save data changes
+		if(core_cpu.controllers.video.current_scanline == 160)
+		{
+			if(!rewind_frame)
+			{
+				rewind.update(this);
+				core_mmu.update_backup_journal();
+			}
+
+			rewind_frame = true;
+		}
+
+		else { rewind_frame = false; }
+
 		//Handle SDL Events
-		if((core_cpu.controllers.video.current_scanline == 160) && SDL_PollEvent(&event))
+		if((!config::headless) && (core_cpu.controllers.video.current_scanline == 160) && SDL_PollEvent(&event))
 		{
 			//X out of a window
 			if(event.type == SDL_QUIT) { stop(); SDL_Quit(); }
@@ -333,25 +399,37 @@ void AGB_core::run_core()
 			}
 
 			//Reset system cycles for next instruction
+			if(config::headless) { headless::add_cycles(core_cpu.system_cycles); }
 			core_cpu.system_cycles = 0;
 
 			if(db_unit.debug_mode) { debug_step(); }
 
-			core_cpu.fetch();
-			core_cpu.decode();
-			core_cpu.execute();
+			//Without debugging or serial transfers to service, keep running straight-line code until a branch, an interrupt, or the next scheduled event
+			bool run_block = (!db_unit.debug_mode) && (!core_cpu.controllers.serial_io.sio_stat.connected)
+			&& (!core_cpu.controllers.serial_io.sio_stat.emu_device_ready) && (!core_mmu.am3.transfer_delay);
 
-			core_cpu.handle_interrupt();
+			u64 block_end = (run_block) ? core_cpu.scheduler.next_event_time : 0;
+
+			do
+			{
+				core_cpu.fetch();
+				core_cpu.decode();
+				core_cpu.execute();
+
+				core_cpu.handle_interrupt();
 		
-			//Flush pipeline if necessary
-			if(core_cpu.needs_flush) { core_cpu.flush_pipeline(); }
+				//Flush pipeline if necessary
+				if(core_cpu.needs_flush)
+				{
+					core_cpu.flush_pipeline();
+					break;
+				}
 
-			//Else update the pipeline and PC
-			else 
-			{ 
+				//Otherwise update the pipeline and PC
 				core_cpu.pipeline_pointer = (core_cpu.pipeline_pointer + 1) % 3;
 				core_cpu.update_pc(); 
 			}
+			while((core_cpu.running) && (core_cpu.scheduler.timestamp < block_end));
 		}
 
 		//Stop emulation
@@ -399,6 +477,12 @@ void AGB_core::handle_hotkey(SDL_Event& event)
 		SDL_Quit();
 	}
 
+	//Rewind while the rewind hotkey is held
+	else if(((event.type == SDL_KEYDOWN) || (event.type == SDL_KEYUP)) && (event.key.keysym.sym == config::hotkey_rewind))
+	{
+		rewind.set_active(event.type == SDL_KEYDOWN);
+	}
+
 	//Mute or unmute sound on M
 	else if((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == config::hotkey_mute) && (!config::use_external_interfaces))
 	{
@@ -553,7 +637,9 @@ void AGB_core::handle_hotkey(SDL_Event& event)
 		//Initialize new window - SDL
 		if(!config::use_opengl)
 		{
-			core_cpu.controllers.video.window = SDL_CreateWindow("GBE+", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, config::sys_width, config::sys_height, config::flags);
+			u32 window_scale = (core_cpu.controllers.video.filter.is_active()) ? config::scaling_factor : 1;
+
+			core_cpu.controllers.video.window = SDL_CreateWindow("GBE+", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, (config::sys_width * window_scale), (config::sys_height * window_scale), config::flags);
 			SDL_GetWindowSize(core_cpu.controllers.video.window, &config::win_width, &config::win_height);
 			core_cpu.controllers.video.final_screen = SDL_GetWindowSurface(core_cpu.controllers.video.window);
 
@@ -645,6 +731,9 @@ void AGB_core::handle_hotkey(int input, bool pressed)
 	//Toggle turbo off
 	else if((input == config::hotkey_turbo) && (!pressed)) { config::turbo = false; }
 
+	//Rewind while the rewind hotkey is held
+	else if(input == config::hotkey_rewind) { rewind.set_active(pressed); }
+
 	//Initiate various communication functions
 	//Soul Doll Adapter - Reset Soul Doll
 	else if((input == SDLK_F3) && (pressed))
@@ -784,7 +873,12 @@ u32 AGB_core::ex_get_reg(u8 reg_index)
 }
 
 /****** Read binary file to memory ******/
-bool AGB_core::read_file(std::string filename) { return core_mmu.read_file(filename); }
+bool AGB_core::read_file(std::string filename)
+{
+	//Rewind states from another ROM can't be restored
+	rewind.clear();
+	return core_mmu.read_file(filename);
+}
 
 /****** Read BIOS file into memory ******/
 bool AGB_core::read_bios(std::string filename) 
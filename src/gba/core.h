@@ -38,6 +38,8 @@ class AGB_core : virtual public core_emu
 		void feed_key_input(int sdl_key, bool pressed);
 		void save_state(u8 slot);
 		void load_state(u8 slot);
+		bool serialize_state(save_state_buffer& state);
+		bool deserialize_state(save_state_buffer& state);
 		void run_core();
 		void buffer_audio_data();
 
@@ -13,6 +13,32 @@
 
 //TODO - HDMAs basically act like immediate DMAs during HBlank. In reality, if they are take longer than the HBlank period they should stop, then resume from the last position.
 
+/****** Moves as much of a DMA transfer as possible in bulk when both sides are plain memory ******/
+void ARM7::dma_bulk_transfer(u8 id)
+{
+	u8 unit = (mem->dma[id].word_type) ? 4 : 2;
+	u32 length = (mem->dma[id].word_count * unit);
+	u32 done = 0;
+
+	//Decrementing and fixed destinations go through the normal path
+	if((mem->dma[id].dest_addr_ctrl != 0) && (mem->dma[id].dest_addr_ctrl != 3)) { return; }
+
+	//Incrementing source
+	if(mem->dma[id].src_addr_ctrl != 2)
+	{
+		if(mem->dma[id].src_addr_ctrl == 1) { return; }
+
+		done = mem->copy_block(mem->dma[id].destination_address, mem->dma[id].start_address, length);
+		mem->dma[id].start_address += done;
+	}
+
+	//Fixed source
+	else { done = mem->fill_block(mem->dma[id].destination_address, mem->dma[id].start_address, length, unit); }
+
+	mem->dma[id].destination_address += done;
+	mem->dma[id].word_count -= (done / unit);
+}
+
 /****** Performs DMA0 transfers ******/
 void ARM7::dma0()
 {
@@ -45,6 +71,9 @@ void ARM7::dma0()
 					mem->dma[0].start_address &= ~0x1;
 					mem->dma[0].destination_address	&= ~0x1;
 
+					//Move plain memory in bulk first
+					dma_bulk_transfer(0);
+
 					while(mem->dma[0].word_count != 0)
 					{
 						temp_value = mem->read_u16(mem->dma[0].start_address);
@@ -71,6 +100,9 @@ void ARM7::dma0()
 					mem->dma[0].start_address &= ~0x3;
 					mem->dma[0].destination_address	&= ~0x3;
 
+					//Move plain memory in bulk first
+					dma_bulk_transfer(0);
+
 					while(mem->dma[0].word_count != 0)
 					{
 						temp_value = mem->read_u32(mem->dma[0].start_address);
@@ -126,6 +158,9 @@ void ARM7::dma0()
 						mem->dma[0].start_address &= ~0x1;
 						mem->dma[0].destination_address	&= ~0x1;
 
+						//Move plain memory in bulk first
+						dma_bulk_transfer(0);
+
 						while(mem->dma[0].word_count != 0)
 						{
 							temp_value = mem->read_u16(mem->dma[0].start_address);
@@ -152,6 +187,9 @@ void ARM7::dma0()
 						mem->dma[0].start_address &= ~0x3;
 						mem->dma[0].destination_address	&= ~0x3;
 
+						//Move plain memory in bulk first
+						dma_bulk_transfer(0);
+
 						while(mem->dma[0].word_count != 0)
 						{
 							temp_value = mem->read_u32(mem->dma[0].start_address);
@@ -235,6 +273,9 @@ void ARM7::dma1()
 					mem->dma[1].start_address &= ~0x1;
 					mem->dma[1].destination_address	&= ~0x1;
 
+					//Move plain memory in bulk first
+					dma_bulk_transfer(1);
+
 					while(mem->dma[1].word_count != 0)
 					{
 						temp_value = mem->read_u16(mem->dma[1].start_address);
@@ -261,6 +302,9 @@ void ARM7::dma1()
 					mem->dma[1].start_address &= ~0x3;
 					mem->dma[1].destination_address	&= ~0x3;
 
+					//Move plain memory in bulk first
+					dma_bulk_transfer(1);
+
 					while(mem->dma[1].word_count != 0)
 					{
 						temp_value = mem->read_u32(mem->dma[1].start_address);
@@ -316,6 +360,9 @@ void ARM7::dma1()
 						mem->dma[1].start_address &= ~0x1;
 						mem->dma[1].destination_address	&= ~0x1;
 
+						//Move plain memory in bulk first
+						dma_bulk_transfer(1);
+
 						while(mem->dma[1].word_count != 0)
 						{
 							temp_value = mem->read_u16(mem->dma[1].start_address);
@@ -342,6 +389,9 @@ void ARM7::dma1()
 						mem->dma[1].start_address &= ~0x3;
 						mem->dma[1].destination_address	&= ~0x3;
 
+						//Move plain memory in bulk first
+						dma_bulk_transfer(1);
+
 						while(mem->dma[1].word_count != 0)
 						{
 							temp_value = mem->read_u32(mem->dma[1].start_address);
@@ -425,6 +475,9 @@ void ARM7::dma2()
 					mem->dma[2].start_address &= ~0x1;
 					mem->dma[2].destination_address	&= ~0x1;
 
+					//Move plain memory in bulk first
+					dma_bulk_transfer(2);
+
 					while(mem->dma[2].word_count != 0)
 					{
 						temp_value = mem->read_u16(mem->dma[2].start_address);
@@ -451,6 +504,9 @@ void ARM7::dma2()
 					mem->dma[2].start_address &= ~0x3;
 					mem->dma[2].destination_address	&= ~0x3;
 
+					//Move plain memory in bulk first
+					dma_bulk_transfer(2);
+
 					while(mem->dma[2].word_count != 0)
 					{
 						temp_value = mem->read_u32(mem->dma[2].start_address);
@@ -506,6 +562,9 @@ void ARM7::dma2()
 						mem->dma[2].start_address &= ~0x1;
 						mem->dma[2].destination_address	&= ~0x1;
 
+						//Move plain memory in bulk first
+						dma_bulk_transfer(2);
+
 						while(mem->dma[2].word_count != 0)
 						{
 							temp_value = mem->read_u16(mem->dma[2].start_address);
@@ -532,6 +591,9 @@ void ARM7::dma2()
 						mem->dma[2].start_address &= ~0x3;
 						mem->dma[2].destination_address	&= ~0x3;
 
+						//Move plain memory in bulk first
+						dma_bulk_transfer(2);
+
 						while(mem->dma[2].word_count != 0)
 						{
 							temp_value = mem->read_u32(mem->dma[2].start_address);
@@ -658,6 +720,9 @@ void ARM7::dma3()
 					mem->dma[3].start_address &= ~0x1;
 					mem->dma[3].destination_address	&= ~0x1;
 
+					//Move plain memory in bulk first
+					dma_bulk_transfer(3);
+
 					while(mem->dma[3].word_count != 0)
 					{
 						temp_value = mem->read_u16(mem->dma[3].start_address);
@@ -684,6 +749,9 @@ void ARM7::dma3()
 					mem->dma[3].start_address &= ~0x3;
 					mem->dma[3].destination_address	&= ~0x3;
 
+					//Move plain memory in bulk first
+					dma_bulk_transfer(3);
+
 					while(mem->dma[3].word_count != 0)
 					{
 						temp_value = mem->read_u32(mem->dma[3].start_address);
@@ -739,6 +807,9 @@ void ARM7::dma3()
 						mem->dma[3].start_address &= ~0x1;
 						mem->dma[3].destination_address	&= ~0x1;
 
+						//Move plain memory in bulk first
+						dma_bulk_transfer(3);
+
 						while(mem->dma[3].word_count != 0)
 						{
 							temp_value = mem->read_u16(mem->dma[3].start_address);
@@ -765,6 +836,9 @@ void ARM7::dma3()
 						mem->dma[3].start_address &= ~0x3;
 						mem->dma[3].destination_address	&= ~0x3;
 
+						//Move plain memory in bulk first
+						dma_bulk_transfer(3);
+
 						while(mem->dma[3].word_count != 0)
 						{
 							temp_value = mem->read_u32(mem->dma[3].start_address);
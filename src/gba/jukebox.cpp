@@ -39,7 +39,8 @@ void AGB_MMU::jukebox_reset()
 	jukebox.remaining_playback_time = 0;
 	jukebox.current_recording_time = 0;
 	jukebox.recorded_file = "";
-	jukebox.last_converted_file = "";
+	jukebox.pending_audio_file = "";
+	jukebox.pending_karaoke_file = "";
 	jukebox.karaoke_track = "";
 
 	for(u32 x = 0; x < 9; x++) { jukebox.spectrum_values[x] = 0; }
@@ -1295,12 +1296,20 @@ bool AGB_MMU::jukebox_load_audio(std::string filename)
 {
 	//Reset current karaoke track
 	jukebox.karaoke_track = "";
+	jukebox.pending_audio_file = "";
+	jukebox.pending_karaoke_file = "";
 
-	//Clear previous buffer if necessary
+	//Clear previous buffers if necessary
+	SDL_LockAudio();
 	SDL_FreeWAV(apu_stat->ext_audio.buffer);
 	apu_stat->ext_audio.buffer = NULL;
+	apu_stat->ext_audio.length = 0;
 
-	SDL_AudioSpec file_spec;
+	SDL_FreeWAV(apu_stat->ext_audio.karaoke_buffer);
+	apu_stat->ext_audio.karaoke_buffer = NULL;
+	apu_stat->ext_audio.karaoke_length = 0;
+	jukebox.enable_karaoke = false;
+	SDL_UnlockAudio();
 
 	//If specified audio file is not a PCM S16 LE WAV file, attempt to convert it through a temporary audio file
 	//Grab last 4 characters of filename to determine if the conversion should happen
@@ -1311,67 +1320,52 @@ bool AGB_MMU::jukebox_load_audio(std::string filename)
 		ext = ext.substr(ext.size() - 4);
 	}
 
-	if((ext != ".wav") && (ext != ".WAV") && (ext != ".gb3") && (ext != ".GB3"))
-	{
-		std::string out_file = config::temp_media_file + ".wav";
-		std::string sys_cmd = config::audio_conversion_cmd;
-
-		//Skip conversion if current file has already been converted
-		if(jukebox.last_converted_file == filename)
-		{
-			filename = out_file;
-			jukebox.karaoke_track = out_file;
-		}
-			
-		else
-		{
-			//Delete any existing temporary media file in case audio conversion command complains
-			std::remove(out_file.c_str());
+	if((ext == ".wav") || (ext == ".WAV") || (ext == ".gb3") || (ext == ".GB3")) { return jukebox_open_audio(filename); }
 
-			//Replace %in and %out with proper parameters
-			std::string search_str = "%in";
-			std::size_t pos = sys_cmd.find(search_str);
+	//Abort now if no audio conversion command is specified
+	if(config::audio_conversion_cmd.empty())
+	{
+		std::cout<<"MMU::No audio conversion command specified. Cannot convert file " << filename << "\n";
+		return false;
+	}
 
-			if(pos != std::string::npos)
-			{
-				std::string start = sys_cmd.substr(0, pos);
-				std::string end = sys_cmd.substr(pos + 3);
-				sys_cmd = start + filename + end;
-			}
+	//Conversion runs in the background, unless this file was already converted or cached
+	std::string out_file = "";
+	media_convert_status status = audio_converter.request(filename, config::audio_conversion_cmd, out_file);
 
-			search_str = "%out";
-			pos = sys_cmd.find(search_str);
+	//Convert the next music file ahead of time
+	if((jukebox.current_category == 0x00) && (u32(jukebox.current_file + 1) < jukebox.music_files.size()))
+	{
+		std::string next_file = jukebox.music_files[jukebox.current_file + 1];
+		std::string next_ext = (next_file.size() >= 4) ? next_file.substr(next_file.size() - 4) : "";
 
-			if(pos != std::string::npos)
-			{
-				std::string start = sys_cmd.substr(0, pos);
-				std::string end = sys_cmd.substr(pos + 4);
-				sys_cmd = start + out_file + end;
-			}
-		
-			//Check for a command processor on system and run audio conversion command
-			if(system(NULL))
-			{
-				std::cout<<"MMU::Converting audio file " << filename << "\n";
-				system(sys_cmd.c_str());
-				std::cout<<"MMU::Conversion complete\n";
+		if((next_ext != ".wav") && (next_ext != ".WAV") && (next_ext != ".gb3") && (next_ext != ".GB3"))
+		{
+			audio_converter.prefetch(config::data_path + "jukebox/" + next_file, config::audio_conversion_cmd);
+		}
+	}
 
-				jukebox.last_converted_file = filename;
-				filename = out_file;
-				jukebox.karaoke_track = out_file;
-			}
+	if(status == MEDIA_CONVERT_DONE) { return jukebox_open_audio(out_file); }
 
-			else
-			{
-				std::cout<<"Conversion of audio file " << filename << " failed \n";
-				return false;
-			}
-		}
+	else if(status == MEDIA_CONVERT_FAILED)
+	{
+		std::cout<<"MMU::Jukebox could not convert audio file " << filename << "\n";
+		return false;
 	}
 
-	else { jukebox.karaoke_track = filename; }
+	//Audio stays silent until the conversion finishes, see jukebox_check_pending_audio()
+	jukebox.pending_audio_file = filename;
+	return true;
+}
 
-	if(SDL_LoadWAV(filename.c_str(), &file_spec, &apu_stat->ext_audio.buffer, &apu_stat->ext_audio.length) == NULL)
+/****** Loads a PCM S16 LE WAV file into the external audio buffer ******/
+bool AGB_MMU::jukebox_open_audio(std::string filename)
+{
+	SDL_AudioSpec file_spec;
+	u8* buffer = NULL;
+	u32 length = 0;
+
+	if(SDL_LoadWAV(filename.c_str(), &file_spec, &buffer, &length) == NULL)
 	{
 		std::cout<<"MMU::Jukebox could not load audio file: " << filename << " :: " << SDL_GetError() << "\n";
 		return false;
@@ -1381,6 +1375,7 @@ bool AGB_MMU::jukebox_load_audio(std::string filename)
 	if(file_spec.format != AUDIO_S16)
 	{
 		std::cout<<"MMU::Jukebox loaded file, but format is not Signed 16-bit LSB audio\n";
+		SDL_FreeWAV(buffer);
 		return false;
 	}
 
@@ -1388,79 +1383,97 @@ bool AGB_MMU::jukebox_load_audio(std::string filename)
 	if(file_spec.channels > 2)
 	{
 		std::cout<<"MMU::Jukebox loaded file, but audio uses more than 2 channels\n";
+		SDL_FreeWAV(buffer);
 		return false;
 	}
 
+	//Audio output may already be running when a background conversion finishes
+	SDL_LockAudio();
+	SDL_FreeWAV(apu_stat->ext_audio.buffer);
+	apu_stat->ext_audio.buffer = buffer;
+	apu_stat->ext_audio.length = length;
 	apu_stat->ext_audio.frequency = file_spec.freq;
 	apu_stat->ext_audio.channels = file_spec.channels;
+	SDL_UnlockAudio();
+
+	jukebox.karaoke_track = filename;
+	jukebox.pending_karaoke_file = "";
 
 	std::cout<<"MMU::Jukebox loaded audio file: " << filename << "\n";
 
+	//The previous karaoke track belongs to different audio
+	SDL_LockAudio();
+	SDL_FreeWAV(apu_stat->ext_audio.karaoke_buffer);
+	apu_stat->ext_audio.karaoke_buffer = NULL;
+	apu_stat->ext_audio.karaoke_length = 0;
+	jukebox.enable_karaoke = false;
+	SDL_UnlockAudio();
+
 	//Attempt to remove vocals from the audio file if using Music or Karaoke modes
-	if((jukebox.current_category == 0) || (jukebox.current_category == 2))
+	if(((jukebox.current_category == 0) || (jukebox.current_category == 2)) && (!config::remove_vocals_cmd.empty()))
 	{
-		jukebox.enable_karaoke = jukebox_load_karaoke_audio();
+		//Vocal removal runs in the background and is cached like any other conversion
+		std::string out_file = "";
+		media_convert_status status = audio_converter.request(filename, config::remove_vocals_cmd, out_file);
+
+		if(status == MEDIA_CONVERT_DONE) { jukebox_load_karaoke_audio(out_file); }
+		else if(status == MEDIA_CONVERT_FAILED) { std::cout<<"MMU::Jukebox could not remove vocals from audio file " << filename << "\n"; }
+		else { jukebox.pending_karaoke_file = filename; }
 	}
 
 	return true;
 }
 
-/****** Loads a karaoke track (.WAV) file for playback on Jukebox (GBA speakers or headphones) ******/
-bool AGB_MMU::jukebox_load_karaoke_audio()
+/****** Finishes loading audio and karaoke tracks once their background conversions are done ******/
+void AGB_MMU::jukebox_check_pending_audio()
 {
-	//Clear previous buffer if necessary
-	SDL_FreeWAV(apu_stat->ext_audio.karaoke_buffer);
-	apu_stat->ext_audio.karaoke_buffer = NULL;
+	std::string out_file = "";
+	media_convert_status status = MEDIA_CONVERT_QUEUED;
 
-	SDL_AudioSpec file_spec;
+	if(!jukebox.pending_audio_file.empty())
+	{
+		status = audio_converter.get_status(jukebox.pending_audio_file, config::audio_conversion_cmd, out_file);
 
-	//This function MUST be called IMMEDIATELY AFTER the audio format conversion was successful in jukebox_load_audio()
-	//This ensures that the file being loaded is a .WAV file in PCM S16 LE
-	std::string in_file = jukebox.karaoke_track;
-	std::string out_file = config::data_path + "gbe_temp_karaoke.wav";
-	std::string sys_cmd = config::remove_vocals_cmd;
+		if((status == MEDIA_CONVERT_QUEUED) || (status == MEDIA_CONVERT_ACTIVE)) { return; }
 
-	//Delete any existing temporary media file in case audio conversion command complains
-	std::remove(out_file.c_str());
+		std::string filename = jukebox.pending_audio_file;
+		jukebox.pending_audio_file = "";
 
-	//Replace %in and %out with proper parameters
-	std::string search_str = "%in";
-	std::size_t pos = sys_cmd.find(search_str);
+		if((status == MEDIA_CONVERT_FAILED) || (!jukebox_open_audio(out_file)))
+		{
+			std::cout<<"MMU::Jukebox could not convert audio file " << filename << "\n";
+			apu_stat->ext_audio.playing = false;
+		}
 
-	if(pos != std::string::npos)
-	{
-		std::string start = sys_cmd.substr(0, pos);
-		std::string end = sys_cmd.substr(pos + 3);
-		sys_cmd = start + in_file + end;
+		return;
 	}
 
-	search_str = "%out";
-	pos = sys_cmd.find(search_str);
-
-	if(pos != std::string::npos)
-	{
-		std::string start = sys_cmd.substr(0, pos);
-		std::string end = sys_cmd.substr(pos + 4);
-		sys_cmd = start + out_file + end;
-	}
-		
-	//Check for a command processor on system and run audio conversion command
-	if(system(NULL))
+	if(!jukebox.pending_karaoke_file.empty())
 	{
-		std::cout<<"MMU::Removing vocals from audio file " << in_file << "\n";
-		system(sys_cmd.c_str());
-		std::cout<<"MMU::Removal complete\n";
-	}
+		status = audio_converter.get_status(jukebox.pending_karaoke_file, config::remove_vocals_cmd, out_file);
 
-	else
-	{
-		std::cout<<"Conversion of audio file " << in_file << " failed \n";
-		return false;
+		if((status == MEDIA_CONVERT_QUEUED) || (status == MEDIA_CONVERT_ACTIVE)) { return; }
+
+		std::string filename = jukebox.pending_karaoke_file;
+		jukebox.pending_karaoke_file = "";
+
+		if((status == MEDIA_CONVERT_FAILED) || (!jukebox_load_karaoke_audio(out_file)))
+		{
+			std::cout<<"MMU::Jukebox could not remove vocals from audio file " << filename << "\n";
+		}
 	}
+}
+
+/****** Loads a karaoke track (.WAV) file for playback on Jukebox (GBA speakers or headphones) ******/
+bool AGB_MMU::jukebox_load_karaoke_audio(std::string filename)
+{
+	SDL_AudioSpec file_spec;
+	u8* buffer = NULL;
+	u32 length = 0;
 
-	if(SDL_LoadWAV(out_file.c_str(), &file_spec, &apu_stat->ext_audio.karaoke_buffer, &apu_stat->ext_audio.karaoke_length) == NULL)
+	if(SDL_LoadWAV(filename.c_str(), &file_spec, &buffer, &length) == NULL)
 	{
-		std::cout<<"MMU::Jukebox could not load audio file: " << out_file << " :: " << SDL_GetError() << "\n";
+		std::cout<<"MMU::Jukebox could not load audio file: " << filename << " :: " << SDL_GetError() << "\n";
 		return false;
 	}
 
@@ -1468,6 +1481,7 @@ bool AGB_MMU::jukebox_load_karaoke_audio()
 	if(file_spec.format != AUDIO_S16)
 	{
 		std::cout<<"MMU::Jukebox loaded file, but format is not Signed 16-bit LSB audio\n";
+		SDL_FreeWAV(buffer);
 		return false;
 	}
 
@@ -1475,17 +1489,27 @@ bool AGB_MMU::jukebox_load_karaoke_audio()
 	if(file_spec.channels != apu_stat->ext_audio.channels)
 	{
 		std::cout<<"MMU::Karaoke track does not have the same amount of channels as the original\n";
+		SDL_FreeWAV(buffer);
 		return false;
 	}
 
 	//Make sure the frequency matches the original audio
-	if(file_spec.freq != apu_stat->ext_audio.frequency)
+	if(u32(file_spec.freq) != apu_stat->ext_audio.frequency)
 	{
 		std::cout<<"MMU::Karaoke track does not have the same frequency as the original\n";
+		SDL_FreeWAV(buffer);
 		return false;
 	}
 
-	std::cout<<"MMU::Jukebox loaded audio file: " << out_file << "\n";
+	//The audio thread mixes from this buffer while the original track plays
+	SDL_LockAudio();
+	SDL_FreeWAV(apu_stat->ext_audio.karaoke_buffer);
+	apu_stat->ext_audio.karaoke_buffer = buffer;
+	apu_stat->ext_audio.karaoke_length = length;
+	jukebox.enable_karaoke = true;
+	SDL_UnlockAudio();
+
+	std::cout<<"MMU::Jukebox loaded audio file: " << filename << "\n";
 	return true;
 }
 
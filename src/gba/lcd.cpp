@@ -24,6 +24,7 @@ AGB_LCD::AGB_LCD()
 /****** LCD Destructor ******/
 AGB_LCD::~AGB_LCD()
 {
+	filter.stop();
 	screen_buffer.clear();
 	scanline_buffer.clear();
 	SDL_DestroyWindow(window);
@@ -35,8 +36,12 @@ void AGB_LCD::reset()
 {
 	final_screen = NULL;
 	original_screen = NULL;
+	filtered_screen = NULL;
 	mem = NULL;
 
+	//Restarted by init() if still enabled
+	filter.stop();
+
 	if((window != NULL) && (config::sdl_render)) { SDL_DestroyWindow(window); }
 	window = NULL;
 
@@ -192,11 +197,24 @@ bool AGB_LCD::init()
 		//Set up software rendering
 		else
 		{
-			window = SDL_CreateWindow("GBE+", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, config::sys_width, config::sys_height, config::flags);
+			u8 filter_type = (config::use_sw_filters) ? sw_filter::get_type(config::fragment_shader) : SW_FILTER_NONE;
+			u32 window_scale = 1;
+
+			//The CDZ sub screen changes the screen size, so the filter restarts whenever the window is rebuilt
+			if(filtered_screen != NULL) { SDL_FreeSurface(filtered_screen); }
+			filtered_screen = NULL;
+
+			if((filter_type != SW_FILTER_NONE) && (filter.start(filter_type, config::sys_width, config::sys_height)))
+			{
+				filtered_screen = SDL_CreateRGBSurface(SDL_SWSURFACE, filter.get_width(), filter.get_height(), 32, 0, 0, 0, 0);
+				window_scale = filter.get_width() / config::sys_width;
+			}
+
+			window = SDL_CreateWindow("GBE+", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, (config::sys_width * window_scale), (config::sys_height * window_scale), config::flags);
 			SDL_GetWindowSize(window, &config::win_width, &config::win_height);
 			final_screen = SDL_GetWindowSurface(window);
 			original_screen = SDL_CreateRGBSurface(SDL_SWSURFACE, config::sys_width, config::sys_height, 32, 0, 0, 0, 0);
-			config::scaling_factor = 1;
+			config::scaling_factor = window_scale;
 		}
 
 		if(final_screen == NULL) { return false; }
@@ -506,14 +524,20 @@ void AGB_LCD::update_palettes()
 	}
 }
 
-/****** Determines if a sprite pixel should be rendered, and if so draws it to the current scanline pixel ******/
-bool AGB_LCD::render_sprite_pixel()
+/****** Draws all sprite pixels for the current scanline into the OBJ line buffer ******/
+void AGB_LCD::render_obj_line()
 {
+	for(u32 x = 0; x < 240; x++)
+	{
+		obj_line_opaque[x] = false;
+		obj_line_win[x] = false;
+	}
+
 	//If sprites are disabled, quit now
-	if((lcd_stat.display_control & 0x1000) == 0) { return false; }
+	if((lcd_stat.display_control & 0x1000) == 0) { return; }
 
 	//If no sprites are rendered on this line, quit now
-	if(obj_render_length == 0) { return false; }
+	if(obj_render_length == 0) { return; }
 
 	u8 sprite_id = 0;
 	u32 sprite_tile_addr = 0;
@@ -524,80 +548,83 @@ bool AGB_LCD::render_sprite_pixel()
 	u16 sprite_tile_pixel_y = 0;
 
 	bool render_obj;
-	bool final_render = false;
 
-	//Cycle through all sprites that are rendering on this pixel, draw them according to their priority
-	for(int x = 0; x < obj_render_length; x++)
+	//Cycle through all sprites on this line, draw them according to their priority
+	//Sprites earlier in the list take priority, so only OBJ Window sprites can touch pixels already drawn
+	for(int y = 0; y < obj_render_length; y++)
 	{
-		sprite_id = obj_render_list[x];
-		render_obj = true;
-
-		if((final_render) && (obj[sprite_id].mode != 2)) { continue; }
-
-		//Check to see if current_scanline_pixel is within sprite
-		if((!obj[sprite_id].x_wrap) && ((scanline_pixel_counter < obj[sprite_id].left) || (scanline_pixel_counter > obj[sprite_id].right))) { continue; }
-		else if((obj[sprite_id].x_wrap) && ((scanline_pixel_counter > obj[sprite_id].right) && (scanline_pixel_counter < obj[sprite_id].left))) { continue; }
+		sprite_id = obj_render_list[y];
 
 		//For bitmap BG Modes 3-5, skip rendering tile numbers lower than 512
-		else if((lcd_stat.bg_mode >= 0x3) && (obj[sprite_id].tile_number < 512)) { continue; }
+		if((lcd_stat.bg_mode >= 0x3) && (obj[sprite_id].tile_number < 512)) { continue; }
 
-		//Normal sprite rendering
-		if(!obj[sprite_id].affine_enable)
+		for(u32 x = 0; x < 240; x++)
 		{
-			//Determine the internal X-Y coordinates of the sprite's pixel
-			sprite_tile_pixel_x = obj[sprite_id].x_wrap ? (scanline_pixel_counter + obj[sprite_id].x_wrap_val) : (scanline_pixel_counter - obj[sprite_id].x);
-			sprite_tile_pixel_y = obj[sprite_id].y_wrap ? (current_scanline + obj[sprite_id].y_wrap_val) : (current_scanline - obj[sprite_id].y);
+			render_obj = true;
+
+			if((obj_line_opaque[x]) && (obj[sprite_id].mode != 2)) { continue; }
 
-			//Horizontal flip the internal X coordinate
-			if(obj[sprite_id].h_flip)
+			//Check to see if current pixel is within sprite
+			if((!obj[sprite_id].x_wrap) && ((x < obj[sprite_id].left) || (x > obj[sprite_id].right))) { continue; }
+			else if((obj[sprite_id].x_wrap) && ((x > obj[sprite_id].right) && (x < obj[sprite_id].left))) { continue; }
+
+			//Normal sprite rendering
+			if(!obj[sprite_id].affine_enable)
 			{
-				s16 h_flip = sprite_tile_pixel_x;
-				h_flip -= (obj[sprite_id].width - 1);
+				//Determine the internal X-Y coordinates of the sprite's pixel
+				sprite_tile_pixel_x = obj[sprite_id].x_wrap ? (x + obj[sprite_id].x_wrap_val) : (x - obj[sprite_id].x);
+				sprite_tile_pixel_y = obj[sprite_id].y_wrap ? (current_scanline + obj[sprite_id].y_wrap_val) : (current_scanline - obj[sprite_id].y);
 
-				if(h_flip < 0) { h_flip *= -1; }
+				//Horizontal flip the internal X coordinate
+				if(obj[sprite_id].h_flip)
+				{
+					s16 h_flip = sprite_tile_pixel_x;
+					h_flip -= (obj[sprite_id].width - 1);
 
-				sprite_tile_pixel_x = h_flip;
-			}
+					if(h_flip < 0) { h_flip *= -1; }
 
-			//Vertical flip the internal Y coordinate
-			if(obj[sprite_id].v_flip)
-			{
-				s16 v_flip = sprite_tile_pixel_y;
-				v_flip -= (obj[sprite_id].height - 1);
+					sprite_tile_pixel_x = h_flip;
+				}
+
+				//Vertical flip the internal Y coordinate
+				if(obj[sprite_id].v_flip)
+				{
+					s16 v_flip = sprite_tile_pixel_y;
+					v_flip -= (obj[sprite_id].height - 1);
 
-				if(v_flip < 0) { v_flip *= -1; }
+					if(v_flip < 0) { v_flip *= -1; }
 
-				sprite_tile_pixel_y = v_flip;
+					sprite_tile_pixel_y = v_flip;
+				}
 			}
-		}
 
-		//Affine transformation sprite rendering
-		else
-		{
-			u8 index = (obj[sprite_id].affine_group << 2);
-			s16 current_x, current_y;
+			//Affine transformation sprite rendering
+			else
+			{
+				u8 index = (obj[sprite_id].affine_group << 2);
+				s16 current_x, current_y;
 
-			//Determine current X position relative to the OBJ center X, account for screen wrapping
-			if((obj[sprite_id].x_wrap) && (scanline_pixel_counter < obj[sprite_id].right)) { current_x = scanline_pixel_counter - (obj[sprite_id].cx - obj[sprite_id].x_wrap); }
-			else { current_x = scanline_pixel_counter - obj[sprite_id].cx; }
+				//Determine current X position relative to the OBJ center X, account for screen wrapping
+				if((obj[sprite_id].x_wrap) && (x < obj[sprite_id].right)) { current_x = x - (obj[sprite_id].cx - obj[sprite_id].x_wrap); }
+				else { current_x = x - obj[sprite_id].cx; }
 
-			//Determine current Y position relative to the OBJ center Y, account for screen wrapping
-			if((obj[sprite_id].y_wrap) && (current_scanline < obj[sprite_id].bottom)) { current_y = current_scanline - (obj[sprite_id].cy - obj[sprite_id].y_wrap); }
-			else { current_y = current_scanline - obj[sprite_id].cy; }
+				//Determine current Y position relative to the OBJ center Y, account for screen wrapping
+				if((obj[sprite_id].y_wrap) && (current_scanline < obj[sprite_id].bottom)) { current_y = current_scanline - (obj[sprite_id].cy - obj[sprite_id].y_wrap); }
+				else { current_y = current_scanline - obj[sprite_id].cy; }
 
-			s16 new_x = obj[sprite_id].cw + (lcd_stat.obj_affine[index] * current_x) + (lcd_stat.obj_affine[index+1] * current_y);
-			s16 new_y = obj[sprite_id].ch + (lcd_stat.obj_affine[index+2] * current_x) + (lcd_stat.obj_affine[index+3] * current_y);
+				s16 new_x = obj[sprite_id].cw + (lcd_stat.obj_affine[index] * current_x) + (lcd_stat.obj_affine[index+1] * current_y);
+				s16 new_y = obj[sprite_id].ch + (lcd_stat.obj_affine[index+2] * current_x) + (lcd_stat.obj_affine[index+3] * current_y);
 
-			//If out of bounds for the transformed sprite, abort rendering
-			if((new_x < 0) || (new_y < 0) || (new_x >= obj[sprite_id].width) || (new_y >= obj[sprite_id].height)) { render_obj = false; }
+				//If out of bounds for the transformed sprite, abort rendering
+				if((new_x < 0) || (new_y < 0) || (new_x >= obj[sprite_id].width) || (new_y >= obj[sprite_id].height)) { render_obj = false; }
 		
-			sprite_tile_pixel_x = new_x;
-			sprite_tile_pixel_y = new_y;
-		}
+				sprite_tile_pixel_x = new_x;
+				sprite_tile_pixel_y = new_y;
+			}
+
+			//This check is mainly for affine OBJs
+			if(!render_obj) { continue; }
 
-		//This check is mainly for affine OBJs
-		if(render_obj)
-		{
 			//Handle the mosiac function
 			if(obj[sprite_id].mosiac && lcd_stat.obj_mos_hsize) { sprite_tile_pixel_x = ((sprite_tile_pixel_x / lcd_stat.obj_mos_hsize) * lcd_stat.obj_mos_hsize); }
 			if(obj[sprite_id].mosiac && lcd_stat.obj_mos_vsize) { sprite_tile_pixel_y = ((sprite_tile_pixel_y / lcd_stat.obj_mos_vsize) * lcd_stat.obj_mos_vsize); }
@@ -625,8 +652,9 @@ bool AGB_LCD::render_sprite_pixel()
 			meta_y = (sprite_tile_pixel_y % 8);
 
 			u8 sprite_tile_pixel = (meta_y * 8) + meta_x;
+			u16 pal_index = 0;
 
-			//Grab the byte corresponding to (sprite_tile_pixel), render it as ARGB - 4-bit version
+			//Grab the byte corresponding to (sprite_tile_pixel) - 4-bit version
 			if(obj[sprite_id].bit_depth == 4)
 			{
 				sprite_tile_addr += (sprite_tile_pixel >> 1);
@@ -635,101 +663,247 @@ bool AGB_LCD::render_sprite_pixel()
 				if((sprite_tile_pixel % 2) == 0) { raw_color &= 0xF; }
 				else { raw_color >>= 4; }
 
-				if(raw_color != 0) 
-				{
-					//If this sprite is in OBJ Window mode, do not render it, but set a flag indicating the LCD passed over its pixel
-					if(obj[sprite_id].mode == 2) { obj_win_pixel = true; }
-
-					else 
-					{
-						scanline_buffer[scanline_pixel_counter] = pal[((obj[sprite_id].palette_number * 32) + (raw_color * 2)) >> 1][1];
-						last_raw_color = raw_pal[((obj[sprite_id].palette_number * 32) + (raw_color * 2)) >> 1][1];
-						last_obj_priority = obj[sprite_id].bg_priority;
-						last_obj_mode = obj[sprite_id].mode;
-						final_render = true;
-					}
-				}
+				pal_index = ((obj[sprite_id].palette_number * 32) + (raw_color * 2)) >> 1;
 			}
 
-			//Grab the byte corresponding to (sprite_tile_pixel), render it as ARGB - 8-bit version
+			//Grab the byte corresponding to (sprite_tile_pixel) - 8-bit version
 			else
 			{
 				sprite_tile_addr += sprite_tile_pixel;
 				raw_color = mem->memory_map[sprite_tile_addr];
+				pal_index = raw_color;
+			}
 
-				if(raw_color != 0) 
-				{
-					//If this sprite is in OBJ Window mode, do not render it, but set a flag indicating the LCD passed over its pixel
-					if(obj[sprite_id].mode == 2) { obj_win_pixel = true; }
+			if(raw_color == 0) { continue; }
 
-					else
-					{
-						scanline_buffer[scanline_pixel_counter] = pal[raw_color][1];
-						last_raw_color = raw_pal[raw_color][1];
-						last_obj_priority = obj[sprite_id].bg_priority;
-						last_obj_mode = obj[sprite_id].mode;
-						final_render = true;
-					}
-				}
+			//If this sprite is in OBJ Window mode, do not render it, but set a flag indicating the LCD passes over its pixel
+			if(obj[sprite_id].mode == 2) { obj_line_win[x] = true; }
+
+			//Otherwise render it as ARGB
+			else 
+			{
+				obj_line_color[x] = pal[pal_index][1];
+				obj_line_raw[x] = raw_pal[pal_index][1];
+				obj_line_priority[x] = obj[sprite_id].bg_priority;
+				obj_line_mode[x] = obj[sprite_id].mode;
+				obj_line_opaque[x] = true;
 			}
 		}
 	}
+}
+
+/****** Determines if a sprite pixel should be rendered, and if so draws it to the current scanline pixel ******/
+bool AGB_LCD::render_sprite_pixel()
+{
+	u32 x = scanline_pixel_counter;
+
+	//Set a flag if the LCD passes over an OBJ Window pixel
+	if(obj_line_win[x]) { obj_win_pixel = true; }
 
 	//Return false if nothing was drawn
-	return final_render;
+	if(!obj_line_opaque[x]) { return false; }
+
+	scanline_buffer[x] = obj_line_color[x];
+	last_raw_color = obj_line_raw[x];
+	last_obj_priority = obj_line_priority[x];
+	last_obj_mode = obj_line_mode[x];
+
+	return true;
 }
 
-/****** Determines if a background pixel should be rendered, and if so draws it to the current scanline pixel ******/
-bool AGB_LCD::render_bg_pixel(u32 bg_control)
+/****** Draws all pixels of a background for the current scanline into its BG line buffer ******/
+void AGB_LCD::render_bg_line(u8 bg_id)
 {
-	if(!lcd_stat.bg_enable[(bg_control - 0x4000008) >> 1]) { return false; }
+	u32 bg_control = BG0CNT + (bg_id << 1);
+	u8 bg_type = 0xFF;
 
-	//Render BG pixel according to current BG Mode
-	switch(lcd_stat.bg_mode)
+	//Determine how to render this BG according to current BG Mode
+	if(lcd_stat.bg_enable[bg_id])
 	{
-		//BG Mode 0
-		case 0:
-			return render_bg_mode_0(bg_control); break;
+		switch(lcd_stat.bg_mode)
+		{
+			//BG Mode 0 - All BGs are Text
+			case 0:
+				bg_type = 0; break;
+
+			//BG Mode 1 - BG2 is Scaled+Rotation, BG3 is never drawn, BG0 and BG1 are Text
+			case 1:
+				if(bg_id == 2) { bg_type = 1; }
+				else if(bg_id != 3) { bg_type = 0; }
+				break;
+
+			//BG Mode 2 - BG2 and BG3 are Scaled+Rotation
+			case 2:
+				if(bg_id >= 2) { bg_type = 1; }
+				break;
+
+			//BG Modes 3-5 - Bitmap
+			case 3:
+			case 4:
+			case 5:
+				bg_type = lcd_stat.bg_mode; break;
+		}
+	}
 
-		//BG Mode 1
-		case 1:
-			//Render BG2 as Scaled+Rotation
-			if(bg_control == BG2CNT) { return render_bg_mode_1(bg_control); }
+	//Nothing is drawn for this BG
+	if(bg_type == 0xFF)
+	{
+		for(u32 x = 0; x < 240; x++) { bg_line_opaque[bg_id][x] = false; }
+		return;
+	}
 
-			//BG3 is never drawn in Mode 1
-			else if(bg_control == BG3CNT) { return false; }
+	//Text BGs without horizontal mosiac can be drawn a whole tile at a time
+	if((bg_type == 0) && ((!lcd_stat.bg_mosiac[bg_id]) || (!lcd_stat.bg_mos_hsize)))
+	{
+		render_bg_line_mode_0(bg_id);
+		return;
+	}
 
-			//Render BG0 and BG1 as Text (same as Mode 0)
-			else { return render_bg_mode_0(bg_control); } 
+	//Everything else is drawn pixel by pixel
+	for(scanline_pixel_counter = 0; scanline_pixel_counter < 240; scanline_pixel_counter++)
+	{
+		bool opaque = false;
 
-			break;
+		switch(bg_type)
+		{
+			case 0: opaque = render_bg_mode_0(bg_control); break;
+			case 1: opaque = render_bg_mode_1(bg_control); break;
+			case 3: opaque = render_bg_mode_3(); break;
+			case 4: opaque = render_bg_mode_4(); break;
+			case 5: opaque = render_bg_mode_5(); break;
+		}
 
-		//BG Mode 2
-		case 0x2:
-			//Render BG2 and BG3 as Scaled+Rotation
-			if((bg_control == BG2CNT) || (bg_control == BG3CNT)) { return render_bg_mode_1(bg_control); }
-			else { return false; }
+		bg_line_opaque[bg_id][scanline_pixel_counter] = opaque;
 
-			break;
+		if(opaque)
+		{
+			bg_line_color[bg_id][scanline_pixel_counter] = scanline_buffer[scanline_pixel_counter];
+			bg_line_raw[bg_id][scanline_pixel_counter] = last_raw_color;
+		}
+	}
+}
+
+/****** Render BG Mode 0 for a whole scanline - Map entries are only fetched once per tile ******/
+void AGB_LCD::render_bg_line_mode_0(u8 bg_id)
+{
+	u16 screen_offset = 0;
+	u32 map_base_addr = 0;
+	u32 tile_addr = 0;
+	u8* tile_data = NULL;
+	u8 flip_options = 0;
+	u8 palette_number = 0;
+	u16 tile_pixel_y = 0;
+
+	//Determine meta Y-coordinate of rendered BG pixels
+	u16 meta_y = ((current_scanline + lcd_stat.bg_offset_y[bg_id]) % lcd_stat.mode_0_height[bg_id]);
+
+	//Determine the Y coordinate of the BG's tiles on the tile map
+	u16 current_tile_pixel_y = ((current_scanline + lcd_stat.bg_offset_y[bg_id]) % 256);
 
-		//BG Mode 3
-		case 3:
-			return render_bg_mode_3(); break;
+	//Handle mosiac tiles
+	if(lcd_stat.bg_mosiac[bg_id] && lcd_stat.bg_mos_vsize) { current_tile_pixel_y = ((current_tile_pixel_y / lcd_stat.bg_mos_vsize) * lcd_stat.bg_mos_vsize); }
 
-		//BG Mode 4
-		case 4:
-			return render_bg_mode_4(); break;
+	for(u32 x = 0; x < 240; x++)
+	{
+		//Determine meta x-coordinate and tile map X coordinate of rendered BG pixel
+		u16 meta_x = ((x + lcd_stat.bg_offset_x[bg_id]) % lcd_stat.mode_0_width[bg_id]);
+		u16 current_tile_pixel_x = ((x + lcd_stat.bg_offset_x[bg_id]) % 256);
 
-		//BG Mode 5
-		case 5:
-			return render_bg_mode_5(); break;
+		//Grab a new map entry at the start of each tile
+		if((x == 0) || ((current_tile_pixel_x & 0x7) == 0))
+		{
+			//Determine the address offset for the screen
+			switch(lcd_stat.bg_size[bg_id])
+			{
+				//Size 0 - 256x256
+				case 0x0: screen_offset = 0; break;
 
-		default:
-			//std::cout<<"LCD::invalid or unsupported BG Mode : " << std::dec << (lcd_stat.display_control & 0x7);
-			return false;
+				//Size 1 - 512x256
+				case 0x1: 
+					screen_offset = lcd_stat.screen_offset_lut[meta_x];
+					break;
+
+				//Size 2 - 256x512
+				case 0x2:
+					screen_offset = lcd_stat.screen_offset_lut[meta_y];
+					break;
+
+				//Size 3 - 512x512
+				case 0x3:
+					screen_offset = (meta_y > 255) ? (lcd_stat.screen_offset_lut[meta_x] | 0x1000) : lcd_stat.screen_offset_lut[meta_x];
+					break;
+			}
+
+			//Add screen offset to current BG map base address
+			map_base_addr = lcd_stat.bg_base_map_addr[bg_id] + screen_offset;
+
+			//Get current map entry and grab the map's data
+			u16 tile_number = lcd_stat.bg_num_lut[current_tile_pixel_x][current_tile_pixel_y];
+			u16 map_data = mem->read_u16_fast(map_base_addr + (tile_number * 2));
+
+			//Grab horizontal and vertical flipping options, and the Palette number of the tile
+			flip_options = (map_data >> 10) & 0x3;
+			palette_number = (map_data >> 12);
+
+			//Get address of Tile #(map_entry)
+			tile_addr = lcd_stat.bg_base_tile_addr[bg_id] + ((map_data & 0x3FF) * (lcd_stat.bg_depth[bg_id] << 3));
+			tile_data = mem->memory_map.get_region_ptr(tile_addr, (lcd_stat.bg_depth[bg_id] << 3));
+
+			//Vertical flip
+			tile_pixel_y = (flip_options & 0x2) ? lcd_stat.bg_flip_lut[current_tile_pixel_y] : current_tile_pixel_y;
+		}
+
+		//Horizontal flip
+		if(flip_options & 0x1) { current_tile_pixel_x = lcd_stat.bg_flip_lut[current_tile_pixel_x]; }
+
+		u8 current_tile_pixel = lcd_stat.bg_tile_lut[current_tile_pixel_x][tile_pixel_y];
+		u16 pal_index = 0;
+		u8 raw_color = 0;
+
+		//Grab the byte corresponding to (current_tile_pixel) - 4-bit version
+		if(lcd_stat.bg_depth[bg_id] == 4)
+		{
+			u32 offset = (current_tile_pixel >> 1);
+			raw_color = (tile_data != NULL) ? tile_data[offset] : mem->memory_map[tile_addr + offset];
+
+			if((current_tile_pixel % 2) == 0) { raw_color &= 0xF; }
+			else { raw_color >>= 4; }
+
+			pal_index = ((palette_number * 32) + (raw_color * 2)) >> 1;
+		}
+
+		//Grab the byte corresponding to (current_tile_pixel) - 8-bit version
+		else
+		{
+			raw_color = (tile_data != NULL) ? tile_data[current_tile_pixel] : mem->memory_map[tile_addr + current_tile_pixel];
+			pal_index = raw_color;
+		}
+
+		//If the bg color is transparent, skip drawing, otherwise render it as ARGB
+		bg_line_opaque[bg_id][x] = (raw_color != 0);
+
+		if(raw_color != 0)
+		{
+			bg_line_color[bg_id][x] = pal[pal_index][0];
+			bg_line_raw[bg_id][x] = raw_pal[pal_index][0];
+		}
 	}
 }
 
+/****** Determines if a background pixel should be rendered, and if so draws it to the current scanline pixel ******/
+bool AGB_LCD::render_bg_pixel(u32 bg_control)
+{
+	u8 bg_id = (bg_control - 0x4000008) >> 1;
+	u32 x = scanline_pixel_counter;
+
+	if(!bg_line_opaque[bg_id][x]) { return false; }
+
+	scanline_buffer[x] = bg_line_color[bg_id][x];
+	last_raw_color = bg_line_raw[bg_id][x];
+
+	return true;
+}
+
 /****** Render BG Mode 0 ******/
 bool AGB_LCD::render_bg_mode_0(u32 bg_control)
 {
@@ -1009,82 +1183,73 @@ bool AGB_LCD::render_bg_mode_5()
 	return true;
 }
 
-/****** Render pixels for a given scanline (per-pixel) ******/
-void AGB_LCD::render_scanline()
+/****** Determines the window status of every pixel on the current scanline ******/
+void AGB_LCD::render_window_line()
 {
-	bool obj_render = false;
-	bool winout = false;
-	lcd_stat.in_window = false;
-	lcd_stat.current_window = 0;
-	last_obj_priority = 0xFF;
-	last_bg_priority = 0x5;
-	last_obj_mode = 0;
-	last_raw_color = raw_pal[0][0];
-	obj_win_pixel = false;
-	u8 bg_render_list[4];
-	u8 bg_id;
-
-	//Render sprites
-	obj_render = render_sprite_pixel();
+	bool check_y[2] = { false, false };
 
-	bool check_x = false;
-	bool check_y = false;
-
-	//Determine window status of this pixel
-	if(lcd_stat.window_enable[0])
+	//Vertical window bounds only change per scanline
+	for(u32 y = 0; y < 2; y++)
 	{
-		if((lcd_stat.window_x1[0] <= lcd_stat.window_x2[0]) && (scanline_pixel_counter >= lcd_stat.window_x1[0]) && (scanline_pixel_counter <= lcd_stat.window_x2[0]))
+		if((lcd_stat.window_y1[y] <= lcd_stat.window_y2[y]) && (current_scanline >= lcd_stat.window_y1[y]) && (current_scanline < lcd_stat.window_y2[y]))
 		{
-			check_x = true;
+			check_y[y] = true;
 		}
 
-		else if((lcd_stat.window_x1[0] > lcd_stat.window_x2[0]) && ((scanline_pixel_counter >= lcd_stat.window_x1[0]) || (scanline_pixel_counter <= lcd_stat.window_x2[0])))
+		else if((lcd_stat.window_y1[y] > lcd_stat.window_y2[y]) && ((current_scanline >= lcd_stat.window_y1[y]) || (current_scanline < lcd_stat.window_y2[y])))
 		{
-			check_x = true;
+			check_y[y] = true;
 		}
-
-		if((lcd_stat.window_y1[0] <= lcd_stat.window_y2[0]) && (current_scanline >= lcd_stat.window_y1[0]) && (current_scanline < lcd_stat.window_y2[0]))
-		{
-			check_y = true;
-		}
-
-		else if((lcd_stat.window_y1[0] > lcd_stat.window_y2[0]) && ((current_scanline >= lcd_stat.window_y1[0]) || (current_scanline < lcd_stat.window_y2[0])))
-		{
-			check_y = true;
-		}
-		
-		if(check_x && check_y) { lcd_stat.in_window = true; lcd_stat.current_window = 0; }
 	}
 
-	
-	if((lcd_stat.window_enable[1]) && (!lcd_stat.in_window))
+	for(u32 x = 0; x < 240; x++)
 	{
-		check_x = false;
-		check_y = false;
+		win_line_inside[x] = false;
+		win_line_id[x] = 0;
 
-		if((lcd_stat.window_x1[1] <= lcd_stat.window_x2[1]) && (scanline_pixel_counter >= lcd_stat.window_x1[1]) && (scanline_pixel_counter <= lcd_stat.window_x2[1]))
+		//Window 0 takes priority over Window 1
+		for(u32 y = 0; y < 2; y++)
 		{
-			check_x = true;
-		}
+			if((!lcd_stat.window_enable[y]) || (!check_y[y])) { continue; }
 
-		else if((lcd_stat.window_x1[1] > lcd_stat.window_x2[1]) && ((scanline_pixel_counter >= lcd_stat.window_x1[1]) || (scanline_pixel_counter <= lcd_stat.window_x2[1])))
-		{
-			check_x = true;
-		}
+			bool check_x = false;
 
-		if((lcd_stat.window_y1[1] <= lcd_stat.window_y2[1]) && (current_scanline >= lcd_stat.window_y1[1]) && (current_scanline < lcd_stat.window_y2[1]))
-		{
-			check_y = true;
-		}
+			if((lcd_stat.window_x1[y] <= lcd_stat.window_x2[y]) && (x >= lcd_stat.window_x1[y]) && (x <= lcd_stat.window_x2[y]))
+			{
+				check_x = true;
+			}
 
-		else if((lcd_stat.window_y1[1] > lcd_stat.window_y2[1]) && ((current_scanline >= lcd_stat.window_y1[1]) || (current_scanline < lcd_stat.window_y2[1])))
-		{
-			check_y = true;
-		}
+			else if((lcd_stat.window_x1[y] > lcd_stat.window_x2[y]) && ((x >= lcd_stat.window_x1[y]) || (x <= lcd_stat.window_x2[y])))
+			{
+				check_x = true;
+			}
 		
-		if(check_x && check_y) { lcd_stat.in_window = true; lcd_stat.current_window = 1; }
+			if(check_x)
+			{
+				win_line_inside[x] = true;
+				win_line_id[x] = y;
+				break;
+			}
+		}
 	}
-	
+}
+
+/****** Composites the OBJ and BG line buffers for the current scanline pixel ******/
+void AGB_LCD::render_pixel()
+{
+	bool obj_render = false;
+	bool winout = false;
+	lcd_stat.in_window = win_line_inside[scanline_pixel_counter];
+	lcd_stat.current_window = win_line_id[scanline_pixel_counter];
+	last_obj_priority = 0xFF;
+	last_bg_priority = 0x5;
+	last_obj_mode = 0;
+	last_raw_color = raw_pal[0][0];
+	obj_win_pixel = false;
+	u8 bg_id;
+
+	//Render sprites
+	obj_render = render_sprite_pixel();
 
 	//Turn off OBJ rendering if in/out of a window where OBJ rendering is disabled
 	if((lcd_stat.obj_win_enable) && (obj_win_pixel)) { }
@@ -1097,15 +1262,6 @@ void AGB_LCD::render_scanline()
 	//Determine WINOUT status
 	winout = (lcd_stat.obj_win_enable || lcd_stat.window_enable[0] || lcd_stat.window_enable[1]);
 
-	//Determine BG rendering priority
-	for(int x = 0, list_length = 0; x < 4; x++)
-	{
-		if(lcd_stat.bg_priority[0] == x) { bg_render_list[list_length++] = 0; }
-		if(lcd_stat.bg_priority[1] == x) { bg_render_list[list_length++] = 1; }
-		if(lcd_stat.bg_priority[2] == x) { bg_render_list[list_length++] = 2; }
-		if(lcd_stat.bg_priority[3] == x) { bg_render_list[list_length++] = 3; }
-	}
-
 	//Render BGs based on priority (3 is the 'lowest', 0 is the 'highest')
 	for(int x = 0; x < 4; x++)
 	{
@@ -1131,6 +1287,33 @@ void AGB_LCD::render_scanline()
 	if(!obj_render) { scanline_buffer[scanline_pixel_counter] = pal[0][0]; }
 }
 
+/****** Render pixels for a given scanline (per-line) ******/
+void AGB_LCD::render_scanline()
+{
+	//Draw each layer for the whole line
+	render_obj_line();
+	for(u8 x = 0; x < 4; x++) { render_bg_line(x); }
+
+	//Determine window status for the whole line
+	render_window_line();
+
+	//Determine BG rendering priority
+	for(int x = 0, list_length = 0; x < 4; x++)
+	{
+		if(lcd_stat.bg_priority[0] == x) { bg_render_list[list_length++] = 0; }
+		if(lcd_stat.bg_priority[1] == x) { bg_render_list[list_length++] = 1; }
+		if(lcd_stat.bg_priority[2] == x) { bg_render_list[list_length++] = 2; }
+		if(lcd_stat.bg_priority[3] == x) { bg_render_list[list_length++] = 3; }
+	}
+
+	//Composite all layers and apply SFX
+	for(scanline_pixel_counter = 0; scanline_pixel_counter < 240; scanline_pixel_counter++)
+	{
+		render_pixel();
+		if(lcd_stat.current_sfx_type != NORMAL) { apply_sfx(); }
+	}
+}
+
 /****** Applies the GBA's SFX to a pixel ******/
 void AGB_LCD::apply_sfx()
 {
@@ -1351,18 +1534,24 @@ void AGB_LCD::update()
 	//Use SDL
 	if(config::sdl_render)
 	{
-		//Lock source surface
-		if(SDL_MUSTLOCK(final_screen)){ SDL_LockSurface(final_screen); }
-		u32* out_pixel_data = (u32*)final_screen->pixels;
+		//Show the last filtered frame, the current one is still being filtered
+		if(filter.is_active()) { filter.present(final_screen); }
 
-		for(int a = 0; a < 0x9600; a++)
+		else
 		{
-			out_pixel_data[a] = screen_buffer[a];
-			if(mem->sub_screen_buffer.size()) { out_pixel_data[0x9600 + a] = mem->sub_screen_buffer[a]; }
-		}
+			//Lock source surface
+			if(SDL_MUSTLOCK(final_screen)){ SDL_LockSurface(final_screen); }
+			u32* out_pixel_data = (u32*)final_screen->pixels;
 
-		//Unlock source surface
-		if(SDL_MUSTLOCK(final_screen)){ SDL_UnlockSurface(final_screen); }
+			for(int a = 0; a < 0x9600; a++)
+			{
+				out_pixel_data[a] = screen_buffer[a];
+				if(mem->sub_screen_buffer.size()) { out_pixel_data[0x9600 + a] = mem->sub_screen_buffer[a]; }
+			}
+
+			//Unlock source surface
+			if(SDL_MUSTLOCK(final_screen)){ SDL_UnlockSurface(final_screen); }
+		}
 		
 		//Display final screen buffer - OpenGL
 		if(config::use_opengl) { opengl_blit(); }
@@ -1426,6 +1615,18 @@ void AGB_LCD::clear_screen_buffer(u32 color)
 	for(u32 x = 0; x < 0x9600; x++) { screen_buffer[x] = color; }
 }
 
+/****** Sends the current frame to the software filter ******/
+void AGB_LCD::submit_filter_frame()
+{
+	//The filter expects both screens in one buffer, like the GUI
+	if((mem->sub_screen_buffer.size()) && (screen_buffer.size() >= 0x12C00))
+	{
+		for(int a = 0; a < 0x9600; a++) { screen_buffer[0x9600 + a] = mem->sub_screen_buffer[a]; }
+	}
+
+	filter.submit(&screen_buffer[0]);
+}
+
 /****** Run LCD for one cycle ******/
 void AGB_LCD::step()
 {
@@ -1480,13 +1681,6 @@ void AGB_LCD::step()
 			}
 		}
 
-		//Render scanline data (per-pixel every 4 cycles)
-		if((lcd_clock % 4) == 0) 
-		{
-			render_scanline();
-			if(lcd_stat.current_sfx_type != NORMAL) { apply_sfx(); }
-			scanline_pixel_counter++;
-		}
 	}
 
 	//Mode 1 - H-Blank
@@ -1499,18 +1693,21 @@ void AGB_LCD::step()
 			mem->memory_map[DISPSTAT] |= 0x2;
 
 			lcd_mode = 1;
-			scanline_pixel_counter = 0;
 
 			//Raise HBlank interrupt
 			if(mem->memory_map[DISPSTAT] & 0x10) { mem->memory_map[REG_IF] |= 0x2; }
 
-			//Push scanline data to final buffer - Only if Forced Blank is disabled
+			//Render scanline data and push it to final buffer - Only if Forced Blank is disabled
 			if((lcd_stat.display_control & 0x80) == 0)
 			{
+				render_scanline();
+
 				for(int x = 0, y = (240 * current_scanline); x < 240; x++, y++)
 				{
 					screen_buffer[y] = scanline_buffer[x];
 				}
+
+				scanline_pixel_counter = 0;
 			}
 
 			//Draw all-white during Forced Blank
@@ -1603,6 +1800,10 @@ void AGB_LCD::step()
 			//Jukebox
 			if((config::cart_type == AGB_JUKEBOX) && (mem->jukebox.progress)) { mem->process_jukebox(); }
 
+			//Finish loading any audio converted in the background
+			if((config::cart_type == AGB_JUKEBOX) && ((!mem->jukebox.pending_audio_file.empty()) || (!mem->jukebox.pending_karaoke_file.empty()))) { mem->jukebox_check_pending_audio(); }
+			else if((config::cart_type == AGB_PLAY_YAN) && (!mem->play_yan.pending_audio_file.empty())) { mem->play_yan_check_pending_audio(); }
+
 			//Process Turbo Buttons
 			if(mem->g_pad->turbo_button_enabled) { mem->g_pad->process_turbo_buttons(); }
 
@@ -1612,18 +1813,31 @@ void AGB_LCD::step()
 				//If using SDL and no OpenGL, manually stretch for fullscreen via SDL
 				if((config::flags & SDL_WINDOW_FULLSCREEN) && (!config::use_opengl))
 				{
-					//Lock source surface
-					if(SDL_MUSTLOCK(original_screen)){ SDL_LockSurface(original_screen); }
-					u32* out_pixel_data = (u32*)original_screen->pixels;
+					SDL_Surface* source_screen = original_screen;
 
-					for(int a = 0; a < 0x9600; a++)
+					//Stretch the last filtered frame instead
+					if(filter.is_active())
 					{
-						out_pixel_data[a] = screen_buffer[a];
-						if(mem->sub_screen_buffer.size()) { out_pixel_data[0x9600 + a] = mem->sub_screen_buffer[a]; }
+						submit_filter_frame();
+						filter.present(filtered_screen);
+						source_screen = filtered_screen;
 					}
 
-					//Unlock source surface
-					if(SDL_MUSTLOCK(original_screen)){ SDL_UnlockSurface(original_screen); }
+					else
+					{
+						//Lock source surface
+						if(SDL_MUSTLOCK(original_screen)){ SDL_LockSurface(original_screen); }
+						u32* out_pixel_data = (u32*)original_screen->pixels;
+
+						for(int a = 0; a < 0x9600; a++)
+						{
+							out_pixel_data[a] = screen_buffer[a];
+							if(mem->sub_screen_buffer.size()) { out_pixel_data[0x9600 + a] = mem->sub_screen_buffer[a]; }
+						}
+
+						//Unlock source surface
+						if(SDL_MUSTLOCK(original_screen)){ SDL_UnlockSurface(original_screen); }
+					}
 		
 					//Blit the original surface to the final stretched one
 					SDL_Rect dest_rect;
@@ -1631,7 +1845,7 @@ void AGB_LCD::step()
 					dest_rect.h = config::sys_height * max_fullscreen_ratio;
 					dest_rect.x = ((config::win_width - dest_rect.w) >> 1);
 					dest_rect.y = ((config::win_height - dest_rect.h) >> 1);
-					SDL_BlitScaled(original_screen, NULL, final_screen, &dest_rect);
+					SDL_BlitScaled(source_screen, NULL, final_screen, &dest_rect);
 
 					if(SDL_UpdateWindowSurface(window) != 0)
 					{
@@ -1652,18 +1866,28 @@ void AGB_LCD::step()
 				//Otherwise, render normally (SDL 1:1, OpenGL handles its own stretching)
 				else
 				{
-					//Lock source surface
-					if(SDL_MUSTLOCK(final_screen)){ SDL_LockSurface(final_screen); }
-					u32* out_pixel_data = (u32*)final_screen->pixels;
-
-					for(int a = 0; a < 0x9600; a++)
+					//Hand the frame to the software filter, then show the last one it finished
+					if(filter.is_active())
 					{
-						out_pixel_data[a] = screen_buffer[a];
-						if(mem->sub_screen_buffer.size()) { out_pixel_data[0x9600 + a] = mem->sub_screen_buffer[a]; }
+						submit_filter_frame();
+						filter.present(final_screen);
 					}
 
-					//Unlock source surface
-					if(SDL_MUSTLOCK(final_screen)){ SDL_UnlockSurface(final_screen); }
+					else
+					{
+						//Lock source surface
+						if(SDL_MUSTLOCK(final_screen)){ SDL_LockSurface(final_screen); }
+						u32* out_pixel_data = (u32*)final_screen->pixels;
+
+						for(int a = 0; a < 0x9600; a++)
+						{
+							out_pixel_data[a] = screen_buffer[a];
+							if(mem->sub_screen_buffer.size()) { out_pixel_data[0x9600 + a] = mem->sub_screen_buffer[a]; }
+						}
+
+						//Unlock source surface
+						if(SDL_MUSTLOCK(final_screen)){ SDL_UnlockSurface(final_screen); }
+					}
 		
 					//Display final screen buffer - OpenGL
 					if(config::use_opengl) { opengl_blit(); }
@@ -1803,6 +2027,39 @@ void AGB_LCD::step()
 	}
 }
 
+/****** Returns the number of cycles until the LCD next needs to step ******/
+u32 AGB_LCD::get_next_event()
+{
+	u32 line_clock = lcd_clock % 1232;
+
+	//Mode 0 - Step on mode changes, scanline increments, and the transition into H-Blank where the scanline is rendered
+	if((line_clock <= 960) && (lcd_clock < 197120))
+	{
+		if((lcd_mode != 0) || (mem->memory_map[DISPSTAT] & 0x2)) { return 1; }
+		return (961 - line_clock);
+	}
+
+	//Mode 1 - Step on mode changes, cheats, and the start of the next line
+	else if(lcd_clock < 197120)
+	{
+		if(lcd_mode != 1) { return 1; }
+		if((config::use_cheats) && ((current_scanline & 0x7) == 0)) { return 1; }
+		return (1232 - line_clock);
+	}
+
+	//Mode 2 - Step on mode changes, VBlank flag changes, HBlank, and the start of the next line
+	else
+	{
+		if(lcd_mode != 2) { return 1; }
+
+		bool vblank_flag = (mem->memory_map[DISPSTAT] & 0x1) ? true : false;
+		if(vblank_flag != (current_scanline < 227)) { return 1; }
+
+		if(line_clock < 960) { return (960 - line_clock); }
+		return (1232 - line_clock);
+	}
+}
+
 /****** Compare VCOUNT to LYC ******/
 void AGB_LCD::scanline_compare()
 {
@@ -1888,100 +2145,87 @@ void AGB_LCD::reload_affine_references(u32 bg_control)
 }
 
 /****** Read LCD data from save state ******/
-bool AGB_LCD::lcd_read(u32 offset, std::string filename)
+bool AGB_LCD::lcd_read(save_state_buffer& state)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary);
-	
-	if(!file.is_open()) { return false; }
-
-	//Go to offset
-	file.seekg(offset);
-
 	//Serialize LCD data from save state
-	file.read((char*)&lcd_stat, sizeof(lcd_stat));
+	state.read((char*)&lcd_stat, sizeof(lcd_stat));
 
 	//Serialize OBJ data from save state
 	for(int x = 0; x < 128; x++)
 	{
-		file.read((char*)&obj[x], sizeof(obj[x]));
-		file.read((char*)&obj_render_list[x], sizeof(obj_render_list[x]));
+		state.read((char*)&obj[x], sizeof(obj[x]));
+		state.read((char*)&obj_render_list[x], sizeof(obj_render_list[x]));
 	}
 
 	//Serialize Misc LCD data from save state
-	file.read((char*)&lcd_mode, sizeof(lcd_mode));
-	file.read((char*)&current_scanline, sizeof(current_scanline));
-	file.read((char*)&lcd_clock, sizeof(lcd_clock));
-	file.read((char*)&obj_render_length, sizeof(obj_render_length));
-	file.read((char*)&last_obj_priority, sizeof(last_obj_priority));
-	file.read((char*)&last_obj_mode, sizeof(last_obj_mode));
-	file.read((char*)&last_bg_priority, sizeof(last_bg_priority));
-	file.read((char*)&last_raw_color, sizeof(last_raw_color));
-	file.read((char*)&obj_win_pixel, sizeof(obj_win_pixel));
-	file.read((char*)&scanline_pixel_counter, sizeof(scanline_pixel_counter));
+	state.read((char*)&lcd_mode, sizeof(lcd_mode));
+	state.read((char*)&current_scanline, sizeof(current_scanline));
+	state.read((char*)&lcd_clock, sizeof(lcd_clock));
+	state.read((char*)&obj_render_length, sizeof(obj_render_length));
+	state.read((char*)&last_obj_priority, sizeof(last_obj_priority));
+	state.read((char*)&last_obj_mode, sizeof(last_obj_mode));
+	state.read((char*)&last_bg_priority, sizeof(last_bg_priority));
+	state.read((char*)&last_raw_color, sizeof(last_raw_color));
+	state.read((char*)&obj_win_pixel, sizeof(obj_win_pixel));
+	state.read((char*)&scanline_pixel_counter, sizeof(scanline_pixel_counter));
 
 	for(int x = 0; x < 256; x++)
 	{
 		for(int y = 0; y < 2; y++)
 		{
-			file.read((char*)&pal[x][y], sizeof(pal[x][y]));
-			file.read((char*)&raw_pal[x][y], sizeof(raw_pal[x][y]));
+			state.read((char*)&pal[x][y], sizeof(pal[x][y]));
+			state.read((char*)&raw_pal[x][y], sizeof(raw_pal[x][y]));
 		}
 	}
 
 	for(int x = 0; x < 4; x++)
 	{
-		file.read((char*)&bg_offset_x[x], sizeof(bg_offset_x[x]));
-		file.read((char*)&bg_offset_y[x], sizeof(bg_offset_y[x]));
+		state.read((char*)&bg_offset_x[x], sizeof(bg_offset_x[x]));
+		state.read((char*)&bg_offset_y[x], sizeof(bg_offset_y[x]));
 	}
 
-	file.close();
-	return true;
+	return state.good();
 }
 
 /****** Read LCD data from save state ******/
-bool AGB_LCD::lcd_write(std::string filename)
+bool AGB_LCD::lcd_write(save_state_buffer& state)
 {
-	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::app);
-	
-	if(!file.is_open()) { return false; }
-
 	//Serialize LCD data to save state
-	file.write((char*)&lcd_stat, sizeof(lcd_stat));
+	state.write((char*)&lcd_stat, sizeof(lcd_stat));
 
 	//Serialize OBJ data to save state
 	for(int x = 0; x < 128; x++)
 	{
-		file.write((char*)&obj[x], sizeof(obj[x]));
-		file.write((char*)&obj_render_list[x], sizeof(obj_render_list[x]));
+		state.write((char*)&obj[x], sizeof(obj[x]));
+		state.write((char*)&obj_render_list[x], sizeof(obj_render_list[x]));
 	}
 
 	//Serialize Misc LCD data to save state
-	file.write((char*)&lcd_mode, sizeof(lcd_mode));
-	file.write((char*)&current_scanline, sizeof(current_scanline));
-	file.write((char*)&lcd_clock, sizeof(lcd_clock));
-	file.write((char*)&obj_render_length, sizeof(obj_render_length));
-	file.write((char*)&last_obj_priority, sizeof(last_obj_priority));
-	file.write((char*)&last_obj_mode, sizeof(last_obj_mode));
-	file.write((char*)&last_bg_priority, sizeof(last_bg_priority));
-	file.write((char*)&last_raw_color, sizeof(last_raw_color));
-	file.write((char*)&obj_win_pixel, sizeof(obj_win_pixel));
-	file.write((char*)&scanline_pixel_counter, sizeof(scanline_pixel_counter));
+	state.write((char*)&lcd_mode, sizeof(lcd_mode));
+	state.write((char*)&current_scanline, sizeof(current_scanline));
+	state.write((char*)&lcd_clock, sizeof(lcd_clock));
+	state.write((char*)&obj_render_length, sizeof(obj_render_length));
+	state.write((char*)&last_obj_priority, sizeof(last_obj_priority));
+	state.write((char*)&last_obj_mode, sizeof(last_obj_mode));
+	state.write((char*)&last_bg_priority, sizeof(last_bg_priority));
+	state.write((char*)&last_raw_color, sizeof(last_raw_color));
+	state.write((char*)&obj_win_pixel, sizeof(obj_win_pixel));
+	state.write((char*)&scanline_pixel_counter, sizeof(scanline_pixel_counter));
 
 	for(int x = 0; x < 256; x++)
 	{
 		for(int y = 0; y < 2; y++)
 		{
-			file.write((char*)&pal[x][y], sizeof(pal[x][y]));
-			file.write((char*)&raw_pal[x][y], sizeof(raw_pal[x][y]));
+			state.write((char*)&pal[x][y], sizeof(pal[x][y]));
+			state.write((char*)&raw_pal[x][y], sizeof(raw_pal[x][y]));
 		}
 	}
 
 	for(int x = 0; x < 4; x++)
 	{
-		file.write((char*)&bg_offset_x[x], sizeof(bg_offset_x[x]));
-		file.write((char*)&bg_offset_y[x], sizeof(bg_offset_y[x]));
+		state.write((char*)&bg_offset_x[x], sizeof(bg_offset_x[x]));
+		state.write((char*)&bg_offset_y[x], sizeof(bg_offset_y[x]));
 	}
 
-	file.close();
 	return true;
 }
@@ -12,6 +12,7 @@
 #include "SDL2/SDL.h"
 #include "SDL2/SDL_opengl.h"
 #include "mmu.h"
+#include "common/sw_filter.h"
 
 #ifndef GBA_LCD
 #define GBA_LCD
@@ -31,6 +32,7 @@ class AGB_LCD
 	~AGB_LCD();
 
 	void step();
+	u32 get_next_event();
 	void reset();
 	bool init();
 	bool opengl_init();
@@ -38,14 +40,18 @@ class AGB_LCD
 	void clear_screen_buffer(u32 color);
 
 	//Serialize data for save state loading/saving
-	bool lcd_read(u32 offset, std::string filename);
-	bool lcd_write(std::string filename);
+	bool lcd_read(save_state_buffer& state);
+	bool lcd_write(save_state_buffer& state);
 
 	//Screen data
 	SDL_Window* window;
 	SDL_Surface* final_screen;
 	SDL_Surface* original_screen;
 
+	//Software filter output when stretched to fullscreen
+	SDL_Surface* filtered_screen;
+	sw_filter filter;
+
 	//OpenGL data
 	#ifdef GBE_OGL
 	SDL_GLContext gl_context;
@@ -71,6 +77,7 @@ class AGB_LCD
 	void update_obj_render_list();
 
 	void opengl_blit();
+	void submit_filter_frame();
 
 	struct oam_entries
 	{
@@ -140,6 +147,22 @@ class AGB_LCD
 
 	u32 scanline_pixel_counter;
 
+	//Per-line layer buffers
+	u32 bg_line_color[4][240];
+	u16 bg_line_raw[4][240];
+	bool bg_line_opaque[4][240];
+
+	u32 obj_line_color[240];
+	u16 obj_line_raw[240];
+	u8 obj_line_priority[240];
+	u8 obj_line_mode[240];
+	bool obj_line_opaque[240];
+	bool obj_line_win[240];
+
+	bool win_line_inside[240];
+	u8 win_line_id[240];
+	u8 bg_render_list[4];
+
 	int frame_start_time;
 	int frame_current_time;
 	int fps_count;
@@ -149,6 +172,11 @@ class AGB_LCD
 	bool try_window_rebuild;
 
 	void render_scanline();
+	void render_pixel();
+	void render_obj_line();
+	void render_bg_line(u8 bg_id);
+	void render_bg_line_mode_0(u8 bg_id);
+	void render_window_line();
 	bool render_sprite_pixel();
 	bool render_bg_pixel(u32 bg_control);
 	bool render_bg_mode_0(u32 bg_control);
@@ -0,0 +1,225 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : mjpeg_stream.cpp
+// Date : October 16, 2026
+// Description : MJPEG video stream
+//
+// Decodes frames from an MJPEG AVI file ahead of playback on a background thread
+// Decoded frames are kept in a small pool and handed to the Play-Yan as they are needed
+
+#ifdef GBE_IMAGE_FORMATS
+#include <SDL2/SDL_image.h>
+#endif
+
+#include <iostream>
+#include <cstring>
+
+#include "mjpeg_stream.h"
+
+/****** MJPEG stream constructor ******/
+mjpeg_stream::mjpeg_stream()
+{
+	thread = NULL;
+	lock = NULL;
+	work_ready = NULL;
+	quit = false;
+	next_frame = 0;
+
+	for(u32 x = 0; x < MJPEG_DECODE_AHEAD; x++)
+	{
+		pool[x].index = 0xFFFFFFFF;
+		pool[x].ready = false;
+		pool[x].width = 0;
+		pool[x].height = 0;
+		pool[x].pitch = 0;
+	}
+}
+
+/****** MJPEG stream destructor ******/
+mjpeg_stream::~mjpeg_stream()
+{
+	close();
+}
+
+/****** Opens a video and starts decoding from the first frame ******/
+bool mjpeg_stream::open(std::string filename)
+{
+	close();
+
+	if(!reader.open(filename)) { return false; }
+
+	next_frame = 0;
+	quit = false;
+
+	lock = SDL_CreateMutex();
+	work_ready = SDL_CreateCond();
+
+	if((lock != NULL) && (work_ready != NULL)) { thread = SDL_CreateThread(decoder_main, "mjpeg_decoder", this); }
+
+	//Frames are still decoded on demand without a decoder thread
+	if(thread == NULL)
+	{
+		std::cout<<"GBE::Warning - Could not create video decoder thread : " << SDL_GetError() << "\n";
+	}
+
+	return true;
+}
+
+/****** Stops the decoder thread and closes the video ******/
+void mjpeg_stream::close()
+{
+	if(thread != NULL)
+	{
+		SDL_LockMutex(lock);
+		quit = true;
+		SDL_CondSignal(work_ready);
+		SDL_UnlockMutex(lock);
+
+		SDL_WaitThread(thread, NULL);
+		thread = NULL;
+	}
+
+	if(work_ready != NULL) { SDL_DestroyCond(work_ready); }
+	if(lock != NULL) { SDL_DestroyMutex(lock); }
+
+	work_ready = NULL;
+	lock = NULL;
+
+	for(u32 x = 0; x < MJPEG_DECODE_AHEAD; x++)
+	{
+		pool[x].index = 0xFFFFFFFF;
+		pool[x].ready = false;
+	}
+
+	reader.close();
+}
+
+/****** Returns a decoded frame, then moves the decode-ahead window past it ******/
+bool mjpeg_stream::get_frame(u32 index, frame& output)
+{
+	bool result = false;
+
+	if(thread != NULL)
+	{
+		SDL_LockMutex(lock);
+
+		//Take the frame out of the pool, the old output buffer becomes the free slot
+		frame& slot = pool[index % MJPEG_DECODE_AHEAD];
+
+		if((slot.index == index) && (slot.ready))
+		{
+			output.index = slot.index;
+			output.width = slot.width;
+			output.height = slot.height;
+			output.pitch = slot.pitch;
+			output.pixels.swap(slot.pixels);
+			output.ready = true;
+
+			slot.ready = false;
+			slot.index = 0xFFFFFFFF;
+			result = true;
+		}
+
+		next_frame = index + 1;
+		SDL_CondSignal(work_ready);
+		SDL_UnlockMutex(lock);
+	}
+
+	//The decoder fell behind or is not running (seeking, first frame), so decode here
+	if(!result) { result = decode(reader, index, output, jpeg_data); }
+
+	return result;
+}
+
+/****** Decoder thread - Keeps the next frames after the last requested one decoded ******/
+int mjpeg_stream::decoder_main(void* ptr)
+{
+	mjpeg_stream* stream = (mjpeg_stream*)ptr;
+
+	frame work;
+	std::vector<u8> work_data;
+
+	SDL_LockMutex(stream->lock);
+
+	while(!stream->quit)
+	{
+		//Find the earliest frame in the window that has not been decoded yet
+		u32 target = 0xFFFFFFFF;
+		u32 frame_count = stream->reader.get_frame_count();
+
+		for(u32 x = stream->next_frame; (x < (stream->next_frame + MJPEG_DECODE_AHEAD)) && (x < frame_count); x++)
+		{
+			if(stream->pool[x % MJPEG_DECODE_AHEAD].index != x)
+			{
+				target = x;
+				break;
+			}
+		}
+
+		if(target == 0xFFFFFFFF)
+		{
+			SDL_CondWait(stream->work_ready, stream->lock);
+			continue;
+		}
+
+		SDL_UnlockMutex(stream->lock);
+		bool decoded = decode(stream->reader, target, work, work_data);
+		SDL_LockMutex(stream->lock);
+
+		//Only keep the frame if playback has not moved past it while decoding
+		//Frames that failed stay marked as not ready and are retried on demand
+		if((target >= stream->next_frame) && (target < (stream->next_frame + MJPEG_DECODE_AHEAD)))
+		{
+			frame& slot = stream->pool[target % MJPEG_DECODE_AHEAD];
+
+			slot.index = target;
+			slot.ready = decoded;
+
+			if(decoded)
+			{
+				slot.width = work.width;
+				slot.height = work.height;
+				slot.pitch = work.pitch;
+				slot.pixels.swap(work.pixels);
+			}
+		}
+	}
+
+	SDL_UnlockMutex(stream->lock);
+	return 0;
+}
+
+/****** Reads and decodes one JPEG frame ******/
+bool mjpeg_stream::decode(avi_reader& source, u32 index, frame& output, std::vector<u8>& jpeg_data)
+{
+	output.ready = false;
+
+	#ifdef GBE_IMAGE_FORMATS
+
+	if((!source.read_frame(index, jpeg_data)) || (jpeg_data.empty())) { return false; }
+
+	SDL_RWops* io_ops = SDL_RWFromMem(jpeg_data.data(), jpeg_data.size());
+	if(io_ops == NULL) { return false; }
+
+	SDL_Surface* temp_surface = IMG_LoadTyped_RW(io_ops, 1, "JPG");
+	if(temp_surface == NULL) { return false; }
+
+	output.index = index;
+	output.width = temp_surface->w;
+	output.height = temp_surface->h;
+	output.pitch = temp_surface->pitch;
+	output.pixels.resize(output.pitch * output.height);
+
+	if(SDL_MUSTLOCK(temp_surface)) { SDL_LockSurface(temp_surface); }
+	memcpy(&output.pixels[0], temp_surface->pixels, output.pixels.size());
+	if(SDL_MUSTLOCK(temp_surface)) { SDL_UnlockSurface(temp_surface); }
+
+	SDL_FreeSurface(temp_surface);
+	output.ready = true;
+
+	#endif
+
+	return output.ready;
+}
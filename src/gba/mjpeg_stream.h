@@ -0,0 +1,64 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : mjpeg_stream.h
+// Date : October 16, 2026
+// Description : MJPEG video stream
+//
+// Decodes frames from an MJPEG AVI file ahead of playback on a background thread
+// Decoded frames are kept in a small pool and handed to the Play-Yan as they are needed
+
+#ifndef GBA_MJPEG_STREAM
+#define GBA_MJPEG_STREAM
+
+#include "common/avi_reader.h"
+
+#define MJPEG_DECODE_AHEAD 4
+
+class mjpeg_stream
+{
+	public:
+
+	//Decoded frame as 24-bit RGB rows, exactly as SDL_image returns them
+	struct frame
+	{
+		u32 index;
+		bool ready;
+		u32 width;
+		u32 height;
+		u32 pitch;
+		std::vector<u8> pixels;
+	};
+
+	mjpeg_stream();
+	~mjpeg_stream();
+
+	mjpeg_stream(const mjpeg_stream&) = delete;
+	mjpeg_stream& operator=(const mjpeg_stream&) = delete;
+
+	bool open(std::string filename);
+	void close();
+
+	bool get_frame(u32 index, frame& output);
+	u32 get_frame_count() const { return reader.get_frame_count(); }
+
+	avi_reader reader;
+
+	private:
+
+	static int decoder_main(void* ptr);
+	static bool decode(avi_reader& source, u32 index, frame& output, std::vector<u8>& jpeg_data);
+
+	frame pool[MJPEG_DECODE_AHEAD];
+	u32 next_frame;
+
+	std::vector<u8> jpeg_data;
+
+	SDL_Thread* thread;
+	SDL_mutex* lock;
+	SDL_cond* work_ready;
+	bool quit;
+};
+
+#endif // GBA_MJPEG_STREAM
@@ -9,6 +9,7 @@
 // Handles reading and writing bytes to memory locations
 
 #include <filesystem>
+#include <cstring>
 
 #include "mmu.h"
 #include "common/util.h"
@@ -22,7 +23,10 @@ AGB_MMU::AGB_MMU()
 /****** MMU Deconstructor ******/
 AGB_MMU::~AGB_MMU() 
 { 
-	save_backup(config::save_file);
+	//Stop the journal before the final save, so a late compaction cannot replace it with older data
+	//Only drop the journal once the full save is safely on disk
+	backup.stop();
+	if(save_backup(config::save_file)) { backup.finish(); }
 	memory_map.clear();
 
 	#ifdef GBE_NETPLAY
@@ -46,8 +50,23 @@ AGB_MMU::~AGB_MMU()
 /****** MMU Reset ******/
 void AGB_MMU::reset()
 {
-	memory_map.clear();
-	memory_map.resize(0x10000000, 0);
+	//Setup memory regions, anything else in the 28-bit address space is allocated on demand
+	memory_map.reset(0x10000000);
+	memory_map.map_region(0x0000000, 0x4000);
+	memory_map.map_region(0x2000000, 0x40000);
+	memory_map.map_region(0x3000000, 0x8000);
+	memory_map.map_region(0x4000000, 0x10000);
+	memory_map.map_region(0x5000000, 0x8000);
+	memory_map.map_region(0x6000000, 0x18000);
+	memory_map.map_region(0x7000000, 0x8000);
+	memory_map.map_region(0x8000000, 0x2000000);
+	memory_map.map_region(0xE000000, 0x10000);
+
+	//ROM Waitstates 1 and 2 mirror Waitstate 0
+	memory_map.map_mirror(0xA000000, 0x2000000, 0x8000000);
+	memory_map.map_mirror(0xC000000, 0x1000000, 0x8000000);
+
+	rom_file.close();
 
 	eeprom.data.clear();
 	eeprom.data.resize(0x200, 0);
@@ -120,6 +139,8 @@ void AGB_MMU::reset()
 
 	gpio.rtc_control = 0x40;
 
+	update_page_tables();
+
 	gpio.solar_counter = 0;
 	gpio.adc_clear = 0;
 
@@ -173,6 +194,8 @@ void AGB_MMU::reset()
 
 	g_pad = NULL;
 	timer = NULL;
+	scheduler = NULL;
+	timer_polled = false;
 
 	//Advanced debugging
 	#ifdef GBE_DEBUG
@@ -187,6 +210,136 @@ void AGB_MMU::reset()
 	std::cout<<"MMU::Initialized\n";
 }
 
+/****** Builds page tables for memory that can be accessed without any special handling ******/
+void AGB_MMU::update_page_tables()
+{
+	for(u32 x = 0; x < 0x2000; x++)
+	{
+		read_page[x] = NULL;
+		write_page[x] = NULL;
+	}
+
+	for(u32 x = 0; x < 0x200; x++)
+	{
+		u32 offset = (x << 15);
+
+		//Slow WRAM 256KB mirror
+		read_page[0x400 + x] = write_page[0x400 + x] = &memory_map[0x2000000 + (offset & 0x3FFFF)];
+
+		//Fast WRAM 32KB mirror
+		read_page[0x600 + x] = write_page[0x600 + x] = &memory_map[0x3000000];
+
+		//Palette RAM and OAM 32KB mirrors - Writes need to update the LCD
+		read_page[0xA00 + x] = &memory_map[0x5000000];
+		read_page[0xE00 + x] = &memory_map[0x7000000];
+
+		//ROM Waitstate 0
+		if((config::cart_type != AGB_CAMPHO) && (config::cart_type != AGB_TV_TUNER)) { read_page[0x1000 + x] = &memory_map[0x8000000 + offset]; }
+		if(config::cart_type != AGB_PLAY_YAN) { read_page[0x1200 + x] = &memory_map[0x9000000 + offset]; }
+
+		//ROM Waitstate 1
+		if((config::cart_type != AGB_JUKEBOX) && (config::cart_type != AGB_PLAY_YAN) && (config::cart_type != AGB_CAMPHO) && (config::cart_type != AGB_TV_TUNER))
+		{
+			read_page[0x1400 + x] = read_page[0x1000 + x];
+			read_page[0x1600 + x] = &memory_map[0x9000000 + offset];
+		}
+
+		//ROM Waitstate 2
+		read_page[0x1800 + x] = &memory_map[0x8000000 + offset];
+	}
+
+	//BIOS
+	read_page[0] = &memory_map[0];
+	read_page[1] = &memory_map[0x8000];
+
+	//VRAM
+	for(u32 x = 0; x < 4; x++) { read_page[0xC00 + x] = write_page[0xC00 + x] = &memory_map[0x6000000 + (x << 15)]; }
+
+	//Cartridge registers mapped over ROM and its mirrors
+	for(u32 x = 0; x <= 0x800; x += 0x400)
+	{
+		if(gpio.type != GPIO_DISABLED) { read_page[(GPIO_DATA >> 15) + x] = NULL; }
+		if(config::cart_type == AGB_AM3) { read_page[(AM_BLK_ADDR >> 15) + x] = NULL; }
+	}
+
+	//Memory behind cached instructions may have changed
+	clear_code_cache();
+}
+
+/****** Returns the pre-decoded instruction slot for an address in IWRAM or ROM - NULL if code there is not cached ******/
+AGB_MMU::decoded_instruction* AGB_MMU::get_code_entry(u32 address)
+{
+	if(address >= 0x10000000) { return NULL; }
+
+	decoded_instruction* page = code_page[address >> 15];
+
+	if(page == NULL)
+	{
+		u8 region = (address >> 24);
+		u32 index = 0;
+
+		//Fast WRAM
+		if(region == 0x3) { index = 0; }
+
+		//ROM and its mirrors - Writes to ROM always land in Waitstate 0, so that page has to be plain memory as well
+		//AM3 cards swap firmware and card data into ROM, so never cache those
+		else if((region >= 0x8) && (region <= 0xD) && (config::cart_type != AGB_AM3))
+		{
+			index = ((address & 0x1FFFFFF) >> 15) + 1;
+			if((read_page[address >> 15] == NULL) || (read_page[0x1000 + index - 1] == NULL)) { return NULL; }
+		}
+
+		else { return NULL; }
+
+		if(code_cache[index].empty()) { code_cache[index].resize(0x4000); }
+		page = code_cache[index].data();
+
+		//Share the page with every mirror of the same memory
+		if(index == 0) { for(u32 x = 0x600; x < 0x800; x++) { code_page[x] = page; } }
+
+		else
+		{
+			for(u32 x = (0x1000 + index - 1); x < 0x1C00; x += 0x400)
+			{
+				if(read_page[x] != NULL) { code_page[x] = page; }
+			}
+		}
+	}
+
+	return &page[(address & 0x7FFF) >> 1];
+}
+
+/****** Drops pre-decoded instructions overlapping memory that was just written ******/
+void AGB_MMU::invalidate_code(u32 address, u32 length)
+{
+	u32 end = address + length;
+
+	//ARM instructions are cached at word boundaries, so writes to their upper halfword count too
+	address &= ~0x3;
+
+	while((address < end) && (address < 0x10000000))
+	{
+		u32 page_end = (address & ~0x7FFF) + 0x8000;
+		if(page_end > end) { page_end = end; }
+
+		decoded_instruction* page = code_page[address >> 15];
+
+		if(page != NULL)
+		{
+			for(u32 x = address; x < page_end; x += 2) { page[(x & 0x7FFF) >> 1].valid = false; }
+		}
+
+		address = page_end;
+	}
+}
+
+/****** Drops every pre-decoded instruction ******/
+void AGB_MMU::clear_code_cache()
+{
+	for(u32 x = 0; x < 0x2000; x++) { code_page[x] = NULL; }
+	for(u32 x = 0; x < 0x401; x++) { code_cache[x].clear(); }
+}
+
 /****** Read byte from memory ******/
 u8 AGB_MMU::read_u8(u32 address)
 {
@@ -194,6 +347,14 @@ u8 AGB_MMU::read_u8(u32 address)
 	#ifdef GBE_DEBUG
 	debug_read = true;
 	debug_addr[address & 0x3] = address;
+
+	//Plain memory can be read directly
+	#else
+	if(address < 0x10000000)
+	{
+		u8* page = read_page[address >> 15];
+		if(page != NULL) { return page[address & 0x7FFF]; }
+	}
 	#endif
 
 	//Check for unused memory and mirrors first
@@ -310,36 +471,23 @@ u8 AGB_MMU::read_u8(u32 address)
 
 	switch(address)
 	{
+		//Timer counters are only brought up to date when read
 		case TM0CNT_L:
-			return (timer->at(0).counter & 0xFF);
-			break;
-
 		case TM0CNT_L+1:
-			return (timer->at(0).counter >> 8);
-			break;
-
 		case TM1CNT_L:
-			return (timer->at(1).counter & 0xFF);
-			break;
-
 		case TM1CNT_L+1:
-			return (timer->at(1).counter >> 8);
-			break;
-
 		case TM2CNT_L:
-			return (timer->at(2).counter & 0xFF);
-			break;
-
 		case TM2CNT_L+1:
-			return (timer->at(2).counter >> 8);
-			break;
-
 		case TM3CNT_L:
-			return (timer->at(3).counter & 0xFF);
-			break;
-
 		case TM3CNT_L+1:
-			return (timer->at(3).counter >> 8);
+			{
+				u8 id = (address - TM0CNT_L) >> 2;
+				sync_timer(id);
+				timer_polled = true;
+
+				return (address & 0x1) ? (timer->at(id).counter >> 8) : (timer->at(id).counter & 0xFF);
+			}
+
 			break;
 
 		case KEYINPUT:
@@ -572,25 +720,59 @@ u8 AGB_MMU::read_u8(u32 address)
 /****** Read 2 bytes from memory ******/
 u16 AGB_MMU::read_u16(u32 address)
 {
+	//Plain memory within a single page can be read directly
+	#ifndef GBE_DEBUG
+	if((address < 0x10000000) && ((address & 0x7FFF) <= 0x7FFE))
+	{
+		u8* page = read_page[address >> 15];
+		
+		if(page != NULL)
+		{
+			page += (address & 0x7FFF);
+			return (page[0] | (page[1] << 8));
+		}
+	}
+	#endif
+
 	return (read_u8(address) | (read_u8(address+1) << 8) ); 
 }
 
 /****** Read 4 bytes from memory ******/
 u32 AGB_MMU::read_u32(u32 address)
 {
+	//Plain memory within a single page can be read directly
+	#ifndef GBE_DEBUG
+	if((address < 0x10000000) && ((address & 0x7FFF) <= 0x7FFC))
+	{
+		u8* page = read_page[address >> 15];
+		
+		if(page != NULL)
+		{
+			page += (address & 0x7FFF);
+			return (page[0] | (page[1] << 8) | (page[2] << 16) | (page[3] << 24));
+		}
+	}
+	#endif
+
 	return (read_u8(address) |  (read_u8(address+1) << 8) | (read_u8(address+2) << 16) | (read_u8(address+3) << 24));
 }
 
 /****** Reads 2 bytes from memory - No checks done on the read, used for known memory locations such as registers ******/
 u16 AGB_MMU::read_u16_fast(u32 address)
 {
-	return ((memory_map[address+1] << 8) | memory_map[address]);
+	u8* data = memory_map.get_region_ptr(address, 2);
+	if(data == NULL) { return ((memory_map[address+1] << 8) | memory_map[address]); }
+
+	return ((data[1] << 8) | data[0]);
 }
 
 /****** Reads 4 bytes from memory - No checks done on the read, used for known memory locations such as registers ******/
 u32 AGB_MMU::read_u32_fast(u32 address)
 {
-	return ((memory_map[address+3] << 24) | (memory_map[address+2] << 16) | (memory_map[address+1] << 8) | memory_map[address]);
+	u8* data = memory_map.get_region_ptr(address, 4);
+	if(data == NULL) { return ((memory_map[address+3] << 24) | (memory_map[address+2] << 16) | (memory_map[address+1] << 8) | memory_map[address]); }
+
+	return ((data[3] << 24) | (data[2] << 16) | (data[1] << 8) | data[0]);
 }
 
 /****** Write byte into memory ******/
@@ -600,6 +782,20 @@ void AGB_MMU::write_u8(u32 address, u8 value)
 	#ifdef GBE_DEBUG
 	debug_write = true;
 	debug_addr[address & 0x3] = address;
+
+	//Plain memory can be written directly
+	#else
+	if((address < 0x10000000) && (!flash_ram.write_single_byte))
+	{
+		u8* page = write_page[address >> 15];
+		
+		if(page != NULL)
+		{
+			page[address & 0x7FFF] = value;
+			if(code_page[address >> 15] != NULL) { invalidate_code(address, 1); }
+			return;
+		}
+	}
 	#endif
 
 	//Check for unused memory and mirrors first
@@ -661,7 +857,7 @@ void AGB_MMU::write_u8(u32 address, u8 value)
 		//SRAM Mirror
 		case 0xE:
 		case 0xF:
-			if(current_save_type == SRAM) { address &= 0xF007FFF; }
+			if(current_save_type == SRAM) { address &= 0xF007FFF; backup.mark((address & 0x7FFF), 1); }
 			else if(config::cart_type == AGB_PLAY_YAN) { write_play_yan(address, value); }
 			else if(config::cart_type == AGB_GLUCOBOY) { write_glucoboy(address, value); }
 			else if(config::cart_type == AGB_TV_TUNER) { write_tv_tuner(address, value); }
@@ -673,6 +869,9 @@ void AGB_MMU::write_u8(u32 address, u8 value)
 			return;
 	}
 
+	//Drop any instructions decoded from this address
+	if(code_page[address >> 15] != NULL) { invalidate_code(address, 1); }
+
 	//BIOS is read-only, prevent any attempted writes
 	if((address <= 0x3FFF) && (bios_lock)) { return; }
 
@@ -1703,6 +1902,7 @@ void AGB_MMU::write_u8(u32 address, u8 value)
 			dma[0].enable = true;
 			dma[0].started = false;
 			dma[0].delay = 2;
+			scheduler->schedule(AGB_EVENT_DMA, 1);
 			break;
 
 		//DMA1 Start Address
@@ -1737,6 +1937,7 @@ void AGB_MMU::write_u8(u32 address, u8 value)
 			dma[1].enable = true;
 			dma[1].started = false;
 			dma[1].delay = 2;
+			scheduler->schedule(AGB_EVENT_DMA, 1);
 			break;
 
 		//DMA2 Start Address
@@ -1771,6 +1972,7 @@ void AGB_MMU::write_u8(u32 address, u8 value)
 			dma[2].enable = true;
 			dma[2].started = false;
 			dma[2].delay = 2;
+			scheduler->schedule(AGB_EVENT_DMA, 1);
 			break;
 
 		//DMA3 Start Address
@@ -1802,6 +2004,7 @@ void AGB_MMU::write_u8(u32 address, u8 value)
 			dma[3].enable = true;
 			dma[3].started = false;
 			dma[3].delay = 2;
+			scheduler->schedule(AGB_EVENT_DMA, 1);
 			break;
 
 		case KEYINPUT:
@@ -1851,12 +2054,19 @@ void AGB_MMU::write_u8(u32 address, u8 value)
 		case TM0CNT_H:
 		case TM0CNT_H+1:
 			{
+				//Finish counting with the old settings first
+				sync_timer(0);
+
 				bool prev_enable = (memory_map[TM0CNT_H] & 0x80) ?  true : false;
 				memory_map[address] = value;
 
 				timer->at(0).enable = (memory_map[TM0CNT_H] & 0x80) ?  true : false;
 				timer->at(0).interrupt = (memory_map[TM0CNT_H] & 0x40) ? true : false;
-				if((timer->at(0).enable) && (!prev_enable)) { timer->at(0).counter = timer->at(0).reload_value; }
+				if((timer->at(0).enable) && (!prev_enable))
+				{
+					timer->at(0).counter = timer->at(0).reload_value;
+					timer->at(0).cycles = 0;
+				}
 			}
 
 			switch(memory_map[TM0CNT_H] & 0x3)
@@ -1867,19 +2077,31 @@ void AGB_MMU::write_u8(u32 address, u8 value)
 				case 0x3: timer->at(0).prescalar = 1024; break;
 			}
 
+			//Drop prescalar progress that no longer fits after switching to a faster prescalar
+			if(timer->at(0).cycles >= timer->at(0).prescalar) { timer->at(0).cycles = 0; }
+
+			scheduler->schedule(AGB_EVENT_TIMER_UPDATE, 0);
+
 			break;
 
 		//Timer 1 Control
 		case TM1CNT_H:
 		case TM1CNT_H+1:
 			{
+				//Finish counting with the old settings first
+				sync_timer(1);
+
 				bool prev_enable = (memory_map[TM1CNT_H] & 0x80) ?  true : false;
 				memory_map[address] = value;
 
 				timer->at(1).count_up = (memory_map[TM1CNT_H] & 0x4) ? true : false;
 				timer->at(1).enable = (memory_map[TM1CNT_H] & 0x80) ?  true : false;
 				timer->at(1).interrupt = (memory_map[TM1CNT_H] & 0x40) ? true : false;
-				if((timer->at(1).enable) && (!prev_enable)) { timer->at(1).counter = timer->at(1).reload_value; }
+				if((timer->at(1).enable) && (!prev_enable))
+				{
+					timer->at(1).counter = timer->at(1).reload_value;
+					timer->at(1).cycles = 0;
+				}
 			}
 
 			switch(memory_map[TM1CNT_H] & 0x3)
@@ -1892,19 +2114,31 @@ void AGB_MMU::write_u8(u32 address, u8 value)
 
 			if(timer->at(1).count_up) { timer->at(1).prescalar = 1; }
 
+			//Drop prescalar progress that no longer fits after switching to a faster prescalar
+			if(timer->at(1).cycles >= timer->at(1).prescalar) { timer->at(1).cycles = 0; }
+
+			scheduler->schedule(AGB_EVENT_TIMER_UPDATE, 0);
+
 			break;
 
 		//Timer 2 Control
 		case TM2CNT_H:
 		case TM2CNT_H+1:
 			{
+				//Finish counting with the old settings first
+				sync_timer(2);
+
 				bool prev_enable = (memory_map[TM2CNT_H] & 0x80) ?  true : false;
 				memory_map[address] = value;
 
 				timer->at(2).count_up = (memory_map[TM2CNT_H] & 0x4) ? true : false;
 				timer->at(2).enable = (memory_map[TM2CNT_H] & 0x80) ?  true : false;
 				timer->at(2).interrupt = (memory_map[TM2CNT_H] & 0x40) ? true : false;
-				if((timer->at(2).enable) && (!prev_enable)) { timer->at(2).counter = timer->at(2).reload_value; }
+				if((timer->at(2).enable) && (!prev_enable))
+				{
+					timer->at(2).counter = timer->at(2).reload_value;
+					timer->at(2).cycles = 0;
+				}
 			}
 
 			switch(memory_map[TM2CNT_H] & 0x3)
@@ -1917,19 +2151,31 @@ void AGB_MMU::write_u8(u32 address, u8 value)
 
 			if(timer->at(2).count_up) { timer->at(2).prescalar = 1; }
 
+			//Drop prescalar progress that no longer fits after switching to a faster prescalar
+			if(timer->at(2).cycles >= timer->at(2).prescalar) { timer->at(2).cycles = 0; }
+
+			scheduler->schedule(AGB_EVENT_TIMER_UPDATE, 0);
+
 			break;
 
 		//Timer 3 Control
 		case TM3CNT_H:
 		case TM3CNT_H+1:
 			{
+				//Finish counting with the old settings first
+				sync_timer(3);
+
 				bool prev_enable = (memory_map[TM3CNT_H] & 0x80) ?  true : false;
 				memory_map[address] = value;
 
 				timer->at(3).count_up = (memory_map[TM3CNT_H] & 0x4) ? true : false;
 				timer->at(3).enable = (memory_map[TM3CNT_H] & 0x80) ?  true : false;
 				timer->at(3).interrupt = (memory_map[TM3CNT_H] & 0x40) ? true : false;
-				if((timer->at(3).enable) && (!prev_enable)) { timer->at(3).counter = timer->at(3).reload_value; }
+				if((timer->at(3).enable) && (!prev_enable))
+				{
+					timer->at(3).counter = timer->at(3).reload_value;
+					timer->at(3).cycles = 0;
+				}
 			}
 
 			switch(memory_map[TM3CNT_H] & 0x3)
@@ -1942,6 +2188,11 @@ void AGB_MMU::write_u8(u32 address, u8 value)
 
 			if(timer->at(3).count_up) { timer->at(3).prescalar = 1; }
 
+			//Drop prescalar progress that no longer fits after switching to a faster prescalar
+			if(timer->at(3).cycles >= timer->at(3).prescalar) { timer->at(3).cycles = 0; }
+
+			scheduler->schedule(AGB_EVENT_TIMER_UPDATE, 0);
+
 			break;
 
 		//RCNT Mode Selection
@@ -2182,6 +2433,7 @@ void AGB_MMU::write_u8(u32 address, u8 value)
 	{
 			flash_ram.data[flash_ram.bank][(address & 0xFFFF)] = value;
 			flash_ram.next_write = false;
+			backup.mark(((flash_ram.bank << 16) | (address & 0xFFFF)), 1);
 	}
 
 	if(flash_ram.write_single_byte) 
@@ -2194,6 +2446,23 @@ void AGB_MMU::write_u8(u32 address, u8 value)
 /****** Write 2 bytes into memory ******/
 void AGB_MMU::write_u16(u32 address, u16 value)
 {
+	//Plain memory within a single page can be written directly
+	#ifndef GBE_DEBUG
+	if((address < 0x10000000) && ((address & 0x7FFF) <= 0x7FFE) && (!flash_ram.write_single_byte))
+	{
+		u8* page = write_page[address >> 15];
+		
+		if(page != NULL)
+		{
+			page += (address & 0x7FFF);
+			page[0] = (value & 0xFF);
+			page[1] = ((value >> 8) & 0xFF);
+			if(code_page[address >> 15] != NULL) { invalidate_code(address, 2); }
+			return;
+		}
+	}
+	#endif
+
 	write_u8(address, (value & 0xFF));
 	write_u8((address+1), ((value >> 8) & 0xFF));
 }
@@ -2201,6 +2470,25 @@ void AGB_MMU::write_u16(u32 address, u16 value)
 /****** Write 4 bytes into memory ******/
 void AGB_MMU::write_u32(u32 address, u32 value)
 {
+	//Plain memory within a single page can be written directly
+	#ifndef GBE_DEBUG
+	if((address < 0x10000000) && ((address & 0x7FFF) <= 0x7FFC) && (!flash_ram.write_single_byte))
+	{
+		u8* page = write_page[address >> 15];
+		
+		if(page != NULL)
+		{
+			page += (address & 0x7FFF);
+			page[0] = (value & 0xFF);
+			page[1] = ((value >> 8) & 0xFF);
+			page[2] = ((value >> 16) & 0xFF);
+			page[3] = ((value >> 24) & 0xFF);
+			if(code_page[address >> 15] != NULL) { invalidate_code(address, 4); }
+			return;
+		}
+	}
+	#endif
+
 	write_u8(address, (value & 0xFF));
 	write_u8((address+1), ((value >> 8) & 0xFF));
 	write_u8((address+2), ((value >> 16) & 0xFF));
@@ -2210,19 +2498,147 @@ void AGB_MMU::write_u32(u32 address, u32 value)
 /****** Writes 2 bytes into memory - No checks done on the read, used for known memory locations such as registers ******/
 void AGB_MMU::write_u16_fast(u32 address, u16 value)
 {
-	memory_map[address] = (value & 0xFF);
-	memory_map[address+1] = ((value >> 8) & 0xFF);
+	u8* data = memory_map.get_region_ptr(address, 2);
+
+	//Fall back to byte writes if this straddles unrelated pages
+	if(data == NULL)
+	{
+		memory_map[address] = (value & 0xFF);
+		memory_map[address+1] = ((value >> 8) & 0xFF);
+		return;
+	}
+
+	data[0] = (value & 0xFF);
+	data[1] = ((value >> 8) & 0xFF);
 }
 
 /****** Writes 4 bytes into memory - No checks done on the read, used for known memory locations such as registers ******/
 void AGB_MMU::write_u32_fast(u32 address, u32 value)
 {
-	memory_map[address] = (value & 0xFF);
-	memory_map[address+1] = ((value >> 8) & 0xFF);
-	memory_map[address+2] = ((value >> 16) & 0xFF);
-	memory_map[address+3] = ((value >> 24) & 0xFF);
+	u8* data = memory_map.get_region_ptr(address, 4);
+
+	//Fall back to byte writes if this straddles unrelated pages
+	if(data == NULL)
+	{
+		memory_map[address] = (value & 0xFF);
+		memory_map[address+1] = ((value >> 8) & 0xFF);
+		memory_map[address+2] = ((value >> 16) & 0xFF);
+		memory_map[address+3] = ((value >> 24) & 0xFF);
+		return;
+	}
+
+	data[0] = (value & 0xFF);
+	data[1] = ((value >> 8) & 0xFF);
+	data[2] = ((value >> 16) & 0xFF);
+	data[3] = ((value >> 24) & 0xFF);
 }	
 
+/****** Copies plain memory directly - Stops at the first page needing full read/write handling, returns bytes copied ******/
+u32 AGB_MMU::copy_block(u32 dest_addr, u32 src_addr, u32 length)
+{
+	u32 copied = 0;
+
+	#ifndef GBE_DEBUG
+	if(flash_ram.write_single_byte) { return 0; }
+
+	while(copied < length)
+	{
+		if((src_addr >= 0x10000000) || (dest_addr >= 0x10000000)) { break; }
+
+		u8* src = read_page[src_addr >> 15];
+		u8* dest = write_page[dest_addr >> 15];
+
+		if((src == NULL) || (dest == NULL)) { break; }
+
+		//Copy up to the end of whichever page ends first
+		u32 chunk = length - copied;
+		if(chunk > (0x8000 - (src_addr & 0x7FFF))) { chunk = (0x8000 - (src_addr & 0x7FFF)); }
+		if(chunk > (0x8000 - (dest_addr & 0x7FFF))) { chunk = (0x8000 - (dest_addr & 0x7FFF)); }
+
+		src += (src_addr & 0x7FFF);
+		dest += (dest_addr & 0x7FFF);
+
+		//Forward copies onto their own source repeat earlier data, leave those to the normal path
+		if((dest > src) && (dest < (src + chunk))) { break; }
+
+		memmove(dest, src, chunk);
+		if(code_page[dest_addr >> 15] != NULL) { invalidate_code(dest_addr, chunk); }
+
+		src_addr += chunk;
+		dest_addr += chunk;
+		copied += chunk;
+	}
+	#endif
+
+	return copied;
+}
+
+/****** Fills plain memory with a 16-bit or 32-bit value read once from plain memory - Returns bytes filled ******/
+u32 AGB_MMU::fill_block(u32 dest_addr, u32 src_addr, u32 length, u8 unit)
+{
+	u32 filled = 0;
+
+	#ifndef GBE_DEBUG
+	if((flash_ram.write_single_byte) || (src_addr >= 0x10000000) || ((src_addr & 0x7FFF) > (0x8000u - unit))) { return 0; }
+
+	//Sources with side effects have to be read for every unit
+	u8* src = read_page[src_addr >> 15];
+	if(src == NULL) { return 0; }
+
+	src += (src_addr & 0x7FFF);
+
+	while(filled < length)
+	{
+		if(dest_addr >= 0x10000000) { break; }
+
+		u8* dest = write_page[dest_addr >> 15];
+		if(dest == NULL) { break; }
+
+		u32 chunk = length - filled;
+		if(chunk > (0x8000 - (dest_addr & 0x7FFF))) { chunk = (0x8000 - (dest_addr & 0x7FFF)); }
+
+		dest += (dest_addr & 0x7FFF);
+
+		for(u32 x = 0; x < chunk; x++) { dest[x] = src[x & (unit - 1)]; }
+		if(code_page[dest_addr >> 15] != NULL) { invalidate_code(dest_addr, chunk); }
+
+		dest_addr += chunk;
+		filled += chunk;
+	}
+	#endif
+
+	return filled;
+}
+
+/****** Writes a buffer directly into plain memory - Returns bytes written ******/
+u32 AGB_MMU::write_block(u32 dest_addr, const u8* data, u32 length)
+{
+	u32 written = 0;
+
+	#ifndef GBE_DEBUG
+	if(flash_ram.write_single_byte) { return 0; }
+
+	while(written < length)
+	{
+		if(dest_addr >= 0x10000000) { break; }
+
+		u8* dest = write_page[dest_addr >> 15];
+		if(dest == NULL) { break; }
+
+		u32 chunk = length - written;
+		if(chunk > (0x8000 - (dest_addr & 0x7FFF))) { chunk = (0x8000 - (dest_addr & 0x7FFF)); }
+
+		memcpy(dest + (dest_addr & 0x7FFF), data + written, chunk);
+		if(code_page[dest_addr >> 15] != NULL) { invalidate_code(dest_addr, chunk); }
+
+		dest_addr += chunk;
+		written += chunk;
+	}
+	#endif
+
+	return written;
+}
+
 /****** Read binary file to memory ******/
 bool AGB_MMU::read_file(std::string filename)
 {
@@ -2316,8 +2732,24 @@ bool AGB_MMU::read_file(std::string filename)
 		campho_map_rom_banks();
 	}	
 
-	//Read data from the ROM file
-	else { file.read((char*)ex_mem, file_size); }
+	//Map the ROM file instead of reading it, Waitstates 1 and 2 alias the same pages
+	else
+	{
+		file.close();
+
+		if(!rom_file.open(filename, 0x2000000, 0, true))
+		{
+			std::cout<<"MMU::Error - Could not map " << filename << "\n";
+			return false;
+		}
+
+		file_size = rom_file.size();
+
+		memory_map.map_external(0x8000000, 0x2000000, rom_file.data());
+		memory_map.map_mirror(0xA000000, 0x2000000, 0x8000000);
+		memory_map.map_mirror(0xC000000, 0x1000000, 0x8000000);
+		update_page_tables();
+	}
 
 	file.close();
 
@@ -2332,9 +2764,9 @@ bool AGB_MMU::read_file(std::string filename)
 		}
 	}
 
-	for(u32 x = 0; x < file_size; x++)
+	//Waitstates 1 and 2 share ROM memory, only the last 16MB of Waitstate 2 needs a copy
+	for(u32 x = 0x1000000; x < file_size; x++)
 	{
-		memory_map[0xA000000 + x] = memory_map[0x8000000 + x];
 		memory_map[0xC000000 + x] = memory_map[0x8000000 + x];
 	}
 
@@ -2627,6 +3059,18 @@ bool AGB_MMU::load_backup(std::string filename)
 		 filename = config::save_path + util::get_filename_from_path(filename);
 	}
 
+	//Fold in a journal left by a crashed session, then journal this one
+	//Imported or exported saves are left alone
+	if((config::save_import_path.empty()) && (config::save_export_path.empty()))
+	{
+		backup_journal::recover(filename);
+
+		if((current_save_type == SRAM) || (current_save_type == EEPROM) || (current_save_type == FLASH_64) || (current_save_type == FLASH_128))
+		{
+			backup.start(filename);
+		}
+	}
+
 	//Import save if applicable
 	if(!config::save_import_path.empty()) { filename = config::save_import_path; }
 
@@ -3072,6 +3516,25 @@ void AGB_MMU::start_blank_dma()
 		
 		if(dma_type == 2) { dma[3].started = true; }
 	}
+
+	//Run any enabled DMAs this cycle
+	if((dma[0].enable) || (dma[3].enable)) { scheduler->schedule(AGB_EVENT_DMA, 0); }
+}
+
+/****** Brings a running Timer's counter up to the current time - Counters are not updated between overflows ******/
+void AGB_MMU::sync_timer(u8 id)
+{
+	agb_event_types timer_event = agb_event_types(AGB_EVENT_TIMER_0 + id);
+
+	//Count-up and disabled timers have no pending event, overflows due this cycle are left to the event
+	if(!scheduler->event_pending[timer_event]) { return; }
+	if(scheduler->event_time[timer_event] <= scheduler->timestamp) { return; }
+
+	u32 cycles = timer->at(id).cycles + scheduler->get_elapsed(timer_event);
+
+	timer->at(id).counter += (cycles / timer->at(id).prescalar);
+	timer->at(id).cycles = (cycles % timer->at(id).prescalar);
+	scheduler->rebase(timer_event);
 }
 
 /****** Set EEPROM read-write address ******/
@@ -3163,6 +3626,8 @@ void AGB_MMU::eeprom_write_data()
 	u16 temp_addr = (eeprom.address * 8);
 	bits = 0x80;
 
+	backup.mark(temp_addr, 8);
+
 	//Read 64 bits from the bitstream to store at EEPROM address, MSB 1st
 	for(int x = 0; x < 64; x++)
 	{
@@ -3194,6 +3659,8 @@ void AGB_MMU::flash_erase_chip()
 		flash_ram.data[0][x] = 0xFF;
 		flash_ram.data[1][x] = 0xFF; 
 	}
+
+	backup.mark(0, 0x20000);
 }
 
 /****** Erase 4KB sector of FLASH RAM ******/
@@ -3203,6 +3670,55 @@ void AGB_MMU::flash_erase_sector(u32 sector)
 	{ 
 		flash_ram.data[flash_ram.bank][(x & 0xFFFF)] = 0xFF; 
 	}
+
+	backup.mark(((flash_ram.bank << 16) | (sector & 0xFFFF)), 0x1000);
+}
+
+/****** Copies recent changes to battery saves into the backup journal ******/
+void AGB_MMU::update_backup_journal()
+{
+	switch(current_save_type)
+	{
+		case SRAM:
+			if(backup.begin_sync(0x8000))
+			{
+				backup.sync_segment(0, &memory_map[0xE000000], 0x8000);
+				backup.end_sync();
+			}
+
+			break;
+
+		case EEPROM:
+			if((eeprom.data.size() >= eeprom.size) && (backup.begin_sync(eeprom.size)))
+			{
+				backup.sync_segment(0, &eeprom.data[0], eeprom.size);
+				backup.end_sync();
+			}
+
+			break;
+
+		case FLASH_64:
+			if(backup.begin_sync(0x10000))
+			{
+				backup.sync_segment(0, &flash_ram.data[0][0], 0x10000);
+				backup.end_sync();
+			}
+
+			break;
+
+		case FLASH_128:
+			if(backup.begin_sync(0x20000))
+			{
+				backup.sync_segment(0, &flash_ram.data[0][0], 0x10000);
+				backup.sync_segment(0x10000, &flash_ram.data[1][0], 0x10000);
+				backup.end_sync();
+			}
+
+			break;
+
+		default:
+			break;
+	}
 }
 
 /****** Read 8-bit data from 8M DACS FLASH cartridge or its commands ******/
@@ -3806,191 +4322,182 @@ void AGB_MMU::set_sio_data(agb_sio_data* ex_sio_stat) { sio_stat = ex_sio_stat;
 void AGB_MMU::set_mw_data(mag_watch* ex_mw_data) { mw = ex_mw_data; }
 
 /****** Read MMU data from save state ******/
-bool AGB_MMU::mmu_read(u32 offset, std::string filename)
+bool AGB_MMU::mmu_read(save_state_buffer& state)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary);
-	
-	if(!file.is_open()) { return false; }
-
-	//Go to offset
-	file.seekg(offset);
-
 	//Serialize WRAM from save state
 	u8* ex_mem = &memory_map[0x2000000];
-	file.read((char*)ex_mem, 0x40000);
+	state.read((char*)ex_mem, 0x40000);
 
 	//Serialize WRAM from save state
 	ex_mem = &memory_map[0x3000000];
-	file.read((char*)ex_mem, 0x8000);
+	state.read((char*)ex_mem, 0x8000);
+	clear_code_cache();
 
 	//Serialize IO registers from save state
 	ex_mem = &memory_map[0x4000000];
-	file.read((char*)ex_mem, 0x400);
+	state.read((char*)ex_mem, 0x400);
 
 	//Serialize BG and OBJ palettes from save state
 	ex_mem = &memory_map[0x5000000];
-	file.read((char*)ex_mem, 0x400);
+	state.read((char*)ex_mem, 0x400);
 
 	//Serialize VRAM from save state
 	ex_mem = &memory_map[0x6000000];
-	file.read((char*)ex_mem, 0x18000);
+	state.read((char*)ex_mem, 0x18000);
 
 	//Serialize OAM from save state
 	ex_mem = &memory_map[0x7000000];
-	file.read((char*)ex_mem, 0x400);
+	state.read((char*)ex_mem, 0x400);
 
 	//Serialize SRAM from save state
 	ex_mem = &memory_map[0xE000000];
-	file.read((char*)ex_mem, 0x10000);
+	state.read((char*)ex_mem, 0x10000);
 
 	//Serialize misc data from MMU from save state
-	file.read((char*)&current_save_type, sizeof(current_save_type));
-	file.read((char*)&n_clock, sizeof(n_clock));
-	file.read((char*)&s_clock, sizeof(s_clock));
-	file.read((char*)&bios_lock, sizeof(bios_lock));
-	file.read((char*)&dma[0], sizeof(dma[0]));
-	file.read((char*)&dma[1], sizeof(dma[1]));
-	file.read((char*)&dma[2], sizeof(dma[2]));
-	file.read((char*)&dma[3], sizeof(dma[3]));
-	file.read((char*)&gpio, sizeof(gpio));
+	state.read((char*)&current_save_type, sizeof(current_save_type));
+	state.read((char*)&n_clock, sizeof(n_clock));
+	state.read((char*)&s_clock, sizeof(s_clock));
+	state.read((char*)&bios_lock, sizeof(bios_lock));
+	state.read((char*)&dma[0], sizeof(dma[0]));
+	state.read((char*)&dma[1], sizeof(dma[1]));
+	state.read((char*)&dma[2], sizeof(dma[2]));
+	state.read((char*)&dma[3], sizeof(dma[3]));
+	state.read((char*)&gpio, sizeof(gpio));
 
 	//Serialize EEPROM from save state
-	file.read((char*)&eeprom.bitstream_byte, sizeof(eeprom.bitstream_byte));
-	file.read((char*)&eeprom.address, sizeof(eeprom.address));
-	file.read((char*)&eeprom.dma_ptr, sizeof(eeprom.dma_ptr));
-	file.read((char*)&eeprom.size, sizeof(eeprom.size));
-	file.read((char*)&eeprom.size_lock, sizeof(eeprom.size_lock));
-	file.read((char*)&eeprom.data[0], eeprom.size);
+	state.read((char*)&eeprom.bitstream_byte, sizeof(eeprom.bitstream_byte));
+	state.read((char*)&eeprom.address, sizeof(eeprom.address));
+	state.read((char*)&eeprom.dma_ptr, sizeof(eeprom.dma_ptr));
+	state.read((char*)&eeprom.size, sizeof(eeprom.size));
+	state.read((char*)&eeprom.size_lock, sizeof(eeprom.size_lock));
+	state.read((char*)&eeprom.data[0], eeprom.size);
 
 	//Serialize FLASH RAM from save state
-	file.read((char*)&flash_ram.current_command, sizeof(flash_ram.current_command));
-	file.read((char*)&flash_ram.bank, sizeof(flash_ram.bank));
-	file.read((char*)&flash_ram.write_single_byte, sizeof(flash_ram.write_single_byte));
-	file.read((char*)&flash_ram.switch_bank, sizeof(flash_ram.switch_bank));
-	file.read((char*)&flash_ram.grab_ids, sizeof(flash_ram.grab_ids));
-	file.read((char*)&flash_ram.next_write, sizeof(flash_ram.next_write));
-	file.read((char*)&flash_ram.data[0][0], 0x10000);
-	file.read((char*)&flash_ram.data[1][0], 0x10000);
+	state.read((char*)&flash_ram.current_command, sizeof(flash_ram.current_command));
+	state.read((char*)&flash_ram.bank, sizeof(flash_ram.bank));
+	state.read((char*)&flash_ram.write_single_byte, sizeof(flash_ram.write_single_byte));
+	state.read((char*)&flash_ram.switch_bank, sizeof(flash_ram.switch_bank));
+	state.read((char*)&flash_ram.grab_ids, sizeof(flash_ram.grab_ids));
+	state.read((char*)&flash_ram.next_write, sizeof(flash_ram.next_write));
+	state.read((char*)&flash_ram.data[0][0], 0x10000);
+	state.read((char*)&flash_ram.data[1][0], 0x10000);
+
+	//Loaded save data may differ anywhere, let the journal compare all of it
+	backup.mark(0, 0x20000);
 
 	//Serialize AM3 data from save state
 	if(config::cart_type == AGB_AM3)
 	{
-		file.read((char*)&am3.read_sm_card, sizeof(am3.read_sm_card));
-		file.read((char*)&am3.read_key, sizeof(am3.read_key));
-		file.read((char*)&am3.op_delay, sizeof(am3.op_delay));
-		file.read((char*)&am3.transfer_delay, sizeof(am3.transfer_delay));
-		file.read((char*)&am3.base_addr, sizeof(am3.base_addr));
-		file.read((char*)&am3.blk_stat, sizeof(am3.blk_stat));
-		file.read((char*)&am3.blk_size, sizeof(am3.blk_size));
-		file.read((char*)&am3.blk_addr, sizeof(am3.blk_addr));
-		file.read((char*)&am3.smc_offset, sizeof(am3.smc_offset));
-		file.read((char*)&am3.last_offset, sizeof(am3.last_offset));
-		file.read((char*)&am3.smc_size, sizeof(am3.smc_size));
-		file.read((char*)&am3.smc_base, sizeof(am3.smc_base));
-		file.read((char*)&am3.file_index, sizeof(am3.file_index));
-		file.read((char*)&am3.file_count, sizeof(am3.file_count));
-		file.read((char*)&am3.file_size, sizeof(am3.file_size));
-		file.read((char*)&am3.remaining_size, sizeof(am3.remaining_size));
-		file.read((char*)&am3.file_size_list[0], (sizeof(u32) * am3.file_size_list.size()));
-		file.read((char*)&am3.file_addr_list[0], (sizeof(u32) * am3.file_addr_list.size()));
-		file.read((char*)&am3.smid[0], 0x10);
-		file.read((char*)&memory_map[0x8000000], 0x400);
+		state.read((char*)&am3.read_sm_card, sizeof(am3.read_sm_card));
+		state.read((char*)&am3.read_key, sizeof(am3.read_key));
+		state.read((char*)&am3.op_delay, sizeof(am3.op_delay));
+		state.read((char*)&am3.transfer_delay, sizeof(am3.transfer_delay));
+		state.read((char*)&am3.base_addr, sizeof(am3.base_addr));
+		state.read((char*)&am3.blk_stat, sizeof(am3.blk_stat));
+		state.read((char*)&am3.blk_size, sizeof(am3.blk_size));
+		state.read((char*)&am3.blk_addr, sizeof(am3.blk_addr));
+		state.read((char*)&am3.smc_offset, sizeof(am3.smc_offset));
+		state.read((char*)&am3.last_offset, sizeof(am3.last_offset));
+		state.read((char*)&am3.smc_size, sizeof(am3.smc_size));
+		state.read((char*)&am3.smc_base, sizeof(am3.smc_base));
+		state.read((char*)&am3.file_index, sizeof(am3.file_index));
+		state.read((char*)&am3.file_count, sizeof(am3.file_count));
+		state.read((char*)&am3.file_size, sizeof(am3.file_size));
+		state.read((char*)&am3.remaining_size, sizeof(am3.remaining_size));
+		state.read((char*)&am3.file_size_list[0], (sizeof(u32) * am3.file_size_list.size()));
+		state.read((char*)&am3.file_addr_list[0], (sizeof(u32) * am3.file_addr_list.size()));
+		state.read((char*)&am3.smid[0], 0x10);
+		state.read((char*)&memory_map[0x8000000], 0x400);
 	}
 
-	file.close();
-	return true;
+	return state.good();
 }
 
 /****** Write MMU data to save state ******/
-bool AGB_MMU::mmu_write(std::string filename)
+bool AGB_MMU::mmu_write(save_state_buffer& state)
 {
-	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::app);
-	
-	if(!file.is_open()) { return false; }
-
 	//Serialize WRAM to save state
 	u8* ex_mem = &memory_map[0x2000000];
-	file.write((char*)ex_mem, 0x40000);
+	state.write((char*)ex_mem, 0x40000);
 
 	//Serialize WRAM to save state
 	ex_mem = &memory_map[0x3000000];
-	file.write((char*)ex_mem, 0x8000);
+	state.write((char*)ex_mem, 0x8000);
 
 	//Serialize IO registers to save state
 	ex_mem = &memory_map[0x4000000];
-	file.write((char*)ex_mem, 0x400);
+	state.write((char*)ex_mem, 0x400);
 
 	//Serialize BG and OBJ palettes to save state
 	ex_mem = &memory_map[0x5000000];
-	file.write((char*)ex_mem, 0x400);
+	state.write((char*)ex_mem, 0x400);
 
 	//Serialize VRAM to save state
 	ex_mem = &memory_map[0x6000000];
-	file.write((char*)ex_mem, 0x18000);
+	state.write((char*)ex_mem, 0x18000);
 
 	//Serialize OAM to save state
 	ex_mem = &memory_map[0x7000000];
-	file.write((char*)ex_mem, 0x400);
+	state.write((char*)ex_mem, 0x400);
 
 	//Serialize SRAM to save state
 	ex_mem = &memory_map[0xE000000];
-	file.write((char*)ex_mem, 0x10000);
+	state.write((char*)ex_mem, 0x10000);
 
 	//Serialize misc data from MMU to save state
-	file.write((char*)&current_save_type, sizeof(current_save_type));
-	file.write((char*)&n_clock, sizeof(n_clock));
-	file.write((char*)&s_clock, sizeof(s_clock));
-	file.write((char*)&bios_lock, sizeof(bios_lock));
-	file.write((char*)&dma[0], sizeof(dma[0]));
-	file.write((char*)&dma[1], sizeof(dma[1]));
-	file.write((char*)&dma[2], sizeof(dma[2]));
-	file.write((char*)&dma[3], sizeof(dma[3]));
-	file.write((char*)&gpio, sizeof(gpio));
+	state.write((char*)&current_save_type, sizeof(current_save_type));
+	state.write((char*)&n_clock, sizeof(n_clock));
+	state.write((char*)&s_clock, sizeof(s_clock));
+	state.write((char*)&bios_lock, sizeof(bios_lock));
+	state.write((char*)&dma[0], sizeof(dma[0]));
+	state.write((char*)&dma[1], sizeof(dma[1]));
+	state.write((char*)&dma[2], sizeof(dma[2]));
+	state.write((char*)&dma[3], sizeof(dma[3]));
+	state.write((char*)&gpio, sizeof(gpio));
 
 	//Serialize EEPROM to save state
-	file.write((char*)&eeprom.bitstream_byte, sizeof(eeprom.bitstream_byte));
-	file.write((char*)&eeprom.address, sizeof(eeprom.address));
-	file.write((char*)&eeprom.dma_ptr, sizeof(eeprom.dma_ptr));
-	file.write((char*)&eeprom.size, sizeof(eeprom.size));
-	file.write((char*)&eeprom.size_lock, sizeof(eeprom.size_lock));
-	file.write((char*)&eeprom.data[0], eeprom.size);
+	state.write((char*)&eeprom.bitstream_byte, sizeof(eeprom.bitstream_byte));
+	state.write((char*)&eeprom.address, sizeof(eeprom.address));
+	state.write((char*)&eeprom.dma_ptr, sizeof(eeprom.dma_ptr));
+	state.write((char*)&eeprom.size, sizeof(eeprom.size));
+	state.write((char*)&eeprom.size_lock, sizeof(eeprom.size_lock));
+	state.write((char*)&eeprom.data[0], eeprom.size);
 
 	//Serialize FLASH RAM to save state
-	file.write((char*)&flash_ram.current_command, sizeof(flash_ram.current_command));
-	file.write((char*)&flash_ram.bank, sizeof(flash_ram.bank));
-	file.write((char*)&flash_ram.write_single_byte, sizeof(flash_ram.write_single_byte));
-	file.write((char*)&flash_ram.switch_bank, sizeof(flash_ram.switch_bank));
-	file.write((char*)&flash_ram.grab_ids, sizeof(flash_ram.grab_ids));
-	file.write((char*)&flash_ram.next_write, sizeof(flash_ram.next_write));
-	file.write((char*)&flash_ram.data[0][0], 0x10000);
-	file.write((char*)&flash_ram.data[1][0], 0x10000);
+	state.write((char*)&flash_ram.current_command, sizeof(flash_ram.current_command));
+	state.write((char*)&flash_ram.bank, sizeof(flash_ram.bank));
+	state.write((char*)&flash_ram.write_single_byte, sizeof(flash_ram.write_single_byte));
+	state.write((char*)&flash_ram.switch_bank, sizeof(flash_ram.switch_bank));
+	state.write((char*)&flash_ram.grab_ids, sizeof(flash_ram.grab_ids));
+	state.write((char*)&flash_ram.next_write, sizeof(flash_ram.next_write));
+	state.write((char*)&flash_ram.data[0][0], 0x10000);
+	state.write((char*)&flash_ram.data[1][0], 0x10000);
 
 	//Serialize AM3 data to save state
 	if(config::cart_type == AGB_AM3)
 	{ 
-		file.write((char*)&am3.read_sm_card, sizeof(am3.read_sm_card));
-		file.write((char*)&am3.read_key, sizeof(am3.read_key));
-		file.write((char*)&am3.op_delay, sizeof(am3.op_delay));
-		file.write((char*)&am3.transfer_delay, sizeof(am3.transfer_delay));
-		file.write((char*)&am3.base_addr, sizeof(am3.base_addr));
-		file.write((char*)&am3.blk_stat, sizeof(am3.blk_stat));
-		file.write((char*)&am3.blk_size, sizeof(am3.blk_size));
-		file.write((char*)&am3.blk_addr, sizeof(am3.blk_addr));
-		file.write((char*)&am3.smc_offset, sizeof(am3.smc_offset));
-		file.write((char*)&am3.last_offset, sizeof(am3.last_offset));
-		file.write((char*)&am3.smc_size, sizeof(am3.smc_size));
-		file.write((char*)&am3.smc_base, sizeof(am3.smc_base));
-		file.write((char*)&am3.file_index, sizeof(am3.file_index));
-		file.write((char*)&am3.file_count, sizeof(am3.file_count));
-		file.write((char*)&am3.file_size, sizeof(am3.file_size));
-		file.write((char*)&am3.remaining_size, sizeof(am3.remaining_size));
-		file.write((char*)&am3.file_size_list[0], (sizeof(u32) * am3.file_size_list.size()));
-		file.write((char*)&am3.file_addr_list[0], (sizeof(u32) * am3.file_addr_list.size()));
-		file.write((char*)&am3.smid[0], 0x10);
-		file.write((char*)&memory_map[0x8000000], 0x400);
+		state.write((char*)&am3.read_sm_card, sizeof(am3.read_sm_card));
+		state.write((char*)&am3.read_key, sizeof(am3.read_key));
+		state.write((char*)&am3.op_delay, sizeof(am3.op_delay));
+		state.write((char*)&am3.transfer_delay, sizeof(am3.transfer_delay));
+		state.write((char*)&am3.base_addr, sizeof(am3.base_addr));
+		state.write((char*)&am3.blk_stat, sizeof(am3.blk_stat));
+		state.write((char*)&am3.blk_size, sizeof(am3.blk_size));
+		state.write((char*)&am3.blk_addr, sizeof(am3.blk_addr));
+		state.write((char*)&am3.smc_offset, sizeof(am3.smc_offset));
+		state.write((char*)&am3.last_offset, sizeof(am3.last_offset));
+		state.write((char*)&am3.smc_size, sizeof(am3.smc_size));
+		state.write((char*)&am3.smc_base, sizeof(am3.smc_base));
+		state.write((char*)&am3.file_index, sizeof(am3.file_index));
+		state.write((char*)&am3.file_count, sizeof(am3.file_count));
+		state.write((char*)&am3.file_size, sizeof(am3.file_size));
+		state.write((char*)&am3.remaining_size, sizeof(am3.remaining_size));
+		state.write((char*)&am3.file_size_list[0], (sizeof(u32) * am3.file_size_list.size()));
+		state.write((char*)&am3.file_addr_list[0], (sizeof(u32) * am3.file_addr_list.size()));
+		state.write((char*)&am3.smid[0], 0x10);
+		state.write((char*)&memory_map[0x8000000], 0x400);
 	}
 
-	file.close();
 	return true;
 }
 
@@ -22,11 +22,18 @@
 #endif
 
 #include "common.h"
+#include "common/paged_memory.h"
+#include "common/mapped_file.h"
+#include "common/backup_journal.h"
+#include "common/save_state.h"
+#include "common/media_converter.h"
 #include "gamepad.h"
 #include "timer.h"
+#include "scheduler.h"
 #include "lcd_data.h"
 #include "apu_data.h"
 #include "sio_data.h"
+#include "mjpeg_stream.h"
 
 class AGB_MMU
 {
@@ -170,7 +177,29 @@ class AGB_MMU
 
 	backup_types current_save_type;
 
-	std::vector <u8> memory_map;
+	paged_memory_map memory_map;
+
+	//ROM file mapped into Waitstate 0 and its mirrors
+	mapped_file rom_file;
+	backup_journal backup;
+
+	//Fast path page tables, 32KB per entry - NULL entries use full read/write handling
+	u8* read_page[0x2000];
+	u8* write_page[0x2000];
+
+	//Instruction already fetched and decoded by the CPU at a given address
+	struct decoded_instruction
+	{
+		u32 opcode;
+		u8 operation;
+		bool idle;
+		bool thumb;
+		bool valid;
+	};
+
+	//Pre-decoded instruction pages for IWRAM and ROM, 32KB per entry and shared by mirrors - NULL entries are not cached
+	decoded_instruction* code_page[0x2000];
+	std::vector<decoded_instruction> code_cache[0x401];
 
 	//Memory access timings (Nonsequential and Sequential)
 	u8 n_clock;
@@ -295,7 +324,8 @@ class AGB_MMU
 		std::vector<u16> karaoke_times;
 
 		std::string recorded_file;
-		std::string last_converted_file;
+		std::string pending_audio_file;
+		std::string pending_karaoke_file;
 		std::string karaoke_track;
 
 		u32 spectrum_values[9];
@@ -365,8 +395,9 @@ class AGB_MMU
 
 		std::vector<u8> video_thumbnail;
 		std::vector<u8> video_data;
-		std::vector<u8> video_bytes;
 		std::vector<u32> video_frames;
+		mjpeg_stream video_stream;
+		mjpeg_stream::frame decoded_frame;
 		u16 thumbnail_addr;
 		u16 thumbnail_index;
 		u32 video_data_addr;
@@ -397,6 +428,7 @@ class AGB_MMU
 		std::string base_dir;
 		std::string current_music_file;
 		std::string current_video_file;
+		std::string pending_audio_file;
 
 		u8 volume;
 		u8 bass_boost;
@@ -609,6 +641,8 @@ class AGB_MMU
 
 	void start_blank_dma();
 
+	void sync_timer(u8 id);
+
 	u8 read_u8(u32 address);
 	u16 read_u16(u32 address);
 	u32 read_u32(u32 address);
@@ -623,12 +657,23 @@ class AGB_MMU
 	void write_u16_fast(u32 address, u16 value);
 	void write_u32_fast(u32 address, u32 value);
 
+	u32 copy_block(u32 dest_addr, u32 src_addr, u32 length);
+	u32 fill_block(u32 dest_addr, u32 src_addr, u32 length, u8 unit);
+	u32 write_block(u32 dest_addr, const u8* data, u32 length);
+
+	void update_page_tables();
+
+	decoded_instruction* get_code_entry(u32 address);
+	void invalidate_code(u32 address, u32 length);
+	void clear_code_cache();
+
 	bool read_file(std::string filename);
 	bool read_bios(std::string filename);
 	bool read_am3_firmware(std::string filename);
 	bool read_smid(std::string filename);
 	bool save_backup(std::string filename);
 	bool load_backup(std::string filename);
+	void update_backup_journal();
 
 	bool patch_ips(std::string filename);
 	bool patch_ups(std::string filename);
@@ -657,7 +702,9 @@ class AGB_MMU
 	void jukebox_set_file_info();
 	void jukebox_update_metadata();
 	bool jukebox_load_audio(std::string filename);
-	bool jukebox_load_karaoke_audio();
+	bool jukebox_open_audio(std::string filename);
+	void jukebox_check_pending_audio();
+	bool jukebox_load_karaoke_audio(std::string filename);
 	bool jukebox_update_music_file_list();
 	void process_jukebox();
 
@@ -677,11 +724,12 @@ class AGB_MMU
 	void play_yan_set_video_pixels();
 	void play_yan_wake();
 	bool play_yan_load_audio(std::string filename);
+	bool play_yan_open_audio(std::string filename, bool is_sfx);
+	void play_yan_check_pending_audio();
 	bool play_yan_load_video(std::string filename);
 	bool play_yan_load_sfx(std::string filename);
 	void play_yan_grab_frame_data(u32 frame);
 	void play_yan_check_video_header(std::string filename);
-	void play_yan_check_audio_from_video(std::vector <u8> &data);
 	bool play_yan_get_headphone_status();
 
 	void write_nmp(u32 address, u8 value);
@@ -749,10 +797,12 @@ class AGB_MMU
 
 	AGB_GamePad* g_pad;
 	std::vector<gba_timer>* timer;
+	AGB_scheduler* scheduler;
+	bool timer_polled;
 
 	//Serialize data for save state loading/saving
-	bool mmu_read(u32 offset, std::string filename);
-	bool mmu_write(std::string filename);
+	bool mmu_read(save_state_buffer& state);
+	bool mmu_write(save_state_buffer& state);
 	u32 size();
 
 	private:
@@ -768,6 +818,9 @@ class AGB_MMU
 
 	//Only the MMU and SIO should communicate through this structure
 	mag_watch* mw;
+
+	//Converts Play-Yan, Nintendo MP3, and Jukebox audio in the background
+	media_converter audio_converter;
 };
 
 #endif // GBA_MMU
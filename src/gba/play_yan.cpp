@@ -33,7 +33,7 @@ void AGB_MMU::play_yan_reset()
 	play_yan.firmware_status = 0x10;
 	play_yan.firmware_addr_count = 0;
 
-	play_yan.video_bytes.clear();
+	play_yan.video_stream.close();
 	play_yan.video_frames.clear();
 
 	play_yan.status = 0x80;
@@ -101,6 +101,7 @@ void AGB_MMU::play_yan_reset()
 
 	play_yan.current_music_file = "";
 	play_yan.current_video_file = "";
+	play_yan.pending_audio_file = "";
 
 	play_yan.audio_channels = 0;
 	play_yan.audio_sample_rate = 0;
@@ -1817,67 +1818,74 @@ bool AGB_MMU::play_yan_load_audio(std::string filename)
 	play_yan.tracker_update_size = 0;
 	play_yan.audio_sample_rate = 0;
 	play_yan.audio_channels = 0;
+	play_yan.pending_audio_file = "";
 
 	//Clear previous buffer if necessary
+	SDL_LockAudio();
 	SDL_FreeWAV(apu_stat->ext_audio.buffer);
 	apu_stat->ext_audio.buffer = NULL;
+	apu_stat->ext_audio.length = 0;
+	SDL_UnlockAudio();
 
-	SDL_AudioSpec file_spec;
+	//Load sfx
+	if(is_sfx) { return play_yan_open_audio(filename, true); }
 
-	//Load music
-	if(!is_sfx)
+	//Abort now if no audio conversion command is specified
+	if(config::audio_conversion_cmd.empty())
 	{
-		//Abort now if no audio conversion command is specified
-		if(config::audio_conversion_cmd.empty())
-		{
-			std::cout<<"MMU::No audio conversion command specified. Cannot convert file " << filename << "\n";
-			return false;
-		}
+		std::cout<<"MMU::No audio conversion command specified. Cannot convert file " << filename << "\n";
+		return false;
+	}
 
-		std::string out_file = config::temp_media_file + ".wav";
-		std::string sys_cmd = config::audio_conversion_cmd;
+	//Load music - Conversion runs in the background, unless this file was already converted or cached
+	std::string out_file = "";
+	media_convert_status status = audio_converter.request(filename, config::audio_conversion_cmd, out_file);
 
-		//Delete any existing temporary media file in case audio conversion command complains
-		std::remove(out_file.c_str());
+	//Convert the next file in the current folder ahead of time
+	std::string current_file = util::get_filename_from_path(filename);
 
-		//Replace %in and %out with proper parameters
-		std::string search_str = "%in";
-		std::size_t pos = sys_cmd.find(search_str);
+	for(u32 x = 0; (x + 1) < play_yan.music_files.size(); x++)
+	{
+		if(util::get_filename_from_path(play_yan.music_files[x]) != current_file) { continue; }
+
+		std::string next_file = util::get_filename_from_path(play_yan.music_files[x + 1]);
+		std::string ext = (next_file.size() >= 4) ? next_file.substr(next_file.size() - 4) : "";
 
-		if(pos != std::string::npos)
+		if((ext == ".mp3") || (ext == ".MP3"))
 		{
-			std::string start = sys_cmd.substr(0, pos);
-			std::string end = sys_cmd.substr(pos + 3);
-			sys_cmd = start + filename + end;
+			std::string next_path = filename.substr(0, filename.size() - current_file.size()) + next_file;
+			audio_converter.prefetch(next_path, config::audio_conversion_cmd);
 		}
 
-		search_str = "%out";
-		pos = sys_cmd.find(search_str);
+		break;
+	}
 
-		if(pos != std::string::npos)
-		{
-			std::string start = sys_cmd.substr(0, pos);
-			std::string end = sys_cmd.substr(pos + 4);
-			sys_cmd = start + out_file + end;
-		}
-		
-		//Check for a command processor on system and run audio conversion command
-		if(system(NULL))
-		{
-			std::cout<<"MMU::Converting audio file " << filename << "\n";
-			system(sys_cmd.c_str());
-			std::cout<<"MMU::Conversion complete\n";
-		}
+	if(status == MEDIA_CONVERT_DONE) { return play_yan_open_audio(out_file, false); }
 
-		else
-		{
-			std::cout<<"Conversion of audio file " << filename << " failed \n";
-			return false;
-		}
+	else if(status == MEDIA_CONVERT_FAILED)
+	{
+		std::cout<<"MMU::Play-Yan could not convert audio file " << filename << "\n";
+		return false;
+	}
+
+	//Audio stays silent until the conversion finishes, see play_yan_check_pending_audio()
+	play_yan.pending_audio_file = filename;
+	return true;
+}
 
-		if(SDL_LoadWAV(out_file.c_str(), &file_spec, &apu_stat->ext_audio.buffer, &apu_stat->ext_audio.length) == NULL)
+/****** Loads converted audio (.WAV) or SFX samples into the external audio buffer ******/
+bool AGB_MMU::play_yan_open_audio(std::string filename, bool is_sfx)
+{
+	SDL_AudioSpec file_spec;
+	u8* buffer = NULL;
+	u32 length = 0;
+
+	//Load music
+	if(!is_sfx)
+	{
+		if(SDL_LoadWAV(filename.c_str(), &file_spec, &buffer, &length) == NULL)
 		{
-			std::cout<<"MMU::Play-Yan could not load audio file: " << out_file << " :: " << SDL_GetError() << "\n";
+			std::cout<<"MMU::Play-Yan could not load audio file: " << filename << " :: " << SDL_GetError() << "\n";
 			return false;
 		}
 	}
@@ -1891,19 +1899,20 @@ bool AGB_MMU::play_yan_load_audio(std::string filename)
 			return false;
 		}
 
-		SDL_RWops* io_ops = SDL_AllocRW();
-		io_ops = SDL_RWFromMem(play_yan.sfx_data.data(), play_yan.sfx_data.size());
+		SDL_RWops* io_ops = SDL_RWFromMem(play_yan.sfx_data.data(), play_yan.sfx_data.size());
 
-		if(SDL_LoadWAV_RW(io_ops, 0, &file_spec, &apu_stat->ext_audio.buffer, &apu_stat->ext_audio.length) == NULL)
+		if(SDL_LoadWAV_RW(io_ops, 1, &file_spec, &buffer, &length) == NULL)
 		{
 			std::cout<<"MMU::Play-Yan could not load SFX samples : " << SDL_GetError() << "\n";
-		}		
+			return false;
+		}
 	}
 
 	//Check format, must be S16 audio, LSB
 	if(file_spec.format != AUDIO_S16)
 	{
 		std::cout<<"MMU::Play-Yan loaded file, but format is not Signed 16-bit LSB audio\n";
+		SDL_FreeWAV(buffer);
 		return false;
 	}
 
@@ -1911,11 +1920,18 @@ bool AGB_MMU::play_yan_load_audio(std::string filename)
 	if(file_spec.channels > 2)
 	{
 		std::cout<<"MMU::Play-Yan loaded file, but audio uses more than 2 channels\n";
+		SDL_FreeWAV(buffer);
 		return false;
 	}
 
+	//Audio output may already be running when a background conversion finishes
+	SDL_LockAudio();
+	SDL_FreeWAV(apu_stat->ext_audio.buffer);
+	apu_stat->ext_audio.buffer = buffer;
+	apu_stat->ext_audio.length = length;
 	apu_stat->ext_audio.frequency = file_spec.freq;
 	apu_stat->ext_audio.channels = file_spec.channels;
+	SDL_UnlockAudio();
 
 	play_yan.audio_channels = apu_stat->ext_audio.channels;
 	play_yan.audio_sample_rate = apu_stat->ext_audio.frequency;
@@ -1931,7 +1947,7 @@ bool AGB_MMU::play_yan_load_audio(std::string filename)
 	
 		play_yan.music_length = song_seconds;
 
-		if(play_yan.type != NINTENDO_MP3)
+		if((play_yan.type != NINTENDO_MP3) && (play_yan.music_length))
 		{
 			play_yan.tracker_update_size = (0x6400 / play_yan.music_length);
 		}
@@ -1942,6 +1958,26 @@ bool AGB_MMU::play_yan_load_audio(std::string filename)
 	return true;
 }
 
+/****** Finishes loading music once its background conversion is done ******/
+void AGB_MMU::play_yan_check_pending_audio()
+{
+	std::string out_file = "";
+	media_convert_status status = audio_converter.get_status(play_yan.pending_audio_file, config::audio_conversion_cmd, out_file);
+
+	if((status == MEDIA_CONVERT_QUEUED) || (status == MEDIA_CONVERT_ACTIVE)) { return; }
+
+	std::string filename = play_yan.pending_audio_file;
+	play_yan.pending_audio_file = "";
+
+	if((status == MEDIA_CONVERT_FAILED) || (!play_yan_open_audio(out_file, false)))
+	{
+		std::cout<<"MMU::Play-Yan could not convert audio file " << filename << "\n";
+
+		//If no audio could be loaded, use dummy length for song
+		if(play_yan.type == NINTENDO_MP3) { play_yan.music_length = 2; }
+	}
+}
+
 /****** Loads video that's already been converted - MJPEG video, 16-bit PCM-LE ******/
 bool AGB_MMU::play_yan_load_video(std::string filename)
 {
@@ -1951,96 +1987,34 @@ bool AGB_MMU::play_yan_load_video(std::string filename)
 	play_yan.audio_sample_rate = 0;
 
 	//Clear video data now - Prevents leftover video data from accidentally repeating
-	play_yan.video_bytes.clear();
+	play_yan.video_stream.close();
 	play_yan.video_frames.clear();
 
-	std::vector<u8> vid_info;
-	std::vector<u8> mus_info;
-	std::vector<u8> tmp_info;
-	std::ifstream vid_file(filename.c_str(), std::ios::binary);
-
-	if(!vid_file.is_open()) 
+	//Only the AVI index is read here, frames are read and decoded on demand during playback
+	if(!play_yan.video_stream.open(filename)) 
 	{
 		play_yan.video_frames.resize(10000, 0xFFFFFFFF);
-		std::cout<<"MMU::" << filename << " could not be opened. Check file path or permissions. \n";
+		std::cout<<"MMU::" << filename << " could not be opened. Check file path, permissions, or if file is valid AVI video. \n";
 		return false;
 	}
 
-	vid_file.seekg(0, vid_file.end);
-	u32 vid_file_size = vid_file.tellg();
-	vid_file.seekg(0, vid_file.beg);
-	vid_info.resize(vid_file_size);
-
-	vid_file.read(reinterpret_cast<char*> (&vid_info[0]), vid_file_size);
-	vid_file.close();
-
-	//Verify audio data format separately
-	play_yan_check_audio_from_video(vid_info);
-
-	u32 index = 0;
+	u32 frame_count = play_yan.video_stream.get_frame_count();
 
-	//Search for movi and idx1 FOURCC as start and endpoints of usable data
-	bool found_movi = false;
-
-	for(u32 x = 0; x < (vid_file_size - 4); x++)
-	{
-		if((vid_info[x] == 0x6D) && (vid_info[x + 1] == 0x6F)
-		&& (vid_info[x + 2] == 0x76) && (vid_info[x + 3] == 0x69))
-		{
-			index = x;
-			found_movi = true;
-		}
-	} 
-
-	if(!found_movi)
+	if(!frame_count)
 	{
+		play_yan.video_stream.close();
 		play_yan.video_frames.resize(10000, 0xFFFFFFFF);
-		std::cout<<"MMU::No movi FOURCC found in " << filename << ". Check if file is valid AVI video.\n";
+		std::cout<<"MMU::No video data found in " << filename << ". Check if file is valid AVI video.\n";
 		return false;
 	}
 
-	for(u32 x = index; x < vid_file_size; x++)
-	{
-		if(x < (vid_file_size - 4))
-		{
-
-			if((vid_info[x] == 0x69) && (vid_info[x + 1] == 0x64)
-			&& (vid_info[x + 2] == 0x78) && (vid_info[x + 3] == 0x31))
-			{
-				break;
-			}
-		}
+	//Frame table only tracks frame numbers, the AVI reader keeps the file offsets
+	play_yan.video_frames.resize(frame_count);
+	for(u32 x = 0; x < frame_count; x++) { play_yan.video_frames[x] = x; }
 
-		tmp_info.push_back(vid_info[x]);
-	}
-
-	//Search and parse each 00dc FOURCC - Video Frames
-	for(u32 x = 0; x < (tmp_info.size() - 4); x++)
-	{
-		if((tmp_info[x] == 0x30) && (tmp_info[x + 1] == 0x30)
-		&& (tmp_info[x + 2] == 0x64) && (tmp_info[x + 3] == 0x63))
-		{
-			play_yan.video_frames.push_back(play_yan.video_bytes.size());
-
-			x += 4;
-			u32 len = (tmp_info[x + 3] << 24) | (tmp_info[x + 2] << 16) | (tmp_info[x + 1] << 8) | tmp_info[x];
-
-			x += 4;
-			for(u32 y = 0; y < len; y++)
-			{
-				play_yan.video_bytes.push_back(tmp_info[x + y]);
-			}
-
-			x += (len - 1);
-		}
-	}
-
-	if(play_yan.video_frames.empty())
-	{
-		play_yan.video_frames.resize(10000, 0xFFFFFFFF);
-		std::cout<<"MMU::No video data found in " << filename << ". Check if file is valid AVI video.\n";
-		return false;
-	}
+	//Verify audio data format separately
+	play_yan.audio_channels = play_yan.video_stream.reader.audio_channels;
+	play_yan.audio_sample_rate = play_yan.video_stream.reader.audio_sample_rate;
 
 	u32 run_time = play_yan.video_frames.size() / 30;
 	play_yan.video_length = play_yan.video_frames.size() * 33.3333;
@@ -2052,33 +2026,14 @@ bool AGB_MMU::play_yan_load_video(std::string filename)
 	//Check for thumbnail. If none exists, make one for the user
 	std::string thumb_file = util::get_filename_no_ext(filename) + ".bmp";
 	SDL_Surface* thumb_pixels = SDL_LoadBMP(thumb_file.c_str());
-	SDL_RWops* io_ops = SDL_AllocRW();
 
 	if(thumb_pixels == NULL)
 	{
 		std::vector<u8> new_thumb;
-		u32 mid = (play_yan.video_frames.size() / 2);
-		u32 start = 0;
-		u32 end = 0;
-		
-		if(play_yan.video_frames.size() >= 2)
-		{
-			start = play_yan.video_frames[mid];
-			end = play_yan.video_frames[mid + 1];
-		}
+		play_yan.video_stream.reader.read_frame(frame_count / 2, new_thumb);
 
-		else
-		{
-			end = play_yan.video_bytes.size();
-		}
-
-		for(u32 x = start; x < end; x++)
-		{
-			new_thumb.push_back(play_yan.video_bytes[x]);
-		}
-
-		io_ops = SDL_RWFromMem(new_thumb.data(), new_thumb.size());
-		SDL_Surface* temp_surface = IMG_LoadTyped_RW(io_ops, 0, "JPG");
+		SDL_RWops* io_ops = SDL_RWFromMem(new_thumb.data(), new_thumb.size());
+		SDL_Surface* temp_surface = (io_ops != NULL) ? IMG_LoadTyped_RW(io_ops, 1, "JPG") : NULL;
 		SDL_Surface* final_surface = SDL_CreateRGBSurface(SDL_SWSURFACE, 60, 40, 32, 0, 0, 0, 0);
 
 		SDL_Rect dest_rect;
@@ -2094,38 +2049,20 @@ bool AGB_MMU::play_yan_load_video(std::string filename)
 	}
 
 	SDL_FreeSurface(thumb_pixels);
-	SDL_FreeRW(io_ops);
-
-	//Search and parse each 01wb FOURCC - Audio Data
-	for(u32 x = 0; x < (tmp_info.size() - 4); x++)
-	{
-		if((tmp_info[x] == 0x30) && (tmp_info[x + 1] == 0x31)
-		&& (tmp_info[x + 2] == 0x77) && (tmp_info[x + 3] == 0x62))
-		{
-			x += 4;
-			u32 len = (tmp_info[x + 3] << 24) | (tmp_info[x + 2] << 16) | (tmp_info[x + 1] << 8) | tmp_info[x];
-
-			x += 4;
-			for(u32 y = 0; y < len; y++)
-			{
-				mus_info.push_back(tmp_info[x + y]);
-			}
-
-			x += (len - 1);
-		}
-	}
 
 	//Create .WAV file in memory, then have SDL load it for external audio
 	if(play_yan.audio_sample_rate && play_yan.audio_channels)
 	{
-		std::vector<u8> mus_header;
-		util::build_wav_header(mus_header, play_yan.audio_sample_rate, play_yan.audio_channels, mus_info.size());
+		//Read all audio chunks straight into the .WAV body
+		u32 mus_size = play_yan.video_stream.reader.get_audio_size();
+		std::vector<u8> mus_info;
+		play_yan.video_stream.reader.read_audio(mus_info);
 
-		std::vector<u8> mus_file = mus_header;
+		std::vector<u8> mus_file;
+		util::build_wav_header(mus_file, play_yan.audio_sample_rate, play_yan.audio_channels, mus_size);
 		mus_file.insert(mus_file.end(), mus_info.begin(), mus_info.end());
 
-		io_ops = SDL_AllocRW();
-		io_ops = SDL_RWFromMem(mus_file.data(), mus_file.size());
+		SDL_RWops* io_ops = SDL_RWFromMem(mus_file.data(), mus_file.size());
 
 		if(io_ops != NULL)
 		{
@@ -2139,9 +2076,9 @@ bool AGB_MMU::play_yan_load_video(std::string filename)
 			{
 				std::cout<<"MMU::Play-Yan could not load audio from video : " << SDL_GetError() << "\n";
 			}
-		}
 
-		SDL_FreeRW(io_ops);
+			SDL_FreeRW(io_ops);
+		}
 	}
 
 	return true;
@@ -2177,54 +2114,6 @@ bool AGB_MMU::play_yan_load_sfx(std::string filename)
 	return true;
 }
 
-/****** Verifies audio data (if any) from a video file ******/
-void AGB_MMU::play_yan_check_audio_from_video(std::vector <u8> &data)
-{
-	u32 i = 0;
-
-	//Search for auds FOURCC as start of usable data
-	bool found_auds = false;
-
-	for(u32 x = i; x < (data.size() - 4); x++)
-	{
-		if((data[x] == 0x61) && (data[x + 1] == 0x75)
-		&& (data[x + 2] == 0x64) && (data[x + 3] == 0x73))
-		{
-			i = x + 4;
-			found_auds = true;
-		}
-	}
-
-	if(!found_auds) { return; }
-
-	//Search for strf FOURCC as start of usable data
-	bool found_strf = false;
-
-	for(u32 x = i; x < (data.size() - 4); x++)
-	{
-		if((data[x] == 0x73) && (data[x + 1] == 0x74)
-		&& (data[x + 2] == 0x72) && (data[x + 3] == 0x66))
-		{
-			i = x + 4;
-			found_strf = true;
-		}
-	}
-
-	if(!found_strf) { return; }
-
-	//Make sure there is enough data to read - strf size (4) + strf data (16)
-	if((i + 20) < data.size())
-	{
-		u8 audio_type = data[i + 4];
-
-		//Verify audio type is PCM
-		if(audio_type != 0x01) { return; }
-
-		play_yan.audio_channels = data[i + 6];
-		play_yan.audio_sample_rate = (data[i + 11] << 24) | (data[i + 10] << 16) | (data[i + 9] << 8) | data[i + 8];	
-	}
-}
-
 /****** Grabs the data for a specific frame ******/
 void AGB_MMU::play_yan_grab_frame_data(u32 frame)
 {
@@ -2236,40 +2125,26 @@ void AGB_MMU::play_yan_grab_frame_data(u32 frame)
 	//Abort if dummy frames are present
 	if(play_yan.video_frames[0] == 0xFFFFFFFF) { return; }
 
-	u32 start = play_yan.video_frames[frame];
-	u32 end = 0;
-
-	//Check to see if this is the last frame
-	//In that case, set end to be last byte of video data
-	if((frame + 1) == play_yan.video_frames.size()) { end = play_yan.video_bytes.size(); }
-	else { end = play_yan.video_frames[frame + 1]; }
-
-	std::vector<u8> new_frame;
-
-	for(u32 x = start; x < end; x++)
-	{
-		new_frame.push_back(play_yan.video_bytes[x]);
-	}
-	
-	//Decode JPG data from memory into SDL_Surface
-	SDL_RWops* io_ops = SDL_AllocRW();
-	io_ops = SDL_RWFromMem(new_frame.data(), new_frame.size());
+	//Frames are normally already decoded ahead of time by the video stream's thread
+	mjpeg_stream::frame& decoded = play_yan.decoded_frame;
 
-	SDL_Surface* temp_surface = IMG_LoadTyped_RW(io_ops, 0, "JPG");
+	//Frames are converted as 240 pixels wide, skip anything too small to hold that
+	bool valid_frame = play_yan.video_stream.get_frame(frame, decoded);
+	if((valid_frame) && ((decoded.height < 160) || (decoded.pixels.size() < (decoded.height * 720)))) { valid_frame = false; }
 
-	if(temp_surface != NULL)
+	if(valid_frame)
 	{
 		//Copy and convert data into video frame buffer used by Play-Yan
 		play_yan.video_data.clear();
 		play_yan.video_data.resize(0x12C00, 0x00);
 
 		u32 w = 240;
-		u32 h = temp_surface->h;
+		u32 h = decoded.height;
 
-		start = ((h - 160) / 2) * (w * 3);
+		u32 start = ((h - 160) / 2) * (w * 3);
 		if(h > 160) { h = 160; }
 
-		u8* pixel_data = (u8*)temp_surface->pixels;
+		u8* pixel_data = &decoded.pixels[0];
 
 		for(u32 index = 0, a = 0, i = start; a < (w * h); a++, i+=3)
 		{
@@ -2308,9 +2183,6 @@ void AGB_MMU::play_yan_grab_frame_data(u32 frame)
 		std::cout<<"MMU::Warning - Could not decode video frame #" << std::dec << frame << std::hex << "\n";
 	}
 
-	SDL_FreeSurface(temp_surface);
-	SDL_FreeRW(io_ops);
-
 	#endif
 }
 
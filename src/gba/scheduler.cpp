@@ -0,0 +1,92 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : scheduler.cpp
+// Date : October 16, 2026
+// Description : GBA event scheduler
+//
+// Keeps track of when components driven by the CPU clock (LCD, timers, DMA) next need to run
+// The CPU runs until the next pending event instead of stepping every component each cycle
+
+#include "scheduler.h"
+
+/****** Scheduler Constructor ******/
+AGB_scheduler::AGB_scheduler()
+{
+	reset();
+}
+
+/****** Scheduler Destructor ******/
+AGB_scheduler::~AGB_scheduler() { }
+
+/****** Scheduler Reset ******/
+void AGB_scheduler::reset()
+{
+	timestamp = 0;
+	next_event_time = 0xFFFFFFFFFFFFFFFF;
+
+	for(u32 x = 0; x < AGB_EVENT_COUNT; x++)
+	{
+		event_time[x] = 0;
+		event_base[x] = 0;
+		event_pending[x] = false;
+	}
+}
+
+/****** Schedules an event to run after a number of cycles from now - Replaces any previous time for the event ******/
+void AGB_scheduler::schedule(agb_event_types event, u32 cycles)
+{
+	event_time[event] = timestamp + cycles;
+	event_base[event] = timestamp;
+	event_pending[event] = true;
+
+	if(event_time[event] < next_event_time) { next_event_time = event_time[event]; }
+	else { update_next_event(); }
+}
+
+/****** Removes an event from the schedule ******/
+void AGB_scheduler::cancel(agb_event_types event)
+{
+	if(!event_pending[event]) { return; }
+
+	event_pending[event] = false;
+	update_next_event();
+}
+
+/****** Marks the current time as the point an event's elapsed cycles are counted from ******/
+void AGB_scheduler::rebase(agb_event_types event)
+{
+	event_base[event] = timestamp;
+}
+
+/****** Returns the earliest pending event - Ties go to the lowest event type ******/
+agb_event_types AGB_scheduler::get_next_event() const
+{
+	u32 next_event = AGB_EVENT_COUNT;
+
+	for(u32 x = 0; x < AGB_EVENT_COUNT; x++)
+	{
+		if(!event_pending[x]) { continue; }
+		if((next_event == AGB_EVENT_COUNT) || (event_time[x] < event_time[next_event])) { next_event = x; }
+	}
+
+	return agb_event_types(next_event);
+}
+
+/****** Returns the number of cycles passed since an event was scheduled or rebased ******/
+u32 AGB_scheduler::get_elapsed(agb_event_types event) const
+{
+	return (timestamp - event_base[event]);
+}
+
+/****** Recalculates the time of the earliest pending event ******/
+void AGB_scheduler::update_next_event()
+{
+	next_event_time = 0xFFFFFFFFFFFFFFFF;
+
+	for(u32 x = 0; x < AGB_EVENT_COUNT; x++)
+	{
+		if((event_pending[x]) && (event_time[x] < next_event_time)) { next_event_time = event_time[x]; }
+	}
+}
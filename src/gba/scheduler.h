@@ -0,0 +1,61 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : scheduler.h
+// Date : October 16, 2026
+// Description : GBA event scheduler
+//
+// Keeps track of when components driven by the CPU clock (LCD, timers, DMA) next need to run
+// The CPU runs until the next pending event instead of stepping every component each cycle
+
+#ifndef GBA_SCHEDULER
+#define GBA_SCHEDULER
+
+#include "common.h"
+
+//Scheduler event enumerations
+//Events due on the same cycle run in this order
+enum agb_event_types
+{
+	AGB_EVENT_TIMER_UPDATE,
+	AGB_EVENT_LCD,
+	AGB_EVENT_TIMER_0,
+	AGB_EVENT_TIMER_1,
+	AGB_EVENT_TIMER_2,
+	AGB_EVENT_TIMER_3,
+	AGB_EVENT_DMA,
+	AGB_EVENT_COUNT
+};
+
+class AGB_scheduler
+{
+	public:
+
+	//Current system time in cycles
+	u64 timestamp;
+
+	//Time of the earliest pending event
+	u64 next_event_time;
+
+	u64 event_time[AGB_EVENT_COUNT];
+	u64 event_base[AGB_EVENT_COUNT];
+	bool event_pending[AGB_EVENT_COUNT];
+
+	AGB_scheduler();
+	~AGB_scheduler();
+
+	void reset();
+	void schedule(agb_event_types event, u32 cycles);
+	void cancel(agb_event_types event);
+	void rebase(agb_event_types event);
+
+	agb_event_types get_next_event() const;
+	u32 get_elapsed(agb_event_types event) const;
+
+	private:
+
+	void update_next_event();
+};
+
+#endif // GBA_SCHEDULER
@@ -361,6 +361,7 @@ void ARM7::swi_softreset()
 
 	//Clear top 0x200 bytes of the 32KB WRAM
 	for(int x = 0x3007E00; x < 0x3008000; x++) { mem->memory_map[x] = 0; }
+	mem->invalidate_code(0x3007E00, 0x200);
 
 	arm_mode = ARM;
 	in_interrupt = false;
@@ -446,7 +447,7 @@ void ARM7::swi_halt()
 	//Run controllers until an interrupt happens
 	while(halt)
 	{
-		clock();
+		skip_to_next_event();
 
 		if_check = mem->read_u16(REG_IF);
 		ie_check = mem->read_u16(REG_IE);
@@ -645,6 +646,13 @@ void ARM7::swi_cpufastset()
 
 	u32 temp = 0;
 
+	//Move plain memory in bulk, anything left over goes through the normal memory handlers
+	u32 done = (copy_fill == 0) ? mem->copy_block(dest_addr, src_addr, (transfer_size << 2)) : mem->fill_block(dest_addr, src_addr, (transfer_size << 2), 4);
+
+	if(copy_fill == 0) { src_addr += done; }
+	dest_addr += done;
+	transfer_size -= (done >> 2);
+
 	while(transfer_size != 0)
 	{
 		//Copy from source to destination
@@ -709,6 +717,14 @@ void ARM7::swi_cpuset()
 	u32 temp_32 = 0;
 	u16 temp_16 = 0;
 
+	//Move plain memory in bulk, anything left over goes through the normal memory handlers
+	u8 unit = (transfer_type == 0) ? 2 : 4;
+	u32 done = (copy_fill == 0) ? mem->copy_block(dest_addr, src_addr, (transfer_size * unit)) : mem->fill_block(dest_addr, src_addr, (transfer_size * unit), unit);
+
+	if(copy_fill == 0) { src_addr += done; }
+	dest_addr += done;
+	transfer_size -= (done / unit);
+
 	while(transfer_size != 0)
 	{
 		//Copy from source to destination
@@ -790,7 +806,7 @@ void ARM7::swi_intrwait()
 	//Run controllers until an interrupt is generated
 	while(!fire_interrupt)
 	{
-		clock();
+		skip_to_next_event();
 
 		current_if = mem->read_u16_fast(REG_IF);
 		ie_check = mem->read_u16_fast(REG_IE);
@@ -836,7 +852,7 @@ void ARM7::swi_vblankintrwait()
 	//Run controllers until an interrupt is generated
 	while(!fire_interrupt && !is_vblank)
 	{
-		clock();
+		skip_to_next_event();
 
 		if_check = mem->read_u16_fast(REG_IF);
 		ie_check = mem->read_u16_fast(REG_IE);
@@ -966,29 +982,22 @@ void ARM7::swi_lz77uncompvram()
 	//When uncompression starts, move 5 bytes from source address (header + flag)
 	u32 data_ptr = (src_addr + 4);
 
-	u8 temp = 0;
+	//Uncompress into a local buffer, then write it all at once
+	std::vector<u8> output(data_size, 0);
+	u32 out_pos = 0;
 
-	//Uncompress data
-	while(data_size > 0)
+	while(out_pos < data_size)
 	{
 		//Grab flag data
 		u8 flag_data = mem->read_u8(data_ptr++);
 
 		//Process 8 blocks
-		for(int x = 7; x >= 0; x--)
+		for(int x = 7; (x >= 0) && (out_pos < data_size); x--)
 		{
 			u8 block_type = (flag_data & (1 << x)) ? 1 : 0;
 
 			//Block Type 0 - Uncompressed
-			if(block_type == 0)
-			{
-				temp = mem->read_u8(data_ptr++);
-				mem->write_u8(dest_addr++, temp);
-				
-				data_size--;
-				if(data_size == 0) { return; }
-			}
-
+			if(block_type == 0) { output[out_pos++] = mem->read_u8(data_ptr++); }
 
 			//Block Type 1 - Compressed
 			else
@@ -1002,18 +1011,22 @@ void ARM7::swi_lz77uncompvram()
 				u8 length = ((compressed_block >> 4) & 0xF) + 3;
 
 				//Copy length+3 Bytes from dest_addr-length-1 to dest_addr
-				for(int y = 0; y < length; y++)
+				//Anything before the start of the output comes from memory already at the destination
+				for(int y = 0; (y < length) && (out_pos < data_size); y++)
 				{
-					temp = mem->read_u8(dest_addr - distance - 1);
-					mem->write_u8(dest_addr, temp);
-					
-					dest_addr++;
-					data_size--;
-					if(data_size == 0) { return; }
+					if(out_pos > distance) { output[out_pos] = output[out_pos - distance - 1]; }
+					else { output[out_pos] = mem->read_u8(dest_addr + out_pos - distance - 1); }
+
+					out_pos++;
 				}
 			}
 		}
 	}
+
+	//Write plain memory in bulk, anything left over goes through the normal memory handlers
+	u32 done = (data_size) ? mem->write_block(dest_addr, &output[0], data_size) : 0;
+
+	for(u32 x = done; x < data_size; x++) { mem->write_u8(dest_addr + x, output[x]); }
 }
 
 /****** HLE implementation of HuffUnComp ******/
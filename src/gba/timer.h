@@ -14,6 +14,7 @@
 
 #include "common.h"
 
+//Running timers only update counter and cycles (prescalar progress) when read, written, or overflowing
 struct gba_timer
 {
 	u16 counter;
@@ -14,6 +14,7 @@
 #include "nds/core.h"
 #include "min/core.h"
 #include "common/config.h"
+#include "common/headless.h"
 
 #include <SDL2/SDL_main.h>
 
@@ -23,9 +24,6 @@ int main(int argc, char* args[])
 
 	core_emu* gbe_plus = NULL;
 
-	//Start SDL from the main thread now, report specific init errors later in the core
-	SDL_Init(SDL_INIT_VIDEO);
-
 	//Grab command-line arguments
 	for(int x = 0; x++ < argc - 1;) 
 	{ 
@@ -49,6 +47,10 @@ int main(int argc, char* args[])
 	//These will override .ini options!
 	if(!parse_cli_args()) { return 0; }
 
+	//Start SDL from the main thread now, report specific init errors later in the core
+	//Headless mode never opens a window, so video is left uninitialized
+	SDL_Init(config::headless ? 0 : SDL_INIT_VIDEO);
+
 	//Get emulated system type from file
 	config::gb_type = get_system_type_from_file(config::rom_file);
 
@@ -109,6 +111,9 @@ int main(int argc, char* args[])
 		if(!gbe_plus->read_firmware(config::nds_firmware_path)) { return 0; }
 	}
 
+	//Replace window, audio device, and frame limiter with headless batch execution
+	if(config::headless) { headless::init(gbe_plus); }
+
 	//Engage the core
 	gbe_plus->start();
 	gbe_plus->db_unit.debug_mode = config::use_debugger;
@@ -116,10 +121,13 @@ int main(int argc, char* args[])
 	if(gbe_plus->db_unit.debug_mode) { SDL_CloseAudio(); }
 
 	//Disbale mouse cursor in SDL, it's annoying
-	SDL_ShowCursor(SDL_DISABLE);
+	if(!config::headless) { SDL_ShowCursor(SDL_DISABLE); }
 
 	//Actually run the core
 	gbe_plus->run_core();
 
+	//Print hashes of the final frame, audio, and save data
+	if(config::headless) { headless::report(); }
+
 	return 0;
 }  
@@ -12,6 +12,7 @@
 #include <cmath>
 
 #include "apu.h"
+#include "common/headless.h"
 
 /****** APU Constructor ******/
 MIN_APU::MIN_APU()
@@ -61,8 +62,8 @@ bool MIN_APU::init()
 		putenv(const_cast<char*>(env_var.c_str()));
 	}
 
-	//Initialize audio subsystem
-	if(SDL_InitSubSystem(SDL_INIT_AUDIO) == -1)
+	//Initialize audio subsystem - Headless mode pulls samples without an audio device
+	if((!config::headless) && (SDL_InitSubSystem(SDL_INIT_AUDIO) == -1))
 	{
 		std::cout<<"APU::Error - Could not initialize SDL audio\n";
 		return false;
@@ -76,8 +77,11 @@ bool MIN_APU::init()
     	desired_spec.callback = min_audio_callback;
     	desired_spec.userdata = this;
 
+	//Allocate mixing buffers up front
+	mixer.init(1, (desired_spec.samples * desired_spec.channels));
+
     	//Open SDL audio for desired specifications
-	if(SDL_OpenAudio(&desired_spec, NULL) < 0) 
+	if(headless::open_audio(&desired_spec) < 0) 
 	{ 
 		std::cout<<"APU::Failed to open audio\n";
 		return false; 
@@ -184,53 +188,44 @@ void MIN_APU::buffer_channel()
 void min_audio_callback(void* _apu, u8 *_stream, int _length)
 {
 	s16* stream = (s16*) _stream;
-	int length = _length/2;
-
-	std::vector<s16> channel_stream(length);
+	u32 length = _length/2;
 
 	MIN_APU* apu_link = (MIN_APU*) _apu;
-	apu_link->generate_samples(&channel_stream[0], length);
-
-	double channel_ratio = apu_link->apu_stat.channel_master_volume / 128.0;
+	audio_mixer& mixer = apu_link->mixer;
 
-	//Custom software mixing
-	for(u32 x = 0; x < length; x++)
+	//Only mix as many samples as the preallocated buffers hold, silence anything else
+	if(length > mixer.get_max_length())
 	{
-		//Multiply output by volume ratio
-		s16 out_sample = channel_stream[x] * channel_ratio;
-
-		stream[x] = out_sample;
+		for(u32 x = mixer.get_max_length(); x < length; x++) { stream[x] = 0; }
+		length = mixer.get_max_length();
 	}
+
+	apu_link->generate_samples(mixer.get_channel(0), length);
+
+	//Custom software mixing - Multiply output by volume (out of 128)
+	mixer.clear(length);
+	mixer.add(mixer.get_channel(0), length, apu_link->apu_stat.channel_master_volume);
+	mixer.output(stream, length, 1, 128);
+
 }
 
 /****** Read APU data from save state ******/
-bool MIN_APU::apu_read(u32 offset, std::string filename)
+bool MIN_APU::apu_read(save_state_buffer& state)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary);
-	
-	if(!file.is_open()) { return false; }
-
-	//Go to offset
-	file.seekg(offset);
-
-	//Serialize misc APU data from save state
-	file.read((char*)&apu_stat, sizeof(apu_stat));
+	//Serialize misc APU data from save state - Lock out the audio callback while the data is replaced
+	SDL_LockAudio();
+	state.read((char*)&apu_stat, sizeof(apu_stat));
+	SDL_UnlockAudio();
 
-	file.close();
-	return true;
+	return state.good();
 }
 
 /****** Read MMU data from save state ******/
-bool MIN_APU::apu_write(std::string filename)
+bool MIN_APU::apu_write(save_state_buffer& state)
 {
-	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::app);
-	
-	if(!file.is_open()) { return false; }
-
 	//Serialize misc APU data from save state
-	file.write((char*)&apu_stat, sizeof(apu_stat));
+	state.write((char*)&apu_stat, sizeof(apu_stat));
 
-	file.close();
 	return true;
 }
 
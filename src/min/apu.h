@@ -15,6 +15,7 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_audio.h>
 #include "mmu.h"
+#include "common/audio_mixer.h"
 
 class MIN_APU
 {
@@ -27,6 +28,9 @@ class MIN_APU
 
 	SDL_AudioSpec desired_spec;
 
+	//Preallocated buffers for the audio callback
+	audio_mixer mixer;
+
 	MIN_APU();
 	~MIN_APU();
 
@@ -37,8 +41,8 @@ class MIN_APU
 	void generate_samples(s16* stream, int length);
 
 	//Serialize data for save state loading/saving
-	bool apu_read(u32 offset, std::string filename);
-	bool apu_write(std::string filename);
+	bool apu_read(save_state_buffer& state);
+	bool apu_write(save_state_buffer& state);
 	u32 size();
 };
 
@@ -19,6 +19,7 @@
 #endif
 
 #include "common/util.h"
+#include "common/headless.h"
 
 #include "core.h"
 
@@ -138,6 +139,9 @@ void MIN_core::reset()
 	//Re-read BIOS file
 	if((config::use_bios) && (!read_bios(config::bios_file))) { can_reset = false; }
 
+	//Older rewind states belong to the previous session
+	rewind.clear();
+
 	//Start everything all over again
 	if(can_reset) { start(); }
 	else { running = false; }
@@ -151,28 +155,20 @@ void MIN_core::load_state(u8 slot)
 	std::string state_file = config::rom_file + ".ss";
 	state_file += id;
 
-	u32 offset = 0;
+	save_state_buffer state;
 
 	//Check if save state is accessible
-	std::ifstream test(state_file.c_str());
-	
-	if(!test.good())
+	if(!state.load_file(state_file))
 	{
-		config::osd_message = "NO SS " + util::to_str(slot);
+		config::osd_message = "INVALID SAVE STATE " + util::to_str(slot);
 		config::osd_count = 180;
 		return;
 	}
 
-	if(!core_cpu.cpu_read(offset, state_file)) { return; }
-	offset += core_cpu.size();
-
-	if(!core_mmu.mmu_read(offset, state_file)) { return; }
-	offset += core_mmu.size();
-
-	if(!core_cpu.controllers.audio.apu_read(offset, state_file)) { return; }
-	offset += core_cpu.controllers.audio.size();
+	if(!deserialize_state(state)) { return; }
 
-	if(!core_cpu.controllers.video.lcd_read(offset, state_file)) { return; }
+	//Don't rewind past the loaded state
+	rewind.clear();
 
 	std::cout<<"GBE::Loaded state " << state_file << "\n";
 
@@ -189,10 +185,10 @@ void MIN_core::save_state(u8 slot)
 	std::string state_file = config::rom_file + ".ss";
 	state_file += id;
 
-	if(!core_cpu.cpu_write(state_file)) { return; }
-	if(!core_mmu.mmu_write(state_file)) { return; }
-	if(!core_cpu.controllers.audio.apu_write(state_file)) { return; }
-	if(!core_cpu.controllers.video.lcd_write(state_file)) { return; }
+	save_state_buffer state;
+
+	if(!serialize_state(state)) { return; }
+	if(!state.save_file(state_file)) { return; }
 
 	std::cout<<"GBE::Saved state " << state_file << "\n";
 
@@ -201,14 +197,59 @@ void MIN_core::save_state(u8 slot)
 	config::osd_count = 180;
 }
 
+/****** Saves the current state of the core to a memory buffer ******/
+bool MIN_core::serialize_state(save_state_buffer& state)
+{
+	state.begin_write(STATE_SYSTEM_MIN);
+
+	state.begin_section(STATE_SECTION_CPU);
+	if(!core_cpu.cpu_write(state)) { return false; }
+
+	state.begin_section(STATE_SECTION_MMU);
+	if(!core_mmu.mmu_write(state)) { return false; }
+
+	state.begin_section(STATE_SECTION_APU);
+	if(!core_cpu.controllers.audio.apu_write(state)) { return false; }
+
+	state.begin_section(STATE_SECTION_LCD);
+	if(!core_cpu.controllers.video.lcd_write(state)) { return false; }
+
+	state.end_write();
+	return true;
+}
+
+/****** Loads the state of the core from a memory buffer ******/
+bool MIN_core::deserialize_state(save_state_buffer& state)
+{
+	if(!state.begin_read(STATE_SYSTEM_MIN)) { return false; }
+
+	if((!state.find_section(STATE_SECTION_CPU)) || (!core_cpu.cpu_read(state))) { return false; }
+	if((!state.find_section(STATE_SECTION_MMU)) || (!core_mmu.mmu_read(state))) { return false; }
+	if((!state.find_section(STATE_SECTION_APU)) || (!core_cpu.controllers.audio.apu_read(state))) { return false; }
+	if((!state.find_section(STATE_SECTION_LCD)) || (!core_cpu.controllers.video.lcd_read(state))) { return false; }
+
+	return true;
+}
+
 /****** Run the core in a loop until exit ******/
 void MIN_core::run_core()
 {
+	bool rewind_frame = false;
+
 	//Begin running the core
 	while(running)
 	{
+		//Capture or restore rewind states once per frame
+		if(core_cpu.controllers.video.lcd_stat.prc_counter == 1)
+		{
+			if(!rewind_frame) { rewind.update(this); }
+			rewind_frame = true;
+		}
+
+		else { rewind_frame = false; }
+
 		//Handle SDL Events
-		if((core_cpu.controllers.video.lcd_stat.prc_counter == 1) && SDL_PollEvent(&event))
+		if((!config::headless) && (core_cpu.controllers.video.lcd_stat.prc_counter == 1) && SDL_PollEvent(&event))
 		{
 			//X out of a window
 			if(event.type == SDL_QUIT) { stop(); SDL_Quit(); }
@@ -259,6 +300,7 @@ void MIN_core::run_core()
 			}
 
 			//Reset system cycles for next instruction
+			if(config::headless) { headless::add_cycles(core_cpu.system_cycles); }
 			core_cpu.debug_cycles += core_cpu.system_cycles;
 			core_cpu.system_cycles = 0;
 
@@ -266,7 +308,10 @@ void MIN_core::run_core()
 
 			if(db_unit.debug_mode) { debug_step(); }
 
+			u16 opcode_addr = core_cpu.reg.pc;
 			core_cpu.execute();
+
+			if(config::use_idle_loop_detection) { core_cpu.check_idle_loop(opcode_addr); }
 			core_cpu.clock_system();
 		}
 
@@ -309,6 +354,12 @@ void MIN_core::handle_hotkey(SDL_Event& event)
 		SDL_Quit();
 	}
 
+	//Rewind while the rewind hotkey is held
+	else if(((event.type == SDL_KEYDOWN) || (event.type == SDL_KEYUP)) && (event.key.keysym.sym == config::hotkey_rewind))
+	{
+		rewind.set_active(event.type == SDL_KEYDOWN);
+	}
+
 	//Mute or unmute sound on M
 	else if((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == config::hotkey_mute) && (!config::use_external_interfaces))
 	{
@@ -533,6 +584,9 @@ void MIN_core::handle_hotkey(int input, bool pressed)
 	//Toggle turbo off
 	else if((input == config::hotkey_turbo) && (!pressed)) { config::turbo = false; }
 
+	//Rewind while the rewind hotkey is held
+	else if(input == config::hotkey_rewind) { rewind.set_active(pressed); }
+
 	//Switch current netplay connection on F3 
 	else if((input == SDLK_F3) && (core_mmu.ir_stat.sync_timeout == 0) && (pressed))
 	{
@@ -630,7 +684,12 @@ u32 MIN_core::ex_get_reg(u8 reg_index)
 }
 
 /****** Read binary file to memory ******/
-bool MIN_core::read_file(std::string filename) { return core_mmu.read_file(filename); }
+bool MIN_core::read_file(std::string filename)
+{
+	//Rewind states from another ROM can't be restored
+	rewind.clear();
+	return core_mmu.read_file(filename);
+}
 
 /****** Read BIOS file into memory ******/
 bool MIN_core::read_bios(std::string filename) 
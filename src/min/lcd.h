@@ -58,8 +58,8 @@ class MIN_LCD
 	u32 mix_colors[64];
 
 	//Serialize data for save state loading/saving
-	bool lcd_read(u32 offset, std::string filename);
-	bool lcd_write(std::string filename);
+	bool lcd_read(save_state_buffer& state);
+	bool lcd_write(save_state_buffer& state);
 
 	private:
 
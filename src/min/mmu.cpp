@@ -65,6 +65,7 @@ void MIN_MMU::reset()
 	enable_rtc = (config::min_config & 0x2) ? true : false;
 	rtc_cycles = 0;
 	rtc = 0;
+	write_count = 0;
 
 	for(u32 x = 0; x < 0x2000; x++) { eeprom.data[x] = 0xFF; }
 
@@ -214,6 +215,8 @@ void MIN_MMU::write_u8(u32 address, u8 value)
 	debug_addr = address;
 	#endif
 
+	write_count++;
+
 	//Only write to RAM and MMIO registers
 	if((address > 0xFFF)  && (address < 0x2100)) { memory_map[address] = value; }
 
@@ -1436,73 +1439,60 @@ void MIN_MMU::set_lcd_data(min_lcd_data* ex_lcd_stat) { lcd_stat = ex_lcd_stat;
 void MIN_MMU::set_apu_data(min_apu_data* ex_apu_stat) { apu_stat = ex_apu_stat; }
 
 /****** Read MMU data from save state ******/
-bool MIN_MMU::mmu_read(u32 offset, std::string filename)
+bool MIN_MMU::mmu_read(save_state_buffer& state)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary);
-	
-	if(!file.is_open()) { return false; }
-
-	//Go to offset
-	file.seekg(offset);
-
 	//Serialize RAM and hardware MMIO registers from save state
 	u8* ex_mem = &memory_map[0x1000];
-	file.read((char*)ex_mem, 0x1100);
+	state.read((char*)ex_mem, 0x1100);
 
 	//Serialize IRQ stuff to save state
 	for(u32 x = 0; x < 32; x++)
 	{
-		file.read((char*)&irq_priority[x], sizeof(irq_priority[x]));
-		file.read((char*)&irq_enable[x], sizeof(irq_enable[x]));
-		file.read((char*)&irq_vectors[x], sizeof(irq_vectors[x]));
+		state.read((char*)&irq_priority[x], sizeof(irq_priority[x]));
+		state.read((char*)&irq_enable[x], sizeof(irq_enable[x]));
+		state.read((char*)&irq_vectors[x], sizeof(irq_vectors[x]));
 	}
 
 	//Serialize misc data from MMU from save state
-	file.read((char*)&master_irq_flags, sizeof(master_irq_flags));
-	file.read((char*)&osc_1_enable, sizeof(osc_1_enable));
-	file.read((char*)&osc_2_enable, sizeof(osc_2_enable));
-	file.read((char*)&save_eeprom, sizeof(save_eeprom));
-	file.read((char*)&rtc, sizeof(rtc));
-	file.read((char*)&enable_rtc, sizeof(enable_rtc));
-	file.read((char*)&eeprom, sizeof(eeprom));
-	file.read((char*)&sed, sizeof(sed));
-	file.read((char*)&ir_stat, sizeof(ir_stat));
-
-	file.close();
-	return true;
+	state.read((char*)&master_irq_flags, sizeof(master_irq_flags));
+	state.read((char*)&osc_1_enable, sizeof(osc_1_enable));
+	state.read((char*)&osc_2_enable, sizeof(osc_2_enable));
+	state.read((char*)&save_eeprom, sizeof(save_eeprom));
+	state.read((char*)&rtc, sizeof(rtc));
+	state.read((char*)&enable_rtc, sizeof(enable_rtc));
+	state.read((char*)&eeprom, sizeof(eeprom));
+	state.read((char*)&sed, sizeof(sed));
+	state.read((char*)&ir_stat, sizeof(ir_stat));
+
+	return state.good();
 }
 
 /****** Write MMU data to save state ******/
-bool MIN_MMU::mmu_write(std::string filename)
+bool MIN_MMU::mmu_write(save_state_buffer& state)
 {
-	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::app);
-	
-	if(!file.is_open()) { return false; }
-
 	//Serialize RAM and hardware MMIO registers to save state
 	u8* ex_mem = &memory_map[0x1000];
-	file.write((char*)ex_mem, 0x1100);
+	state.write((char*)ex_mem, 0x1100);
 
 	//Serialize IRQ stuff to save state
 	for(u32 x = 0; x < 32; x++)
 	{
-		file.write((char*)&irq_priority[x], sizeof(irq_priority[x]));
-		file.write((char*)&irq_enable[x], sizeof(irq_enable[x]));
-		file.write((char*)&irq_vectors[x], sizeof(irq_vectors[x]));
+		state.write((char*)&irq_priority[x], sizeof(irq_priority[x]));
+		state.write((char*)&irq_enable[x], sizeof(irq_enable[x]));
+		state.write((char*)&irq_vectors[x], sizeof(irq_vectors[x]));
 	}
 
 	//Serialize misc data from MMU to save state
-	file.write((char*)&master_irq_flags, sizeof(master_irq_flags));
-	file.write((char*)&osc_1_enable, sizeof(osc_1_enable));
-	file.write((char*)&osc_2_enable, sizeof(osc_2_enable));
-	file.write((char*)&save_eeprom, sizeof(save_eeprom));
-	file.write((char*)&rtc, sizeof(rtc));
-	file.write((char*)&enable_rtc, sizeof(enable_rtc));
-	file.write((char*)&eeprom, sizeof(eeprom));
-	file.write((char*)&sed, sizeof(sed));
-	file.write((char*)&ir_stat, sizeof(ir_stat));
+	state.write((char*)&master_irq_flags, sizeof(master_irq_flags));
+	state.write((char*)&osc_1_enable, sizeof(osc_1_enable));
+	state.write((char*)&osc_2_enable, sizeof(osc_2_enable));
+	state.write((char*)&save_eeprom, sizeof(save_eeprom));
+	state.write((char*)&rtc, sizeof(rtc));
+	state.write((char*)&enable_rtc, sizeof(enable_rtc));
+	state.write((char*)&eeprom, sizeof(eeprom));
+	state.write((char*)&sed, sizeof(sed));
+	state.write((char*)&ir_stat, sizeof(ir_stat));
 
-	file.close();
 	return true;
 }
 
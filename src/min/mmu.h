@@ -24,6 +24,7 @@
 #include "gamepad.h"
 #include "common/config.h"
 #include "common/util.h"
+#include "common/save_state.h"
 #include "timer.h"
 #include "lcd_data.h"
 #include "apu_data.h"
@@ -96,6 +97,9 @@ class MIN_MMU
 	u32 rtc_cycles;
 	bool enable_rtc;
 
+	//Counts every write, used to see whether an idle loop changed memory
+	u32 write_count;
+
 	struct eeprom_save
 	{
 		u8 data[0x2000];
@@ -196,8 +200,8 @@ class MIN_MMU
 	void reset();
 
 	//Serialize data for save state loading/saving
-	bool mmu_read(u32 offset, std::string filename);
-	bool mmu_write(std::string filename);
+	bool mmu_read(save_state_buffer& state);
+	bool mmu_write(save_state_buffer& state);
 	u32 size();
 
 	private:
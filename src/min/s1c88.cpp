@@ -60,6 +60,10 @@ void S1C88::reset()
 
 	debug_opcode = 0;
 
+	idle_loop.start = idle_loop.end = 0;
+	idle_loop.write_count = 0;
+	idle_loop.valid = false;
+
 	controllers.timer.clear();
 	controllers.timer.resize(4);
 
@@ -5956,6 +5960,60 @@ void S1C88::handle_interrupt()
 	}
 }
 
+/****** Stretches an idle loop up to the next PRC or timer change when a short loop repeats without changing anything ******/
+void S1C88::check_idle_loop(u16 addr)
+{
+	//Only look at short backward jumps
+	if((halt) || (reg.pc > addr) || ((addr - reg.pc) > S1C88_IDLE_LOOP_SIZE)) { return; }
+
+	u32 regs[13] = { reg.ba, reg.hl, reg.sp, reg.iy, reg.ix, reg.br, reg.sc, reg.cc, reg.nb, reg.cb, reg.xp, reg.yp, reg.ep };
+
+	//An iteration that wrote nothing (including IRQ stack pushes) and left every register alone will repeat exactly
+	bool repeated = (idle_loop.valid) && (idle_loop.start == reg.pc) && (idle_loop.end == addr) && (idle_loop.write_count == mem->write_count);
+	for(u32 x = 0; (repeated) && (x < 13); x++) { repeated = (regs[x] == idle_loop.regs[x]); }
+
+	//A different loop or a loop still changing something - Remember this iteration and compare against the next one
+	if(!repeated)
+	{
+		for(u32 x = 0; x < 13; x++) { idle_loop.regs[x] = regs[x]; }
+		idle_loop.start = reg.pc;
+		idle_loop.end = addr;
+		idle_loop.write_count = mem->write_count;
+		idle_loop.valid = true;
+		return;
+	}
+
+	//IR transfers are handled cycle by cycle, so leave those alone
+	if((mem->ir_stat.connected[mem->ir_stat.network_id]) || (mem->ir_stat.fade != 0)) { return; }
+
+	//Identical iterations read identical values until the next PRC count or timer count
+	float prc_time = controllers.video.lcd_stat.prc_counter * PRC_COUNT_TIME;
+	if(controllers.video.lcd_stat.prc_clock >= prc_time) { return; }
+
+	u32 idle_cycles = u32(prc_time - controllers.video.lcd_stat.prc_clock) + 1;
+	if(idle_cycles > 0xFF) { idle_cycles = 0xFF; }
+
+	for(u32 x = 0; x < 4; x++)
+	{
+		min_timer& timer = controllers.timer[x];
+
+		if(timer.enable_lo)
+		{
+			if(timer.clock_lo >= timer.prescalar_lo) { return; }
+			if((timer.prescalar_lo - timer.clock_lo) < idle_cycles) { idle_cycles = timer.prescalar_lo - timer.clock_lo; }
+		}
+
+		if((timer.enable_hi) && (!timer.full_mode))
+		{
+			if(timer.clock_hi >= timer.prescalar_hi) { return; }
+			if((timer.prescalar_hi - timer.clock_hi) < idle_cycles) { idle_cycles = timer.prescalar_hi - timer.clock_hi; }
+		}
+	}
+
+	//Let this iteration's last instruction take until then, clock_system() runs right afterwards
+	if(idle_cycles > system_cycles) { system_cycles = idle_cycles; }
+}
+
 /****** Calculates most recent extended values for certain paged registers ******/
 void S1C88::update_regs()
 {
@@ -6281,65 +6339,54 @@ void S1C88::clock_system()
 }
 
 /****** Read CPU data from save state ******/
-bool S1C88::cpu_read(u32 offset, std::string filename)
+bool S1C88::cpu_read(save_state_buffer& state)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary);
-	
-	if(!file.is_open()) { return false; }
-
-	//Go to offset
-	file.seekg(offset);
-
 	//Serialize CPU registers data from file stream
-	file.read((char*)&reg, sizeof(reg));
+	state.read((char*)&reg, sizeof(reg));
 
 	//Serialize misc CPU data from file stream
-	file.read((char*)&opcode, sizeof(opcode));
-	file.read((char*)&log_addr, sizeof(log_addr));
-	file.read((char*)&system_cycles, sizeof(system_cycles));
-	file.read((char*)&debug_cycles, sizeof(debug_cycles));
-	file.read((char*)&halt, sizeof(halt));
-	file.read((char*)&debug_opcode, sizeof(debug_opcode));
-	file.read((char*)&running, sizeof(running));
-	file.read((char*)&skip_irq, sizeof(skip_irq));
+	state.read((char*)&opcode, sizeof(opcode));
+	state.read((char*)&log_addr, sizeof(log_addr));
+	state.read((char*)&system_cycles, sizeof(system_cycles));
+	state.read((char*)&debug_cycles, sizeof(debug_cycles));
+	state.read((char*)&halt, sizeof(halt));
+	state.read((char*)&debug_opcode, sizeof(debug_opcode));
+	state.read((char*)&running, sizeof(running));
+	state.read((char*)&skip_irq, sizeof(skip_irq));
+
+	idle_loop.valid = false;
 
 	//Serialize timers from file stream
-	file.read((char*)&controllers.timer[0], sizeof(controllers.timer[0]));
-	file.read((char*)&controllers.timer[1], sizeof(controllers.timer[1]));
-	file.read((char*)&controllers.timer[2], sizeof(controllers.timer[2]));
-	file.read((char*)&controllers.timer[3], sizeof(controllers.timer[3]));
+	state.read((char*)&controllers.timer[0], sizeof(controllers.timer[0]));
+	state.read((char*)&controllers.timer[1], sizeof(controllers.timer[1]));
+	state.read((char*)&controllers.timer[2], sizeof(controllers.timer[2]));
+	state.read((char*)&controllers.timer[3], sizeof(controllers.timer[3]));
 
-	file.close();
-	return true;
+	return state.good();
 }
 
 /****** Write CPU data to save state ******/
-bool S1C88::cpu_write(std::string filename)
+bool S1C88::cpu_write(save_state_buffer& state)
 {
-	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
-	
-	if(!file.is_open()) { return false; }
-
 	//Serialize CPU registers data to save state
-	file.write((char*)&reg, sizeof(reg));
+	state.write((char*)&reg, sizeof(reg));
 
 	//Serialize misc CPU data to save state
-	file.write((char*)&opcode, sizeof(opcode));
-	file.write((char*)&log_addr, sizeof(log_addr));
-	file.write((char*)&system_cycles, sizeof(system_cycles));
-	file.write((char*)&debug_cycles, sizeof(debug_cycles));
-	file.write((char*)&halt, sizeof(halt));
-	file.write((char*)&debug_opcode, sizeof(debug_opcode));
-	file.write((char*)&running, sizeof(running));
-	file.write((char*)&skip_irq, sizeof(skip_irq));
+	state.write((char*)&opcode, sizeof(opcode));
+	state.write((char*)&log_addr, sizeof(log_addr));
+	state.write((char*)&system_cycles, sizeof(system_cycles));
+	state.write((char*)&debug_cycles, sizeof(debug_cycles));
+	state.write((char*)&halt, sizeof(halt));
+	state.write((char*)&debug_opcode, sizeof(debug_opcode));
+	state.write((char*)&running, sizeof(running));
+	state.write((char*)&skip_irq, sizeof(skip_irq));
 
 	//Serialize timers from file stream
-	file.write((char*)&controllers.timer[0], sizeof(controllers.timer[0]));
-	file.write((char*)&controllers.timer[1], sizeof(controllers.timer[1]));
-	file.write((char*)&controllers.timer[2], sizeof(controllers.timer[2]));
-	file.write((char*)&controllers.timer[3], sizeof(controllers.timer[3]));
+	state.write((char*)&controllers.timer[0], sizeof(controllers.timer[0]));
+	state.write((char*)&controllers.timer[1], sizeof(controllers.timer[1]));
+	state.write((char*)&controllers.timer[2], sizeof(controllers.timer[2]));
+	state.write((char*)&controllers.timer[3], sizeof(controllers.timer[3]));
 
-	file.close();
 	return true;
 }
 
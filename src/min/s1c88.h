@@ -20,6 +20,9 @@
 #include "timer.h"
 #include "apu.h"
 
+//Largest backward jump (in bytes) treated as a possible idle loop
+#define S1C88_IDLE_LOOP_SIZE 0x40
+
 class S1C88
 {
 	public:
@@ -93,6 +96,16 @@ class S1C88
 	bool running;
 	bool skip_irq;
 
+	//Idle loop detection - Last short backward jump, and the registers and MMU write count when it was taken
+	struct idle_loop_info
+	{
+		u16 start;
+		u16 end;
+		u32 regs[13];
+		u32 write_count;
+		bool valid;
+	} idle_loop;
+
 	//Audio-Video and other controllers
 	struct io_controllers
 	{
@@ -109,6 +122,7 @@ class S1C88
 	void execute();
 	void handle_interrupt();
 	void clock_system();
+	void check_idle_loop(u16 addr);
 
 	u8 add_u8(u8 reg_one, u8 reg_two);
 	u16 add_u16(u16 reg_one, u16 reg_two);
@@ -158,8 +172,8 @@ class S1C88
 	void update_regs();
 
 	//Serialize data for save state loading/saving
-	bool cpu_read(u32 offset, std::string filename);
-	bool cpu_write(std::string filename);
+	bool cpu_read(save_state_buffer& state);
+	bool cpu_write(save_state_buffer& state);
 	u32 size();
 };
 		
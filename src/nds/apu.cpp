@@ -12,6 +12,7 @@
 #include <cmath>
 
 #include "apu.h"
+#include "common/headless.h"
 
 /****** APU Constructor ******/
 NTR_APU::NTR_APU()
@@ -45,6 +46,7 @@ void NTR_APU::reset()
 		apu_stat.channel[x].output_frequency = 0.0;
 		apu_stat.channel[x].data_src = 0;
 		apu_stat.channel[x].data_pos = 0;
+		apu_stat.channel[x].data_frac = 0;
 		apu_stat.channel[x].loop_start = 0;
 		apu_stat.channel[x].length = 0;
 		apu_stat.channel[x].samples = 0;
@@ -58,8 +60,11 @@ void NTR_APU::reset()
 		apu_stat.channel[x].adpcm_pos = 0;
 		apu_stat.channel[x].adpcm_index = 0;
 		apu_stat.channel[x].adpcm_val = 0;
-		apu_stat.channel[x].adpcm_buffer.clear();
-		apu_stat.channel[x].decode_adpcm = false;
+		apu_stat.channel[x].adpcm_loop_index = 0;
+		apu_stat.channel[x].adpcm_loop_val = 0;
+
+		apu_stat.channel[x].noise_lfsr = 0x7FFF;
+		apu_stat.channel[x].noise_val = 0;
 	}
 
 	//Setup IMA-ADPCM table
@@ -92,8 +97,8 @@ bool NTR_APU::init()
 		putenv(const_cast<char*>(env_var.c_str()));
 	}
 
-	//Initialize audio subsystem
-	if(SDL_InitSubSystem(SDL_INIT_AUDIO) == -1)
+	//Initialize audio subsystem - Headless mode pulls samples without an audio device
+	if((!config::headless) && (SDL_InitSubSystem(SDL_INIT_AUDIO) == -1))
 	{
 		std::cout<<"APU::Error - Could not initialize SDL audio\n";
 		return false;
@@ -107,8 +112,11 @@ bool NTR_APU::init()
     	desired_spec.callback = ntr_audio_callback;
     	desired_spec.userdata = this;
 
+	//Allocate mixing buffers up front - All 16 channels are summed directly into the mixer's output
+	mixer.init(0, (desired_spec.samples * desired_spec.channels));
+
     	//Open SDL audio for desired specifications
-	if(SDL_OpenAudio(&desired_spec, NULL) < 0) 
+	if(headless::open_audio(&desired_spec) < 0) 
 	{ 
 		std::cout<<"APU::Failed to open audio\n";
 		return false; 
@@ -125,235 +133,364 @@ bool NTR_APU::init()
 }
 
 /****** Generates samples for NDS sound channels ******/
-void NTR_APU::generate_channel_samples(s32* stream, int length, u8 id)
+void NTR_APU::generate_channel_samples(s32* stream, u32 length, u8 id)
 {
-	double sample_ratio = (apu_stat.channel[id].output_frequency / apu_stat.sample_rate);
-	u32 sample_pos = apu_stat.channel[id].data_pos;
+	if((!apu_stat.channel[id].playing) || (apu_stat.channel[id].output_frequency <= 0)) { return; }
+
 	u8 format = ((apu_stat.channel[id].cnt >> 29) & 0x3);
+
+	//Generate silence if sound has no samples
+	if((format != 0x3) && (apu_stat.channel[id].samples == 0)) { return; }
+
+	//Calculate how far to move through the channel's samples for every output sample, as 16.16 fixed-point
+	u32 step = (apu_stat.channel[id].output_frequency * 65536.0) / apu_stat.sample_rate;
+
+	//Calculate volume as a 16.16 fixed-point gain
+	s32 gain = ((s64)apu_stat.channel[id].volume * apu_stat.main_volume * config::volume * 65536) / (127 * 127 * 128);
+
+	switch(format)
+	{
+		case 0x0: mix_pcm8(stream, length, id, step, gain); break;
+		case 0x1: mix_pcm16(stream, length, id, step, gain); break;
+		case 0x2: mix_adpcm(stream, length, id, step, gain); break;
+
+		//Channels 8-13 play PSG, channels 14-15 play noise
+		case 0x3:
+			if(id >= 14) { mix_noise(stream, length, id, step, gain); }
+			else { mix_psg(stream, length, id, step, gain); }
+			break;
+	}
+}
+
+/****** Returns the sample position where a channel loops or stops ******/
+u32 NTR_APU::get_loop_end(u8 id)
+{
 	u8 loop_mode = ((apu_stat.channel[id].cnt >> 27) & 0x3);
 
-	//Calculate volume
-	float vol = (apu_stat.channel[id].volume != 0) ? (apu_stat.channel[id].volume / 127.0) : 0;
-	vol *= (apu_stat.main_volume / 127.0);
-	vol *= (config::volume / 128.0);
+	//Manual mode keeps playing past the end of the sample
+	return ((loop_mode == 1) || (loop_mode == 2)) ? apu_stat.channel[id].samples : 0xFFFFFFFF;
+}
+
+/****** Loops or stops a channel that reached the end of its samples - Returns false if the channel stopped ******/
+bool NTR_APU::loop_channel(u8 id, u32& pos, u32 loop_pos)
+{
+	u8 loop_mode = ((apu_stat.channel[id].cnt >> 27) & 0x3);
+	u32 end_pos = apu_stat.channel[id].samples;
+
+	//Loop sound - Keep however far the position moved past the end
+	if((loop_mode == 1) && (loop_pos < end_pos))
+	{
+		pos = loop_pos + ((pos - loop_pos) % (end_pos - loop_pos));
+		return true;
+	}
+
+	//Stop sound
+	apu_stat.channel[id].playing = false;
+	apu_stat.channel[id].cnt &= ~0x80000000;
+
+	return false;
+}
+
+/****** Mixes PCM8 samples from NDS memory ******/
+void NTR_APU::mix_pcm8(s32* stream, u32 length, u8 id, u32 step, s32 gain)
+{
+	const paged_memory_map& memory = mem->memory_map;
 
-	s8 nds_sample_8 = 0;
-	s16 nds_sample_16 = 0;
-	u32 samples_played = 0;
-	u32 adpcm_pos = 0;
+	u32 src = apu_stat.channel[id].data_src;
+	u32 pos = apu_stat.channel[id].data_pos;
+	u32 frac = apu_stat.channel[id].data_frac;
+	u32 end_pos = get_loop_end(id);
+	u32 loop_pos = (apu_stat.channel[id].loop_start * 4);
 
 	for(u32 x = 0; x < length; x++)
 	{
-		//Channel 0 should set default data
-		if(id == 0) { stream[x] = 0; }
+		//Scale S8 audio to S16
+		s32 sample = (s8)memory[src + pos] * 256;
+		stream[x] += ((sample * gain) >> 16);
+
+		frac += step;
+		pos += (frac >> 16);
+		frac &= 0xFFFF;
+
+		if((pos >= end_pos) && (!loop_channel(id, pos, loop_pos))) { break; }
+	}
+
+	apu_stat.channel[id].data_pos = pos;
+	apu_stat.channel[id].data_frac = frac;
+}
+
+/****** Mixes PCM16 samples from NDS memory ******/
+void NTR_APU::mix_pcm16(s32* stream, u32 length, u8 id, u32 step, s32 gain)
+{
+	const paged_memory_map& memory = mem->memory_map;
+
+	u32 src = apu_stat.channel[id].data_src;
+	u32 pos = apu_stat.channel[id].data_pos;
+	u32 frac = apu_stat.channel[id].data_frac;
+	u32 end_pos = get_loop_end(id);
+	u32 loop_pos = (apu_stat.channel[id].loop_start * 2);
+
+	for(u32 x = 0; x < length; x++)
+	{
+		u32 data_addr = src + (pos << 1);
+		s32 sample = (s16)(memory[data_addr] | (memory[data_addr + 1] << 8));
+		stream[x] += ((sample * gain) >> 16);
+
+		frac += step;
+		pos += (frac >> 16);
+		frac &= 0xFFFF;
 
-		//Pull data from NDS memory
-		if((apu_stat.channel[id].samples) && (apu_stat.channel[id].playing))
+		if((pos >= end_pos) && (!loop_channel(id, pos, loop_pos))) { break; }
+	}
+
+	apu_stat.channel[id].data_pos = pos;
+	apu_stat.channel[id].data_frac = frac;
+}
+
+/****** Mixes IMA-ADPCM samples, decoding them from NDS memory as the channel plays ******/
+void NTR_APU::mix_adpcm(s32* stream, u32 length, u8 id, u32 step, s32 gain)
+{
+	const paged_memory_map& memory = mem->memory_map;
+
+	u32 src = apu_stat.channel[id].data_src;
+	u32 pos = apu_stat.channel[id].data_pos;
+	u32 frac = apu_stat.channel[id].data_frac;
+	u32 end_pos = get_loop_end(id);
+
+	//Loop start counts the 32-bit header
+	u32 loop_pos = (apu_stat.channel[id].loop_start) ? ((apu_stat.channel[id].loop_start - 1) * 8) : 0;
+
+	u32 decode_pos = apu_stat.channel[id].adpcm_pos;
+	s32 val = apu_stat.channel[id].adpcm_val;
+	s32 index = apu_stat.channel[id].adpcm_index;
+
+	for(u32 x = 0; x < length; x++)
+	{
+		//Decode every sample up to the current one
+		while(decode_pos <= pos)
 		{
-			//PCM8
-			if(format == 0)
+			//Save decoder state at the loop start - Looping restores it instead of decoding from the beginning
+			if(decode_pos == loop_pos)
 			{
-				u32 data_addr = (sample_pos + (sample_ratio * x));
-				nds_sample_8 = mem->memory_map[sample_pos + (sample_ratio * x)];
-
-				//Scale S8 audio to S16
-				stream[x] += (nds_sample_8 * 256);
-
-				//Adjust volume level
-				stream[x] *= vol;
-
-				if(data_addr >= (apu_stat.channel[id].data_src + apu_stat.channel[id].samples))
-				{
-					//Loop sound
-					if(loop_mode == 1)
-					{
-						u32 src_addr = mem->read_u32_fast(NDS_SOUNDXSAD | (id << 8)) & 0x7FFFFFF;
-						apu_stat.channel[id].data_src = src_addr + (apu_stat.channel[id].loop_start * 4);
-						apu_stat.channel[id].data_pos = apu_stat.channel[id].data_src;
-						apu_stat.channel[id].samples = (apu_stat.channel[id].length * 4);
-					}
-					
-					//Stop sound
-					else if(loop_mode == 2)
-					{
-						apu_stat.channel[id].playing = false;
-						apu_stat.channel[id].cnt &= ~0x80000000;
-					}
-				}	
+				apu_stat.channel[id].adpcm_loop_val = val;
+				apu_stat.channel[id].adpcm_loop_index = index;
 			}
 
-			//PCM16
-			else if(format == 1)
+			//Grab data from memory, 1 byte for every 2 samples, lower half first
+			u8 half_byte = memory[src + (decode_pos >> 1)];
+			half_byte = (decode_pos & 0x1) ? (half_byte >> 4) : (half_byte & 0xF);
+
+			//Calculate difference
+			s32 table_val = apu_stat.adpcm_table[index];
+			s32 diff = (table_val >> 3);
+
+			if(half_byte & 0x1) { diff += (table_val >> 2); }
+			if(half_byte & 0x2) { diff += (table_val >> 1); }
+			if(half_byte & 0x4) { diff += table_val; }
+
+			if(half_byte & 0x8)
 			{
-				u32 data_addr = (sample_pos + (sample_ratio * x));
-				data_addr &= ~0x1;
-				nds_sample_16 = mem->read_u16_fast(data_addr);
-
-				stream[x] += nds_sample_16;
-
-				//Adjust volume level
-				stream[x] *= vol;
-
-				if(data_addr >= (apu_stat.channel[id].data_src + apu_stat.channel[id].samples))
-				{
-					//Loop sound
-					if(loop_mode == 1)
-					{
-						u32 src_addr = mem->read_u32_fast(NDS_SOUNDXSAD | (id << 8)) & 0x7FFFFFF;
-						apu_stat.channel[id].data_src = src_addr + (apu_stat.channel[id].loop_start * 2);
-						apu_stat.channel[id].data_pos = apu_stat.channel[id].data_src;
-						apu_stat.channel[id].samples = (apu_stat.channel[id].length * 2);
-					}
-					
-					//Stop sound
-					else if(loop_mode == 2)
-					{	
-						apu_stat.channel[id].playing = false;
-						apu_stat.channel[id].cnt &= ~0x80000000;
-					}
-				}	
+				val -= diff;
+				if(val < -0x7FFF) { val = -0x7FFF; }
 			}
 
-			//IMA-ADPCM
-			else if(format == 2)
+			else
 			{
-				u32 data_pos = (apu_stat.channel[id].adpcm_pos + (sample_ratio * x));
-				if(data_pos > apu_stat.channel[id].adpcm_buffer.size()) { data_pos = (apu_stat.channel[id].adpcm_buffer.size() - 1); }
-				nds_sample_16 = apu_stat.channel[id].adpcm_buffer[data_pos];
-
-				stream[x] += nds_sample_16;
-
-				//Adjust volume level
-				stream[x] *= vol;
-
-				if(data_pos >= apu_stat.channel[id].samples)
-				{
-					//Loop sound
-					if(loop_mode == 1)
-					{
-						apu_stat.channel[id].data_pos = apu_stat.channel[id].data_src;
-						apu_stat.channel[id].samples = ((apu_stat.channel[id].length - 1) * 8);
-					}
-
-					//Stop sound
-					else if(loop_mode == 2)
-					{
-						apu_stat.channel[id].playing = false;
-						apu_stat.channel[id].cnt &= ~0x80000000;
-					}
-				}
-
+				val += diff;
+				if(val > 0x7FFF) { val = 0x7FFF; }
 			}
 
-			else { stream[x] += (-32768 * vol); }
+			//Calculate next index
+			index += apu_stat.index_table[half_byte & 0x7];
+			if(index > 88) { index = 88; }
+			else if(index < 0) { index = 0; }
 
-			samples_played++;
+			decode_pos++;
 		}
 
-		//Generate silence if sound has run out of samples or is not playing
-		else { stream[x] += (-32768 * vol); }
-	}
+		stream[x] += ((val * gain) >> 16);
 
-	//Advance data pointer to sound samples
-	switch(format)
-	{
-		case 0x0:
-			apu_stat.channel[id].data_pos += (sample_ratio * samples_played);
-			break;
+		frac += step;
+		pos += (frac >> 16);
+		frac &= 0xFFFF;
 
-		case 0x1:
-			apu_stat.channel[id].data_pos += (sample_ratio * samples_played);
-			apu_stat.channel[id].data_pos &= ~0x1;
-			break;
+		if(pos >= end_pos)
+		{
+			if(!loop_channel(id, pos, loop_pos)) { break; }
 
-		case 0x2:
-			apu_stat.channel[id].adpcm_pos += (sample_ratio * samples_played);
-			break;
-	} 
+			decode_pos = loop_pos;
+			val = apu_stat.channel[id].adpcm_loop_val;
+			index = apu_stat.channel[id].adpcm_loop_index;
+		}
+	}
+
+	apu_stat.channel[id].data_pos = pos;
+	apu_stat.channel[id].data_frac = frac;
+	apu_stat.channel[id].adpcm_pos = decode_pos;
+	apu_stat.channel[id].adpcm_val = val;
+	apu_stat.channel[id].adpcm_index = index;
 }
 
-/****** Decodes IMA-ADPCM data into samples, stores into channel buffer ******/
-void NTR_APU::decode_adpcm_samples(u8 id)
+/****** Mixes PSG square waves - Each cycle is 8 samples long ******/
+void NTR_APU::mix_psg(s32* stream, u32 length, u8 id, u32 step, s32 gain)
 {
-	//Clear channel buffer and reset flag
-	apu_stat.channel[id].adpcm_buffer.clear();
-	apu_stat.channel[id].decode_adpcm = false;
-
-	u32 current_pos = 0;
-	u8 half_byte = 0;
-	u8 full_byte = 0;
-	u32 diff = 0;
-	s32 high_result, low_result = 0;
-	s16 next_index;
-
-	//Decode IMA-ADPCM from memory
-	while(current_pos < apu_stat.channel[id].samples)
-	{
-		//Verify data read address first
-		if((apu_stat.channel[id].data_src + (current_pos >> 1)) >= 0x10000000) { return; }
+	u32 pos = apu_stat.channel[id].data_pos;
+	u32 frac = apu_stat.channel[id].data_frac;
+	u8 duty = ((apu_stat.channel[id].cnt >> 24) & 0x7);
 
-		//Grab data from memory, 1 byte at a time for every 2 samples
-		//Also determine if current sample uses upper or lower half of byte from memory
-		if((current_pos & 0x1) == 0)
-		{
-			full_byte = mem->memory_map[apu_stat.channel[id].data_src + (current_pos >> 1)];
-			half_byte = (full_byte & 0xF);
-		}
+	//Cycles start low, then stay high for the last (duty + 1) samples - Duty 7 is always low
+	s32 wave[8];
 
-		else { half_byte = ((full_byte >> 4) & 0xF); }
-
-		//Calculate difference
-		diff = (apu_stat.adpcm_table[apu_stat.channel[id].adpcm_index] / 8);
+	for(u32 x = 0; x < 8; x++)
+	{
+		s32 sample = ((duty != 7) && (x >= (7 - duty))) ? 0x7FFF : -0x7FFF;
+		wave[x] = ((sample * gain) >> 16);
+	}
 
-		if(half_byte & 0x1) { diff += (apu_stat.adpcm_table[apu_stat.channel[id].adpcm_index] / 4); }
-		if(half_byte & 0x2) { diff += (apu_stat.adpcm_table[apu_stat.channel[id].adpcm_index] / 2); }
-		if(half_byte & 0x4) { diff += apu_stat.adpcm_table[apu_stat.channel[id].adpcm_index]; }
+	for(u32 x = 0; x < length; x++)
+	{
+		stream[x] += wave[pos & 0x7];
 
-		high_result = apu_stat.channel[id].adpcm_val + diff;
-		if(high_result > 32767) { high_result = 32767; }
+		frac += step;
+		pos += (frac >> 16);
+		frac &= 0xFFFF;
+	}
 
-		low_result = apu_stat.channel[id].adpcm_val - diff;
-		if(low_result < -32768) { low_result = -32768; }
+	apu_stat.channel[id].data_pos = pos;
+	apu_stat.channel[id].data_frac = frac;
+}
 
-		if(half_byte & 0x8) { apu_stat.channel[id].adpcm_val = high_result; }
-		else { apu_stat.channel[id].adpcm_val = low_result; }
+/****** Mixes white noise generated by a 15-bit LFSR ******/
+void NTR_APU::mix_noise(s32* stream, u32 length, u8 id, u32 step, s32 gain)
+{
+	u32 frac = apu_stat.channel[id].data_frac;
+	u16 lfsr = apu_stat.channel[id].noise_lfsr;
+	s32 val = apu_stat.channel[id].noise_val;
 
-		//Calculate next index
-		next_index = apu_stat.channel[id].adpcm_index + apu_stat.index_table[half_byte & 0x7];
-		if(next_index > 88) { next_index = 88; }
-		else if(next_index < 0) { next_index = 0; }
+	for(u32 x = 0; x < length; x++)
+	{
+		stream[x] += ((val * gain) >> 16);
 
-		//Set next index and push sample to buffer
-		apu_stat.channel[id].adpcm_index = next_index;
-		apu_stat.channel[id].adpcm_buffer.push_back(apu_stat.channel[id].adpcm_val);
+		//Clock the LFSR once for every sample that passed
+		for(frac += step; frac >= 0x10000; frac -= 0x10000)
+		{
+			if(lfsr & 0x1)
+			{
+				lfsr = (lfsr >> 1) ^ 0x6000;
+				val = -0x7FFF;
+			}
 
-		current_pos++;
+			else
+			{
+				lfsr >>= 1;
+				val = 0x7FFF;
+			}
+		}
 	}
-}	
+
+	apu_stat.channel[id].data_frac = frac;
+	apu_stat.channel[id].noise_lfsr = lfsr;
+	apu_stat.channel[id].noise_val = val;
+}
 
 /****** SDL Audio Callback ******/ 
 void ntr_audio_callback(void* _apu, u8 *_stream, int _length)
 {
 	s16* stream = (s16*) _stream;
-	int length = _length/2;
-	std::vector<s32> channel_stream(length);
+	u32 length = _length/2;
 
 	NTR_APU* apu_link = (NTR_APU*) _apu;
+	audio_mixer& mixer = apu_link->mixer;
 
-	//Generate samples
-	for(u32 x = 0; x < 16; x++)
+	//Only mix as many samples as the preallocated buffers hold, silence anything else
+	if(length > mixer.get_max_length())
 	{
-		//Decode IMA-ADPCM samples first
-		if(apu_link->apu_stat.channel[x].decode_adpcm) { apu_link->decode_adpcm_samples(x); }
+		for(u32 x = mixer.get_max_length(); x < length; x++) { stream[x] = 0; }
+		length = mixer.get_max_length();
+	}
+
+	//Generate samples - Each channel adds itself to the mixer's output
+	mixer.clear(length);
+
+	for(u32 x = 0; x < 16; x++) { apu_link->generate_channel_samples(mixer.get_accumulator(), length, x); }
+
+	//Custom software mixing - Divide final wave by total amount of channels
+	mixer.output(stream, length, 1, 16);
+}
 
-		//Grab samples
-		apu_link->generate_channel_samples(&channel_stream[0], length, x);
+/****** Read APU data from save state ******/
+bool NTR_APU::apu_read(save_state_buffer& state)
+{
+	//Lock out the audio callback while the data is replaced
+	SDL_LockAudio();
+
+	//Serialize sound channels from save state
+	for(u32 x = 0; x < 16; x++)
+	{
+		state.read((char*)&apu_stat.channel[x].output_frequency, sizeof(apu_stat.channel[x].output_frequency));
+		state.read((char*)&apu_stat.channel[x].data_src, sizeof(apu_stat.channel[x].data_src));
+		state.read((char*)&apu_stat.channel[x].data_pos, sizeof(apu_stat.channel[x].data_pos));
+		state.read((char*)&apu_stat.channel[x].data_frac, sizeof(apu_stat.channel[x].data_frac));
+		state.read((char*)&apu_stat.channel[x].loop_start, sizeof(apu_stat.channel[x].loop_start));
+		state.read((char*)&apu_stat.channel[x].length, sizeof(apu_stat.channel[x].length));
+		state.read((char*)&apu_stat.channel[x].samples, sizeof(apu_stat.channel[x].samples));
+		state.read((char*)&apu_stat.channel[x].cnt, sizeof(apu_stat.channel[x].cnt));
+		state.read((char*)&apu_stat.channel[x].volume, sizeof(apu_stat.channel[x].volume));
+		state.read((char*)&apu_stat.channel[x].playing, sizeof(apu_stat.channel[x].playing));
+		state.read((char*)&apu_stat.channel[x].enable, sizeof(apu_stat.channel[x].enable));
+		state.read((char*)&apu_stat.channel[x].adpcm_header, sizeof(apu_stat.channel[x].adpcm_header));
+		state.read((char*)&apu_stat.channel[x].adpcm_pos, sizeof(apu_stat.channel[x].adpcm_pos));
+		state.read((char*)&apu_stat.channel[x].adpcm_index, sizeof(apu_stat.channel[x].adpcm_index));
+		state.read((char*)&apu_stat.channel[x].adpcm_val, sizeof(apu_stat.channel[x].adpcm_val));
+		state.read((char*)&apu_stat.channel[x].adpcm_loop_index, sizeof(apu_stat.channel[x].adpcm_loop_index));
+		state.read((char*)&apu_stat.channel[x].adpcm_loop_val, sizeof(apu_stat.channel[x].adpcm_loop_val));
+		state.read((char*)&apu_stat.channel[x].noise_lfsr, sizeof(apu_stat.channel[x].noise_lfsr));
+		state.read((char*)&apu_stat.channel[x].noise_val, sizeof(apu_stat.channel[x].noise_val));
 	}
 
-	//Custom software mixing
-	for(u32 x = 0; x < length; x++)
+	//Serialize misc APU data from save state
+	state.read((char*)&apu_stat.sound_on, sizeof(apu_stat.sound_on));
+	state.read((char*)&apu_stat.stereo, sizeof(apu_stat.stereo));
+	state.read((char*)&apu_stat.main_volume, sizeof(apu_stat.main_volume));
+	state.read((char*)&apu_stat.channel_master_volume, sizeof(apu_stat.channel_master_volume));
+
+	SDL_UnlockAudio();
+
+	return state.good();
+}
+
+/****** Write APU data to save state ******/
+bool NTR_APU::apu_write(save_state_buffer& state)
+{
+	//Serialize sound channels to save state
+	for(u32 x = 0; x < 16; x++)
 	{
-		channel_stream[x] /= 16;
-		stream[x] = channel_stream[x];
+		state.write((char*)&apu_stat.channel[x].output_frequency, sizeof(apu_stat.channel[x].output_frequency));
+		state.write((char*)&apu_stat.channel[x].data_src, sizeof(apu_stat.channel[x].data_src));
+		state.write((char*)&apu_stat.channel[x].data_pos, sizeof(apu_stat.channel[x].data_pos));
+		state.write((char*)&apu_stat.channel[x].data_frac, sizeof(apu_stat.channel[x].data_frac));
+		state.write((char*)&apu_stat.channel[x].loop_start, sizeof(apu_stat.channel[x].loop_start));
+		state.write((char*)&apu_stat.channel[x].length, sizeof(apu_stat.channel[x].length));
+		state.write((char*)&apu_stat.channel[x].samples, sizeof(apu_stat.channel[x].samples));
+		state.write((char*)&apu_stat.channel[x].cnt, sizeof(apu_stat.channel[x].cnt));
+		state.write((char*)&apu_stat.channel[x].volume, sizeof(apu_stat.channel[x].volume));
+		state.write((char*)&apu_stat.channel[x].playing, sizeof(apu_stat.channel[x].playing));
+		state.write((char*)&apu_stat.channel[x].enable, sizeof(apu_stat.channel[x].enable));
+		state.write((char*)&apu_stat.channel[x].adpcm_header, sizeof(apu_stat.channel[x].adpcm_header));
+		state.write((char*)&apu_stat.channel[x].adpcm_pos, sizeof(apu_stat.channel[x].adpcm_pos));
+		state.write((char*)&apu_stat.channel[x].adpcm_index, sizeof(apu_stat.channel[x].adpcm_index));
+		state.write((char*)&apu_stat.channel[x].adpcm_val, sizeof(apu_stat.channel[x].adpcm_val));
+		state.write((char*)&apu_stat.channel[x].adpcm_loop_index, sizeof(apu_stat.channel[x].adpcm_loop_index));
+		state.write((char*)&apu_stat.channel[x].adpcm_loop_val, sizeof(apu_stat.channel[x].adpcm_loop_val));
+		state.write((char*)&apu_stat.channel[x].noise_lfsr, sizeof(apu_stat.channel[x].noise_lfsr));
+		state.write((char*)&apu_stat.channel[x].noise_val, sizeof(apu_stat.channel[x].noise_val));
 	}
+
+	//Serialize misc APU data to save state
+	state.write((char*)&apu_stat.sound_on, sizeof(apu_stat.sound_on));
+	state.write((char*)&apu_stat.stereo, sizeof(apu_stat.stereo));
+	state.write((char*)&apu_stat.main_volume, sizeof(apu_stat.main_volume));
+	state.write((char*)&apu_stat.channel_master_volume, sizeof(apu_stat.channel_master_volume));
+
+	return true;
 }
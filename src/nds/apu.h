@@ -15,6 +15,7 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_audio.h>
 #include "mmu.h"
+#include "common/audio_mixer.h"
 
 class NTR_APU
 {
@@ -27,14 +28,29 @@ class NTR_APU
 
 	SDL_AudioSpec desired_spec;
 
+	//Preallocated buffers for the audio callback
+	audio_mixer mixer;
+
 	NTR_APU();
 	~NTR_APU();
 
-	void generate_channel_samples(s32* stream, int length, u8 id);
-	void decode_adpcm_samples(u8 id);
+	void generate_channel_samples(s32* stream, u32 length, u8 id);
+
+	//Format specific mixing loops - Each adds one channel to the stream at a 16.16 sample step
+	void mix_pcm8(s32* stream, u32 length, u8 id, u32 step, s32 gain);
+	void mix_pcm16(s32* stream, u32 length, u8 id, u32 step, s32 gain);
+	void mix_adpcm(s32* stream, u32 length, u8 id, u32 step, s32 gain);
+	void mix_psg(s32* stream, u32 length, u8 id, u32 step, s32 gain);
+	void mix_noise(s32* stream, u32 length, u8 id, u32 step, s32 gain);
+	u32 get_loop_end(u8 id);
+	bool loop_channel(u8 id, u32& pos, u32 loop_pos);
 
 	bool init();
 	void reset();
+
+	//Serialize data for save state loading/saving
+	bool apu_read(save_state_buffer& state);
+	bool apu_write(save_state_buffer& state);
 };
 
 /****** SDL Audio Callback ******/ 
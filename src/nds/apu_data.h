@@ -21,7 +21,9 @@ struct ntr_apu_data
 	{
 		double output_frequency;
 		u32 data_src;
+		//Playback position in samples from data_src, plus a 16-bit fraction
 		u32 data_pos;
+		u32 data_frac;
 		u32 loop_start;
 		u32 length;
 		u32 samples;
@@ -32,11 +34,16 @@ struct ntr_apu_data
 		bool enable;
 
 		u32 adpcm_header;
+		//IMA-ADPCM is decoded as the channel plays - adpcm_pos counts decoded samples
 		u32 adpcm_pos;
 		u8 adpcm_index;
-		u16 adpcm_val;
-		std::vector<s16> adpcm_buffer;
-		bool decode_adpcm;
+		s16 adpcm_val;
+		u8 adpcm_loop_index;
+		s16 adpcm_loop_val;
+
+		//PSG-Noise state
+		u16 noise_lfsr;
+		s16 noise_val;
 	} channel[16];
 
 	//IMA-ADPCM table
@@ -16,11 +16,18 @@
 #include <vector>
 
 #include "common.h"
+#include "common/arm_decoder.h"
 #include "timer.h"
 #include "mmu.h"
 #include "lcd.h"
 #include "apu.h"
 
+//Largest backward branch (in bytes) treated as a possible idle loop
+#define NDS7_IDLE_LOOP_SIZE 0x40
+
+//Extra cycles waited by each repeated iteration of an idle loop
+#define NDS7_IDLE_LOOP_CYCLES 0x40
+
 class NTR_ARM7
 {
 	public:
@@ -196,6 +203,16 @@ class NTR_ARM7
 	u8 cpu_timing[16][8];
 	bool re_sync;
 
+	//Idle loop detection - Last short backward branch, and the registers when it was taken
+	struct idle_loop_info
+	{
+		u32 start;
+		u32 end;
+		u32 regs[16];
+		bool valid;
+		bool pure;
+	} idle_loop;
+
 	NTR_MMU* mem;
 
 	//Audio-Video and other controllers
@@ -215,6 +232,8 @@ class NTR_ARM7
 	void execute();
 	void update_pc();
 	void flush_pipeline();
+	bool is_idle_instruction(u8 pipeline_id) const;
+	void check_idle_loop(u32 addr, u8 pipeline_id);
 
 	void reset();
 	void setup_cpu_timing();
@@ -262,12 +281,14 @@ class NTR_ARM7
 	void clock(u32 access_address, mem_modes current_mode);
 	void clock();
 	void clock_timers(u8 access_cycles);
+	void timer_overflow(u8 id);
 	void clock_system();
 	void clock_dma();
 	void handle_interrupt();
 
 	//DMA functions
 	void nds7_dma(u8 index);
+	void dma_bulk_transfer(u8 index);
 
 	//Misc CPU helpers
 	void update_condition_logical(u32 result, u8 shift_out);
@@ -315,8 +336,8 @@ class NTR_ARM7
 	void swi_getvolumetable();
 
 	//Serialize data for save state loading/saving
-	bool cpu_read(u32 offset, std::string filename);
-	bool cpu_write(std::string filename);
+	bool cpu_read(save_state_buffer& state);
+	bool cpu_write(save_state_buffer& state);
 	u32 size();
 };
 		
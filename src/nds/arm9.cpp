@@ -100,6 +100,10 @@ void NTR_ARM9::reset()
 	flush_pipeline();
 	mem = NULL;
 
+	idle_loop.start = idle_loop.end = 0;
+	idle_loop.valid = false;
+	idle_loop.pure = true;
+
 	co_proc.reset();
 
 	std::cout<<"CPU::ARM9 - Initialized\n";
@@ -426,291 +430,13 @@ void NTR_ARM9::decode()
 	//Decode THUMB instructions
 	if(arm_mode == THUMB)
 	{
-		u16 current_instruction = instruction_pipeline[pipeline_id];
-		
-		if(((current_instruction >> 13) == 0) && (((current_instruction >> 11) & 0x7) != 0x3))
-		{
-			//THUMB_1
-			instruction_operation[pipeline_id] = THUMB_1;
-		}
-
-		else if(((current_instruction >> 11) & 0x1F) == 0x3)
-		{
-			//THUMB_2
-			instruction_operation[pipeline_id] = THUMB_2;
-		}
-
-		else if((current_instruction >> 13) == 0x1)
-		{
-			//THUMB_3
-			instruction_operation[pipeline_id] = THUMB_3;
-		}
-
-		else if(((current_instruction >> 10) & 0x3F) == 0x10)
-		{
-			//THUMB_4
-			instruction_operation[pipeline_id] = THUMB_4;
-		}
-
-		else if(((current_instruction >> 10) & 0x3F) == 0x11)
-		{
-			//THUMB_5
-			instruction_operation[pipeline_id] = THUMB_5;
-		}
-
-		else if((current_instruction >> 11) == 0x9)
-		{
-			//THUMB_6
-			instruction_operation[pipeline_id] = THUMB_6;
-		}
-
-		else if((current_instruction >> 12) == 0x5)
-		{
-			if(current_instruction & 0x200)
-			{
-				//THUMB_8
-				instruction_operation[pipeline_id] = THUMB_8;
-			}
-
-			else
-			{
-				//THUMB_7
-				instruction_operation[pipeline_id] = THUMB_7;
-			}
-		}
-
-		else if(((current_instruction >> 13) & 0x7) == 0x3)
-		{
-			//THUMB_9
-			instruction_operation[pipeline_id] = THUMB_9;
-		}
-
-		else if((current_instruction >> 12) == 0x8)
-		{
-			//THUMB_10
-			instruction_operation[pipeline_id] = THUMB_10;
-		}
-
-		else if((current_instruction >> 12) == 0x9)
-		{
-			//THUMB_11
-			instruction_operation[pipeline_id] = THUMB_11;
-		}
-
-		else if((current_instruction >> 12) == 0xA)
-		{
-			//THUMB_12
-			instruction_operation[pipeline_id] = THUMB_12;
-		}
-
-		else if((current_instruction >> 8) == 0xB0)
-		{
-			//THUMB_13
-			instruction_operation[pipeline_id] = THUMB_13;
-		}
-
-		else if((current_instruction >> 12) == 0xB)
-		{
-			//THUMB_14
-			instruction_operation[pipeline_id] = THUMB_14;
-		}
-
-		else if((current_instruction >> 12) == 0xC)
-		{
-			//THUMB_15
-			instruction_operation[pipeline_id] = THUMB_15;
-		}
-
-		else if((current_instruction >> 12) == 13)
-		{
-			//THUMB_16
-			instruction_operation[pipeline_id] = THUMB_16;
-		}
-
-		else if((current_instruction >> 11) == 0x1C)
-		{
-			//THUMB_18
-			instruction_operation[pipeline_id] = THUMB_18;
-		}
-
-		else if((current_instruction >> 11) >= 0x1E)
-		{
-			//THUMB_19
-			instruction_operation[pipeline_id] = THUMB_19;
-		}
-
-		else if((current_instruction & 0xF800) == 0xE800)
-		{
-			//THUMB_19 BLX
-			instruction_operation[pipeline_id] = THUMB_19;
-		}
+		instruction_operation[pipeline_id] = arm_decoder::decode_thumb<arm_instructions, (ARM_DECODE_ARMV5 | ARM_DECODE_SMUL)>(instruction_pipeline[pipeline_id]);
 	}
 
 	//Decode ARM instructions
-	if(arm_mode == ARM)
+	else if(arm_mode == ARM)
 	{
-		u32 current_instruction = instruction_pipeline[pipeline_id];
-
-		if(((current_instruction >> 8) & 0xFFFFF) == 0x12FFF)
-		{
-			//ARM_3
-			instruction_operation[pipeline_id] = ARM_3;
-		}
-
-		else if(((current_instruction >> 25) & 0x7) == 0x5)
-		{
-			//ARM_4
-			instruction_operation[pipeline_id] = ARM_4;
-		}		
-
-		else if((current_instruction & 0xD900000) == 0x1000000) 
-		{
-
-			if((((current_instruction >> 16) & 0xFFF) == 0x16F) && (((current_instruction >> 4) & 0xFF) == 0xF1))
-			{
-				//ARM CLZ
-				instruction_operation[pipeline_id] = ARM_CLZ;
-			}
-
-			else if((((current_instruction >> 24) & 0xF) == 0x1) && (((current_instruction >> 4) & 0xFF) == 0x5))
-			{
-				//ARM QADD-QSUB
-				instruction_operation[pipeline_id] = ARM_QADD_QSUB;
-			}
-
-			else if((current_instruction & 0x80) && (current_instruction & 0x10) && ((current_instruction & 0x2000000) == 0))
-			{
-				if(((current_instruction >> 5) & 0x3) == 0) 
-				{ 
-					instruction_operation[pipeline_id] = ARM_12;
-				}
-
-				else 
-				{
-					instruction_operation[pipeline_id] = ARM_10;
-				}
-			}
-
-			else 
-			{
-				//ARM7
-				if((current_instruction & 0x80) && ((current_instruction & 0x2000000) == 0))
-				{
-					instruction_operation[pipeline_id] = ARM_7;
-				}
-
-				//ARM_6
-				else
-				{
-					instruction_operation[pipeline_id] = ARM_6;
-				}
-			}
-		}
-
-		else if(((current_instruction >> 26) & 0x3) == 0x0)
-		{
-			if((current_instruction & 0x80) && ((current_instruction & 0x10) == 0))
-			{
-				//ARM.5
-				if(current_instruction & 0x2000000)
-				{
-					instruction_operation[pipeline_id] = ARM_5;
-				}
-
-				//ARM.5
-				else if((current_instruction & 0x100000) && (((current_instruction >> 23) & 0x3) == 0x2))
-				{
-					instruction_operation[pipeline_id] = ARM_5;
-				}
-
-				//ARM.5
-				else if(((current_instruction >> 23) & 0x3) != 0x2)
-				{
-					instruction_operation[pipeline_id] = ARM_5;
-				}
-
-				//ARM.7
-				else
-				{
-					instruction_operation[pipeline_id] = ARM_7;
-				}
-			}
-
-			else if((current_instruction & 0x80) && (current_instruction & 0x10))
-			{
-				if(((current_instruction >> 4) & 0xF) == 0x9)
-				{
-					//ARM.5
-					if(current_instruction & 0x2000000)
-					{
-						instruction_operation[pipeline_id] = ARM_5;
-					}
-
-					//ARM.12
-					else if(((current_instruction >> 23) & 0x3) == 0x2)
-					{
-						instruction_operation[pipeline_id] = ARM_12;
-					}
-
-					//ARM.7
-					else
-					{
-						instruction_operation[pipeline_id] = ARM_7;
-					}
-				}
-
-				//ARM.5
-				else if(current_instruction & 0x2000000)
-				{
-					instruction_operation[pipeline_id] = ARM_5;
-				}
-
-				//ARM.10
-				else
-				{
-					instruction_operation[pipeline_id] = ARM_10;
-				}
-			}
-
-			//ARM.5
-			else
-			{
-				instruction_operation[pipeline_id] = ARM_5;
-			}
-		}
-
-		else if(((current_instruction >> 26) & 0x3) == 0x1)
-		{
-			//ARM_9
-			instruction_operation[pipeline_id] = ARM_9;
-		}
-
-		else if(((current_instruction >> 25) & 0x7) == 0x4)
-		{
-			//ARM_11
-			instruction_operation[pipeline_id] = ARM_11;
-		}
-
-		else if(((current_instruction >> 24) & 0xF) == 0xF)
-		{
-			//ARM_13
-			instruction_operation[pipeline_id] = ARM_13;
-		}
-
-		else if(((current_instruction >> 24) & 0xF) == 0xE)
-		{
-			//ARM Coprocessor Register Transfer
-			if(current_instruction & 0x10) { instruction_operation[pipeline_id] = ARM_COP_REG_TRANSFER; }
-			
-			//ARM Coprocessor Data Operation
-			else { instruction_operation[pipeline_id] = ARM_COP_DATA_OP; }
-		}
-
-		else if(((current_instruction >> 25) & 0x7) == 6)
-		{
-			//ARM Coprocessor Data Transfer
-			instruction_operation[pipeline_id] = ARM_COP_DATA_TRANSFER;
-		}
+		instruction_operation[pipeline_id] = arm_decoder::decode_arm<arm_instructions, (ARM_DECODE_ARMV5 | ARM_DECODE_SMUL)>(instruction_pipeline[pipeline_id]);
 	}
 }
 
@@ -725,6 +451,10 @@ void NTR_ARM9::execute()
 		return; 
 	}
 
+	//Anything that could change memory or the CPU mode means the current loop is not just waiting
+	u32 current_addr = reg.r15 - ((arm_mode == ARM) ? 8 : 4);
+	if((config::use_idle_loop_detection) && (!is_idle_instruction(pipeline_id))) { idle_loop.pure = false; }
+
 	//Execute THUMB instruction
 	if(arm_mode == THUMB)
 	{
@@ -937,7 +667,56 @@ void NTR_ARM9::execute()
 		}
 	}
 
-}	
+	//Check for idle loops whenever a branch is taken
+	if((needs_flush) && (config::use_idle_loop_detection)) { check_idle_loop(current_addr, pipeline_id); }
+}
+
+/****** Checks whether an instruction is safe to repeat inside an idle loop ******/
+bool NTR_ARM9::is_idle_instruction(u8 pipeline_id) const
+{
+	//ARM instructions that fail their condition do nothing
+	if((arm_mode == ARM) && (!check_condition(instruction_pipeline[pipeline_id]))) { return true; }
+
+	return arm_decoder::is_idle_op<arm_instructions>(instruction_operation[pipeline_id], instruction_pipeline[pipeline_id]);
+}
+
+/****** Stretches an idle loop when a short loop repeats without changing anything ******/
+void NTR_ARM9::check_idle_loop(u32 addr, u8 pipeline_id)
+{
+	u32 target = reg.r15;
+	bool loop_branch = arm_decoder::is_loop_branch<arm_instructions>(instruction_operation[pipeline_id], instruction_pipeline[pipeline_id]);
+
+	//Only short backward branches ending an iteration that just read memory and worked on registers count
+	if((!loop_branch) || (!idle_loop.pure) || (target > addr) || ((addr - target) > NDS9_IDLE_LOOP_SIZE))
+	{
+		idle_loop.valid = false;
+		idle_loop.pure = true;
+		return;
+	}
+
+	u32 regs[16];
+	for(u32 x = 0; x < 15; x++) { regs[x] = get_reg(x); }
+	regs[15] = reg.cpsr;
+
+	bool repeated = (idle_loop.valid) && (idle_loop.start == target) && (idle_loop.end == addr);
+	for(u32 x = 0; (repeated) && (x < 16); x++) { repeated = (regs[x] == idle_loop.regs[x]); }
+
+	idle_loop.pure = true;
+
+	//A different loop or a loop still changing registers - Remember this iteration and compare against the next one
+	if(!repeated)
+	{
+		for(u32 x = 0; x < 16; x++) { idle_loop.regs[x] = regs[x]; }
+		idle_loop.start = target;
+		idle_loop.end = addr;
+		idle_loop.valid = true;
+		return;
+	}
+
+	//There are no scheduled events to jump to, and the other CPU can change shared memory at any time
+	//Instead, let each repeated iteration wait a little longer so the LCD, timers, and the other CPU run ahead
+	system_cycles += NDS9_IDLE_LOOP_CYCLES;
+}
 
 /****** Flush the pipeline - Called when branching or resetting ******/
 void NTR_ARM9::flush_pipeline()
@@ -1431,48 +1210,46 @@ void NTR_ARM9::clock_dma()
 	}
 }
 
-/****** Runs Timer controllers every clock cycle ******/
+/****** Counts down to each enabled Timer's next overflow ******/
 void NTR_ARM9::clock_timers(u8 access_cycles)
 {
-	u32 due_cycles = 0;
-	u32 update_count = 0;
-	u32 old_count = 0;
-
 	for(u32 x = 0; x < 4; x++)
 	{
-		//See if this timer is enabled first
-		if(controllers.timer[x].enable)
-		{
-			//If internal clock goes past 0, increment counter
-			if((controllers.timer[x].clock - access_cycles) & 0x80000000)
-			{
-				old_count = controllers.timer[x].counter;
-				due_cycles = ~(controllers.timer[x].clock - access_cycles) + 1;
-				update_count = due_cycles / controllers.timer[x].prescalar;
-				due_cycles -= (update_count * controllers.timer[x].prescalar);
+		//Count-up timers only change when the previous timer overflows
+		if((!controllers.timer[x].enable) || (controllers.timer[x].count_up)) { continue; }
 
-				if((controllers.timer[x].prescalar == 1)) { controllers.timer[x].clock = 0; }
-				else { controllers.timer[x].clock = controllers.timer[x].prescalar - due_cycles; }
+		//Counters are worked out from the remaining cycles whenever they are read
+		if(controllers.timer[x].clock > access_cycles)
+		{
+			controllers.timer[x].clock -= access_cycles;
+			continue;
+		}
 
-				if(!update_count) { update_count = 1; }
-				if(!controllers.timer[x].count_up) { controllers.timer[x].counter += update_count; }
+		//Handle every overflow that happened during these cycles
+		u32 due_cycles = access_cycles - controllers.timer[x].clock;
+		u32 period = (0x10000 - controllers.timer[x].reload_value) * controllers.timer[x].prescalar;
+		u32 overflows = 1 + (due_cycles / period);
 
-				//If counter overflows, reload value, trigger interrupt if necessary
-				if((old_count + update_count) > 0xFFFF) 
-				{
-					controllers.timer[x].counter = controllers.timer[x].reload_value;
+		controllers.timer[x].clock = period - (due_cycles % period);
 
-					//Increment next timer if in count-up mode
-					if((x < 4) && (controllers.timer[x+1].count_up)) { controllers.timer[x+1].counter++; }
+		for(u32 y = 0; y < overflows; y++) { timer_overflow(x); }
+	}
+}
 
-					//Interrupt
-					if(controllers.timer[x].interrupt) { mem->nds9_if |= (8 << x); }
-				}
-			}
+/****** Reloads an overflowed Timer, then triggers interrupts and count-up timers ******/
+void NTR_ARM9::timer_overflow(u8 x)
+{
+	controllers.timer[x].counter = controllers.timer[x].reload_value;
 
-			else { controllers.timer[x].clock -= access_cycles; }
-		}
+	//Increment next timer if in count-up mode, which may overflow as well
+	if((x < 3) && (controllers.timer[x+1].enable) && (controllers.timer[x+1].count_up))
+	{
+		controllers.timer[x+1].counter++;
+		if(controllers.timer[x+1].counter == 0) { timer_overflow(x+1); }
 	}
+
+	//Interrupt
+	if(controllers.timer[x].interrupt) { mem->nds9_if |= (8 << x); }
 }
 
 /****** Jumps to or exits an interrupt ******/
@@ -1586,107 +1363,116 @@ void NTR_ARM9::handle_interrupt()
 }
 
 /****** Read CPU data from save state ******/
-bool NTR_ARM9::cpu_read(u32 offset, std::string filename)
+bool NTR_ARM9::cpu_read(save_state_buffer& state)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary);
-	
-	if(!file.is_open()) { return false; }
-
-	//Go to offset
-	file.seekg(offset);
-
 	//Serialize CPU registers data from file stream
-	file.read((char*)&reg, sizeof(reg));
+	state.read((char*)&reg, sizeof(reg));
 
 	//Serialize misc CPU data to save state
-	file.read((char*)&current_cpu_mode, sizeof(current_cpu_mode));
-	file.read((char*)&arm_mode, sizeof(arm_mode));
-	file.read((char*)&lbl_addr, sizeof(lbl_addr));
-	file.read((char*)&first_branch, sizeof(first_branch));
-	file.read((char*)&running, sizeof(running));
-	file.read((char*)&needs_flush, sizeof(needs_flush));
-	file.read((char*)&in_interrupt, sizeof(in_interrupt));
-	file.read((char*)&idle_state, sizeof(idle_state));
-	file.read((char*)&last_idle_state, sizeof(last_idle_state));
-	file.read((char*)&thumb_long_branch, sizeof(thumb_long_branch));
-	file.read((char*)&last_instr_branch, sizeof(last_instr_branch));
-	file.read((char*)&swi_waitbyloop_count, sizeof(swi_waitbyloop_count));
-	file.read((char*)&instruction_pipeline[0], sizeof(instruction_pipeline[0]));
-	file.read((char*)&instruction_pipeline[1], sizeof(instruction_pipeline[1]));
-	file.read((char*)&instruction_pipeline[2], sizeof(instruction_pipeline[2]));
-	file.read((char*)&instruction_operation[0], sizeof(instruction_operation[0]));
-	file.read((char*)&instruction_operation[1], sizeof(instruction_operation[1]));
-	file.read((char*)&instruction_operation[2], sizeof(instruction_operation[2]));
-	file.read((char*)&pipeline_pointer, sizeof(pipeline_pointer));
-	file.read((char*)&debug_message, sizeof(debug_message));
-	file.read((char*)&debug_code, sizeof(debug_code));
-	file.read((char*)&debug_cycles, sizeof(debug_cycles));
-	file.read((char*)&debug_addr, sizeof(debug_addr));
-	file.read((char*)&sync_cycles, sizeof(sync_cycles));
-	file.read((char*)&system_cycles, sizeof(system_cycles));
-	file.read((char*)&re_sync, sizeof(re_sync));
+	state.read((char*)&current_cpu_mode, sizeof(current_cpu_mode));
+	state.read((char*)&arm_mode, sizeof(arm_mode));
+	state.read((char*)&lbl_addr, sizeof(lbl_addr));
+	state.read((char*)&first_branch, sizeof(first_branch));
+	state.read((char*)&running, sizeof(running));
+	state.read((char*)&needs_flush, sizeof(needs_flush));
+	state.read((char*)&flush_counter, sizeof(flush_counter));
+	state.read((char*)&in_interrupt, sizeof(in_interrupt));
+	state.read((char*)&idle_state, sizeof(idle_state));
+	state.read((char*)&last_idle_state, sizeof(last_idle_state));
+	state.read((char*)&thumb_long_branch, sizeof(thumb_long_branch));
+	state.read((char*)&last_instr_branch, sizeof(last_instr_branch));
+	state.read((char*)&swi_waitbyloop_count, sizeof(swi_waitbyloop_count));
+	state.read((char*)&instruction_pipeline[0], sizeof(instruction_pipeline[0]));
+	state.read((char*)&instruction_pipeline[1], sizeof(instruction_pipeline[1]));
+	state.read((char*)&instruction_pipeline[2], sizeof(instruction_pipeline[2]));
+	state.read((char*)&instruction_operation[0], sizeof(instruction_operation[0]));
+	state.read((char*)&instruction_operation[1], sizeof(instruction_operation[1]));
+	state.read((char*)&instruction_operation[2], sizeof(instruction_operation[2]));
+	state.read((char*)&pipeline_pointer, sizeof(pipeline_pointer));
+	state.read((char*)&debug_message, sizeof(debug_message));
+	state.read((char*)&debug_code, sizeof(debug_code));
+	state.read((char*)&debug_cycles, sizeof(debug_cycles));
+	state.read((char*)&debug_addr, sizeof(debug_addr));
+	state.read((char*)&sync_cycles, sizeof(sync_cycles));
+	state.read((char*)&system_cycles, sizeof(system_cycles));
+	state.read((char*)&re_sync, sizeof(re_sync));
+
+	idle_loop.valid = false;
 
 	//Serialize timers to save state
-	file.read((char*)&controllers.timer[0], sizeof(controllers.timer[0]));
-	file.read((char*)&controllers.timer[1], sizeof(controllers.timer[1]));
-	file.read((char*)&controllers.timer[2], sizeof(controllers.timer[2]));
-	file.read((char*)&controllers.timer[3], sizeof(controllers.timer[3]));
-
-	//Serialize CP15 registers
-	for(u32 x = 0; x < 32; x++) { file.read((char*)&co_proc.regs[x], sizeof(co_proc.regs[x])); }
-
-	file.close();
-	return true;
+	state.read((char*)&controllers.timer[0], sizeof(controllers.timer[0]));
+	state.read((char*)&controllers.timer[1], sizeof(controllers.timer[1]));
+	state.read((char*)&controllers.timer[2], sizeof(controllers.timer[2]));
+	state.read((char*)&controllers.timer[3], sizeof(controllers.timer[3]));
+
+	//Serialize CP15 registers and control parameters
+	for(u32 x = 0; x < 34; x++) { state.read((char*)&co_proc.regs[x], sizeof(co_proc.regs[x])); }
+
+	state.read((char*)&co_proc.pu_enable, sizeof(co_proc.pu_enable));
+	state.read((char*)&co_proc.unified_cache, sizeof(co_proc.unified_cache));
+	state.read((char*)&co_proc.instr_cache, sizeof(co_proc.instr_cache));
+	state.read((char*)&co_proc.exception_vector, sizeof(co_proc.exception_vector));
+	state.read((char*)&co_proc.cache_replacement, sizeof(co_proc.cache_replacement));
+	state.read((char*)&co_proc.pre_armv5, sizeof(co_proc.pre_armv5));
+	state.read((char*)&co_proc.dtcm_enable, sizeof(co_proc.dtcm_enable));
+	state.read((char*)&co_proc.itcm_enable, sizeof(co_proc.itcm_enable));
+
+	return state.good();
 }
 
 /****** Write CPU data to save state ******/
-bool NTR_ARM9::cpu_write(std::string filename)
+bool NTR_ARM9::cpu_write(save_state_buffer& state)
 {
-	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
-	
-	if(!file.is_open()) { return false; }
-
 	//Serialize CPU registers data to save state
-	file.write((char*)&reg, sizeof(reg));
+	state.write((char*)&reg, sizeof(reg));
 
 	//Serialize misc CPU data to save state
-	file.write((char*)&current_cpu_mode, sizeof(current_cpu_mode));
-	file.write((char*)&arm_mode, sizeof(arm_mode));
-	file.write((char*)&running, sizeof(running));
-	file.write((char*)&lbl_addr, sizeof(lbl_addr));
-	file.write((char*)&first_branch, sizeof(first_branch));
-	file.write((char*)&needs_flush, sizeof(needs_flush));
-	file.write((char*)&in_interrupt, sizeof(in_interrupt));
-	file.write((char*)&idle_state, sizeof(idle_state));
-	file.write((char*)&last_idle_state, sizeof(last_idle_state));
-	file.write((char*)&thumb_long_branch, sizeof(thumb_long_branch));
-	file.write((char*)&last_instr_branch, sizeof(last_instr_branch));
-	file.write((char*)&swi_waitbyloop_count, sizeof(swi_waitbyloop_count));
-	file.write((char*)&instruction_pipeline[0], sizeof(instruction_pipeline[0]));
-	file.write((char*)&instruction_pipeline[1], sizeof(instruction_pipeline[1]));
-	file.write((char*)&instruction_pipeline[2], sizeof(instruction_pipeline[2]));
-	file.write((char*)&instruction_operation[0], sizeof(instruction_operation[0]));
-	file.write((char*)&instruction_operation[1], sizeof(instruction_operation[1]));
-	file.write((char*)&instruction_operation[2], sizeof(instruction_operation[2]));
-	file.write((char*)&pipeline_pointer, sizeof(pipeline_pointer));
-	file.write((char*)&debug_message, sizeof(debug_message));
-	file.write((char*)&debug_code, sizeof(debug_code));
-	file.write((char*)&debug_cycles, sizeof(debug_cycles));
-	file.write((char*)&debug_addr, sizeof(debug_addr));
-	file.write((char*)&sync_cycles, sizeof(sync_cycles));
-	file.write((char*)&system_cycles, sizeof(system_cycles));
-	file.write((char*)&re_sync, sizeof(re_sync));
+	state.write((char*)&current_cpu_mode, sizeof(current_cpu_mode));
+	state.write((char*)&arm_mode, sizeof(arm_mode));
+	state.write((char*)&lbl_addr, sizeof(lbl_addr));
+	state.write((char*)&first_branch, sizeof(first_branch));
+	state.write((char*)&running, sizeof(running));
+	state.write((char*)&needs_flush, sizeof(needs_flush));
+	state.write((char*)&flush_counter, sizeof(flush_counter));
+	state.write((char*)&in_interrupt, sizeof(in_interrupt));
+	state.write((char*)&idle_state, sizeof(idle_state));
+	state.write((char*)&last_idle_state, sizeof(last_idle_state));
+	state.write((char*)&thumb_long_branch, sizeof(thumb_long_branch));
+	state.write((char*)&last_instr_branch, sizeof(last_instr_branch));
+	state.write((char*)&swi_waitbyloop_count, sizeof(swi_waitbyloop_count));
+	state.write((char*)&instruction_pipeline[0], sizeof(instruction_pipeline[0]));
+	state.write((char*)&instruction_pipeline[1], sizeof(instruction_pipeline[1]));
+	state.write((char*)&instruction_pipeline[2], sizeof(instruction_pipeline[2]));
+	state.write((char*)&instruction_operation[0], sizeof(instruction_operation[0]));
+	state.write((char*)&instruction_operation[1], sizeof(instruction_operation[1]));
+	state.write((char*)&instruction_operation[2], sizeof(instruction_operation[2]));
+	state.write((char*)&pipeline_pointer, sizeof(pipeline_pointer));
+	state.write((char*)&debug_message, sizeof(debug_message));
+	state.write((char*)&debug_code, sizeof(debug_code));
+	state.write((char*)&debug_cycles, sizeof(debug_cycles));
+	state.write((char*)&debug_addr, sizeof(debug_addr));
+	state.write((char*)&sync_cycles, sizeof(sync_cycles));
+	state.write((char*)&system_cycles, sizeof(system_cycles));
+	state.write((char*)&re_sync, sizeof(re_sync));
 
 	//Serialize timers to save state
-	file.write((char*)&controllers.timer[0], sizeof(controllers.timer[0]));
-	file.write((char*)&controllers.timer[1], sizeof(controllers.timer[1]));
-	file.write((char*)&controllers.timer[2], sizeof(controllers.timer[2]));
-	file.write((char*)&controllers.timer[3], sizeof(controllers.timer[3]));
+	state.write((char*)&controllers.timer[0], sizeof(controllers.timer[0]));
+	state.write((char*)&controllers.timer[1], sizeof(controllers.timer[1]));
+	state.write((char*)&controllers.timer[2], sizeof(controllers.timer[2]));
+	state.write((char*)&controllers.timer[3], sizeof(controllers.timer[3]));
+
+	//Serialize CP15 registers and control parameters
+	for(u32 x = 0; x < 34; x++) { state.write((char*)&co_proc.regs[x], sizeof(co_proc.regs[x])); }
+
+	state.write((char*)&co_proc.pu_enable, sizeof(co_proc.pu_enable));
+	state.write((char*)&co_proc.unified_cache, sizeof(co_proc.unified_cache));
+	state.write((char*)&co_proc.instr_cache, sizeof(co_proc.instr_cache));
+	state.write((char*)&co_proc.exception_vector, sizeof(co_proc.exception_vector));
+	state.write((char*)&co_proc.cache_replacement, sizeof(co_proc.cache_replacement));
+	state.write((char*)&co_proc.pre_armv5, sizeof(co_proc.pre_armv5));
+	state.write((char*)&co_proc.dtcm_enable, sizeof(co_proc.dtcm_enable));
+	state.write((char*)&co_proc.itcm_enable, sizeof(co_proc.itcm_enable));
 
-	//Serialize CP15 registers
-	for(u32 x = 0; x < 32; x++) { file.write((char*)&co_proc.regs[x], sizeof(co_proc.regs[x])); }
-
-	file.close();
 	return true;
 }
 
@@ -1702,6 +1488,7 @@ u32 NTR_ARM9::size()
 	cpu_size += sizeof(first_branch);
 	cpu_size += sizeof(running);
 	cpu_size += sizeof(needs_flush);
+	cpu_size += sizeof(flush_counter);
 	cpu_size += sizeof(in_interrupt);
 	cpu_size += sizeof(idle_state);
 	cpu_size += sizeof(last_idle_state);
@@ -1727,7 +1514,16 @@ u32 NTR_ARM9::size()
 	cpu_size += sizeof(system_cycles);
 	cpu_size += sizeof(re_sync);
 
-	for(u32 x = 0; x < 32; x++) { cpu_size += sizeof(co_proc.regs[x]); }
+	for(u32 x = 0; x < 34; x++) { cpu_size += sizeof(co_proc.regs[x]); }
+
+	cpu_size += sizeof(co_proc.pu_enable);
+	cpu_size += sizeof(co_proc.unified_cache);
+	cpu_size += sizeof(co_proc.instr_cache);
+	cpu_size += sizeof(co_proc.exception_vector);
+	cpu_size += sizeof(co_proc.cache_replacement);
+	cpu_size += sizeof(co_proc.pre_armv5);
+	cpu_size += sizeof(co_proc.dtcm_enable);
+	cpu_size += sizeof(co_proc.itcm_enable);
 
 	return cpu_size;
 }
@@ -13,12 +13,15 @@
 #include <iomanip>
 #include <ctime>
 #include <sstream>
+#include <fstream>
+#include <cstdio>
 
 #ifdef GBE_IMAGE_FORMATS
 #include <SDL2/SDL_image.h>
 #endif
 
 #include "common/util.h"
+#include "common/headless.h"
 
 #include "core.h"
 
@@ -75,6 +78,8 @@ NTR_core::NTR_core()
 	nds9_debug = true;
 	arm_debug = true;
 
+	base_crc = 0;
+
 	//Load Virtual Cursor
 	if(config::vc_enable) { load_virtual_cursor(); }
 
@@ -183,22 +188,228 @@ void NTR_core::reset()
 	core_cpu_nds9.re_sync = true;
 	core_cpu_nds7.re_sync = false;
 
+	//Older rewind states belong to the previous session
+	rewind.clear();
+
 	//Start everything all over again
 	if(can_reset) { start(); }
 	else { running = false; }
 }
 
 /****** Loads a save state ******/
-void NTR_core::load_state(u8 slot) { }
+void NTR_core::load_state(u8 slot)
+{
+	std::string id = (slot > 0) ? util::to_str(slot) : "";
+
+	std::string state_file = config::rom_file + ".ss";
+	state_file += id;
+
+	save_state_buffer state;
+
+	//Check if save state is accessible
+	if(!state.load_file(state_file))
+	{
+		config::osd_message = "INVALID SAVE STATE " + util::to_str(slot);
+		config::osd_count = 180;
+		return;
+	}
+
+	//Rebuild the full state from the base snapshot if necessary
+	if(state.is_delta())
+	{
+		if(!load_base_state(state.get_delta_base_crc()) || !state.apply_delta(base_state))
+		{
+			config::osd_message = "INVALID SAVE STATE " + util::to_str(slot);
+			config::osd_count = 180;
+			return;
+		}
+	}
+
+	if(!deserialize_state(state)) { return; }
+
+	//Don't rewind past the loaded state
+	rewind.clear();
+
+	std::cout<<"GBE::Loaded state " << state_file << "\n";
+
+	//OSD
+	config::osd_message = "LOADED STATE " + util::to_str(slot);
+	config::osd_count = 180;
+}
 
 /****** Saves a save state ******/
-void NTR_core::save_state(u8 slot) { }
+void NTR_core::save_state(u8 slot)
+{
+	std::string id = (slot > 0) ? util::to_str(slot) : "";
+
+	std::string state_file = config::rom_file + ".ss";
+	state_file += id;
+
+	save_state_buffer state;
+
+	if(!serialize_state(state)) { return; }
+
+	//Remember which base this slot used before, it may no longer be needed afterwards
+	u32 old_slot_crc = get_state_base_crc(state_file);
+	u32 old_base_crc = base_crc;
+
+	//Store the state as a delta against the current base when that saves enough space
+	save_state_buffer delta;
+	bool use_delta = false;
+
+	if(!base_state.data.empty())
+	{
+		state.make_delta(base_state, delta.data);
+		use_delta = (delta.data.size() < (state.data.size() / 2));
+
+		//Write the base again if its file has gone missing
+		if(use_delta)
+		{
+			std::ifstream base_file(get_base_file(base_crc).c_str(), std::ios::binary);
+			if(!base_file.is_open()) { use_delta = base_state.save_file(get_base_file(base_crc)); }
+		}
+	}
+
+	//Otherwise this state becomes a new base. Existing bases are never overwritten, so older deltas stay valid
+	if(!use_delta)
+	{
+		base_state.data = state.data;
+		base_crc = util::get_crc32(&base_state.data[0], base_state.data.size());
+
+		if(base_state.save_file(get_base_file(base_crc)))
+		{
+			state.make_delta(base_state, delta.data);
+			use_delta = true;
+		}
+
+		else
+		{
+			base_state.data.clear();
+			base_crc = 0;
+		}
+	}
+
+	if(use_delta) { state.data.swap(delta.data); }
+
+	if(!state.save_file(state_file)) { return; }
+
+	//Delete bases that no slot depends on anymore
+	if((old_base_crc != base_crc) && (old_base_crc != 0) && (!is_base_in_use(old_base_crc))) { std::remove(get_base_file(old_base_crc).c_str()); }
+
+	if((old_slot_crc != base_crc) && (old_slot_crc != old_base_crc) && (old_slot_crc != 0) && (!is_base_in_use(old_slot_crc)))
+	{
+		std::remove(get_base_file(old_slot_crc).c_str());
+	}
+
+	std::cout<<"GBE::Saved state " << state_file << "\n";
+
+	//OSD
+	config::osd_message = "SAVED STATE " + util::to_str(slot);
+	config::osd_count = 180;
+}
+
+/****** Returns the file holding the base snapshot with the given CRC32 ******/
+std::string NTR_core::get_base_file(u32 crc)
+{
+	std::stringstream name;
+	name << config::rom_file << ".ssb." << std::hex << std::uppercase << std::setw(8) << std::setfill('0') << crc;
+	return name.str();
+}
+
+/****** Loads the base snapshot a delta was made against, unless it is already in memory ******/
+bool NTR_core::load_base_state(u32 crc)
+{
+	if((!base_state.data.empty()) && (base_crc == crc)) { return true; }
+
+	save_state_buffer base;
+
+	if(!base.load_file(get_base_file(crc)) || base.data.empty() || (util::get_crc32(&base.data[0], base.data.size()) != crc))
+	{
+		std::cout<<"GBE::Error - Could not load save state base " << get_base_file(crc) << "\n";
+		return false;
+	}
+
+	base_state.data.swap(base.data);
+	base_crc = crc;
+
+	return true;
+}
+
+/****** Checks whether any save state slot is a delta against the given base ******/
+bool NTR_core::is_base_in_use(u32 crc)
+{
+	//Quick Save plus Slots 1 - 9
+	for(u32 slot = 0; slot < 10; slot++)
+	{
+		std::string state_file = config::rom_file + ".ss";
+		if(slot > 0) { state_file += util::to_str(slot); }
+
+		if(get_state_base_crc(state_file) == crc) { return true; }
+	}
+
+	return false;
+}
+
+/****** Returns the CRC32 of the base a save state file is a delta against, or 0 if it is not a delta ******/
+u32 NTR_core::get_state_base_crc(std::string filename)
+{
+	std::ifstream file(filename.c_str(), std::ios::binary);
+	if(!file.is_open()) { return 0; }
+
+	//Only the delta header is needed
+	save_state_buffer header;
+	header.data.resize(STATE_DELTA_HEADER_SIZE, 0);
+	file.read((char*)&header.data[0], STATE_DELTA_HEADER_SIZE);
+
+	if(!file.good()) { return 0; }
+	return header.get_delta_base_crc();
+}
+
+/****** Saves the current state of the core to a memory buffer ******/
+bool NTR_core::serialize_state(save_state_buffer& state)
+{
+	state.begin_write(STATE_SYSTEM_NTR);
+
+	//Both CPUs share one section, along with the data keeping them in sync
+	state.begin_section(STATE_SECTION_CPU);
+	if(!core_cpu_nds9.cpu_write(state)) { return false; }
+	if(!core_cpu_nds7.cpu_write(state)) { return false; }
+	state.write((char*)&cpu_sync_cycles, sizeof(cpu_sync_cycles));
+
+	state.begin_section(STATE_SECTION_MMU);
+	if(!core_mmu.mmu_write(state)) { return false; }
+
+	state.begin_section(STATE_SECTION_APU);
+	if(!core_cpu_nds7.controllers.audio.apu_write(state)) { return false; }
+
+	state.begin_section(STATE_SECTION_LCD);
+	if(!core_cpu_nds9.controllers.video.lcd_write(state)) { return false; }
+
+	state.end_write();
+	return true;
+}
+
+/****** Loads the state of the core from a memory buffer ******/
+bool NTR_core::deserialize_state(save_state_buffer& state)
+{
+	if(!state.begin_read(STATE_SYSTEM_NTR)) { return false; }
+
+	if(!state.find_section(STATE_SECTION_CPU)) { return false; }
+	if((!core_cpu_nds9.cpu_read(state)) || (!core_cpu_nds7.cpu_read(state))) { return false; }
+	if(!state.read((char*)&cpu_sync_cycles, sizeof(cpu_sync_cycles))) { return false; }
+
+	if((!state.find_section(STATE_SECTION_MMU)) || (!core_mmu.mmu_read(state))) { return false; }
+	if((!state.find_section(STATE_SECTION_APU)) || (!core_cpu_nds7.controllers.audio.apu_read(state))) { return false; }
+	if((!state.find_section(STATE_SECTION_LCD)) || (!core_cpu_nds9.controllers.video.lcd_read(state))) { return false; }
+
+	return true;
+}
 
 /****** Run the core in a loop until exit ******/
 void NTR_core::run_core()
 {
 	//Reaneble cursor for this core since it's actually useful for the touchscreen
-	SDL_ShowCursor(SDL_ENABLE);
+	if(!config::headless) { SDL_ShowCursor(SDL_ENABLE); }
 
 	if(!config::use_bios || !config::use_firmware)
 	{
@@ -209,11 +420,27 @@ void NTR_core::run_core()
 		core_cpu_nds7.reg.r15 = core_mmu.header.arm7_entry_addr;
 	}
 
+	bool rewind_frame = false;
+
 	//Begin running the core
 	while(running)
 	{
+		//Capture or restore rewind states once per frame, then journal any save data changes
+		if(core_cpu_nds9.controllers.video.lcd_stat.current_scanline == 192)
+		{
+			if(!rewind_frame)
+			{
+				rewind.update(this);
+				core_mmu.update_backup_journal();
+			}
+
+			rewind_frame = true;
+		}
+
+		else { rewind_frame = false; }
+
 		//Handle SDL Events
-		if((core_cpu_nds9.controllers.video.lcd_stat.current_scanline == 192) && SDL_PollEvent(&event))
+		if((!config::headless) && (core_cpu_nds9.controllers.video.lcd_stat.current_scanline == 192) && SDL_PollEvent(&event))
 		{
 			//X out of a window
 			if(event.type == SDL_QUIT) { stop(); SDL_Quit(); }
@@ -366,6 +593,8 @@ void NTR_core::run_core()
 				//Clock system components
 				core_cpu_nds9.clock_system();
 
+				if(config::headless) { headless::add_cycles(core_cpu_nds9.sync_cycles); }
+
 				//Determine if NDS7 needs to run in order to sync
 				cpu_sync_cycles -= core_cpu_nds9.sync_cycles;	
 
@@ -738,6 +967,24 @@ void NTR_core::handle_hotkey(SDL_Event& event)
 		SDL_Quit();
 	}
 
+	//Rewind while the rewind hotkey is held
+	else if(((event.type == SDL_KEYDOWN) || (event.type == SDL_KEYUP)) && (event.key.keysym.sym == config::hotkey_rewind))
+	{
+		rewind.set_active(event.type == SDL_KEYDOWN);
+	}
+
+	//Quick save state on F1
+	else if((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == SDLK_F1)) 
+	{
+		save_state(0);
+	}
+
+	//Quick load save state on F2
+	else if((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == SDLK_F2)) 
+	{
+		load_state(0);
+	}
+
 	//Screenshot on F9
 	else if((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == SDLK_F9)) 
 	{
@@ -803,7 +1050,9 @@ void NTR_core::handle_hotkey(SDL_Event& event)
 		//Initialize new window - SDL
 		if(!config::use_opengl)
 		{
-			core_cpu_nds9.controllers.video.window = SDL_CreateWindow("GBE+", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, config::sys_width, config::sys_height, config::flags);
+			u32 window_scale = (core_cpu_nds9.controllers.video.filter.is_active()) ? config::scaling_factor : 1;
+
+			core_cpu_nds9.controllers.video.window = SDL_CreateWindow("GBE+", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, (config::sys_width * window_scale), (config::sys_height * window_scale), config::flags);
 			SDL_GetWindowSize(core_cpu_nds9.controllers.video.window, &config::win_width, &config::win_height);
 			core_cpu_nds9.controllers.video.final_screen = SDL_GetWindowSurface(core_cpu_nds9.controllers.video.window);
 
@@ -911,6 +1160,9 @@ void NTR_core::handle_hotkey(int input, bool pressed)
 	//Toggle turbo off
 	else if((input == config::hotkey_turbo) && (!pressed)) { config::turbo = false; }
 
+	//Rewind while the rewind hotkey is held
+	else if(input == config::hotkey_rewind) { rewind.set_active(pressed); }
+
 	//Toggle swap NDS screens on F4
 	else if((input == config::hotkey_swap_screen) && (pressed))
 	{
@@ -965,7 +1217,12 @@ void NTR_core::feed_key_input(int sdl_key, bool pressed)
 u32 NTR_core::ex_get_reg(u8 reg_index) { return 0; }
 
 /****** Read binary file to memory ******/
-bool NTR_core::read_file(std::string filename) { return core_mmu.read_file(filename); }
+bool NTR_core::read_file(std::string filename)
+{
+	//Rewind states from another ROM can't be restored
+	rewind.clear();
+	return core_mmu.read_file(filename);
+}
 
 /****** Read BIOS file into memory ******/
 bool NTR_core::read_bios(std::string filename)
@@ -40,6 +40,8 @@ class NTR_core : virtual public core_emu
 		void feed_key_input(int sdl_key, bool pressed);
 		void save_state(u8 slot);
 		void load_state(u8 slot);
+		bool serialize_state(save_state_buffer& state);
+		bool deserialize_state(save_state_buffer& state);
 		void run_core();
 		void step();
 
@@ -71,6 +73,16 @@ class NTR_core : virtual public core_emu
 		NTR_ARM7 core_cpu_nds7;
 		NTR_ARM9 core_cpu_nds9;
 
+		//Delta save state base snapshots, each file is named after the CRC32 of its contents
+		std::string get_base_file(u32 crc);
+		bool load_base_state(u32 crc);
+		bool is_base_in_use(u32 crc);
+		u32 get_state_base_crc(std::string filename);
+
+		//Base snapshot that save states are stored as deltas against
+		save_state_buffer base_state;
+		u32 base_crc;
+
 		double cpu_sync_cycles;
 		bool nds9_debug;
 		bool arm_debug;
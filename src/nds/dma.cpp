@@ -12,6 +12,36 @@
 #include "arm9.h"
 #include "arm7.h" 
 
+/****** Moves as much of a DMA transfer as possible in bulk when both sides are plain memory - NDS9 ******/
+void NTR_ARM9::dma_bulk_transfer(u8 index)
+{
+	u8 unit = (mem->dma[index].word_type) ? 4 : 2;
+	u32 length = (mem->dma[index].word_count * unit);
+	u32 done = 0;
+
+	//Decrementing and fixed destinations go through the normal path
+	if((mem->dma[index].dest_addr_ctrl != 0) && (mem->dma[index].dest_addr_ctrl != 3)) { return; }
+
+	//Incrementing source
+	if((mem->dma[index].src_addr_ctrl == 0) || (mem->dma[index].src_addr_ctrl == 3))
+	{
+		done = mem->copy_block(mem->dma[index].destination_address, mem->dma[index].start_address, length);
+		mem->dma[index].start_address += done;
+	}
+
+	//DMA fill operation
+	else if(mem->dma[index].src_addr_ctrl == 4)
+	{
+		u32 value = (unit == 4) ? mem->read_u32(mem->dma[index].start_address) : mem->read_u16(mem->dma[index].start_address);
+		if(unit == 2) { value |= (value << 16); }
+
+		done = mem->fill_block(mem->dma[index].destination_address, value, length);
+	}
+
+	mem->dma[index].destination_address += done;
+	mem->dma[index].word_count -= (done / unit);
+}
+
 /****** Performs DMA0 through DMA3 transfers - NDS9 ******/
 void NTR_ARM9::nds9_dma(u8 index)
 {
@@ -60,6 +90,9 @@ void NTR_ARM9::nds9_dma(u8 index)
 			mem->dma[index].start_address &= ~0x1;
 			mem->dma[index].destination_address &= ~0x1;
 
+			//Move plain memory in bulk first
+			dma_bulk_transfer(index);
+
 			while(mem->dma[index].word_count != 0)
 			{
 				temp_value = mem->read_u16(mem->dma[index].start_address);
@@ -86,6 +119,9 @@ void NTR_ARM9::nds9_dma(u8 index)
 			mem->dma[index].start_address &= ~0x3;
 			mem->dma[index].destination_address &= ~0x3;
 
+			//Move plain memory in bulk first
+			dma_bulk_transfer(index);
+
 			while(mem->dma[index].word_count != 0)
 			{
 				temp_value = mem->read_u32(mem->dma[index].start_address);
@@ -127,6 +163,7 @@ void NTR_ARM9::nds9_dma(u8 index)
 
 		while(mem->dma[index].word_count != 0)
 		{
+			mem->mark_tex_vram(mem->dma[index].destination_address);
 			mem->memory_map[mem->dma[index].destination_address++] = mem->cart_data[mem->nds_card.transfer_src++];
 			mem->dma[index].word_count--;
 		}
@@ -198,6 +235,27 @@ void NTR_ARM9::nds9_dma(u8 index)
 	}
 }
 
+/****** Moves as much of a DMA transfer as possible in bulk when both sides are plain memory - NDS7 ******/
+void NTR_ARM7::dma_bulk_transfer(u8 index)
+{
+	u8 unit = (mem->dma[index].word_type) ? 4 : 2;
+	u32 length = (mem->dma[index].word_count * unit);
+	u32 done = 0;
+
+	//Decrementing and fixed destinations go through the normal path
+	if((mem->dma[index].dest_addr_ctrl != 0) && (mem->dma[index].dest_addr_ctrl != 3)) { return; }
+
+	//Incrementing source
+	if((mem->dma[index].src_addr_ctrl == 0) || (mem->dma[index].src_addr_ctrl == 3))
+	{
+		done = mem->copy_block(mem->dma[index].destination_address, mem->dma[index].start_address, length);
+		mem->dma[index].start_address += done;
+	}
+
+	mem->dma[index].destination_address += done;
+	mem->dma[index].word_count -= (done / unit);
+}
+
 /****** Performs DMA0 through DMA3 transfers - NDS7 ******/
 void NTR_ARM7::nds7_dma(u8 index)
 {
@@ -232,6 +290,9 @@ void NTR_ARM7::nds7_dma(u8 index)
 		mem->dma[index].start_address &= ~0x1;
 		mem->dma[index].destination_address &= ~0x1;
 
+		//Move plain memory in bulk first
+		dma_bulk_transfer(index);
+
 		while(mem->dma[index].word_count != 0)
 		{
 			temp_value = mem->read_u16(mem->dma[index].start_address);
@@ -258,6 +319,9 @@ void NTR_ARM7::nds7_dma(u8 index)
 		mem->dma[index].start_address &= ~0x3;
 		mem->dma[index].destination_address &= ~0x3;
 
+		//Move plain memory in bulk first
+		dma_bulk_transfer(index);
+
 		while(mem->dma[index].word_count != 0)
 		{
 			temp_value = mem->read_u32(mem->dma[index].start_address);
@@ -29,7 +29,7 @@ void NTR_LCD::render_bg_3D()
 	u8 bg_priority = lcd_stat.bg_priority_a[0] + 1;
 	u16 x_offset = lcd_stat.bg_offset_x_a[0];
 
-	//Grab data from the previous buffer
+	//Grab data from the front buffer - Polygons are only ever drawn to the back buffer
 	u16 current_buffer = (lcd_3D_stat.buffer_id);
 
 	//Push 3D screen buffer data to scanline buffer
@@ -45,38 +45,29 @@ void NTR_LCD::render_bg_3D()
 			{
 				render_buffer_a[x] = bg_priority;
 				scanline_buffer_a[x] = gx_screen_buffer[current_buffer][gx_index + i];
-				line_buffer[4][x] |= 1;
+				line_buffer_a[4][x] |= 1;
 			}
 		}
 
-		line_buffer[0][x] = scanline_buffer_a[x];
+		line_buffer_a[0][x] = scanline_buffer_a[x];
 	} 
 }
 
-/****** Renders geometry to the 3D screen buffers ******/
+/****** Translates the current polygon to screen coordinates and queues it for rasterization ******/
 void NTR_LCD::render_geometry()
 {
-	u8 bg_priority = lcd_stat.bg_priority_a[0] + 1;
-
 	//Calculate origin coordinates based on viewport dimensions
 	u8 viewport_width = (lcd_3D_stat.view_port_x2 - lcd_3D_stat.view_port_x1);
 	u8 viewport_height = (lcd_3D_stat.view_port_y2 - lcd_3D_stat.view_port_y1);
 
 	//Plot points used for screen rendering
-	float plot_x[4];
-	float plot_y[4];
-	float plot_z[4];
-	float plot_w[4];
-	float plot_tx[4];
-	float plot_ty[4];
-	s32 buffer_index = 0;
-	u8 vert_count = 0;
+	gx_poly_entry poly;
 	gx_matrix vert_matrix = current_poly;
 	gx_matrix temp_matrix;
 	gx_matrix clip_matrix;
 
 	//Determine what kind of polygon to render
-	vert_count = (lcd_3D_stat.vertex_mode & 0x1) ? 4 : 3;
+	poly.vert_count = (lcd_3D_stat.vertex_mode & 0x1) ? 4 : 3;
 
 	//Vertex order
 	u8 vert_order[4];
@@ -96,13 +87,13 @@ void NTR_LCD::render_geometry()
 	}
 
 	//Translate all vertices to screen coordinates
-	for(u8 a = 0; a < vert_count; a++)
+	for(u8 a = 0; a < poly.vert_count; a++)
 	{
 		u8 x = vert_order[a];
 
 		//Sort texture coordinates according to vertices as well
-		plot_tx[a] = lcd_3D_stat.tex_coord_x[x];
-		plot_ty[a] = lcd_3D_stat.tex_coord_y[x];
+		poly.plot_tx[a] = lcd_3D_stat.tex_coord_x[x];
+		poly.plot_ty[a] = lcd_3D_stat.tex_coord_y[x];
 
 		clip_matrix = last_pos_matrix[x] * gx_projection_matrix;
 
@@ -114,108 +105,203 @@ void NTR_LCD::render_geometry()
 
 		//Generate NDS XY screen coordinate from clip matrix
 		temp_matrix = temp_matrix * clip_matrix;
- 		plot_x[a] = round(((temp_matrix[0] + temp_matrix[3]) * viewport_width) / ((2 * temp_matrix[3]) + lcd_3D_stat.view_port_x1));
-  		plot_y[a] = round(((-temp_matrix[1] + temp_matrix[3]) * viewport_height) / ((2 * temp_matrix[3]) + lcd_3D_stat.view_port_y1));
+ 		poly.plot_x[a] = round(((temp_matrix[0] + temp_matrix[3]) * viewport_width) / ((2 * temp_matrix[3]) + lcd_3D_stat.view_port_x1));
+  		poly.plot_y[a] = round(((-temp_matrix[1] + temp_matrix[3]) * viewport_height) / ((2 * temp_matrix[3]) + lcd_3D_stat.view_port_y1));
 
 		//Get Z coordinate, use existing data from vertex
 		if(lcd_3D_stat.z_buffering)
 		{
-			plot_z[a] = temp_matrix[2];
+			poly.plot_z[a] = temp_matrix[2];
 			
 			if(temp_matrix[3])
 			{
 				u64 z = get_u32_fixed(temp_matrix[2]);
 				u32 w = get_u32_fixed(temp_matrix[3]);
 				z = ((((z << 14) / w) + 0x3FFF) << 9) & 0xFFFFFF;
-				plot_z[a] = (z >> 12) + ((z & 0xFFF) / 4096.0);
+				poly.plot_z[a] = (z >> 12) + ((z & 0xFFF) / 4096.0);
 			}
 		}
 
 		//Otherwise, use W value for depth
 		else
 		{
-			plot_z[a] = temp_matrix[3];
+			poly.plot_z[a] = temp_matrix[3];
 		}
 
-		plot_w[a] = temp_matrix[3];
-
 		//Check for wonky coordinates
-		if(std::isnan(plot_x[a])) { lcd_3D_stat.render_polygon = false; return; }
-		if(std::isinf(plot_x[a])) { lcd_3D_stat.render_polygon = false; return; }
+		if(std::isnan(poly.plot_x[a])) { lcd_3D_stat.render_polygon = false; return; }
+		if(std::isinf(poly.plot_x[a])) { lcd_3D_stat.render_polygon = false; return; }
 
-		if(std::isnan(plot_y[a])) { lcd_3D_stat.render_polygon = false; return; }
-		if(std::isinf(plot_y[a])) { lcd_3D_stat.render_polygon = false; return; }
+		if(std::isnan(poly.plot_y[a])) { lcd_3D_stat.render_polygon = false; return; }
+		if(std::isinf(poly.plot_y[a])) { lcd_3D_stat.render_polygon = false; return; }
 
 		//Check if coordinates need to be clipped to the view volume
-		if((plot_x[a] < 0) || (plot_x[a] > 255) || (plot_y[a] < 0) || (plot_y[a] > 192))
+		if((poly.plot_x[a] < 0) || (poly.plot_x[a] > 255) || (poly.plot_y[a] < 0) || (poly.plot_y[a] > 192))
 		{
 			lcd_3D_stat.clip_flags |= (1 << x);
 		}
 	}
 
-	//Reset hi and lo fill coordinates
-	for(int x = 0; x < 256; x++)
+	//Find minimum and maximum X values for polygon
+	float x_min = poly.plot_x[0];
+	float x_max = poly.plot_x[0];
+
+	for(u8 x = 1; x < poly.vert_count; x++)
 	{
-		lcd_3D_stat.hi_fill[x] = 0xFF;
-		lcd_3D_stat.lo_fill[x] = 0;
+		if(poly.plot_x[x] < x_min) { x_min = poly.plot_x[x]; }
+		if(poly.plot_x[x] > x_max) { x_max = poly.plot_x[x]; }
+	}
+
+	poly.min_x = round(x_min);
+	poly.max_x = round(x_max);
+
+	if(poly.min_x < 0) { poly.min_x = 0; }
+	if(poly.max_x < 0) { poly.max_x = 0; }
 
-		lcd_3D_stat.hi_overflow[x] = 0;
-		lcd_3D_stat.lo_overflow[x] = 0;
+	if(poly.min_x > 255) { poly.min_x = 255; }
+	if(poly.max_x > 255) { poly.max_x = 255; }
 
-		lcd_3D_stat.hi_color[x] = 0;
-		lcd_3D_stat.lo_color[x] = 0;
+	//Capture polygon attributes as they are now, rasterization happens later
+	for(u8 x = 0; x < 4; x++) { poly.vert_colors[x] = vert_colors[x]; }
 
-		lcd_3D_stat.hi_tx[x] = 0;
-		lcd_3D_stat.lo_tx[x] = 0;
+	poly.poly_mode = lcd_3D_stat.poly_mode;
+	poly.poly_alpha = lcd_3D_stat.poly_alpha;
+	poly.poly_new_depth = lcd_3D_stat.poly_new_depth;
+	poly.poly_depth_test = lcd_3D_stat.poly_depth_test;
+	poly.vertex_color = lcd_3D_stat.vertex_color;
 
-		lcd_3D_stat.hi_ty[x] = 0;
-		lcd_3D_stat.lo_ty[x] = 0;
+	poly.use_texture = lcd_3D_stat.use_texture;
+	poly.tex_width = lcd_3D_stat.tex_src_width;
+	poly.tex_height = lcd_3D_stat.tex_src_height;
+	poly.repeat_tex_x = lcd_3D_stat.repeat_tex_x;
+	poly.repeat_tex_y = lcd_3D_stat.repeat_tex_y;
+	poly.flip_tex_x = lcd_3D_stat.flip_tex_x;
+	poly.flip_tex_y = lcd_3D_stat.flip_tex_y;
+
+	//Decode texture now, VRAM may change before the polygon is drawn
+	if(poly.use_texture && (poly.poly_mode != 3))
+	{
+		u8 slot = (lcd_3D_stat.tex_offset >> 17);
+		u32 tex_addr = (mem->vram_tex_slot[slot] + (lcd_3D_stat.tex_offset & 0x1FFFF));
+		poly.texels = get_tex(tex_addr);
 	}
 
-	//Find minimum and maximum X values for polygon
-	float x_min = plot_x[0];
-	float x_max = plot_x[0];
+	gx_poly_list[gx_poly_list_id].push_back(poly);
+
+	lcd_3D_stat.render_polygon = false;
+	lcd_3D_stat.clip_flags = 0;
+}
+
+/****** Draws all queued polygons to the back buffer using worker threads ******/
+void NTR_LCD::flush_geometry()
+{
+	wait_geometry();
 
-	for(u8 x = 1; x < vert_count; x++)
+	if(gx_poly_list[gx_poly_list_id].empty()) { return; }
+
+	gx_raster_list_id = gx_poly_list_id;
+
+	gx_poly_list_id ^= 0x1;
+	gx_poly_list[gx_poly_list_id].clear();
+
+	gx_workers.dispatch(rasterize_band_task, this, gx_band_count);
+}
+
+/****** Waits until queued polygons have finished drawing to the back buffer ******/
+void NTR_LCD::wait_geometry()
+{
+	gx_workers.wait();
+}
+
+/****** Worker thread entry point for rasterization ******/
+void NTR_LCD::rasterize_band_task(void* data, u32 index)
+{
+	NTR_LCD* lcd = (NTR_LCD*)data;
+	lcd->rasterize_band(index);
+}
+
+/****** Draws every queued polygon, limited to one band of scanlines ******/
+void NTR_LCD::rasterize_band(u32 band)
+{
+	//Each band owns its scanlines in the screen, render, and Z buffers, so polygons are still drawn in submission order per pixel
+	u8 y_start = (192 * band) / gx_band_count;
+	u8 y_end = (192 * (band + 1)) / gx_band_count;
+
+	gx_poly_edges& edges = gx_band_edges[band];
+	const std::vector<gx_poly_entry>& poly_list = gx_poly_list[gx_raster_list_id];
+
+	for(u32 x = 0; x < poly_list.size(); x++)
 	{
-		if(plot_x[x] < x_min) { x_min = plot_x[x]; }
-		if(plot_x[x] > x_max) { x_max = plot_x[x]; }
+		const gx_poly_entry& poly = poly_list[x];
+
+		//Shadow polygons
+		if(poly.poly_mode == 3) { continue; }
+
+		trace_poly_edges(poly, edges);
+
+		//Textured color fill
+		if(poly.use_texture) { fill_poly_textured(poly, edges, gx_raster_buffer_id, y_start, y_end); continue; }
+
+		bool solid = true;
+
+		for(u8 y = 1; y < poly.vert_count; y++)
+		{
+			if(poly.vert_colors[y] != poly.vert_colors[0]) { solid = false; }
+		}
+
+		//Solid color fill
+		if(solid) { fill_poly_solid(poly, edges, gx_raster_buffer_id, y_start, y_end); }
+
+		//Interpolated color fill
+		else { fill_poly_interpolated(poly, edges, gx_raster_buffer_id, y_start, y_end); }
 	}
+}
+
+/****** NDS 3D Software Renderer - Calculates fill coordinates along the edges of a polygon ******/
+void NTR_LCD::trace_poly_edges(const gx_poly_entry& poly, gx_poly_edges& edges)
+{
+	//Reset hi and lo fill coordinates
+	for(int x = 0; x < 256; x++)
+	{
+		edges.hi_fill[x] = 0xFF;
+		edges.lo_fill[x] = 0;
 
-	lcd_3D_stat.poly_min_x = round(x_min);
-	lcd_3D_stat.poly_max_x = round(x_max);
+		edges.hi_overflow[x] = 0;
+		edges.lo_overflow[x] = 0;
 
-	if(lcd_3D_stat.poly_min_x < 0) { lcd_3D_stat.poly_min_x = 0; }
-	if(lcd_3D_stat.poly_max_x < 0) { lcd_3D_stat.poly_max_x = 0; }
+		edges.hi_color[x] = 0;
+		edges.lo_color[x] = 0;
 
-	if(lcd_3D_stat.poly_min_x > 255) { lcd_3D_stat.poly_min_x = 255; }
-	if(lcd_3D_stat.poly_max_x > 255) { lcd_3D_stat.poly_max_x = 255; }
+		edges.hi_tx[x] = 0;
+		edges.lo_tx[x] = 0;
+
+		edges.hi_ty[x] = 0;
+		edges.lo_ty[x] = 0;
+	}
 
 	//Draw lines for all polygons
-	for(u8 x = 0; x < vert_count; x++)
+	for(u8 x = 0; x < poly.vert_count; x++)
 	{
 		u8 next_index = x + 1;
-		if(next_index == vert_count) { next_index = 0; }
+		if(next_index == poly.vert_count) { next_index = 0; }
 
-		float x_dist = (plot_x[next_index] - plot_x[x]);
-		float y_dist = (plot_y[next_index] - plot_y[x]);
-		float z_dist = (plot_z[next_index] - plot_z[x]);
+		float x_dist = (poly.plot_x[next_index] - poly.plot_x[x]);
+		float y_dist = (poly.plot_y[next_index] - poly.plot_y[x]);
 
 		float x_inc = 0.0;
 		float y_inc = 0.0;
 		float z_inc = 0.0;
 
-		float x_coord = plot_x[x];
-		float y_coord = plot_y[x];
-		float z_coord = plot_z[x];
-		float w_coord = plot_w[x];
+		float x_coord = poly.plot_x[x];
+		float y_coord = poly.plot_y[x];
+		float z_coord = poly.plot_z[x];
 
 		s32 xy_start = 0;
 		s32 xy_end = 0;
 		s32 xy_len = 0;
 
-		u32 c1 = vert_colors[x];
-		u32 c2 = vert_colors[next_index];
+		u32 c1 = poly.vert_colors[x];
+		u32 c2 = poly.vert_colors[next_index];
 		u32 c3 = 0;
 		float c_ratio = 0.0;
 		float c_inc = 0.0;
@@ -223,8 +309,8 @@ void NTR_LCD::render_geometry()
 		float tx_inc = 0.0;
 		float ty_inc = 0.0;
 
-		float tx = plot_tx[x];
-		float ty = plot_ty[x];
+		float tx = poly.plot_tx[x];
+		float ty = poly.plot_ty[x];
 
 		u32 overflow = 0;
 
@@ -242,8 +328,8 @@ void NTR_LCD::render_geometry()
 				if((x_dist < 0) && (x_inc > 0)) { x_inc *= -1.0; }
 				else if((x_dist > 0) && (x_inc < 0)) { x_inc *= -1.0; }
 
-				xy_start = plot_y[x];
-				xy_end = plot_y[next_index];
+				xy_start = poly.plot_y[x];
+				xy_end = poly.plot_y[next_index];
 			}
 
 			//Gentle slope, X = 1
@@ -255,8 +341,8 @@ void NTR_LCD::render_geometry()
 				if((y_dist < 0) && (y_inc > 0)) { y_inc *= -1.0; }
 				else if((y_dist > 0) && (y_inc < 0)) { y_inc *= -1.0; }
 
-				xy_start = plot_x[x];
-				xy_end = plot_x[next_index];
+				xy_start = poly.plot_x[x];
+				xy_end = poly.plot_x[next_index];
 			}
 		}
 
@@ -265,8 +351,8 @@ void NTR_LCD::render_geometry()
 			x_inc = 0.0;
 			y_inc = (y_dist > 0) ? 1.0 : -1.0;
 
-			xy_start = plot_y[x];
-			xy_end = plot_y[next_index];
+			xy_start = poly.plot_y[x];
+			xy_end = poly.plot_y[next_index];
 		}
 
 		else if(y_dist == 0)
@@ -274,19 +360,19 @@ void NTR_LCD::render_geometry()
 			x_inc = (x_dist > 0) ? 1.0 : -1.0;
 			y_inc = 0.0;
 
-			xy_start = plot_x[x];
-			xy_end = plot_x[next_index];
+			xy_start = poly.plot_x[x];
+			xy_end = poly.plot_x[next_index];
 		}
 
 		xy_len = std::abs(xy_end - xy_start);
 
 		if(xy_len != 0)
 		{
-			z_inc = (plot_z[next_index] - plot_z[x]) / xy_len;
+			z_inc = (poly.plot_z[next_index] - poly.plot_z[x]) / xy_len;
 			c_inc = 1.0 / xy_len;
 
-			tx_inc = (plot_tx[next_index] - plot_tx[x]) / xy_len;
-			ty_inc = (plot_ty[next_index] - plot_ty[x]) / xy_len;
+			tx_inc = (poly.plot_tx[next_index] - poly.plot_tx[x]) / xy_len;
+			ty_inc = (poly.plot_ty[next_index] - poly.plot_ty[x]) / xy_len;
 		}
 
 		while(xy_len)
@@ -314,28 +400,28 @@ void NTR_LCD::render_geometry()
 					temp_y = 0;
 				}
 
-				if(lcd_3D_stat.hi_fill[temp_x] > temp_y)
+				if(edges.hi_fill[temp_x] > temp_y)
 				{
-					lcd_3D_stat.hi_fill[temp_x] = temp_y;
-					lcd_3D_stat.hi_line_z[temp_x] = z_coord;
-					lcd_3D_stat.hi_color[temp_x] = c3;
+					edges.hi_fill[temp_x] = temp_y;
+					edges.hi_line_z[temp_x] = z_coord;
+					edges.hi_color[temp_x] = c3;
 
-					lcd_3D_stat.hi_tx[temp_x] = tx;
-					lcd_3D_stat.hi_ty[temp_x] = ty;
+					edges.hi_tx[temp_x] = tx;
+					edges.hi_ty[temp_x] = ty;
 
-					lcd_3D_stat.hi_overflow[temp_x] = overflow;
+					edges.hi_overflow[temp_x] = overflow;
 				}
 
-				if(lcd_3D_stat.lo_fill[temp_x] < temp_y)
+				if(edges.lo_fill[temp_x] < temp_y)
 				{
-					lcd_3D_stat.lo_fill[temp_x] = temp_y;
-					lcd_3D_stat.lo_line_z[temp_x] = z_coord;
-					lcd_3D_stat.lo_color[temp_x] = c3;
+					edges.lo_fill[temp_x] = temp_y;
+					edges.lo_line_z[temp_x] = z_coord;
+					edges.lo_color[temp_x] = c3;
 
-					lcd_3D_stat.lo_tx[temp_x] = tx;
-					lcd_3D_stat.lo_ty[temp_x] = ty;
+					edges.lo_tx[temp_x] = tx;
+					edges.lo_ty[temp_x] = ty;
 
-					lcd_3D_stat.lo_overflow[temp_x] = overflow;
+					edges.lo_overflow[temp_x] = overflow;
 				}
 			} 
 
@@ -350,108 +436,63 @@ void NTR_LCD::render_geometry()
 			xy_len--;
 		}
 	}
-
-	//Fill in polygon
-	switch(lcd_3D_stat.vertex_mode)
-	{
-		//Triangles
-		//Triangle Strips
-		case 0x0:
-		case 0x2:
-			//Shadow polygons
-			if(lcd_3D_stat.poly_mode == 3) { }
-
-			//Textured color fill
-			else if(lcd_3D_stat.use_texture) { fill_poly_textured(); }
-
-			//Solid color fill
-			else if((vert_colors[0] == vert_colors[1]) && (vert_colors[0] == vert_colors[2])) { fill_poly_solid(); }
-			
-			//Interpolated color fill
-			else { fill_poly_interpolated(); }
-
-			break;
-
-		//Quads
-		//Quad Strips
-		case 0x1:
-		case 0x3:
-			//Shadow polygons
-			if(lcd_3D_stat.poly_mode == 3) { }
-
-			//Textured color fill
-			else if(lcd_3D_stat.use_texture) { fill_poly_textured(); }
-
-			//Solid color fill
-			else if((vert_colors[0] == vert_colors[1]) && (vert_colors[0] == vert_colors[2]) && (vert_colors[0] == vert_colors[3])) { fill_poly_solid(); }
-
-			//Interpolated color fill
-			else { fill_poly_interpolated(); }
-
-			break;
-	}
-
-	lcd_3D_stat.render_polygon = false;
-	lcd_3D_stat.clip_flags = 0;
 }
 
 /****** NDS 3D Software Renderer - Fills a given poly with a solid color ******/
-void NTR_LCD::fill_poly_solid()
+void NTR_LCD::fill_poly_solid(const gx_poly_entry& poly, const gx_poly_edges& edges, u8 buffer_id, u8 y_start, u8 y_end)
 {
 	u8 y_coord = 0;
-	u8 buffer_id = (lcd_3D_stat.buffer_id + 1) & 0x1;
 	u32 buffer_index = 0;
 	u32 vert_color = 0;
 
-	bool use_alpha = (lcd_3D_stat.poly_alpha <= 30) ? true : false;
+	bool use_alpha = (poly.poly_alpha <= 30) ? true : false;
 
-	bool use_edge = lcd_3D_stat.edge_marking;
-	u32 edge_color = lcd_3D_stat.edge_color[lcd_3D_stat.poly_id >> 3];
-	u8 edge_x1 = lcd_3D_stat.poly_min_x;
-	u8 edge_x2 = lcd_3D_stat.poly_max_x - 1;
+	std::vector<u32>& frame_buffer = gx_screen_buffer[buffer_id];
+	std::vector<u8>& render_buffer = gx_render_buffer[buffer_id];
+	std::vector<float>& z_buffer = gx_z_buffer[buffer_id];
 
-	for(u32 x = lcd_3D_stat.poly_min_x; x <= lcd_3D_stat.poly_max_x; x++)
+	for(u32 x = poly.min_x; x <= poly.max_x; x++)
 	{
 		float z_start = 0.0;
 		float z_end = 0.0;
 		float z_inc = 0.0;
 
-		s16 hi_fill = lcd_3D_stat.hi_overflow[x] ? (lcd_3D_stat.hi_overflow[x]) : lcd_3D_stat.hi_fill[x];
-		s16 lo_fill = lcd_3D_stat.lo_overflow[x] ? (lcd_3D_stat.lo_overflow[x]) : lcd_3D_stat.lo_fill[x];
+		s16 hi_fill = edges.hi_overflow[x] ? (edges.hi_overflow[x]) : edges.hi_fill[x];
+		s16 lo_fill = edges.lo_overflow[x] ? (edges.lo_overflow[x]) : edges.lo_fill[x];
 
 		//Calculate Z start and end fill coordinates
-		z_start = lcd_3D_stat.hi_line_z[x];
-		z_end = lcd_3D_stat.lo_line_z[x];
+		z_start = edges.hi_line_z[x];
+		z_end = edges.lo_line_z[x];
 		
 		z_inc = z_end - z_start;
-		if((lcd_3D_stat.lo_fill[x] - lcd_3D_stat.hi_fill[x]) != 0) { z_inc /= float(lo_fill - hi_fill); }
+		if((edges.lo_fill[x] - edges.hi_fill[x]) != 0) { z_inc /= float(lo_fill - hi_fill); }
 
-		y_coord = lcd_3D_stat.hi_fill[x];
+		y_coord = edges.hi_fill[x];
 
 		//Handle coordinates that extend vertically
-		if(lcd_3D_stat.hi_overflow[x])
+		if(edges.hi_overflow[x])
 		{
-			z_start += (-lcd_3D_stat.hi_overflow[x] * z_inc);
+			z_start += (-edges.hi_overflow[x] * z_inc);
 		}
 
-		while(y_coord < lcd_3D_stat.lo_fill[x])
+		while((y_coord < edges.lo_fill[x]) && (y_coord < y_end))
 		{
-			vert_color = vert_colors[0];
+			vert_color = poly.vert_colors[0];
 
 			//Convert plot points to buffer index
 			buffer_index = (y_coord * 256) + x;
 
 			//Check Z buffer if drawing is applicable
-			if(z_start < gx_z_buffer[buffer_index])
+			if((y_coord >= y_start) && (z_start < z_buffer[buffer_index]))
 			{
 				//Do alpha-blending if necessary
-				if(use_alpha) { vert_color = alpha_blend_pixel(vert_color, gx_screen_buffer[buffer_id][buffer_index], lcd_3D_stat.poly_alpha); }
+				if(use_alpha) { vert_color = alpha_blend_pixel(vert_color, frame_buffer[buffer_index], poly.poly_alpha); }
 
-				gx_screen_buffer[buffer_id][buffer_index] = vert_color;
-				gx_render_buffer[buffer_id][buffer_index] = 1;
+				frame_buffer[buffer_index] = vert_color;
+				render_buffer[buffer_index] = 1;
 
 				//Update Z-buffer if necessary
-				if(lcd_3D_stat.poly_new_depth) { gx_z_buffer[buffer_index] = z_start; }
+				if(poly.poly_new_depth) { z_buffer[buffer_index] = z_start; }
 			}
 
 			y_coord++;
@@ -461,35 +502,35 @@ void NTR_LCD::fill_poly_solid()
 }
 
 /****** NDS 3D Software Renderer - Fills a given poly with interpolated colors from its vertices ******/
-void NTR_LCD::fill_poly_interpolated()
+void NTR_LCD::fill_poly_interpolated(const gx_poly_entry& poly, const gx_poly_edges& edges, u8 buffer_id, u8 y_start, u8 y_end)
 {
 	u8 y_coord = 0;
-	u8 buffer_id = (lcd_3D_stat.buffer_id + 1) & 0x1;
 	u32 buffer_index = 0;
 	u32 color = 0;
 
-	bool use_alpha = (lcd_3D_stat.poly_alpha <= 30) ? true : false;
+	bool use_alpha = (poly.poly_alpha <= 30) ? true : false;
 
-	bool use_edge = lcd_3D_stat.edge_marking;
-	u32 edge_color = lcd_3D_stat.edge_color[lcd_3D_stat.poly_id >> 3];
+	std::vector<u32>& frame_buffer = gx_screen_buffer[buffer_id];
+	std::vector<u8>& render_buffer = gx_render_buffer[buffer_id];
+	std::vector<float>& z_buffer = gx_z_buffer[buffer_id];
 
-	for(u32 x = lcd_3D_stat.poly_min_x; x <= lcd_3D_stat.poly_max_x; x++)
+	for(u32 x = poly.min_x; x <= poly.max_x; x++)
 	{
 		float z_start = 0.0;
 		float z_end = 0.0;
 		float z_inc = 0.0;
 
-		s16 hi_fill = lcd_3D_stat.hi_overflow[x] ? (lcd_3D_stat.hi_overflow[x]) : lcd_3D_stat.hi_fill[x];
-		s16 lo_fill = lcd_3D_stat.lo_overflow[x] ? (lcd_3D_stat.lo_overflow[x]) : lcd_3D_stat.lo_fill[x];
+		s16 hi_fill = edges.hi_overflow[x] ? (edges.hi_overflow[x]) : edges.hi_fill[x];
+		s16 lo_fill = edges.lo_overflow[x] ? (edges.lo_overflow[x]) : edges.lo_fill[x];
 
-		u32 c1 = lcd_3D_stat.hi_color[x];
-		u32 c2 = lcd_3D_stat.lo_color[x];
+		u32 c1 = edges.hi_color[x];
+		u32 c2 = edges.lo_color[x];
 		float c_inc = 0;
 		float c_ratio = 0;
 
 		//Calculate Z start and end fill coordinates
-		z_start = lcd_3D_stat.hi_line_z[x];
-		z_end = lcd_3D_stat.lo_line_z[x];
+		z_start = edges.hi_line_z[x];
+		z_end = edges.lo_line_z[x];
 		
 		z_inc = z_end - z_start;
 
@@ -499,33 +540,33 @@ void NTR_LCD::fill_poly_interpolated()
 			c_inc = 1.0 / (lo_fill - hi_fill);
 		}
 
-		y_coord = lcd_3D_stat.hi_fill[x];
+		y_coord = edges.hi_fill[x];
 
 		//Handle coordinates that extend vertically
-		if(lcd_3D_stat.hi_overflow[x])
+		if(edges.hi_overflow[x])
 		{
-			z_start += (-lcd_3D_stat.hi_overflow[x] * z_inc);
-			c_ratio += (-lcd_3D_stat.hi_overflow[x] * c_inc);
+			z_start += (-edges.hi_overflow[x] * z_inc);
+			c_ratio += (-edges.hi_overflow[x] * c_inc);
 		}
 
-		while(y_coord < lcd_3D_stat.lo_fill[x])
+		while((y_coord < edges.lo_fill[x]) && (y_coord < y_end))
 		{
 			//Convert plot points to buffer index
 			buffer_index = (y_coord * 256) + x;
 
 			//Check Z buffer if drawing is applicable
-			if(z_start < gx_z_buffer[buffer_index])
+			if((y_coord >= y_start) && (z_start < z_buffer[buffer_index]))
 			{
 				color = interpolate_rgb(c1, c2, c_ratio);
 
 				//Do alpha-blending if necessary
-				if(use_alpha) { color = alpha_blend_pixel(color, gx_screen_buffer[buffer_id][buffer_index], lcd_3D_stat.poly_alpha); }
+				if(use_alpha) { color = alpha_blend_pixel(color, frame_buffer[buffer_index], poly.poly_alpha); }
 
-				gx_screen_buffer[buffer_id][buffer_index] = color;
-				gx_render_buffer[buffer_id][buffer_index] = 1;
+				frame_buffer[buffer_index] = color;
+				render_buffer[buffer_index] = 1;
 
 				//Update Z-buffer if necessary
-				if(lcd_3D_stat.poly_new_depth) { gx_z_buffer[buffer_index] = z_start; }
+				if(poly.poly_new_depth) { z_buffer[buffer_index] = z_start; }
 			}
 
 			y_coord++;
@@ -536,59 +577,46 @@ void NTR_LCD::fill_poly_interpolated()
 }
 
 /****** NDS 3D Software Renderer - Fills a given poly with color from a texture ******/
-void NTR_LCD::fill_poly_textured()
+void NTR_LCD::fill_poly_textured(const gx_poly_entry& poly, const gx_poly_edges& edges, u8 buffer_id, u8 y_start, u8 y_end)
 {
 	u8 y_coord = 0;
-	u8 buffer_id = (lcd_3D_stat.buffer_id + 1) & 0x1;
 	u32 buffer_index = 0;
 	u32 texel_index = 0;
 	u32 texel = 0;
 
-	u8 slot = (lcd_3D_stat.tex_offset >> 17);
-
-	bool use_alpha = (lcd_3D_stat.poly_alpha <= 30) ? true : false;
+	bool use_alpha = (poly.poly_alpha <= 30) ? true : false;
 	bool use_new_z = false;
 	bool texel_depth_test;
 
-	if((use_alpha && lcd_3D_stat.poly_new_depth) || (!use_alpha)) { use_new_z = true; }
-	bool skip_tex_blending = ((lcd_3D_stat.poly_mode == 0) && (!use_alpha) && (lcd_3D_stat.vertex_color == 0xFFFCFCFC));
+	if((use_alpha && poly.poly_new_depth) || (!use_alpha)) { use_new_z = true; }
+	bool skip_tex_blending = ((poly.poly_mode == 0) && (!use_alpha) && (poly.vertex_color == 0xFFFCFCFC));
 
-	bool use_edge = lcd_3D_stat.edge_marking;
-	u32 edge_color = lcd_3D_stat.edge_color[lcd_3D_stat.poly_id >> 3];
+	std::vector<u32>& frame_buffer = gx_screen_buffer[buffer_id];
+	std::vector<u8>& render_buffer = gx_render_buffer[buffer_id];
+	std::vector<float>& z_buffer = gx_z_buffer[buffer_id];
 
-	//Calculate VRAM address of texture
-	u32 tex_addr = (mem->vram_tex_slot[slot] + (lcd_3D_stat.tex_offset & 0x1FFFF));
-
-	//Generate pixel data from VRAM
-	switch(lcd_3D_stat.tex_format)
-	{
-		case 0x1: gen_tex_1(tex_addr); break;
-		case 0x2: gen_tex_2(tex_addr); break;
-		case 0x3: gen_tex_3(tex_addr); break;
-		case 0x4: gen_tex_4(tex_addr); break;
-		case 0x5: gen_tex_5(tex_addr); break;
-		case 0x6: gen_tex_6(tex_addr); break;
-		case 0x7: gen_tex_7(tex_addr); break;
-	}
+	//Pixel data was decoded from VRAM when the polygon was submitted
+	if(!poly.texels) { return; }
+	const std::vector<u32>& tex_data = *poly.texels;
 
-	u32 tex_size = lcd_3D_stat.tex_data.size();
-	u32 tw = lcd_3D_stat.tex_src_width;
-	u32 th = lcd_3D_stat.tex_src_height;
+	u32 tex_size = tex_data.size();
+	u32 tw = poly.tex_width;
+	u32 th = poly.tex_height;
 
-	for(u32 x = lcd_3D_stat.poly_min_x; x <= lcd_3D_stat.poly_max_x; x++)
+	for(u32 x = poly.min_x; x <= poly.max_x; x++)
 	{
 		float z_start = 0.0;
 		float z_end = 0.0;
 		float z_inc = 0.0;
 
-		s16 hi_fill = lcd_3D_stat.hi_overflow[x] ? lcd_3D_stat.hi_overflow[x] : lcd_3D_stat.hi_fill[x];
-		s16 lo_fill = lcd_3D_stat.lo_overflow[x] ? lcd_3D_stat.lo_overflow[x] : lcd_3D_stat.lo_fill[x];
+		s16 hi_fill = edges.hi_overflow[x] ? edges.hi_overflow[x] : edges.hi_fill[x];
+		s16 lo_fill = edges.lo_overflow[x] ? edges.lo_overflow[x] : edges.lo_fill[x];
 
-		float tx1 = lcd_3D_stat.hi_tx[x];
-		float tx2 = lcd_3D_stat.lo_tx[x];
+		float tx1 = edges.hi_tx[x];
+		float tx2 = edges.lo_tx[x];
 
-		float ty1 = lcd_3D_stat.hi_ty[x];
-		float ty2 = lcd_3D_stat.lo_ty[x];
+		float ty1 = edges.hi_ty[x];
+		float ty2 = edges.lo_ty[x];
 
 		float tx_inc = tx2 - tx1;
 		float ty_inc = ty2 - ty1;
@@ -597,8 +625,8 @@ void NTR_LCD::fill_poly_textured()
 		float real_ty = 0.0;
 
 		//Calculate Z start and end fill coordinates
-		z_start = lcd_3D_stat.hi_line_z[x];
-		z_end = lcd_3D_stat.lo_line_z[x];
+		z_start = edges.hi_line_z[x];
+		z_end = edges.lo_line_z[x];
 		
 		z_inc = z_end - z_start;
 
@@ -609,28 +637,39 @@ void NTR_LCD::fill_poly_textured()
 			ty_inc /= float(lo_fill - hi_fill);
 		}
 
-		y_coord = lcd_3D_stat.hi_fill[x];
+		y_coord = edges.hi_fill[x];
 
 		//Handle coordinates that extend vertically
-		if(lcd_3D_stat.hi_overflow[x])
+		if(edges.hi_overflow[x])
 		{
-			z_start += (-lcd_3D_stat.hi_overflow[x] * z_inc);
-			tx1 += (-lcd_3D_stat.hi_overflow[x] * tx_inc);
-			ty1 += (-lcd_3D_stat.hi_overflow[x] * ty_inc);
+			z_start += (-edges.hi_overflow[x] * z_inc);
+			tx1 += (-edges.hi_overflow[x] * tx_inc);
+			ty1 += (-edges.hi_overflow[x] * ty_inc);
 		}
 
-		while(y_coord < lcd_3D_stat.lo_fill[x])
+		while((y_coord < edges.lo_fill[x]) && (y_coord < y_end))
 		{
+			//Scanlines outside of this band only advance the interpolation
+			if(y_coord < y_start)
+			{
+				y_coord++;
+				z_start += z_inc;
+
+				tx1 += tx_inc;
+				ty1 += ty_inc;
+				continue;
+			}
+
 			real_tx = tx1;
 			real_ty = ty1;
 
 			//Wrap horizontally, if necessary
-			if(lcd_3D_stat.repeat_tex_x)
+			if(poly.repeat_tex_x)
 			{
 				u8 x_flip = u32(std::abs(tx1 / tw)) & 0x1;
 
 				//No flipping horizontally
-				if(!lcd_3D_stat.flip_tex_x || !x_flip)
+				if(!poly.flip_tex_x || !x_flip)
 				{
 					if(tx1 < 0) { real_tx = (tx1 + (tw * (std::abs(s32(tx1 / tw)) + 1))); }
 					else if(tx1 >= tw) { real_tx = (tx1 - (tw * (s32(tx1 / tw)))); }
@@ -645,12 +684,12 @@ void NTR_LCD::fill_poly_textured()
 			}
 
 			//Wrap vertically, if necessary
-			if(lcd_3D_stat.repeat_tex_y)
+			if(poly.repeat_tex_y)
 			{
 				u8 y_flip = u32(std::abs(ty1 / th)) & 0x1;
 
 				//No flipping vertically
-				if(!lcd_3D_stat.flip_tex_y || !y_flip)
+				if(!poly.flip_tex_y || !y_flip)
 				{
 					if(ty1 < 0) { real_ty = (ty1 + (th * (std::abs(s32(ty1 / th)) + 1))); }
 					else if(ty1 >= th) { real_ty = (ty1 - (th * s32(ty1 / th))); }
@@ -671,31 +710,31 @@ void NTR_LCD::fill_poly_textured()
 			texel_index = u32(u32(real_ty) * tw) + u32(real_tx);
 
 			//Calculate depth test
-			texel_depth_test = (lcd_3D_stat.poly_depth_test) ? (z_start <= gx_z_buffer[buffer_index]) : (z_start < gx_z_buffer[buffer_index]);
+			texel_depth_test = (poly.poly_depth_test) ? (z_start <= z_buffer[buffer_index]) : (z_start < z_buffer[buffer_index]);
 
 			//Check Z buffer if drawing is applicable
 			//Make sure texel exists as well
 			if((texel_depth_test) && (texel_index < tex_size) && (texel_index >= 0))
 			{
-				texel = lcd_3D_stat.tex_data[texel_index];
+				texel = tex_data[texel_index];
 
 				//Draw texel if not transparent
 				if(texel & 0xFF000000)
 				{
 					//Apply texture blending if necessary
-					if(!skip_tex_blending) { texel = blend_texel(texel); }
+					if(!skip_tex_blending) { texel = blend_texel(texel, poly); }
 
 					//Alpha-blend if necessary
 					if(((texel >> 24) != 0xFF) || (use_alpha))
 					{
-						texel = alpha_blend_texel(texel, gx_screen_buffer[buffer_id][buffer_index]);
+						texel = alpha_blend_texel(texel, frame_buffer[buffer_index], poly.poly_alpha);
 					}
 
-					gx_screen_buffer[buffer_id][buffer_index] = texel;
-					gx_render_buffer[buffer_id][buffer_index] = 1;
+					frame_buffer[buffer_index] = texel;
+					render_buffer[buffer_index] = 1;
 
 					//Update Z-buffer if necessary
-					if(use_new_z) { gx_z_buffer[buffer_index] = z_start; }
+					if(use_new_z) { z_buffer[buffer_index] = z_start; }
 				}
 			}
 
@@ -2018,12 +2057,9 @@ u32 NTR_LCD::alpha_blend_pixel(u32 color_1, u32 color_2, u8 poly_alpha)
 }
 
 /****** Alpha blends given texel with 3D framebuffer ******/
-u32 NTR_LCD::alpha_blend_texel(u32 color_1, u32 color_2)
+u32 NTR_LCD::alpha_blend_texel(u32 color_1, u32 color_2, u8 poly_alpha)
 {
-	u8 poly_alpha = 0;
-
 	if((color_1 >> 24) != 0xFF) { poly_alpha = (color_1 >> 24); }
-	else { poly_alpha = lcd_3D_stat.poly_alpha; }
 
 	if(poly_alpha == 0) { return color_2; }
 
@@ -2046,7 +2082,7 @@ u32 NTR_LCD::alpha_blend_texel(u32 color_1, u32 color_2)
 }
 
 /****** Blends texel via modulation, decal mode, toon shading, or highlight shading ******/
-u32 NTR_LCD::blend_texel(u32 color_1)
+u32 NTR_LCD::blend_texel(u32 color_1, const gx_poly_entry& poly)
 {
 	u16 poly_r = (color_1 >> 18) & 0x3F;
 	u16 poly_g = (color_1 >> 10) & 0x3F;
@@ -2054,7 +2090,7 @@ u32 NTR_LCD::blend_texel(u32 color_1)
 	u16 poly_a = 0;
 
 	if((color_1 >> 24) != 0xFF) { poly_a = (color_1 >> 24); }
-	else { poly_a = lcd_3D_stat.poly_alpha; }
+	else { poly_a = poly.poly_alpha; }
 
 	poly_a = (poly_a == 31) ? 63 : (poly_a << 1);
 
@@ -2071,14 +2107,14 @@ u32 NTR_LCD::blend_texel(u32 color_1)
 
 	u32 final_color = color_1;
 
-	switch(lcd_3D_stat.poly_mode & 0x3)
+	switch(poly.poly_mode & 0x3)
 	{
 		//Modulation
 		case 0:
-			blend_r = (lcd_3D_stat.vertex_color >> 18) & 0x3F;
-			blend_g = (lcd_3D_stat.vertex_color >> 10) & 0x3F;
-			blend_b = (lcd_3D_stat.vertex_color >> 2) & 0x3F;
-			blend_a = (lcd_3D_stat.poly_alpha == 31) ? 63 : (lcd_3D_stat.poly_alpha << 1);
+			blend_r = (poly.vertex_color >> 18) & 0x3F;
+			blend_g = (poly.vertex_color >> 10) & 0x3F;
+			blend_b = (poly.vertex_color >> 2) & 0x3F;
+			blend_a = (poly.poly_alpha == 31) ? 63 : (poly.poly_alpha << 1);
 
 			frame_r = modulation_lut[(poly_r << 6) | blend_r];
 			frame_g = modulation_lut[(poly_g << 6) | blend_g];
@@ -2100,10 +2136,10 @@ u32 NTR_LCD::blend_texel(u32 color_1)
 
 		//Decal Mode
 		case 1:
-			blend_r = (lcd_3D_stat.vertex_color >> 18) & 0x3F;
-			blend_g = (lcd_3D_stat.vertex_color >> 10) & 0x3F;
-			blend_b = (lcd_3D_stat.vertex_color >> 2) & 0x3F;
-			blend_a = lcd_3D_stat.poly_alpha;
+			blend_r = (poly.vertex_color >> 18) & 0x3F;
+			blend_g = (poly.vertex_color >> 10) & 0x3F;
+			blend_b = (poly.vertex_color >> 2) & 0x3F;
+			blend_a = poly.poly_alpha;
 
 			if(poly_a == 0)
 			{
@@ -2138,6 +2174,166 @@ u32 NTR_LCD::blend_texel(u32 color_1)
 	return final_color;
 }
 
+/****** Returns decoded pixel data for the current texture, using cached data when VRAM is unchanged ******/
+std::shared_ptr< const std::vector<u32> > NTR_LCD::get_tex(u32 address)
+{
+	u32 tex_size = (lcd_3D_stat.tex_src_width * lcd_3D_stat.tex_src_height);
+	u32 tex_length = 0;
+	u32 pal_addr = 0;
+	u32 pal_length = 0;
+	u32 slot_addr = 0;
+	u32 slot_length = 0;
+
+	//Determine the VRAM ranges this texture reads from
+	switch(lcd_3D_stat.tex_format)
+	{
+		case 0x1:
+			tex_length = tex_size;
+			pal_addr = lcd_3D_stat.pal_bank_addr + (lcd_3D_stat.pal_base * 0x10);
+			pal_length = 64;
+			break;
+
+		case 0x2:
+			tex_length = tex_size >> 2;
+			pal_addr = lcd_3D_stat.pal_bank_addr + (lcd_3D_stat.pal_base * 0x8);
+			pal_length = 8;
+			break;
+
+		case 0x3:
+			tex_length = tex_size >> 1;
+			pal_addr = lcd_3D_stat.pal_bank_addr + (lcd_3D_stat.pal_base * 0x10);
+			pal_length = 32;
+			break;
+
+		case 0x4:
+			tex_length = tex_size;
+			pal_addr = lcd_3D_stat.pal_bank_addr + (lcd_3D_stat.pal_base * 0x10);
+			pal_length = 512;
+			break;
+
+		//Compressed textures can pull palette data from anywhere in the palette bank
+		case 0x5:
+			tex_length = tex_size >> 2;
+			pal_addr = lcd_3D_stat.pal_bank_addr;
+			pal_length = 0x14000;
+			slot_addr = mem->vram_tex_slot[1] + ((lcd_3D_stat.tex_offset & 0x1FFFF) >> 1);
+			if(lcd_3D_stat.tex_offset >> 17) { slot_addr += 0x10000; }
+			slot_length = tex_size >> 3;
+			break;
+
+		case 0x6:
+			tex_length = tex_size;
+			pal_addr = lcd_3D_stat.pal_bank_addr + (lcd_3D_stat.pal_base * 0x10);
+			pal_length = 16;
+			break;
+
+		case 0x7:
+			tex_length = tex_size << 1;
+			break;
+
+		default:
+			return std::make_shared< std::vector<u32> >();
+	}
+
+	//Only data that lives in texture VRAM can be tracked, decode anything else every time
+	bool can_cache = ((address >= 0x6800000) && (address < 0x68A4000));
+	if(pal_length && ((pal_addr < 0x6800000) || (pal_addr >= 0x68A4000))) { can_cache = false; }
+	if(slot_length && ((slot_addr < 0x6800000) || (slot_addr >= 0x68A4000))) { can_cache = false; }
+
+	u32 stamp = 0;
+	u32 entry_id = tex_cache.size();
+
+	if(can_cache)
+	{
+		stamp = mem->get_tex_vram_stamp(address, tex_length) + mem->get_tex_vram_stamp(pal_addr, pal_length) + mem->get_tex_vram_stamp(slot_addr, slot_length);
+		tex_cache_clock++;
+
+		for(u32 x = 0; x < tex_cache.size(); x++)
+		{
+			tex_cache_entry& entry = tex_cache[x];
+
+			if((entry.tex_addr == address) && (entry.pal_addr == pal_addr) && (entry.slot_addr == slot_addr)
+			&& (entry.width == lcd_3D_stat.tex_src_width) && (entry.height == lcd_3D_stat.tex_src_height)
+			&& (entry.format == lcd_3D_stat.tex_format) && (entry.color_zero == lcd_3D_stat.tex_color_zero))
+			{
+				entry.last_use = tex_cache_clock;
+
+				//Cache hit
+				if(entry.stamp == stamp) { return entry.texels; }
+
+				//Stale entry, decode again below and reuse this slot
+				entry_id = x;
+				break;
+			}
+		}
+	}
+
+	//Generate pixel data from VRAM
+	switch(lcd_3D_stat.tex_format)
+	{
+		case 0x1: gen_tex_1(address); break;
+		case 0x2: gen_tex_2(address); break;
+		case 0x3: gen_tex_3(address); break;
+		case 0x4: gen_tex_4(address); break;
+		case 0x5: gen_tex_5(address); break;
+		case 0x6: gen_tex_6(address); break;
+		case 0x7: gen_tex_7(address); break;
+	}
+
+	//Pixel data is handed off as a new buffer, older buffers stay valid for polygons still waiting to be drawn
+	std::shared_ptr< std::vector<u32> > texels = std::make_shared< std::vector<u32> >();
+	texels->swap(lcd_3D_stat.tex_data);
+
+	if(!can_cache || (texels->size() > NTR_TEX_CACHE_TEXELS)) { return texels; }
+
+	//Make room for a new entry by evicting the least recently used textures
+	if(entry_id == tex_cache.size())
+	{
+		while(!tex_cache.empty() && ((tex_cache.size() >= NTR_TEX_CACHE_ENTRIES) || ((tex_cache_texels + texels->size()) > NTR_TEX_CACHE_TEXELS)))
+		{
+			u32 oldest = 0;
+
+			for(u32 x = 1; x < tex_cache.size(); x++)
+			{
+				if(tex_cache[x].last_use < tex_cache[oldest].last_use) { oldest = x; }
+			}
+
+			tex_cache_texels -= tex_cache[oldest].texels->size();
+			std::swap(tex_cache[oldest], tex_cache.back());
+			tex_cache.pop_back();
+		}
+
+		tex_cache.push_back(tex_cache_entry());
+		entry_id = tex_cache.size() - 1;
+
+		tex_cache_entry& entry = tex_cache[entry_id];
+		entry.tex_addr = address;
+		entry.pal_addr = pal_addr;
+		entry.slot_addr = slot_addr;
+		entry.width = lcd_3D_stat.tex_src_width;
+		entry.height = lcd_3D_stat.tex_src_height;
+		entry.format = lcd_3D_stat.tex_format;
+		entry.color_zero = lcd_3D_stat.tex_color_zero;
+		entry.last_use = tex_cache_clock;
+	}
+
+	//Move decoded pixel data into the cache
+	tex_cache_entry& entry = tex_cache[entry_id];
+	if(entry.texels) { tex_cache_texels -= entry.texels->size(); }
+	entry.texels = texels;
+	tex_cache_texels += texels->size();
+	entry.stamp = stamp;
+
+	return texels;
+}
+
+/****** Empties the decoded texture cache ******/
+void NTR_LCD::clear_tex_cache()
+{
+	tex_cache.clear();
+	tex_cache_texels = 0;
+}
+
 /****** Generates pixel data fram VRAM for A315 textures ******/
 void NTR_LCD::gen_tex_1(u32 address)
 {
@@ -10,6 +10,7 @@
 // Responsible for blitting pixel data and limiting frame rate
 
 #include <cmath>
+#include <thread>
 
 #include "lcd.h"
 #include "common/util.h"
@@ -18,12 +19,24 @@
 NTR_LCD::NTR_LCD()
 {
 	window = NULL;
+
+	engine_b_thread = NULL;
+	engine_b_lock = NULL;
+	engine_b_wake = NULL;
+	engine_b_busy = false;
+	engine_b_sleeping = false;
+	engine_b_quit = false;
+
 	reset();
 }
 
 /****** LCD Destructor ******/
 NTR_LCD::~NTR_LCD()
 {
+	gx_workers.stop();
+	stop_engine_b_thread();
+	filter.stop();
+
 	screen_buffer.clear();
 
 	scanline_buffer_a.clear();
@@ -42,8 +55,15 @@ void NTR_LCD::reset()
 {
 	final_screen = NULL;
 	original_screen = NULL;
+	filtered_screen = NULL;
 	mem = NULL;
 
+	//Restarted by init() if still enabled
+	filter.stop();
+
+	//Finish any in-progress 3D rendering before buffers are touched
+	wait_geometry();
+
 	if((window != NULL) && (config::sdl_render)) { SDL_DestroyWindow(window); }
 	window = NULL;
 
@@ -94,13 +114,17 @@ void NTR_LCD::reset()
 	gx_render_buffer.resize(2);
 	gx_render_buffer[0].resize(0xC000, 0);
 	gx_render_buffer[1].resize(0xC000, 0);
-	gx_z_buffer.resize(0xC000, 4096);
+	gx_z_buffer.resize(2);
+	gx_z_buffer[0].resize(0xC000, 4096);
+	gx_z_buffer[1].resize(0xC000, 4096);
 
-	line_buffer.resize(8);
-	for(u32 x = 0; x < 8; x++) { line_buffer[x].resize(0x100); }
+	line_buffer_a.resize(8);
+	line_buffer_b.resize(8);
+	for(u32 x = 0; x < 8; x++) { line_buffer_a[x].resize(0x100); line_buffer_b[x].resize(0x100); }
 
-	obj_line_buffer.resize(8);
-	for(u32 x = 0; x < 8; x++) { obj_line_buffer[x].resize(0x100); }
+	obj_line_buffer_a.resize(8);
+	obj_line_buffer_b.resize(8);
+	for(u32 x = 0; x < 8; x++) { obj_line_buffer_a[x].resize(0x100); obj_line_buffer_b[x].resize(0x100); }
 
 	full_scanline_render_a = false;
 	full_scanline_render_b = false;
@@ -349,9 +373,6 @@ void NTR_LCD::reset()
 	lcd_3D_stat.last_y = 0;
 	lcd_3D_stat.last_z = 0;
 
-	lcd_3D_stat.poly_min_x = 0;
-	lcd_3D_stat.poly_max_x = 0;
-
 	lcd_3D_stat.edge_marking = false;
 	lcd_3D_stat.z_buffering = true;
 
@@ -373,11 +394,29 @@ void NTR_LCD::reset()
 		lcd_3D_stat.tex_coord_y[x] = 0.0;
 	}
 
-	//Polygon fill coordinates
-	for(int x = 0; x < 256; x++) { lcd_3D_stat.hi_fill[x] = lcd_3D_stat.lo_fill[x] = 0xFF; }
+	//Deferred polygon rasterization - Leave one core for the emulated CPUs
+	if(!gx_workers.get_count())
+	{
+		s32 thread_count = SDL_GetCPUCount() - 1;
+		if(thread_count > NTR_GX_MAX_THREADS) { thread_count = NTR_GX_MAX_THREADS; }
+		if(thread_count > 0) { gx_workers.start(thread_count, "NTR_GX"); }
+	}
+
+	gx_band_count = gx_workers.get_count() ? gx_workers.get_count() : 1;
+	gx_band_edges.resize(gx_band_count);
 
-	//Polygon fill Z coordinates
-	for(int x = 0; x < 256; x++) { lcd_3D_stat.hi_line_z[x] = lcd_3D_stat.lo_line_z[x] = 0.0; }
+	//Threaded 2D rendering needs a core beyond the one running the emulated CPUs
+	if((config::nds_threaded_2d) && (engine_b_thread == NULL) && (SDL_GetCPUCount() > 1)) { start_engine_b_thread(); }
+
+	gx_poly_list[0].clear();
+	gx_poly_list[1].clear();
+	gx_poly_list_id = 0;
+	gx_raster_list_id = 0;
+	gx_raster_buffer_id = 1;
+
+	//Texture cache
+	tex_cache_clock = 0;
+	clear_tex_cache();
 
 	//Polygon vertices
 	current_poly.make_identity(4);
@@ -435,11 +474,24 @@ bool NTR_LCD::init()
 		//Set up software rendering
 		else
 		{
-			window = SDL_CreateWindow("GBE+", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, config::sys_width, config::sys_height, config::flags);
+			u8 filter_type = (config::use_sw_filters) ? sw_filter::get_type(config::fragment_shader) : SW_FILTER_NONE;
+			u32 window_scale = 1;
+
+			if(filtered_screen != NULL) { SDL_FreeSurface(filtered_screen); }
+			filtered_screen = NULL;
+
+			//Filter the screen on the CPU - The window grows to the filter's output, touch input is scaled back down
+			if((filter_type != SW_FILTER_NONE) && (filter.start(filter_type, config::sys_width, config::sys_height)))
+			{
+				filtered_screen = SDL_CreateRGBSurface(SDL_SWSURFACE, filter.get_width(), filter.get_height(), 32, 0, 0, 0, 0);
+				window_scale = filter.get_width() / config::sys_width;
+			}
+
+			window = SDL_CreateWindow("GBE+", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, (config::sys_width * window_scale), (config::sys_height * window_scale), config::flags);
 			SDL_GetWindowSize(window, &config::win_width, &config::win_height);
 			final_screen = SDL_GetWindowSurface(window);
 			original_screen = SDL_CreateRGBSurface(SDL_SWSURFACE, config::sys_width, config::sys_height, 32, 0, 0, 0, 0);
-			config::scaling_factor = 1;
+			config::scaling_factor = window_scale;
 		}
 
 		if(final_screen == NULL) { return false; }
@@ -959,12 +1011,16 @@ void NTR_LCD::update_palettes()
 /****** Render the line for a BG ******/
 void NTR_LCD::render_bg_scanline(u32 bg_control)
 {
+	//Use line buffers for the engine being rendered
+	std::vector< std::vector<u32> >& line_buffer = (bg_control & 0x1000) ? line_buffer_b : line_buffer_a;
+	std::vector< std::vector<u32> >& obj_line_buffer = (bg_control & 0x1000) ? obj_line_buffer_b : obj_line_buffer_a;
+
 	u8 bg_mode = (bg_control & 0x1000) ? lcd_stat.bg_mode_b : lcd_stat.bg_mode_a;
 	u8 bg_render_list[4];
 	u8 bg_id = 0;
 
-	//Calculate window status for Engine A and Engine B for current scanline
-	calculate_window_on_scanline();
+	//Calculate window status for this engine on the current scanline
+	calculate_window_on_scanline(bg_control);
 
 	//Render Engine A
 	if((bg_control & 0x1000) == 0)
@@ -1323,6 +1379,9 @@ void NTR_LCD::render_bg_scanline(u32 bg_control)
 /****** Renders a scanline for OBJs ******/
 void NTR_LCD::render_obj_scanline(u32 bg_control)
 {
+	//Use line buffers for the engine being rendered
+	std::vector< std::vector<u32> >& obj_line_buffer = (bg_control & 0x1000) ? obj_line_buffer_b : obj_line_buffer_a;
+
 	//Detemine if Engine A or B
 	u8 engine_id = (bg_control & 0x1000) ? 1 : 0;
 
@@ -1586,6 +1645,9 @@ void NTR_LCD::render_obj_scanline(u32 bg_control)
 /****** Render BG Mode Text scanline ******/
 void NTR_LCD::render_bg_mode_text(u32 bg_control)
 {
+	//Use line buffers for the engine being rendered
+	std::vector< std::vector<u32> >& line_buffer = (bg_control & 0x1000) ? line_buffer_b : line_buffer_a;
+
 	//Render Engine A
 	if((bg_control & 0x1000) == 0)
 	{
@@ -1702,8 +1764,19 @@ void NTR_LCD::render_bg_mode_text(u32 bg_control)
 
 			//Calculate VRAM address to start pulling up tile data
 			line_offset = (flip & 0x2) ? ((bit_depth >> 3) * inv_lut[current_tile_line]) : ((bit_depth >> 3) * current_tile_line);
-			u32 tile_data_addr = tile_addr + (tile_id * bit_depth) + line_offset;
-			if(flip & 0x1) { tile_data_addr += ((bit_depth >> 3) - 1); }
+			u32 tile_row_addr = tile_addr + (tile_id * bit_depth) + line_offset;
+			u8* tile_row = mem->memory_map.get_region_ptr(tile_row_addr, (bit_depth >> 3));
+
+			//Rows that straddle unrelated pages are gathered byte by byte
+			u8 tile_row_bytes[8];
+
+			if(tile_row == NULL)
+			{
+				for(u32 z = 0; z < (bit_depth >> 3); z++) { tile_row_bytes[z] = mem->memory_map[tile_row_addr + z]; }
+				tile_row = tile_row_bytes;
+			}
+
+			u32 tile_data_index = (flip & 0x1) ? ((bit_depth >> 3) - 1) : 0;
 
 			//Read 8 pixels from VRAM and put them in the scanline buffer
 			for(u32 y = tile_offset_x; y < 8; y++, x++)
@@ -1712,7 +1785,7 @@ void NTR_LCD::render_bg_mode_text(u32 bg_control)
 				if(bit_depth == 64)
 				{
 					//Grab dot-data, account for horizontal flipping 
-					u8 raw_color = (flip & 0x1) ? mem->memory_map[tile_data_addr--] : mem->memory_map[tile_data_addr++];
+					u8 raw_color = (flip & 0x1) ? tile_row[tile_data_index--] : tile_row[tile_data_index++];
 
 					//Only draw if no previous pixel was rendered
 					if(!render_buffer_a[scanline_pixel_counter] || (bg_priority < render_buffer_a[scanline_pixel_counter]))
@@ -1741,7 +1814,7 @@ void NTR_LCD::render_bg_mode_text(u32 bg_control)
 				else
 				{
 					//Grab dot-data, account for horizontal flipping 
-					u8 raw_color = (flip & 0x1) ? mem->memory_map[tile_data_addr--] : mem->memory_map[tile_data_addr++];
+					u8 raw_color = (flip & 0x1) ? tile_row[tile_data_index--] : tile_row[tile_data_index++];
 
 					u8 pal_1 = (flip & 0x1) ? (pal_id + (raw_color >> 4)) : (pal_id + (raw_color & 0xF));
 					u8 pal_2 = (flip & 0x1) ? (pal_id + (raw_color & 0xF)) : (pal_id + (raw_color >> 4));
@@ -1914,8 +1987,19 @@ void NTR_LCD::render_bg_mode_text(u32 bg_control)
 
 			//Calculate VRAM address to start pulling up tile data
 			line_offset = (flip & 0x2) ? ((bit_depth >> 3) * inv_lut[current_tile_line]) : ((bit_depth >> 3) * current_tile_line);
-			u32 tile_data_addr = tile_addr + (tile_id * bit_depth) + line_offset;
-			if(flip & 0x1) { tile_data_addr += ((bit_depth >> 3) - 1); }
+			u32 tile_row_addr = tile_addr + (tile_id * bit_depth) + line_offset;
+			u8* tile_row = mem->memory_map.get_region_ptr(tile_row_addr, (bit_depth >> 3));
+
+			//Rows that straddle unrelated pages are gathered byte by byte
+			u8 tile_row_bytes[8];
+
+			if(tile_row == NULL)
+			{
+				for(u32 z = 0; z < (bit_depth >> 3); z++) { tile_row_bytes[z] = mem->memory_map[tile_row_addr + z]; }
+				tile_row = tile_row_bytes;
+			}
+
+			u32 tile_data_index = (flip & 0x1) ? ((bit_depth >> 3) - 1) : 0;
 
 			//Read 8 pixels from VRAM and put them in the scanline buffer
 			for(u32 y = tile_offset_x; y < 8; y++, x++)
@@ -1924,7 +2008,7 @@ void NTR_LCD::render_bg_mode_text(u32 bg_control)
 				if(bit_depth == 64)
 				{
 					//Grab dot-data, account for horizontal flipping 
-					u8 raw_color = (flip & 0x1) ? mem->memory_map[tile_data_addr--] : mem->memory_map[tile_data_addr++];
+					u8 raw_color = (flip & 0x1) ? tile_row[tile_data_index--] : tile_row[tile_data_index++];
 
 					//Only draw if no previous pixel was rendered
 					if(!render_buffer_b[scanline_pixel_counter] || (bg_priority < render_buffer_b[scanline_pixel_counter]))
@@ -1953,7 +2037,7 @@ void NTR_LCD::render_bg_mode_text(u32 bg_control)
 				else
 				{
 					//Grab dot-data, account for horizontal flipping 
-					u8 raw_color = (flip & 0x1) ? mem->memory_map[tile_data_addr--] : mem->memory_map[tile_data_addr++];
+					u8 raw_color = (flip & 0x1) ? tile_row[tile_data_index--] : tile_row[tile_data_index++];
 
 					u8 pal_1 = (flip & 0x1) ? (pal_id + (raw_color >> 4)) : (pal_id + (raw_color & 0xF));
 					u8 pal_2 = (flip & 0x1) ? (pal_id + (raw_color & 0xF)) : (pal_id + (raw_color >> 4));
@@ -2013,6 +2097,9 @@ void NTR_LCD::render_bg_mode_text(u32 bg_control)
 /****** Render BG Mode Affine scanline ******/
 void NTR_LCD::render_bg_mode_affine(u32 bg_control)
 {
+	//Use line buffers for the engine being rendered
+	std::vector< std::vector<u32> >& line_buffer = (bg_control & 0x1000) ? line_buffer_b : line_buffer_a;
+
 	//Render Engine A
 	if((bg_control & 0x1000) == 0)
 	{
@@ -2277,6 +2364,9 @@ void NTR_LCD::render_bg_mode_affine(u32 bg_control)
 /****** Render BG Mode Affine-Extended scanline ******/
 void NTR_LCD::render_bg_mode_affine_ext(u32 bg_control)
 {
+	//Use line buffers for the engine being rendered
+	std::vector< std::vector<u32> >& line_buffer = (bg_control & 0x1000) ? line_buffer_b : line_buffer_a;
+
 	//Render Engine A
 	if((bg_control & 0x1000) == 0)
 	{
@@ -2575,6 +2665,9 @@ void NTR_LCD::render_bg_mode_affine_ext(u32 bg_control)
 /****** Render BG Mode 256-color scanline ******/
 void NTR_LCD::render_bg_mode_bitmap(u32 bg_control)
 {
+	//Use line buffers for the engine being rendered
+	std::vector< std::vector<u32> >& line_buffer = (bg_control & 0x1000) ? line_buffer_b : line_buffer_a;
+
 	//Render Engine A
 	if((bg_control & 0x1000) == 0)
 	{
@@ -2851,6 +2944,9 @@ void NTR_LCD::render_bg_mode_bitmap(u32 bg_control)
 /****** Render BG Mode direct color scanline ******/
 void NTR_LCD::render_bg_mode_direct(u32 bg_control)
 {
+	//Use line buffers for the engine being rendered
+	std::vector< std::vector<u32> >& line_buffer = (bg_control & 0x1000) ? line_buffer_b : line_buffer_a;
+
 	//Render Engine A
 	if((bg_control & 0x1000) == 0)
 	{
@@ -3142,6 +3238,35 @@ void NTR_LCD::render_bg_mode_direct(u32 bg_control)
 
 /****** Render pixels for a given scanline (per-pixel) ******/
 void NTR_LCD::render_scanline()
+{
+	//With threaded 2D rendering, Engine B draws this scanline on its own thread while Engine A draws here
+	//Both engines finish before anything else runs, so each sees registers and VRAM exactly as the CPUs left them for this line
+	if(engine_b_thread != NULL)
+	{
+		engine_b_busy = true;
+
+		if(engine_b_sleeping)
+		{
+			SDL_LockMutex(engine_b_lock);
+			SDL_CondSignal(engine_b_wake);
+			SDL_UnlockMutex(engine_b_lock);
+		}
+
+		render_scanline_a();
+
+		//Wait for Engine B to finish
+		while(engine_b_busy) { }
+	}
+
+	else
+	{
+		render_scanline_a();
+		render_scanline_b();
+	}
+}
+
+/****** Render pixels for a given scanline on Engine A ******/
+void NTR_LCD::render_scanline_a()
 {
 	//Engine A - Render based on display modes
 	switch(lcd_stat.display_mode_a)
@@ -3191,6 +3316,13 @@ void NTR_LCD::render_scanline()
 			break;
 	}
 
+	//Apply Master Brightness if necessary
+	if(lcd_stat.master_bright_a & 0xC000) { adjust_master_brightness(1); }
+}
+
+/****** Render pixels for a given scanline on Engine B ******/
+void NTR_LCD::render_scanline_b()
+{
 	//Engine B - Render based on display modes
 	switch(lcd_stat.display_mode_b)
 	{
@@ -3212,7 +3344,93 @@ void NTR_LCD::render_scanline()
 		default:
 			std::cout<<"LCD::Warning - Engine B - Unsupported Display Mode " << std::dec << (int)lcd_stat.display_mode_b << "\n";
 			break;
-	}		
+	}
+
+	//Apply Master Brightness if necessary
+	if(lcd_stat.master_bright_b & 0xC000) { adjust_master_brightness(0); }
+}
+
+/****** Starts the thread that renders Engine B ******/
+void NTR_LCD::start_engine_b_thread()
+{
+	engine_b_busy = false;
+	engine_b_sleeping = false;
+	engine_b_quit = false;
+
+	engine_b_lock = SDL_CreateMutex();
+	engine_b_wake = SDL_CreateCond();
+
+	if((engine_b_lock != NULL) && (engine_b_wake != NULL)) { engine_b_thread = SDL_CreateThread(engine_b_main, "NTR_2D", this); }
+
+	//Both engines are simply rendered on the emulation thread otherwise
+	if(engine_b_thread == NULL)
+	{
+		std::cout<<"LCD::Warning - Could not create 2D rendering thread : " << SDL_GetError() << "\n";
+		stop_engine_b_thread();
+	}
+}
+
+/****** Stops the thread that renders Engine B ******/
+void NTR_LCD::stop_engine_b_thread()
+{
+	if(engine_b_thread != NULL)
+	{
+		SDL_LockMutex(engine_b_lock);
+		engine_b_quit = true;
+		SDL_CondSignal(engine_b_wake);
+		SDL_UnlockMutex(engine_b_lock);
+
+		SDL_WaitThread(engine_b_thread, NULL);
+		engine_b_thread = NULL;
+	}
+
+	if(engine_b_wake != NULL) { SDL_DestroyCond(engine_b_wake); }
+	if(engine_b_lock != NULL) { SDL_DestroyMutex(engine_b_lock); }
+
+	engine_b_wake = NULL;
+	engine_b_lock = NULL;
+}
+
+/****** Engine B thread - Polls for scanlines while they keep coming, sleeps during VBlank or pauses ******/
+int NTR_LCD::engine_b_main(void* ptr)
+{
+	NTR_LCD* lcd = (NTR_LCD*)ptr;
+	u32 idle_start = SDL_GetTicks();
+	u32 poll_count = 0;
+
+	while(!lcd->engine_b_quit)
+	{
+		if(lcd->engine_b_busy)
+		{
+			lcd->render_scanline_b();
+			lcd->engine_b_busy = false;
+
+			idle_start = SDL_GetTicks();
+			poll_count = 0;
+			continue;
+		}
+
+		//Waking from a sleep takes far longer than a scanline, so only sleep after a while without work
+		if(((++poll_count & 0xFF) != 0) || ((SDL_GetTicks() - idle_start) < NTR_2D_SPIN_TIME))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		//The emulation thread checks engine_b_sleeping after setting engine_b_busy, so no scanline is missed here
+		SDL_LockMutex(lcd->engine_b_lock);
+		lcd->engine_b_sleeping = true;
+
+		while((!lcd->engine_b_busy) && (!lcd->engine_b_quit)) { SDL_CondWait(lcd->engine_b_wake, lcd->engine_b_lock); }
+
+		lcd->engine_b_sleeping = false;
+		SDL_UnlockMutex(lcd->engine_b_lock);
+
+		idle_start = SDL_GetTicks();
+		poll_count = 0;
+	}
+
+	return 0;
 }
 
 /****** Apply SFX to scanline pixels ******/
@@ -3242,6 +3460,10 @@ void NTR_LCD::apply_sfx(u32 bg_control)
 /****** SFX - Adjust scanline brightness up ******/
 void NTR_LCD::brightness_up(u32 bg_control)
 {
+	//Use line buffers for the engine being rendered
+	std::vector< std::vector<u32> >& line_buffer = (bg_control & 0x1000) ? line_buffer_b : line_buffer_a;
+	std::vector< std::vector<u32> >& obj_line_buffer = (bg_control & 0x1000) ? obj_line_buffer_b : obj_line_buffer_a;
+
 	u8 bg_render_list[4];
 	u8 bg_layer[4];
 
@@ -3365,6 +3587,10 @@ void NTR_LCD::brightness_up(u32 bg_control)
 /****** SFX - Adjust scanline brightness down ******/
 void NTR_LCD::brightness_down(u32 bg_control)
 {
+	//Use line buffers for the engine being rendered
+	std::vector< std::vector<u32> >& line_buffer = (bg_control & 0x1000) ? line_buffer_b : line_buffer_a;
+	std::vector< std::vector<u32> >& obj_line_buffer = (bg_control & 0x1000) ? obj_line_buffer_b : obj_line_buffer_a;
+
 	u8 bg_render_list[4];
 	u8 bg_layer[4];
 
@@ -3488,6 +3714,10 @@ void NTR_LCD::brightness_down(u32 bg_control)
 /****** SFX - Alpha blending *****/
 void NTR_LCD::alpha_blend(u32 bg_control)
 {
+	//Use line buffers for the engine being rendered
+	std::vector< std::vector<u32> >& line_buffer = (bg_control & 0x1000) ? line_buffer_b : line_buffer_a;
+	std::vector< std::vector<u32> >& obj_line_buffer = (bg_control & 0x1000) ? obj_line_buffer_b : obj_line_buffer_a;
+
 	u8 bg_render_list[4];
 	u8 bg_layer[4];
 
@@ -3816,151 +4046,154 @@ void NTR_LCD::adjust_master_brightness(u8 engine_id)
 }
 
 /****** Calculates what coordinates of a scanline are within a Window ******/
-void NTR_LCD::calculate_window_on_scanline()
+void NTR_LCD::calculate_window_on_scanline(u32 bg_control)
 {
-	//Clear previous calculations
-	for(u32 y = 0; y < 2; y++)
-	{
-		for(u32 x = 0; x < 256; x++)
-		{
-			lcd_stat.window_status_a[x][y] = false;
-			lcd_stat.window_status_b[x][y] = false;
-		}
-	}
-
 	u32 line = lcd_stat.current_scanline;
 
 	bool win_stat[2];
-	u16 temp_y_a[2][2];
-	u16 temp_y_b[2][2];
+	u16 temp_y[2][2];
 
-	//Store temporary Y values for windows
-	for(u32 y = 0; y < 2; y++)
+	//Calculate Engine A
+	if((bg_control & 0x1000) == 0)
 	{
-		for(u32 x = 0; x < 2; x++)
+		//Clear previous calculations and store temporary Y values for windows
+		for(u32 y = 0; y < 2; y++)
 		{
-			temp_y_a[x][y] = lcd_stat.window_y_a[x][y];
-			temp_y_b[x][y] = lcd_stat.window_y_b[x][y];
+			for(u32 x = 0; x < 256; x++) { lcd_stat.window_status_a[x][y] = false; }
+			for(u32 x = 0; x < 2; x++) { temp_y[x][y] = lcd_stat.window_y_a[x][y]; }
 		}
-	}
-
-	//Check if windows are enabled and if they are usable
-	win_stat[0] = ((lcd_stat.window_enable_a[0]) && (lcd_stat.window_x_a[0][0] != lcd_stat.window_x_a[0][1]));
-	win_stat[1] = ((lcd_stat.window_enable_a[1]) && (lcd_stat.window_x_a[1][0] != lcd_stat.window_x_a[1][1]));
 
-	if((win_stat[0]) && (lcd_stat.window_y_a[0][0] == lcd_stat.window_y_a[0][1]) && (!lcd_stat.window_y_a[0][0]))
-	{
-		lcd_stat.window_y_a[0][1] = 256;
-	}
+		//Check if windows are enabled and if they are usable
+		win_stat[0] = ((lcd_stat.window_enable_a[0]) && (lcd_stat.window_x_a[0][0] != lcd_stat.window_x_a[0][1]));
+		win_stat[1] = ((lcd_stat.window_enable_a[1]) && (lcd_stat.window_x_a[1][0] != lcd_stat.window_x_a[1][1]));
 
-	if((win_stat[1]) && (lcd_stat.window_y_a[1][0] == lcd_stat.window_y_a[1][1]) && (!lcd_stat.window_y_a[1][0]))
-	{
-		lcd_stat.window_y_a[1][1] = 256;
-	}
+		if((win_stat[0]) && (lcd_stat.window_y_a[0][0] == lcd_stat.window_y_a[0][1]) && (!lcd_stat.window_y_a[0][0]))
+		{
+			lcd_stat.window_y_a[0][1] = 256;
+		}
 
-	//Calculate Engine A
-	for(u32 win_id = 0; win_id < 2; win_id++)
-	{
-		for(u32 pixel = 0; pixel < 256; pixel++)
+		if((win_stat[1]) && (lcd_stat.window_y_a[1][0] == lcd_stat.window_y_a[1][1]) && (!lcd_stat.window_y_a[1][0]))
 		{
-			bool check_x = false;
-			bool check_y = false;
+			lcd_stat.window_y_a[1][1] = 256;
+		}
 
-			//Determine window status of this pixel
-			if(win_stat[win_id])
+		//Find which window covers each pixel
+		for(u32 win_id = 0; win_id < 2; win_id++)
+		{
+			for(u32 pixel = 0; pixel < 256; pixel++)
 			{
-				if((lcd_stat.window_x_a[win_id][0] <= lcd_stat.window_x_a[win_id][1]) && (pixel >= lcd_stat.window_x_a[win_id][0]) && (pixel <= lcd_stat.window_x_a[win_id][1]))
-				{
-					check_x = true;
-				}
+				bool check_x = false;
+				bool check_y = false;
 
-				else if((lcd_stat.window_x_a[win_id][0] > lcd_stat.window_x_a[win_id][1]) && ((pixel >= lcd_stat.window_x_a[win_id][0]) || (pixel <= lcd_stat.window_x_a[win_id][1])))
+				//Determine window status of this pixel
+				if(win_stat[win_id])
 				{
-					check_x = true;
-				}
+					if((lcd_stat.window_x_a[win_id][0] <= lcd_stat.window_x_a[win_id][1]) && (pixel >= lcd_stat.window_x_a[win_id][0]) && (pixel <= lcd_stat.window_x_a[win_id][1]))
+					{
+						check_x = true;
+					}
 
-				if((lcd_stat.window_y_a[win_id][0] <= lcd_stat.window_y_a[win_id][1]) && (line >= lcd_stat.window_y_a[win_id][0]) && (line < lcd_stat.window_y_a[win_id][1]))
-				{
-					check_y = true;
-				}
+					else if((lcd_stat.window_x_a[win_id][0] > lcd_stat.window_x_a[win_id][1]) && ((pixel >= lcd_stat.window_x_a[win_id][0]) || (pixel <= lcd_stat.window_x_a[win_id][1])))
+					{
+						check_x = true;
+					}
 
-				else if((lcd_stat.window_y_a[win_id][0] > lcd_stat.window_y_a[win_id][1]) && ((line >= lcd_stat.window_y_a[win_id][0]) || (line < lcd_stat.window_y_a[win_id][1])))
-				{
-					check_y = true;
-				}
+					if((lcd_stat.window_y_a[win_id][0] <= lcd_stat.window_y_a[win_id][1]) && (line >= lcd_stat.window_y_a[win_id][0]) && (line < lcd_stat.window_y_a[win_id][1]))
+					{
+						check_y = true;
+					}
 
-				//Set window status and ID
-				if(check_x && check_y && !lcd_stat.window_status_a[pixel][win_id])
-				{
-					lcd_stat.window_status_a[pixel][win_id] = true;
-					lcd_stat.window_id_a[pixel] = win_id;
+					else if((lcd_stat.window_y_a[win_id][0] > lcd_stat.window_y_a[win_id][1]) && ((line >= lcd_stat.window_y_a[win_id][0]) || (line < lcd_stat.window_y_a[win_id][1])))
+					{
+						check_y = true;
+					}
+
+					//Set window status and ID
+					if(check_x && check_y && !lcd_stat.window_status_a[pixel][win_id])
+					{
+						lcd_stat.window_status_a[pixel][win_id] = true;
+						lcd_stat.window_id_a[pixel] = win_id;
+					}
 				}
 			}
 		}
-	}
 
-	//Check if windows are enabled and if they are usable
-	win_stat[0] = ((lcd_stat.window_enable_b[0]) && (lcd_stat.window_x_b[0][0] != lcd_stat.window_x_b[0][1]));
-	win_stat[1] = ((lcd_stat.window_enable_b[1]) && (lcd_stat.window_x_b[1][0] != lcd_stat.window_x_b[1][1]));
-
-	if((win_stat[0]) && (lcd_stat.window_y_b[0][0] == lcd_stat.window_y_b[0][1]) && (!lcd_stat.window_y_b[0][0]))
-	{
-		lcd_stat.window_y_b[0][1] = 256;
+		//Restore original Y values for windows
+		for(u32 y = 0; y < 2; y++)
+		{
+			for(u32 x = 0; x < 2; x++) { lcd_stat.window_y_a[x][y] = temp_y[x][y]; }
+		}
 	}
 
-	if((win_stat[1]) && (lcd_stat.window_y_b[1][0] == lcd_stat.window_y_b[1][1]) && (!lcd_stat.window_y_b[1][0]))
+	//Calculate Engine B
+	else
 	{
-		lcd_stat.window_y_b[1][1] = 256;
-	}
+		//Clear previous calculations and store temporary Y values for windows
+		for(u32 y = 0; y < 2; y++)
+		{
+			for(u32 x = 0; x < 256; x++) { lcd_stat.window_status_b[x][y] = false; }
+			for(u32 x = 0; x < 2; x++) { temp_y[x][y] = lcd_stat.window_y_b[x][y]; }
+		}
 
-	//Calculate Engine B
-	for(u32 win_id = 0; win_id < 2; win_id++)
-	{	
-		for(u32 pixel = 0; pixel < 256; pixel++)
+		//Check if windows are enabled and if they are usable
+		win_stat[0] = ((lcd_stat.window_enable_b[0]) && (lcd_stat.window_x_b[0][0] != lcd_stat.window_x_b[0][1]));
+		win_stat[1] = ((lcd_stat.window_enable_b[1]) && (lcd_stat.window_x_b[1][0] != lcd_stat.window_x_b[1][1]));
+
+		if((win_stat[0]) && (lcd_stat.window_y_b[0][0] == lcd_stat.window_y_b[0][1]) && (!lcd_stat.window_y_b[0][0]))
 		{
-			bool check_x = false;
-			bool check_y = false;
+			lcd_stat.window_y_b[0][1] = 256;
+		}
 
-			//Determine window status of this pixel
-			if(win_stat[win_id])
+		if((win_stat[1]) && (lcd_stat.window_y_b[1][0] == lcd_stat.window_y_b[1][1]) && (!lcd_stat.window_y_b[1][0]))
+		{
+			lcd_stat.window_y_b[1][1] = 256;
+		}
+
+		//Find which window covers each pixel
+		for(u32 win_id = 0; win_id < 2; win_id++)
+		{	
+			for(u32 pixel = 0; pixel < 256; pixel++)
 			{
-				if((lcd_stat.window_x_b[win_id][0] <= lcd_stat.window_x_b[win_id][1]) && (pixel >= lcd_stat.window_x_b[win_id][0]) && (pixel <= lcd_stat.window_x_b[win_id][1]))
-				{
-					check_x = true;
-				}
+				bool check_x = false;
+				bool check_y = false;
 
-				else if((lcd_stat.window_x_b[win_id][0] > lcd_stat.window_x_b[win_id][1]) && ((pixel >= lcd_stat.window_x_b[win_id][0]) || (pixel <= lcd_stat.window_x_b[win_id][1])))
+				//Determine window status of this pixel
+				if(win_stat[win_id])
 				{
-					check_x = true;
-				}
+					if((lcd_stat.window_x_b[win_id][0] <= lcd_stat.window_x_b[win_id][1]) && (pixel >= lcd_stat.window_x_b[win_id][0]) && (pixel <= lcd_stat.window_x_b[win_id][1]))
+					{
+						check_x = true;
+					}
 
-				if((lcd_stat.window_y_b[win_id][0] <= lcd_stat.window_y_b[win_id][1]) && (line >= lcd_stat.window_y_b[win_id][0]) && (line < lcd_stat.window_y_b[win_id][1]))
-				{
-					check_y = true;
-				}
+					else if((lcd_stat.window_x_b[win_id][0] > lcd_stat.window_x_b[win_id][1]) && ((pixel >= lcd_stat.window_x_b[win_id][0]) || (pixel <= lcd_stat.window_x_b[win_id][1])))
+					{
+						check_x = true;
+					}
 
-				else if((lcd_stat.window_y_b[win_id][0] > lcd_stat.window_y_b[win_id][1]) && ((line >= lcd_stat.window_y_b[win_id][0]) || (line < lcd_stat.window_y_b[win_id][1])))
-				{
-					check_y = true;
-				}
+					if((lcd_stat.window_y_b[win_id][0] <= lcd_stat.window_y_b[win_id][1]) && (line >= lcd_stat.window_y_b[win_id][0]) && (line < lcd_stat.window_y_b[win_id][1]))
+					{
+						check_y = true;
+					}
+
+					else if((lcd_stat.window_y_b[win_id][0] > lcd_stat.window_y_b[win_id][1]) && ((line >= lcd_stat.window_y_b[win_id][0]) || (line < lcd_stat.window_y_b[win_id][1])))
+					{
+						check_y = true;
+					}
 		
-				//Set window status and ID
-				if(check_x && check_y && !lcd_stat.window_status_b[pixel][win_id])
-				{
-					lcd_stat.window_status_b[pixel][win_id] = true;
-					lcd_stat.window_id_b[pixel] = win_id;
+					//Set window status and ID
+					if(check_x && check_y && !lcd_stat.window_status_b[pixel][win_id])
+					{
+						lcd_stat.window_status_b[pixel][win_id] = true;
+						lcd_stat.window_id_b[pixel] = win_id;
+					}
 				}
 			}
 		}
-	}
 
-	//Restore original Y values for windows
-	for(u32 y = 0; y < 2; y++)
-	{
-		for(u32 x = 0; x < 2; x++)
+		//Restore original Y values for windows
+		for(u32 y = 0; y < 2; y++)
 		{
-			lcd_stat.window_y_a[x][y] = temp_y_a[x][y];
-			lcd_stat.window_y_b[x][y] = temp_y_b[x][y];
+			for(u32 x = 0; x < 2; x++) { lcd_stat.window_y_b[x][y] = temp_y[x][y]; }
 		}
 	}
 }
@@ -3971,14 +4204,20 @@ void NTR_LCD::update()
 	//Use SDL
 	if(config::sdl_render)
 	{
-		//Lock source surface
-		if(SDL_MUSTLOCK(final_screen)){ SDL_LockSurface(final_screen); }
-		u32* out_pixel_data = (u32*)final_screen->pixels;
+		//Show the last filtered frame, the current one is still being filtered
+		if(filter.is_active()) { filter.present(final_screen); }
+
+		else
+		{
+			//Lock source surface
+			if(SDL_MUSTLOCK(final_screen)){ SDL_LockSurface(final_screen); }
+			u32* out_pixel_data = (u32*)final_screen->pixels;
 
-		for(int a = 0; a < 0x18000; a++) { out_pixel_data[a] = screen_buffer[a]; }
+			for(int a = 0; a < 0x18000; a++) { out_pixel_data[a] = screen_buffer[a]; }
 
-		//Unlock source surface
-		if(SDL_MUSTLOCK(final_screen)){ SDL_UnlockSurface(final_screen); }
+			//Unlock source surface
+			if(SDL_MUSTLOCK(final_screen)){ SDL_UnlockSurface(final_screen); }
+		}
 		
 		//Display final screen buffer - OpenGL
 		if(config::use_opengl) { opengl_blit(); }
@@ -4105,10 +4344,6 @@ void NTR_LCD::step()
 			//Render scanline data
 			render_scanline();
 
-			//Apply Master Brightness on Engine A and/or Engine B if necessary
-			if(lcd_stat.master_bright_a & 0xC000) { adjust_master_brightness(1); }
-			if(lcd_stat.master_bright_b & 0xC000) { adjust_master_brightness(0); }
-
 			u32 render_position = (lcd_stat.current_scanline * config::sys_width);
 
 			//Swap top and bottom if POWERCNT1 Bit 15 is not set, otherwise A is top, B is bottom
@@ -4188,14 +4423,27 @@ void NTR_LCD::step()
 				//If using SDL and no OpenGL, manually stretch for fullscreen via SDL
 				if((config::flags & SDL_WINDOW_FULLSCREEN) && (!config::use_opengl))
 				{
-					//Lock source surface
-					if(SDL_MUSTLOCK(original_screen)){ SDL_LockSurface(original_screen); }
-					u32* out_pixel_data = (u32*)original_screen->pixels;
+					SDL_Surface* source_screen = original_screen;
 
-					for(int a = 0; a < 0x18000; a++) { out_pixel_data[a] = screen_buffer[a]; }
+					//Stretch the last filtered frame instead
+					if(filter.is_active())
+					{
+						filter.submit(&screen_buffer[0]);
+						filter.present(filtered_screen);
+						source_screen = filtered_screen;
+					}
 
-					//Unlock source surface
-					if(SDL_MUSTLOCK(original_screen)){ SDL_UnlockSurface(original_screen); }
+					else
+					{
+						//Lock source surface
+						if(SDL_MUSTLOCK(original_screen)){ SDL_LockSurface(original_screen); }
+						u32* out_pixel_data = (u32*)original_screen->pixels;
+
+						for(int a = 0; a < 0x18000; a++) { out_pixel_data[a] = screen_buffer[a]; }
+
+						//Unlock source surface
+						if(SDL_MUSTLOCK(original_screen)){ SDL_UnlockSurface(original_screen); }
+					}
 		
 					//Blit the original surface to the final stretched one
 					SDL_Rect dest_rect;
@@ -4203,7 +4451,7 @@ void NTR_LCD::step()
 					dest_rect.h = config::sys_height * max_fullscreen_ratio;
 					dest_rect.x = ((config::win_width - dest_rect.w) >> 1);
 					dest_rect.y = ((config::win_height - dest_rect.h) >> 1);
-					SDL_BlitScaled(original_screen, NULL, final_screen, &dest_rect);
+					SDL_BlitScaled(source_screen, NULL, final_screen, &dest_rect);
 
 					if(SDL_UpdateWindowSurface(window) != 0)
 					{
@@ -4224,14 +4472,24 @@ void NTR_LCD::step()
 				//Otherwise, render normally (SDL 1:1, OpenGL handles its own stretching)
 				else
 				{
-					//Lock source surface
-					if(SDL_MUSTLOCK(final_screen)){ SDL_LockSurface(final_screen); }
-					u32* out_pixel_data = (u32*)final_screen->pixels;
+					//Hand the frame to the software filter, then show the last one it finished
+					if(filter.is_active())
+					{
+						filter.submit(&screen_buffer[0]);
+						filter.present(final_screen);
+					}
 
-					for(int a = 0; a < 0x18000; a++) { out_pixel_data[a] = screen_buffer[a]; }
+					else
+					{
+						//Lock source surface
+						if(SDL_MUSTLOCK(final_screen)){ SDL_LockSurface(final_screen); }
+						u32* out_pixel_data = (u32*)final_screen->pixels;
 
-					//Unlock source surface
-					if(SDL_MUSTLOCK(final_screen)){ SDL_UnlockSurface(final_screen); }
+						for(int a = 0; a < 0x18000; a++) { out_pixel_data[a] = screen_buffer[a]; }
+
+						//Unlock source surface
+						if(SDL_MUSTLOCK(final_screen)){ SDL_UnlockSurface(final_screen); }
+					}
 		
 					//Display final screen buffer - OpenGL
 					if(config::use_opengl) { opengl_blit(); }
@@ -4320,25 +4578,30 @@ void NTR_LCD::step()
 			//3D - Swap Buffers command
 			if((lcd_3D_stat.gx_state & 0x80) && (lcd_stat.display_stat_nds9 & 0x1))
 			{
-				lcd_3D_stat.vertex_list_index = 0;
-				lcd_3D_stat.gx_state &= ~0x80;
-				lcd_3D_stat.render_polygon = false;
-				lcd_3D_stat.poly_count = 0;
-				lcd_3D_stat.vert_count = 0;
+				//Show the frame drawn since the last swap - 3D output lags geometry by one frame, so drawing can overlap the next frame's emulation
+				wait_geometry();
+				lcd_3D_stat.buffer_id = gx_raster_buffer_id;
+				gx_raster_buffer_id = (lcd_3D_stat.buffer_id + 1) & 0x1;
 
-				//Clear 3D buffer and fill with rear plane
-				gx_screen_buffer[lcd_3D_stat.buffer_id].clear();
-				gx_screen_buffer[lcd_3D_stat.buffer_id].resize(0xC000, lcd_3D_stat.rear_plane_color);
+				//Clear the back buffer and fill with rear plane
+				gx_screen_buffer[gx_raster_buffer_id].clear();
+				gx_screen_buffer[gx_raster_buffer_id].resize(0xC000, lcd_3D_stat.rear_plane_color);
 
 				//Clear render buffer
-				if(!lcd_3D_stat.rear_plane_alpha) { gx_render_buffer[lcd_3D_stat.buffer_id].assign(0xC000, 0); }
-				else { gx_render_buffer[lcd_3D_stat.buffer_id].assign(0xC000, 1); }
-
-				lcd_3D_stat.buffer_id += 1;
-				lcd_3D_stat.buffer_id &= 0x1;
+				if(!lcd_3D_stat.rear_plane_alpha) { gx_render_buffer[gx_raster_buffer_id].assign(0xC000, 0); }
+				else { gx_render_buffer[gx_raster_buffer_id].assign(0xC000, 1); }
 
 				//Clear z-buffer
-				gx_z_buffer.assign(0xC000, 4096);
+				gx_z_buffer[gx_raster_buffer_id].assign(0xC000, 4096);
+
+				//Draw this frame's polygons to the back buffer in the background
+				flush_geometry();
+
+				lcd_3D_stat.vertex_list_index = 0;
+				lcd_3D_stat.gx_state &= ~0x80;
+				lcd_3D_stat.render_polygon = false;
+				lcd_3D_stat.poly_count = 0;
+				lcd_3D_stat.vert_count = 0;
 			}
 
 			//Start VBlank DMA
@@ -4698,3 +4961,195 @@ void NTR_LCD::render_virtual_cursor()
 		}
 	}
 }
+
+/****** Read LCD data from save state ******/
+bool NTR_LCD::lcd_read(save_state_buffer& state)
+{
+	//Drop any polygons still waiting to be drawn, the state provides finished 3D buffers
+	wait_geometry();
+	gx_poly_list[0].clear();
+	gx_poly_list[1].clear();
+
+	//Serialize 2D LCD data from save state - Palette and OAM update lists are rebuilt instead
+	u32 lcd_stat_length = (u8*)&lcd_stat.bg_pal_update_a - (u8*)&lcd_stat;
+	state.read((char*)&lcd_stat, lcd_stat_length);
+
+	//Serialize 3D LCD data from save state - Texture data is decoded again for each polygon
+	u32 lcd_3D_stat_length = (u8*)&lcd_3D_stat.tex_data - (u8*)&lcd_3D_stat;
+	state.read((char*)&lcd_3D_stat, lcd_3D_stat_length);
+
+	lcd_3D_stat_length = (u8*)(&lcd_3D_stat + 1) - (u8*)&lcd_3D_stat.poly_id;
+	state.read((char*)&lcd_3D_stat.poly_id, lcd_3D_stat_length);
+
+	//The back buffer holds the finished frame shown at the next swap
+	gx_raster_buffer_id = (lcd_3D_stat.buffer_id + 1) & 0x1;
+
+	//Serialize OBJ data from save state
+	for(u32 x = 0; x < 256; x++) { state.read((char*)&obj[x], sizeof(obj[x])); }
+
+	state.read((char*)&obj_render_list_a, sizeof(obj_render_list_a));
+	state.read((char*)&obj_render_length_a, sizeof(obj_render_length_a));
+	state.read((char*)&obj_render_list_b, sizeof(obj_render_list_b));
+	state.read((char*)&obj_render_length_b, sizeof(obj_render_length_b));
+
+	//Serialize misc LCD data from save state
+	state.read((char*)&capture_on, sizeof(capture_on));
+	state.read((char*)&capture_buffer[0], capture_buffer.size() * sizeof(capture_buffer[0]));
+	state.read((char*)&full_scanline_render_a, sizeof(full_scanline_render_a));
+	state.read((char*)&full_scanline_render_b, sizeof(full_scanline_render_b));
+	state.read((char*)&scanline_pixel_counter, sizeof(scanline_pixel_counter));
+
+	//Serialize 3D buffers from save state
+	for(u32 x = 0; x < 2; x++)
+	{
+		state.read((char*)&gx_screen_buffer[x][0], gx_screen_buffer[x].size() * sizeof(gx_screen_buffer[x][0]));
+		state.read((char*)&gx_render_buffer[x][0], gx_render_buffer[x].size() * sizeof(gx_render_buffer[x][0]));
+	}
+
+	for(u32 x = 0; x < 2; x++)
+	{
+		state.read((char*)&gx_z_buffer[x][0], gx_z_buffer[x].size() * sizeof(gx_z_buffer[x][0]));
+	}
+
+	//Serialize polygons, matrix stacks, and matrices from save state
+	state.read((char*)&last_poly, sizeof(last_poly));
+	state.read((char*)&current_poly, sizeof(current_poly));
+
+	state.read((char*)&gx_projection_stack[0], gx_projection_stack.size() * sizeof(gx_projection_stack[0]));
+	state.read((char*)&gx_position_stack[0], gx_position_stack.size() * sizeof(gx_position_stack[0]));
+	state.read((char*)&gx_vector_stack[0], gx_vector_stack.size() * sizeof(gx_vector_stack[0]));
+	state.read((char*)&gx_texture_stack[0], gx_texture_stack.size() * sizeof(gx_texture_stack[0]));
+
+	state.read((char*)&position_sp, sizeof(position_sp));
+	state.read((char*)&vector_sp, sizeof(vector_sp));
+	state.read((char*)&projection_sp, sizeof(projection_sp));
+	state.read((char*)&vert_colors, sizeof(vert_colors));
+
+	state.read((char*)&gx_projection_matrix, sizeof(gx_projection_matrix));
+	state.read((char*)&gx_position_matrix, sizeof(gx_position_matrix));
+	state.read((char*)&gx_vector_matrix, sizeof(gx_vector_matrix));
+	state.read((char*)&gx_texture_matrix, sizeof(gx_texture_matrix));
+
+	for(u32 x = 0; x < 4; x++)
+	{
+		state.read((char*)&last_pos_matrix[x], sizeof(last_pos_matrix[x]));
+		state.read((char*)&light_vector[x], sizeof(light_vector[x]));
+		state.read((char*)&current_normal[x], sizeof(current_normal[x]));
+	}
+
+	//Serialize lighting data from save state
+	state.read((char*)&light_colors, sizeof(light_colors));
+	state.read((char*)&material_colors, sizeof(material_colors));
+	state.read((char*)&shine_table, sizeof(shine_table));
+
+	//Force palettes, OAM, and BG controls to be rebuilt from memory
+	lcd_stat.bg_pal_update_a = true;
+	lcd_stat.bg_pal_update_list_a.assign(0x100, true);
+
+	lcd_stat.bg_pal_update_b = true;
+	lcd_stat.bg_pal_update_list_b.assign(0x100, true);
+
+	lcd_stat.bg_ext_pal_update_a = true;
+	lcd_stat.bg_ext_pal_update_list_a.assign(0x4000, true);
+
+	lcd_stat.bg_ext_pal_update_b = true;
+	lcd_stat.bg_ext_pal_update_list_b.assign(0x4000, true);
+
+	lcd_stat.obj_pal_update_a = true;
+	lcd_stat.obj_pal_update_list_a.assign(0x100, true);
+
+	lcd_stat.obj_pal_update_b = true;
+	lcd_stat.obj_pal_update_list_b.assign(0x100, true);
+
+	lcd_stat.obj_ext_pal_update_a = true;
+	lcd_stat.obj_ext_pal_update_list_a.assign(0x1000, true);
+
+	lcd_stat.obj_ext_pal_update_b = true;
+	lcd_stat.obj_ext_pal_update_list_b.assign(0x1000, true);
+
+	lcd_stat.oam_update = true;
+	lcd_stat.oam_update_list.assign(0x100, true);
+
+	lcd_stat.update_bg_control_a = true;
+	lcd_stat.update_bg_control_b = true;
+
+	return state.good();
+}
+
+/****** Write LCD data to save state ******/
+bool NTR_LCD::lcd_write(save_state_buffer& state)
+{
+	//Let the back buffer finish drawing - Polygons queued for the next swap stay queued
+	wait_geometry();
+
+	//Serialize 2D LCD data to save state - Palette and OAM update lists are rebuilt instead
+	u32 lcd_stat_length = (u8*)&lcd_stat.bg_pal_update_a - (u8*)&lcd_stat;
+	state.write((char*)&lcd_stat, lcd_stat_length);
+
+	//Serialize 3D LCD data to save state - Texture data is decoded again for each polygon
+	u32 lcd_3D_stat_length = (u8*)&lcd_3D_stat.tex_data - (u8*)&lcd_3D_stat;
+	state.write((char*)&lcd_3D_stat, lcd_3D_stat_length);
+
+	lcd_3D_stat_length = (u8*)(&lcd_3D_stat + 1) - (u8*)&lcd_3D_stat.poly_id;
+	state.write((char*)&lcd_3D_stat.poly_id, lcd_3D_stat_length);
+
+	//Serialize OBJ data to save state
+	for(u32 x = 0; x < 256; x++) { state.write((char*)&obj[x], sizeof(obj[x])); }
+
+	state.write((char*)&obj_render_list_a, sizeof(obj_render_list_a));
+	state.write((char*)&obj_render_length_a, sizeof(obj_render_length_a));
+	state.write((char*)&obj_render_list_b, sizeof(obj_render_list_b));
+	state.write((char*)&obj_render_length_b, sizeof(obj_render_length_b));
+
+	//Serialize misc LCD data to save state
+	state.write((char*)&capture_on, sizeof(capture_on));
+	state.write((char*)&capture_buffer[0], capture_buffer.size() * sizeof(capture_buffer[0]));
+	state.write((char*)&full_scanline_render_a, sizeof(full_scanline_render_a));
+	state.write((char*)&full_scanline_render_b, sizeof(full_scanline_render_b));
+	state.write((char*)&scanline_pixel_counter, sizeof(scanline_pixel_counter));
+
+	//Serialize 3D buffers to save state
+	for(u32 x = 0; x < 2; x++)
+	{
+		state.write((char*)&gx_screen_buffer[x][0], gx_screen_buffer[x].size() * sizeof(gx_screen_buffer[x][0]));
+		state.write((char*)&gx_render_buffer[x][0], gx_render_buffer[x].size() * sizeof(gx_render_buffer[x][0]));
+	}
+
+	for(u32 x = 0; x < 2; x++)
+	{
+		state.write((char*)&gx_z_buffer[x][0], gx_z_buffer[x].size() * sizeof(gx_z_buffer[x][0]));
+	}
+
+	//Serialize polygons, matrix stacks, and matrices to save state
+	state.write((char*)&last_poly, sizeof(last_poly));
+	state.write((char*)&current_poly, sizeof(current_poly));
+
+	state.write((char*)&gx_projection_stack[0], gx_projection_stack.size() * sizeof(gx_projection_stack[0]));
+	state.write((char*)&gx_position_stack[0], gx_position_stack.size() * sizeof(gx_position_stack[0]));
+	state.write((char*)&gx_vector_stack[0], gx_vector_stack.size() * sizeof(gx_vector_stack[0]));
+	state.write((char*)&gx_texture_stack[0], gx_texture_stack.size() * sizeof(gx_texture_stack[0]));
+
+	state.write((char*)&position_sp, sizeof(position_sp));
+	state.write((char*)&vector_sp, sizeof(vector_sp));
+	state.write((char*)&projection_sp, sizeof(projection_sp));
+	state.write((char*)&vert_colors, sizeof(vert_colors));
+
+	state.write((char*)&gx_projection_matrix, sizeof(gx_projection_matrix));
+	state.write((char*)&gx_position_matrix, sizeof(gx_position_matrix));
+	state.write((char*)&gx_vector_matrix, sizeof(gx_vector_matrix));
+	state.write((char*)&gx_texture_matrix, sizeof(gx_texture_matrix));
+
+	for(u32 x = 0; x < 4; x++)
+	{
+		state.write((char*)&last_pos_matrix[x], sizeof(last_pos_matrix[x]));
+		state.write((char*)&light_vector[x], sizeof(light_vector[x]));
+		state.write((char*)&current_normal[x], sizeof(current_normal[x]));
+	}
+
+	//Serialize lighting data to save state
+	state.write((char*)&light_colors, sizeof(light_colors));
+	state.write((char*)&material_colors, sizeof(material_colors));
+	state.write((char*)&shine_table, sizeof(shine_table));
+
+	return true;
+}
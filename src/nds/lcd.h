@@ -13,10 +13,25 @@
 #include "SDL2/SDL_opengl.h"
 #include "mmu.h"
 #include "common/gx_util.h"
+#include "common/worker_pool.h"
+#include "common/sw_filter.h"
+
+#include <memory>
+#include <atomic>
 
 #ifndef NDS_LCD
 #define NDS_LCD
 
+//Maximum number of threads used to rasterize 3D polygons
+#define NTR_GX_MAX_THREADS 4
+
+//Time the 2D Engine B thread keeps polling for new scanlines before sleeping, in milliseconds
+#define NTR_2D_SPIN_TIME 2
+
+//Limits for the decoded texture cache
+#define NTR_TEX_CACHE_ENTRIES 128
+#define NTR_TEX_CACHE_TEXELS 0x400000
+
 class NTR_LCD
 {
 	public:
@@ -37,11 +52,19 @@ class NTR_LCD
 	bool get_cart_icon(SDL_Surface* nds_icon);
 	bool save_cart_icon(std::string nds_icon_file);
 
+	//Serialize data for save state loading/saving
+	bool lcd_read(save_state_buffer& state);
+	bool lcd_write(save_state_buffer& state);
+
 	//Screen data
 	SDL_Window* window;
 	SDL_Surface* final_screen;
 	SDL_Surface* original_screen;
 
+	//Software filter output when stretched to fullscreen
+	SDL_Surface* filtered_screen;
+	sw_filter filter;
+
 	//OpenGL data
 	SDL_GLContext gl_context;
 	GLuint lcd_texture;
@@ -134,11 +157,13 @@ class NTR_LCD
 	std::vector<u8> render_buffer_a;
 	std::vector<u8> render_buffer_b;
 	std::vector< std::vector<u8> > gx_render_buffer;
-	std::vector<float> gx_z_buffer;
+	std::vector< std::vector<float> > gx_z_buffer;
 
-	//Other buffers
-	std::vector< std::vector<u32> > line_buffer;
-	std::vector< std::vector<u32> > obj_line_buffer;
+	//Other buffers - Each engine has its own, so Engine A and Engine B can render at the same time
+	std::vector< std::vector<u32> > line_buffer_a;
+	std::vector< std::vector<u32> > line_buffer_b;
+	std::vector< std::vector<u32> > obj_line_buffer_a;
+	std::vector< std::vector<u32> > obj_line_buffer_b;
 
 	//Display Capture
 	bool capture_on;
@@ -193,7 +218,103 @@ class NTR_LCD
 	u32 material_colors[4];
 	float shine_table[4];
 
+	//Decoded textures, reused until the VRAM they came from is written to
+	//Queued polygons may still hold older pixel data after an entry is decoded again
+	struct tex_cache_entry
+	{
+		u32 tex_addr;
+		u32 pal_addr;
+		u32 slot_addr;
+		u16 width;
+		u16 height;
+		u8 format;
+		bool color_zero;
+
+		u32 stamp;
+		u32 last_use;
+		std::shared_ptr< std::vector<u32> > texels;
+	};
+
+	std::vector<tex_cache_entry> tex_cache;
+	u32 tex_cache_texels;
+	u32 tex_cache_clock;
+
+	//Screen-space polygon, captured when geometry is submitted and rasterized later
+	struct gx_poly_entry
+	{
+		float plot_x[4];
+		float plot_y[4];
+		float plot_z[4];
+		float plot_tx[4];
+		float plot_ty[4];
+		u32 vert_colors[4];
+		u8 vert_count;
+
+		s32 min_x;
+		s32 max_x;
+
+		u8 poly_mode;
+		u8 poly_alpha;
+		bool poly_new_depth;
+		bool poly_depth_test;
+		u32 vertex_color;
+
+		bool use_texture;
+		u16 tex_width;
+		u16 tex_height;
+		bool repeat_tex_x;
+		bool repeat_tex_y;
+		bool flip_tex_x;
+		bool flip_tex_y;
+		std::shared_ptr< const std::vector<u32> > texels;
+	};
+
+	//Fill coordinates for the polygon edges, one set per screen band
+	struct gx_poly_edges
+	{
+		s16 hi_fill[256];
+		s16 lo_fill[256];
+
+		u32 hi_overflow[256];
+		u32 lo_overflow[256];
+
+		u32 hi_color[256];
+		u32 lo_color[256];
+
+		float hi_line_z[256];
+		float lo_line_z[256];
+
+		float hi_tx[256];
+		float lo_tx[256];
+
+		float hi_ty[256];
+		float lo_ty[256];
+	};
+
+	//Deferred rasterization - Polygons are queued per frame, then drawn in scanline bands by worker threads
+	std::vector<gx_poly_entry> gx_poly_list[2];
+	std::vector<gx_poly_edges> gx_band_edges;
+	worker_pool gx_workers;
+	u8 gx_poly_list_id;
+	u8 gx_raster_list_id;
+	u8 gx_raster_buffer_id;
+	u32 gx_band_count;
+
+	//Threaded 2D rendering - Engine B draws each scanline on its own thread while Engine A draws on the emulation thread
+	SDL_Thread* engine_b_thread;
+	SDL_mutex* engine_b_lock;
+	SDL_cond* engine_b_wake;
+	std::atomic<bool> engine_b_busy;
+	std::atomic<bool> engine_b_sleeping;
+	std::atomic<bool> engine_b_quit;
+
+	void start_engine_b_thread();
+	void stop_engine_b_thread();
+	static int engine_b_main(void* ptr);
+
 	void render_scanline();
+	void render_scanline_a();
+	void render_scanline_b();
 	void render_bg_scanline(u32 bg_control);
 	void render_bg_mode_text(u32 bg_control);
 	void render_bg_mode_affine(u32 bg_control);
@@ -207,18 +328,23 @@ class NTR_LCD
 	//3D functions
 	void render_bg_3D();
 	void render_geometry();
-	void fill_poly_solid();
-	void fill_poly_interpolated();
-	void fill_poly_textured();
+	void flush_geometry();
+	void wait_geometry();
+	void rasterize_band(u32 band);
+	static void rasterize_band_task(void* data, u32 index);
+	void trace_poly_edges(const gx_poly_entry& poly, gx_poly_edges& edges);
+	void fill_poly_solid(const gx_poly_entry& poly, const gx_poly_edges& edges, u8 buffer_id, u8 y_start, u8 y_end);
+	void fill_poly_interpolated(const gx_poly_entry& poly, const gx_poly_edges& edges, u8 buffer_id, u8 y_start, u8 y_end);
+	void fill_poly_textured(const gx_poly_entry& poly, const gx_poly_edges& edges, u8 buffer_id, u8 y_start, u8 y_end);
 	void build_verts(u8 &l_size, u8 &index);
 	bool poly_push();
 	u32 read_param_u32(u8 index);
 	u16 read_param_u16(u8 index);
 	u32 get_rgb15(u16 color_bytes);
 	u32 interpolate_rgb(u32 color_1, u32 color_2, float ratio);
-	u32 alpha_blend_texel(u32 color_1, u32 color_2);
+	u32 alpha_blend_texel(u32 color_1, u32 color_2, u8 poly_alpha);
 	u32 alpha_blend_pixel(u32 color_1, u32 color_2, u8 poly_alpha);
-	u32 blend_texel(u32 color_1);
+	u32 blend_texel(u32 color_1, const gx_poly_entry& poly);
 	void update_clip_matrix();
 	void update_vector_matrix();
 	float get_u16_float(u16 value);
@@ -228,6 +354,8 @@ class NTR_LCD
 	void render_virtual_cursor();
 
 	//Texture functions
+	std::shared_ptr< const std::vector<u32> > get_tex(u32 address);
+	void clear_tex_cache();
 	void gen_tex_1(u32 address);
 	void gen_tex_2(u32 address);
 	void gen_tex_3(u32 address);
@@ -244,7 +372,7 @@ class NTR_LCD
 	void adjust_master_brightness(u8 engine_id);
 
 	//Window functions
-	void calculate_window_on_scanline();
+	void calculate_window_on_scanline(u32 bg_control);
 };
 
 #endif // NDS_LCD
@@ -251,18 +251,6 @@ struct ntr_lcd_3D_data
 	u8 vertex_mode;
 	u8 vertex_list_index;
 
-	s16 hi_fill[256];
-	s16 lo_fill[256];
-
-	u32 hi_overflow[256];
-	u32 lo_overflow[256];
-
-	u32 hi_color[256];
-	u32 lo_color[256];
-
-	float hi_line_z[256];
-	float lo_line_z[256];
-
 	bool render_polygon;
 	bool use_texture;
 	bool begin_strips;
@@ -283,9 +271,6 @@ struct ntr_lcd_3D_data
 	float last_y;
 	float last_z;
 
-	s32 poly_min_x;
-	s32 poly_max_x;
-
 	//Display Control
 	bool edge_marking;
 	bool z_buffering;
@@ -314,12 +299,6 @@ struct ntr_lcd_3D_data
 
 	float tex_coord_x[4];
 	float tex_coord_y[4];
-
-	float hi_tx[256];
-	float lo_tx[256];
-
-	float hi_ty[256];
-	float lo_ty[256];
 };
 
 #endif // NDS_LCD_DATA
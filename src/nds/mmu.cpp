@@ -12,6 +12,7 @@
 #include "common/util.h"
 
 #include <filesystem>
+#include <cstring>
 #include <cmath>
 #include <algorithm>
 
@@ -24,7 +25,10 @@ NTR_MMU::NTR_MMU()
 /****** MMU Deconstructor ******/
 NTR_MMU::~NTR_MMU() 
 {
-	save_backup(config::save_file);
+	//Stop the journal before the final save, so a late compaction cannot replace it with older data
+	//Only drop the journal once the full save is safely on disk
+	backup.stop();
+	if(save_backup(config::save_file)) { backup.finish(); }
 	memory_map.clear();
 	cart_data.clear();
 	nds7_bios.clear();
@@ -81,8 +85,24 @@ void NTR_MMU::reset()
 			break;
 	}	
 
-	memory_map.clear();
-	memory_map.resize(0x10000000, 0);
+	//Setup memory regions, anything else in the 28-bit address space is allocated on demand
+	memory_map.reset(0x10000000);
+	memory_map.map_region(0x2000000, 0x400000);
+	memory_map.map_region(0x3000000, 0x8000);
+	memory_map.map_region(0x3800000, 0x10000);
+	memory_map.map_region(0x4000000, 0x10000);
+	memory_map.map_region(0x5000000, 0x8000);
+	memory_map.map_region(0x6000000, 0x80000);
+	memory_map.map_region(0x6200000, 0x20000);
+	memory_map.map_region(0x6400000, 0x40000);
+	memory_map.map_region(0x6600000, 0x20000);
+	memory_map.map_region(0x6800000, 0xA4000);
+	memory_map.map_region(0x7000000, 0x8000);
+	memory_map.map_region(0x8000000, 0x2000000);
+	memory_map.map_region(0xE000000, 0x10D000);
+
+	//The 2D engines may read anywhere in VRAM from more than one thread
+	memory_map.map_gaps(0x6000000, 0x1000000);
 
 	cart_data.clear();
 
@@ -306,6 +326,8 @@ void NTR_MMU::reset()
 	vram_tex_slot[2] = 0;
 	vram_tex_slot[3] = 0;
 
+	for(u32 x = 0; x < 0x29; x++) { tex_vram_gen[x] = 0; }
+
 	bg_vram_bank_enable_a = false;
 	bg_vram_bank_enable_b = false;
 
@@ -530,9 +552,11 @@ u8 NTR_MMU::read_u8(u32 address)
 		if(access_mode && timer_cnt) { return ((nds9_timer->at(timer_id).cnt >> addr_shift) & 0xFF); }
 		else if(!access_mode && timer_cnt) { return ((nds7_timer->at(timer_id).cnt >> addr_shift) & 0xFF); }
 
-		//NDS9 and NDS7 timer counter
-		else if(access_mode && !timer_cnt) { return ((nds9_timer->at(timer_id).counter >> addr_shift) & 0xFF); }
-		else { return ((nds7_timer->at(timer_id).counter >> addr_shift) & 0xFF); }
+		//NDS9 and NDS7 timer counter - Only brought up to date when read
+		nds_timer* timer = (access_mode) ? &nds9_timer->at(timer_id) : &nds7_timer->at(timer_id);
+		sync_timer(timer);
+
+		return ((timer->counter >> addr_shift) & 0xFF);
 	}
 
 	//Check for IPCSYNC
@@ -1013,13 +1037,19 @@ u32 NTR_MMU::read_u32(u32 address)
 u16 NTR_MMU::read_u16_fast(u32 address) const
 {
 	address &= ~0x1;
-	return ((memory_map[address+1] << 8) | memory_map[address]);
+
+	//Aligned half-words never straddle pages, so NULL only means unmapped memory
+	const u8* data = memory_map.get_region_ptr(address, 2);
+	return (data != NULL) ? ((data[1] << 8) | data[0]) : 0;
 }
 
 /****** Reads 4 bytes from memory - No checks done on the read, used for known memory locations such as registers ******/
 u32 NTR_MMU::read_u32_fast(u32 address) const
 {
-	return ((memory_map[address+3] << 24) | (memory_map[address+2] << 16) | (memory_map[address+1] << 8) | memory_map[address]);
+	const u8* data = memory_map.get_region_ptr(address, 4);
+	if(data == NULL) { return ((memory_map[address+3] << 24) | (memory_map[address+2] << 16) | (memory_map[address+1] << 8) | memory_map[address]); }
+
+	return ((data[3] << 24) | (data[2] << 16) | (data[1] << 8) | data[0]);
 }
 
 /****** Reads 2 bytes from cartridge memory - No checks done on the read ******/
@@ -3085,6 +3115,9 @@ void NTR_MMU::write_u8(u32 address, u8 value)
 				u8 old_mst = (memory_map[address] & 0x7);
 				memory_map[address] = value;
 
+				//Remapping banks can change which data textures and texture palettes point to
+				mark_tex_vram_all();
+
 				u8 mst = (value & 0x7);
 				u8 offset = (value >> 3) & 0x3;
 				u32 bank_id = (address - 0x4000240);
@@ -3819,6 +3852,12 @@ void NTR_MMU::write_u8(u32 address, u8 value)
 				//Grab pointer to NDS9 or NDS7 Timer 0
 				nds_timer* timer = (access_mode) ? &nds9_timer->at(0) : &nds7_timer->at(0);
 
+				//Finish counting with the old settings first
+				sync_timer(timer);
+
+				bool was_counting = (timer->enable && !timer->count_up);
+				u32 prev_prescalar = timer->prescalar;
+
 				bool prev_enable = (timer->cnt & 0x80) ?  true : false;
 				timer->cnt &= (address & 0x1) ? 0xFF : 0xFF00;
 				timer->cnt |= (address & 0x1) ? (value << 8) : value;
@@ -3837,7 +3876,11 @@ void NTR_MMU::write_u8(u32 address, u8 value)
 
 				if(timer->count_up) { timer->prescalar = 1; }
 
-				timer->clock = (timer->prescalar - 1);
+				//Count down to the next overflow - Keep partial prescaler progress if the timer runs on at the same rate
+				if(timer->enable && !timer->count_up && (!was_counting || (timer->prescalar != prev_prescalar)))
+				{
+					timer->clock = ((0x10000 - timer->counter) * timer->prescalar);
+				}
 			}
 
 			break;
@@ -3849,6 +3892,12 @@ void NTR_MMU::write_u8(u32 address, u8 value)
 				//Grab pointer to NDS9 or NDS7 Timer 1
 				nds_timer* timer = (access_mode) ? &nds9_timer->at(1) : &nds7_timer->at(1);
 
+				//Finish counting with the old settings first
+				sync_timer(timer);
+
+				bool was_counting = (timer->enable && !timer->count_up);
+				u32 prev_prescalar = timer->prescalar;
+
 				bool prev_enable = (timer->cnt & 0x80) ?  true : false;
 				timer->cnt &= (address & 0x1) ? 0xFF : 0xFF00;
 				timer->cnt |= (address & 0x1) ? (value << 8) : value;
@@ -3868,7 +3917,11 @@ void NTR_MMU::write_u8(u32 address, u8 value)
 
 				if(timer->count_up) { timer->prescalar = 1; }
 
-				timer->clock = timer->prescalar; 
+				//Count down to the next overflow - Keep partial prescaler progress if the timer runs on at the same rate
+				if(timer->enable && !timer->count_up && (!was_counting || (timer->prescalar != prev_prescalar)))
+				{
+					timer->clock = ((0x10000 - timer->counter) * timer->prescalar);
+				}
 			}
 
 			break;
@@ -3880,6 +3933,12 @@ void NTR_MMU::write_u8(u32 address, u8 value)
 				//Grab pointer to NDS9 or NDS7 Timer 2
 				nds_timer* timer = (access_mode) ? &nds9_timer->at(2) : &nds7_timer->at(2);
 
+				//Finish counting with the old settings first
+				sync_timer(timer);
+
+				bool was_counting = (timer->enable && !timer->count_up);
+				u32 prev_prescalar = timer->prescalar;
+
 				bool prev_enable = (timer->cnt & 0x80) ?  true : false;
 				timer->cnt &= (address & 0x1) ? 0xFF : 0xFF00;
 				timer->cnt |= (address & 0x1) ? (value << 8) : value;
@@ -3899,7 +3958,11 @@ void NTR_MMU::write_u8(u32 address, u8 value)
 
 				if(timer->count_up) { timer->prescalar = 1; }
 
-				timer->clock = timer->prescalar; 
+				//Count down to the next overflow - Keep partial prescaler progress if the timer runs on at the same rate
+				if(timer->enable && !timer->count_up && (!was_counting || (timer->prescalar != prev_prescalar)))
+				{
+					timer->clock = ((0x10000 - timer->counter) * timer->prescalar);
+				}
 			}
 
 			break;
@@ -3911,6 +3974,12 @@ void NTR_MMU::write_u8(u32 address, u8 value)
 				//Grab pointer to NDS9 or NDS7 Timer 3
 				nds_timer* timer = (access_mode) ? &nds9_timer->at(3) : &nds7_timer->at(3);
 
+				//Finish counting with the old settings first
+				sync_timer(timer);
+
+				bool was_counting = (timer->enable && !timer->count_up);
+				u32 prev_prescalar = timer->prescalar;
+
 				bool prev_enable = (timer->cnt & 0x80) ?  true : false;
 				timer->cnt &= (address & 0x1) ? 0xFF : 0xFF00;
 				timer->cnt |= (address & 0x1) ? (value << 8) : value;
@@ -3930,7 +3999,11 @@ void NTR_MMU::write_u8(u32 address, u8 value)
 
 				if(timer->count_up) { timer->prescalar = 1; }
 
-				timer->clock = timer->prescalar; 
+				//Count down to the next overflow - Keep partial prescaler progress if the timer runs on at the same rate
+				if(timer->enable && !timer->count_up && (!was_counting || (timer->prescalar != prev_prescalar)))
+				{
+					timer->clock = ((0x10000 - timer->counter) * timer->prescalar);
+				}
 			}
 
 			break;
@@ -4826,37 +4899,40 @@ void NTR_MMU::write_u8(u32 address, u8 value)
 				apu_stat->channel[apu_io_id].volume = (apu_stat->channel[apu_io_id].cnt & 0x7F);
 				u8 format = ((apu_stat->channel[apu_io_id].cnt >> 29) & 0x3);
 
-				//Determine loop start offset and sample length
+				//Restart from the first sample and determine the total sample length
+				apu_stat->channel[apu_io_id].data_pos = 0;
+				apu_stat->channel[apu_io_id].data_frac = 0;
+
 				switch(format)
 				{
 					//PCM8
 					case 0x0:
-						apu_stat->channel[apu_io_id].data_pos = apu_stat->channel[apu_io_id].data_src;
-						apu_stat->channel[apu_io_id].samples = (apu_stat->channel[apu_io_id].length * 4) + (apu_stat->channel[apu_io_id].loop_start * 4);
+						apu_stat->channel[apu_io_id].samples = (apu_stat->channel[apu_io_id].length + apu_stat->channel[apu_io_id].loop_start) * 4;
 						break;
 
 					//PCM16
 					case 0x1:
-						apu_stat->channel[apu_io_id].data_pos = apu_stat->channel[apu_io_id].data_src;
-						apu_stat->channel[apu_io_id].samples = (apu_stat->channel[apu_io_id].length * 2) + (apu_stat->channel[apu_io_id].loop_start * 2);
+						apu_stat->channel[apu_io_id].samples = (apu_stat->channel[apu_io_id].length + apu_stat->channel[apu_io_id].loop_start) * 2;
 						break;
 
 					//IMA-ADPCM
 					case 0x2:
-						apu_stat->channel[apu_io_id].data_pos = apu_stat->channel[apu_io_id].data_src;
-						apu_stat->channel[apu_io_id].samples = ((apu_stat->channel[apu_io_id].length - 1) * 8) + ((apu_stat->channel[apu_io_id].loop_start - 1) * 8);
+						apu_stat->channel[apu_io_id].samples = (apu_stat->channel[apu_io_id].length + apu_stat->channel[apu_io_id].loop_start) * 8;
+						if(apu_stat->channel[apu_io_id].samples) { apu_stat->channel[apu_io_id].samples -= 8; }
 
-						//Grab header
+						//Grab header - Always reload the source address so restarting the channel does not skip ahead
+						apu_stat->channel[apu_io_id].data_src = read_u32_fast(NDS_SOUNDXSAD | (apu_io_id << 8)) & 0x7FFFFFF;
 						apu_stat->channel[apu_io_id].adpcm_header = read_u32(apu_stat->channel[apu_io_id].data_src);
 						apu_stat->channel[apu_io_id].data_src += 4;
 
-						//Set up initial ADPCM stuff
+						//Set up initial ADPCM stuff - Samples are decoded by the APU as the channel plays
 						apu_stat->channel[apu_io_id].adpcm_val = (apu_stat->channel[apu_io_id].adpcm_header & 0xFFFF);
 						apu_stat->channel[apu_io_id].adpcm_index = ((apu_stat->channel[apu_io_id].adpcm_header >> 16) & 0x7F);
-						apu_stat->channel[apu_io_id].adpcm_pos = 0;
+						if(apu_stat->channel[apu_io_id].adpcm_index > 88) { apu_stat->channel[apu_io_id].adpcm_index = 88; }
 
-						//Decode ADPCM audio
-						apu_stat->channel[apu_io_id].decode_adpcm = true;
+						apu_stat->channel[apu_io_id].adpcm_loop_val = apu_stat->channel[apu_io_id].adpcm_val;
+						apu_stat->channel[apu_io_id].adpcm_loop_index = apu_stat->channel[apu_io_id].adpcm_index;
+						apu_stat->channel[apu_io_id].adpcm_pos = 0;
 
 						break;
 
@@ -4868,6 +4944,9 @@ void NTR_MMU::write_u8(u32 address, u8 value)
 							apu_stat->channel[apu_io_id].playing = false;
 						}
 
+						apu_stat->channel[apu_io_id].noise_lfsr = 0x7FFF;
+						apu_stat->channel[apu_io_id].noise_val = -0x7FFF;
+
 						break;
 				}	
 			}
@@ -5029,6 +5108,7 @@ void NTR_MMU::write_u8(u32 address, u8 value)
 			
 		default:
 			memory_map[address] = value;
+			mark_tex_vram(address);
 			break;
 	}
 
@@ -5157,8 +5237,12 @@ void NTR_MMU::write_u16_fast(u32 address, u16 value)
 	//Always force half-word alignment
 	address &= ~0x1;
 
-	memory_map[address] = (value & 0xFF);
-	memory_map[address+1] = ((value >> 8) & 0xFF);
+	//Aligned half-words never straddle pages
+	u8* data = memory_map.get_region_ptr(address, 2);
+	data[0] = (value & 0xFF);
+	data[1] = ((value >> 8) & 0xFF);
+
+	mark_tex_vram(address);
 }
 
 /****** Writes 4 bytes into memory - No checks done on the read, used for known memory locations such as registers ******/
@@ -5167,54 +5251,133 @@ void NTR_MMU::write_u32_fast(u32 address, u32 value)
 	//Always force word alignment
 	address &= ~0x3;
 
-	memory_map[address] = (value & 0xFF);
-	memory_map[address+1] = ((value >> 8) & 0xFF);
-	memory_map[address+2] = ((value >> 16) & 0xFF);
-	memory_map[address+3] = ((value >> 24) & 0xFF);
+	//Aligned words never straddle pages
+	u8* data = memory_map.get_region_ptr(address, 4);
+	data[0] = (value & 0xFF);
+	data[1] = ((value >> 8) & 0xFF);
+	data[2] = ((value >> 16) & 0xFF);
+	data[3] = ((value >> 24) & 0xFF);
+
+	mark_tex_vram(address);
+}
+
+/****** Returns memory that can be accessed directly without side effects - Shortens length to the contiguous part ******/
+u8* NTR_MMU::get_plain_block(u32 address, u32& length, bool write)
+{
+	//Advanced debugging watches every access
+	#ifdef GBE_DEBUG
+	return NULL;
+	#else
+
+	//DTCM takes priority over anything it covers on the NDS9
+	if((access_mode) && (address <= dtcm_end) && ((address + length - 1) >= dtcm_addr)) { return NULL; }
+
+	u32 limit = MEM_PAGE_SIZE - (address & MEM_PAGE_MASK);
+
+	//Main RAM and its mirrors
+	if((address >> 24) == 0x2) { address &= 0x23FFFFF; }
+
+	//NDS9 LCDC VRAM writes only need to mark textures as changed
+	else if((write) && (access_mode) && (address >= 0x6800000) && (address < 0x6880000))
+	{
+		if(length > limit) { length = limit; }
+		if(length > (0x6880000 - address)) { length = (0x6880000 - address); }
+
+		for(u32 x = address; x < (address + length); x += 0x4000) { mark_tex_vram(x); }
+		mark_tex_vram(address + length - 1);
+	}
+
+	else { return NULL; }
+
+	if(length > limit) { length = limit; }
+
+	return &memory_map[address];
+	#endif
+}
+
+/****** Copies plain memory directly - Stops at the first part needing full read/write handling, returns bytes copied ******/
+u32 NTR_MMU::copy_block(u32 dest_addr, u32 src_addr, u32 length)
+{
+	u32 copied = 0;
+
+	while(copied < length)
+	{
+		u32 chunk = length - copied;
+
+		u8* src = get_plain_block(src_addr, chunk, false);
+		if(src == NULL) { break; }
+
+		u8* dest = get_plain_block(dest_addr, chunk, true);
+		if(dest == NULL) { break; }
+
+		//Forward copies onto their own source repeat earlier data, leave those to the normal path
+		if((dest > src) && (dest < (src + chunk))) { break; }
+
+		memmove(dest, src, chunk);
+
+		src_addr += chunk;
+		dest_addr += chunk;
+		copied += chunk;
+	}
+
+	return copied;
+}
+
+/****** Fills plain memory with a 32-bit value directly - Returns bytes filled ******/
+u32 NTR_MMU::fill_block(u32 dest_addr, u32 value, u32 length)
+{
+	u32 filled = 0;
+
+	while(filled < length)
+	{
+		u32 chunk = length - filled;
+
+		u8* dest = get_plain_block(dest_addr, chunk, true);
+		if(dest == NULL) { break; }
+
+		for(u32 x = 0; x < chunk; x++) { dest[x] = (value >> ((x & 0x3) << 3)); }
+
+		dest_addr += chunk;
+		filled += chunk;
+	}
+
+	return filled;
 }
 
 /****** Writes 8 bytes into memory - No checks done on the read, used for known memory locations such as registers ******/
 void NTR_MMU::write_u64_fast(u32 address, u64 value)
 {
-	memory_map[address] = (value & 0xFF);
-	memory_map[address+1] = ((value >> 8) & 0xFF);
-	memory_map[address+2] = ((value >> 16) & 0xFF);
-	memory_map[address+3] = ((value >> 24) & 0xFF);
-
-	value >>= 16;
-	value >>= 16;
-
-	memory_map[address+4] = (value & 0xFF);
-	memory_map[address+5] = ((value >> 8) & 0xFF);
-	memory_map[address+6] = ((value >> 16) & 0xFF);
-	memory_map[address+7] = ((value >> 24) & 0xFF);
+	u8* data = memory_map.get_region_ptr(address, 8);
+
+	for(u32 x = 0; x < 8; x++)
+	{
+		//Fall back to byte writes if this straddles unrelated pages
+		if(data != NULL) { data[x] = (value & 0xFF); }
+		else { memory_map[address + x] = (value & 0xFF); }
+
+		value >>= 8;
+	}
+
+	mark_tex_vram(address);
+	mark_tex_vram(address+7);
 }
 
 /****** Read binary file to memory ******/
 bool NTR_MMU::read_file(std::string filename)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary);
-
-	if(!file.is_open()) 
+	//Map the ROM file read-only instead of reading it, so every process running the same ROM shares its pages
+	//Cart transfers can run a little past the end of the ROM, leave some zero-filled space there
+	if(!cart_data.open(filename, 0, 0x1000, false)) 
 	{
 		std::cout<<"MMU::" << filename << " could not be opened. Check file path or permissions. \n";
 		return false;
 	}
 
-	//Get the file size
-	file.seekg(0, file.end);
-	u32 file_size = file.tellg();
-	file.seekg(0, file.beg);
-
-	cart_data.resize(file_size);
-
-	//Read data from the ROM file
-	file.read(reinterpret_cast<char*> (&cart_data[0]), file_size);
+	u32 file_size = cart_data.size();
 
 	//Copy 368 bytes from header to Main RAM on boot
 	for(u32 x = 0; x < 0x170; x++) { write_u8((0x27FFE00 + x), cart_data[x]); }
 
-	file.close();
 	std::cout<<"MMU::" << filename << " loaded successfully. \n";
 
 	parse_header();
@@ -5557,6 +5720,14 @@ bool NTR_MMU::load_backup(std::string filename)
 		 filename = config::save_path + util::get_filename_from_path(filename);
 	}
 
+	//Fold in a journal left by a crashed session, then journal this one
+	//Imported or exported saves are left alone
+	if((config::save_import_path.empty()) && (config::save_export_path.empty()))
+	{
+		backup_journal::recover(filename);
+		backup.start(filename);
+	}
+
 	//Import save if applicable
 	if(!config::save_import_path.empty()) { filename = config::save_import_path; }
 
@@ -5622,6 +5793,25 @@ bool NTR_MMU::save_backup(std::string filename)
 	return true;
 }
 
+/****** Copies recent changes to cartridge saves into the backup journal ******/
+void NTR_MMU::update_backup_journal()
+{
+	if((!save_data.empty()) && (backup.begin_sync(save_data.size())))
+	{
+		backup.sync_segment(0, &save_data[0], save_data.size());
+		backup.end_sync();
+	}
+}
+
+/****** Works out a running Timer's counter from the cycles left until it overflows ******/
+void NTR_MMU::sync_timer(nds_timer* timer)
+{
+	//Count-up and disabled timers keep their counter as is
+	if((!timer->enable) || (timer->count_up)) { return; }
+
+	timer->counter = 0x10000 - ((timer->clock + timer->prescalar - 1) / timer->prescalar);
+}
+
 /****** Start the DMA channels during HBlanking periods ******/
 void NTR_MMU::start_hblank_dma()
 {
@@ -6075,6 +6265,7 @@ void NTR_MMU::process_aux_spi_bus()
 					while(save_data.size() < nds_aux_spi.access_addr) { save_data.resize(save_data.size() << 1); }
 				}
 
+				backup.mark(nds_aux_spi.access_addr, 1);
 				save_data[nds_aux_spi.access_addr++] = nds_aux_spi.data;
 				nds_aux_spi.access_index++;
 				break;
@@ -6576,6 +6767,8 @@ void NTR_MMU::deallocate_vram(u8 bank_id, u8 mst)
 
 	if(v_addr)
 	{
+		mark_tex_vram_all();
+
 		switch(bank_id)
 		{
 			case 0x0:
@@ -6611,6 +6804,28 @@ void NTR_MMU::deallocate_vram(u8 bank_id, u8 mst)
 	}
 }
 
+/****** Invalidates every texture and texture palette VRAM block ******/
+void NTR_MMU::mark_tex_vram_all()
+{
+	for(u32 x = 0; x < 0x29; x++) { tex_vram_gen[x]++; }
+}
+
+/****** Returns the combined write generation of all texture VRAM blocks covering a range ******/
+u32 NTR_MMU::get_tex_vram_stamp(u32 address, u32 length) const
+{
+	if((address < 0x6800000) || (address >= 0x68A4000) || (length == 0)) { return 0; }
+
+	u32 end = address + length - 1;
+	if(end >= 0x68A4000) { end = 0x68A3FFF; }
+
+	u32 stamp = 0;
+
+	//Generations only ever increase, so any write to a covered block changes the sum
+	for(u32 x = ((address - 0x6800000) >> 14); x <= ((end - 0x6800000) >> 14); x++) { stamp += tex_vram_gen[x]; }
+
+	return stamp;
+}
+
 /****** Points the MMU to an lcd_data structure (FROM THE LCD ITSELF) ******/
 void NTR_MMU::set_lcd_data(ntr_lcd_data* ex_lcd_stat) { lcd_stat = ex_lcd_stat; }
 
@@ -6627,291 +6842,334 @@ void NTR_MMU::set_nds7_pc(u32* ex_pc) { nds7_pc = ex_pc; }
 void NTR_MMU::set_nds9_pc(u32* ex_pc) { nds9_pc = ex_pc; }
 
 /****** Read MMU data from save state ******/
-bool NTR_MMU::mmu_read(u32 offset, std::string filename)
+bool NTR_MMU::mmu_read(save_state_buffer& state)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary);
-	
-	if(!file.is_open()) { return false; }
-
-	//Go to offset
-	file.seekg(offset);
-
 	//Serialize WRAM from save state
 	u8* ex_mem = &memory_map[0x2000000];
-	file.read((char*)ex_mem, 0x400000);
+	state.read((char*)ex_mem, 0x400000);
 
 	//Serialize WRAM from save state
 	ex_mem = &memory_map[0x3000000];
-	file.read((char*)ex_mem, 0x8000);
+	state.read((char*)ex_mem, 0x8000);
 
 	//Serialize WRAM from save state
 	ex_mem = &memory_map[0x3800000];
-	file.read((char*)ex_mem, 0x10000);
+	state.read((char*)ex_mem, 0x10000);
 
 	//Serialize ARM9 IO registers from save state
 	ex_mem = &memory_map[0x4000000];
-	file.read((char*)ex_mem, 0x700);
+	state.read((char*)ex_mem, 0x700);
 
 	ex_mem = &memory_map[0x4001000];
-	file.read((char*)ex_mem, 0x70);
+	state.read((char*)ex_mem, 0x70);
 
 	ex_mem = &memory_map[0x4100000];
-	file.read((char*)ex_mem, 0x4);
+	state.read((char*)ex_mem, 0x4);
 
 	ex_mem = &memory_map[0x4100010];
-	file.read((char*)ex_mem, 0x4);
+	state.read((char*)ex_mem, 0x4);
 	
 	//Serialize palettes from save state
 	ex_mem = &memory_map[0x5000000];
-	file.read((char*)ex_mem, 0x800);
+	state.read((char*)ex_mem, 0x800);
 
 	//Serialize VRAM from save state
 	ex_mem = &memory_map[0x6000000];
-	file.read((char*)ex_mem, 0x80000);
+	state.read((char*)ex_mem, 0x80000);
 
 	ex_mem = &memory_map[0x6200000];
-	file.read((char*)ex_mem, 0x20000);
+	state.read((char*)ex_mem, 0x20000);
 
 	ex_mem = &memory_map[0x6400000];
-	file.read((char*)ex_mem, 0x40000);
+	state.read((char*)ex_mem, 0x40000);
 
 	ex_mem = &memory_map[0x6600000];
-	file.read((char*)ex_mem, 0x20000);
+	state.read((char*)ex_mem, 0x20000);
 
 	ex_mem = &memory_map[0x6800000];
-	file.read((char*)ex_mem, 0xA4000);
+	state.read((char*)ex_mem, 0xA4000);
 
 	//Serialize OAM from save state
 	ex_mem = &memory_map[0x7000000];
-	file.read((char*)ex_mem, 0x800);
+	state.read((char*)ex_mem, 0x800);
 
 	//Serialize DTCM
 	ex_mem = &dtcm[0];
-	file.read((char*)ex_mem, 0x4000);
+	state.read((char*)ex_mem, 0x4000);
+
+	//Serialize ITCM
+	ex_mem = &memory_map[0x0];
+	state.read((char*)ex_mem, 0x8000);
+
+	//Serialize NDS7 VRAM-WRAM and display capture data
+	state.read((char*)&nds7_vwram[0], nds7_vwram.size() * sizeof(nds7_vwram[0]));
+	state.read((char*)&capture_buffer[0], capture_buffer.size() * sizeof(capture_buffer[0]));
+
+	//Serialize cartridge backup
+	state.read_vector(save_data);
+
+	//Loaded save data may differ anywhere, let the journal compare all of it
+	backup.mark(0, save_data.size());
 
 	//Serialize misc data from MMU from save state
-	file.read((char*)&current_save_type, sizeof(current_save_type));
-	file.read((char*)&gba_save_type, sizeof(gba_save_type));
-	file.read((char*)&current_slot2_device, sizeof(current_slot2_device));
+	state.read((char*)&current_save_type, sizeof(current_save_type));
+	state.read((char*)&gba_save_type, sizeof(gba_save_type));
+	state.read((char*)&current_slot2_device, sizeof(current_slot2_device));
 
 	//Serialize IPC from save state
-	file.read((char*)&nds7_ipc.sync, sizeof(nds7_ipc.sync));
-	file.read((char*)&nds7_ipc.cnt, sizeof(nds7_ipc.cnt));
-	file.read((char*)&nds7_ipc.fifo, sizeof(nds7_ipc.fifo));
-	file.read((char*)&nds7_ipc.fifo_latest, sizeof(nds7_ipc.fifo_latest));
-	file.read((char*)&nds7_ipc.fifo_incoming, sizeof(nds7_ipc.fifo_incoming));
-
-	file.read((char*)&nds9_ipc.sync, sizeof(nds9_ipc.sync));
-	file.read((char*)&nds9_ipc.cnt, sizeof(nds9_ipc.cnt));
-	file.read((char*)&nds9_ipc.fifo, sizeof(nds9_ipc.fifo));
-	file.read((char*)&nds9_ipc.fifo_latest, sizeof(nds9_ipc.fifo_latest));
-	file.read((char*)&nds9_ipc.fifo_incoming, sizeof(nds9_ipc.fifo_incoming));
+	state.read((char*)&nds7_ipc.sync, sizeof(nds7_ipc.sync));
+	state.read((char*)&nds7_ipc.cnt, sizeof(nds7_ipc.cnt));
+	state.read_queue(nds7_ipc.fifo);
+	state.read((char*)&nds7_ipc.fifo_latest, sizeof(nds7_ipc.fifo_latest));
+	state.read((char*)&nds7_ipc.fifo_incoming, sizeof(nds7_ipc.fifo_incoming));
+
+	state.read((char*)&nds9_ipc.sync, sizeof(nds9_ipc.sync));
+	state.read((char*)&nds9_ipc.cnt, sizeof(nds9_ipc.cnt));
+	state.read_queue(nds9_ipc.fifo);
+	state.read((char*)&nds9_ipc.fifo_latest, sizeof(nds9_ipc.fifo_latest));
+	state.read((char*)&nds9_ipc.fifo_incoming, sizeof(nds9_ipc.fifo_incoming));
 
 	//Serialize SPI, AUX_SPI, Game Card, RTC, NDS9 Math, and Touchscreen from save state
-	file.read((char*)&nds7_spi, sizeof(nds7_spi));
-	file.read((char*)&nds_aux_spi, sizeof(nds_aux_spi));
-	file.read((char*)&nds_card, sizeof(nds_card));
-	file.read((char*)&nds7_rtc, sizeof(nds7_rtc));
-	file.read((char*)&nds9_math, sizeof(nds9_math));
-	file.read((char*)&touchscreen, sizeof(touchscreen));
+	state.read((char*)&nds7_spi, sizeof(nds7_spi));
+	state.read((char*)&nds_aux_spi, sizeof(nds_aux_spi));
+	state.read((char*)&nds_card, sizeof(nds_card));
+	state.read((char*)&nds7_rtc, sizeof(nds7_rtc));
+	state.read((char*)&nds9_math, sizeof(nds9_math));
+	state.read((char*)&touchscreen, sizeof(touchscreen));
 
 	//Serialize GX data from save state
-	file.read((char*)&nds9_gx_fifo, sizeof(nds9_gx_fifo));
-	file.read((char*)&gx_fifo_entry, sizeof(gx_fifo_entry));
-	file.read((char*)&gx_fifo_param_length, sizeof(gx_fifo_param_length));
+	state.read_queue(nds9_gx_fifo);
+	state.read((char*)&gx_fifo_entry, sizeof(gx_fifo_entry));
+	state.read((char*)&gx_fifo_param_length, sizeof(gx_fifo_param_length));
 
 	//Serialize more misc data from MMU from save state
-	file.read((char*)&n_clock, sizeof(n_clock));
-	file.read((char*)&s_clock, sizeof(s_clock));
-	file.read((char*)&nds9_bios_vector, sizeof(nds9_bios_vector));
-	file.read((char*)&nds9_irq_handler, sizeof(nds9_irq_handler));
-	file.read((char*)&nds7_bios_vector, sizeof(nds7_bios_vector));
-	file.read((char*)&nds7_irq_handler, sizeof(nds7_irq_handler));
-	file.read((char*)&access_mode, sizeof(access_mode));
-	file.read((char*)&wram_mode, sizeof(wram_mode));
-	file.read((char*)&rumble_state, sizeof(rumble_state));
-	file.read((char*)&do_save, sizeof(do_save));
-	file.read((char*)&fetch_request, sizeof(fetch_request));
-	file.read((char*)&gx_command, sizeof(gx_command));
-	file.read((char*)&header, sizeof(header));
+	state.read((char*)&n_clock, sizeof(n_clock));
+	state.read((char*)&s_clock, sizeof(s_clock));
+	state.read((char*)&nds9_bios_vector, sizeof(nds9_bios_vector));
+	state.read((char*)&nds9_irq_handler, sizeof(nds9_irq_handler));
+	state.read((char*)&nds7_bios_vector, sizeof(nds7_bios_vector));
+	state.read((char*)&nds7_irq_handler, sizeof(nds7_irq_handler));
+	state.read((char*)&access_mode, sizeof(access_mode));
+	state.read((char*)&wram_mode, sizeof(wram_mode));
+	state.read((char*)&rumble_state, sizeof(rumble_state));
+	state.read((char*)&do_save, sizeof(do_save));
+	state.read((char*)&fetch_request, sizeof(fetch_request));
+	state.read((char*)&gx_command, sizeof(gx_command));
 
 	//Serialize DMA data from save state
-	for(u32 x = 0; x < 8; x++) { file.read((char*)&dma[x], sizeof(dma[x])); }
+	for(u32 x = 0; x < 8; x++) { state.read((char*)&dma[x], sizeof(dma[x])); }
 
 	//Serialize even more misc data from MMU from save state
-	file.read((char*)&nds9_ie, sizeof(nds9_ie));
-	file.read((char*)&nds9_if, sizeof(nds9_if));
-	file.read((char*)&nds9_temp_if, sizeof(nds9_temp_if));
-	file.read((char*)&nds9_ime, sizeof(nds9_ime));
-	file.read((char*)&power_cnt1, sizeof(power_cnt1));
-	file.read((char*)&nds9_exmem, sizeof(nds9_exmem));
-
-	file.read((char*)&nds7_ie, sizeof(nds7_ie));
-	file.read((char*)&nds7_if, sizeof(nds7_if));
-	file.read((char*)&nds7_temp_if, sizeof(nds7_temp_if));
-	file.read((char*)&nds7_ime, sizeof(nds7_ime));
-	file.read((char*)&power_cnt2, sizeof(power_cnt2));
-	file.read((char*)&nds7_exmem, sizeof(nds7_exmem));
-
-	file.read((char*)&firmware_status, sizeof(firmware_status));
-	file.read((char*)&firmware_state, sizeof(firmware_state));
-	file.read((char*)&firmware_count, sizeof(firmware_count));
-	file.read((char*)&firmware_index, sizeof(firmware_index));
-	file.read((char*)&in_firmware, sizeof(in_firmware));
-	file.read((char*)&touchscreen_state, sizeof(touchscreen_state));
-	file.read((char*)&apu_io_id, sizeof(apu_io_id));
-	file.read((char*)&dtcm_addr, sizeof(dtcm_addr));
-	file.read((char*)&itcm_addr, sizeof(itcm_addr));
-	file.read((char*)&pal_a_bg_slot, sizeof(pal_a_bg_slot));
-	file.read((char*)&pal_a_obj_slot, sizeof(pal_a_obj_slot));
-	file.read((char*)&pal_b_bg_slot, sizeof(pal_b_bg_slot));
-	file.read((char*)&pal_b_obj_slot, sizeof(pal_b_obj_slot));
-	file.read((char*)&vram_tex_slot, sizeof(vram_tex_slot));
-
-	file.close();
-	return true;
+	state.read((char*)&nds9_ie, sizeof(nds9_ie));
+	state.read((char*)&nds9_if, sizeof(nds9_if));
+	state.read((char*)&nds9_temp_if, sizeof(nds9_temp_if));
+	state.read((char*)&nds9_ime, sizeof(nds9_ime));
+	state.read((char*)&power_cnt1, sizeof(power_cnt1));
+	state.read((char*)&nds9_exmem, sizeof(nds9_exmem));
+
+	state.read((char*)&nds7_ie, sizeof(nds7_ie));
+	state.read((char*)&nds7_if, sizeof(nds7_if));
+	state.read((char*)&nds7_temp_if, sizeof(nds7_temp_if));
+	state.read((char*)&nds7_ime, sizeof(nds7_ime));
+	state.read((char*)&power_cnt2, sizeof(power_cnt2));
+	state.read((char*)&nds7_exmem, sizeof(nds7_exmem));
+
+	state.read((char*)&firmware_status, sizeof(firmware_status));
+	state.read((char*)&firmware_state, sizeof(firmware_state));
+	state.read((char*)&firmware_count, sizeof(firmware_count));
+	state.read((char*)&firmware_index, sizeof(firmware_index));
+	state.read((char*)&in_firmware, sizeof(in_firmware));
+	state.read((char*)&touchscreen_state, sizeof(touchscreen_state));
+	state.read((char*)&apu_io_id, sizeof(apu_io_id));
+	state.read((char*)&dtcm_addr, sizeof(dtcm_addr));
+	state.read((char*)&itcm_addr, sizeof(itcm_addr));
+	state.read((char*)&pal_a_bg_slot, sizeof(pal_a_bg_slot));
+	state.read((char*)&pal_a_obj_slot, sizeof(pal_a_obj_slot));
+	state.read((char*)&pal_b_bg_slot, sizeof(pal_b_bg_slot));
+	state.read((char*)&pal_b_obj_slot, sizeof(pal_b_obj_slot));
+	state.read((char*)&vram_tex_slot, sizeof(vram_tex_slot));
+	state.read((char*)&vram_bank_log, sizeof(vram_bank_log));
+	state.read((char*)&bg_vram_bank_enable_a, sizeof(bg_vram_bank_enable_a));
+	state.read((char*)&bg_vram_bank_enable_b, sizeof(bg_vram_bank_enable_b));
+	state.read((char*)&dtcm_end, sizeof(dtcm_end));
+	state.read((char*)&dtcm_load_mode, sizeof(dtcm_load_mode));
+	state.read((char*)&itcm_load_mode, sizeof(itcm_load_mode));
+	state.read((char*)&gx_if, sizeof(gx_if));
+	state.read((char*)&current_slot1_device, sizeof(current_slot1_device));
+
+	//Serialize KEY1 and KEY2 encryption state
+	state.read_vector(key_code);
+	state.read((char*)&key_level, sizeof(key_level));
+	state.read((char*)&key_id, sizeof(key_id));
+	state.read((char*)&key_2_x, sizeof(key_2_x));
+	state.read((char*)&key_2_y, sizeof(key_2_y));
+
+	//VRAM contents were replaced wholesale, so any cached textures are stale
+	mark_tex_vram_all();
+
+	return state.good();
 }
 
 /****** Write MMU data to save state ******/
-bool NTR_MMU::mmu_write(std::string filename)
+bool NTR_MMU::mmu_write(save_state_buffer& state)
 {
-	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::app);
-	
-	if(!file.is_open()) { return false; }
-
 	//Serialize WRAM to save state
 	u8* ex_mem = &memory_map[0x2000000];
-	file.write((char*)ex_mem, 0x400000);
+	state.write((char*)ex_mem, 0x400000);
 
 	//Serialize WRAM to save state
 	ex_mem = &memory_map[0x3000000];
-	file.write((char*)ex_mem, 0x8000);
+	state.write((char*)ex_mem, 0x8000);
 
 	//Serialize WRAM to save state
 	ex_mem = &memory_map[0x3800000];
-	file.write((char*)ex_mem, 0x10000);
+	state.write((char*)ex_mem, 0x10000);
 
 	//Serialize ARM9 IO registers to save state
 	ex_mem = &memory_map[0x4000000];
-	file.write((char*)ex_mem, 0x700);
+	state.write((char*)ex_mem, 0x700);
 
 	ex_mem = &memory_map[0x4001000];
-	file.write((char*)ex_mem, 0x70);
+	state.write((char*)ex_mem, 0x70);
 
 	ex_mem = &memory_map[0x4100000];
-	file.write((char*)ex_mem, 0x4);
+	state.write((char*)ex_mem, 0x4);
 
 	ex_mem = &memory_map[0x4100010];
-	file.write((char*)ex_mem, 0x4);
+	state.write((char*)ex_mem, 0x4);
 	
 	//Serialize palettes to save state
 	ex_mem = &memory_map[0x5000000];
-	file.write((char*)ex_mem, 0x800);
+	state.write((char*)ex_mem, 0x800);
 
 	//Serialize VRAM to save state
 	ex_mem = &memory_map[0x6000000];
-	file.write((char*)ex_mem, 0x80000);
+	state.write((char*)ex_mem, 0x80000);
 
 	ex_mem = &memory_map[0x6200000];
-	file.write((char*)ex_mem, 0x20000);
+	state.write((char*)ex_mem, 0x20000);
 
 	ex_mem = &memory_map[0x6400000];
-	file.write((char*)ex_mem, 0x40000);
+	state.write((char*)ex_mem, 0x40000);
 
 	ex_mem = &memory_map[0x6600000];
-	file.write((char*)ex_mem, 0x20000);
+	state.write((char*)ex_mem, 0x20000);
 
 	ex_mem = &memory_map[0x6800000];
-	file.write((char*)ex_mem, 0xA4000);
+	state.write((char*)ex_mem, 0xA4000);
 
 	//Serialize OAM to save state
 	ex_mem = &memory_map[0x7000000];
-	file.write((char*)ex_mem, 0x800);
+	state.write((char*)ex_mem, 0x800);
 
 	//Serialize DTCM
 	ex_mem = &dtcm[0];
-	file.write((char*)ex_mem, 0x4000);
+	state.write((char*)ex_mem, 0x4000);
+
+	//Serialize ITCM
+	ex_mem = &memory_map[0x0];
+	state.write((char*)ex_mem, 0x8000);
+
+	//Serialize NDS7 VRAM-WRAM and display capture data
+	state.write((char*)&nds7_vwram[0], nds7_vwram.size() * sizeof(nds7_vwram[0]));
+	state.write((char*)&capture_buffer[0], capture_buffer.size() * sizeof(capture_buffer[0]));
+
+	//Serialize cartridge backup
+	state.write_vector(save_data);
 
 	//Serialize misc data to MMU to save state
-	file.write((char*)&current_save_type, sizeof(current_save_type));
-	file.write((char*)&gba_save_type, sizeof(gba_save_type));
-	file.write((char*)&current_slot2_device, sizeof(current_slot2_device));
+	state.write((char*)&current_save_type, sizeof(current_save_type));
+	state.write((char*)&gba_save_type, sizeof(gba_save_type));
+	state.write((char*)&current_slot2_device, sizeof(current_slot2_device));
 
 	//Serialize IPC to save state
-	file.write((char*)&nds7_ipc.sync, sizeof(nds7_ipc.sync));
-	file.write((char*)&nds7_ipc.cnt, sizeof(nds7_ipc.cnt));
-	file.write((char*)&nds7_ipc.fifo, sizeof(nds7_ipc.fifo));
-	file.write((char*)&nds7_ipc.fifo_latest, sizeof(nds7_ipc.fifo_latest));
-	file.write((char*)&nds7_ipc.fifo_incoming, sizeof(nds7_ipc.fifo_incoming));
-
-	file.write((char*)&nds9_ipc.sync, sizeof(nds9_ipc.sync));
-	file.write((char*)&nds9_ipc.cnt, sizeof(nds9_ipc.cnt));
-	file.write((char*)&nds9_ipc.fifo, sizeof(nds9_ipc.fifo));
-	file.write((char*)&nds9_ipc.fifo_latest, sizeof(nds9_ipc.fifo_latest));
-	file.write((char*)&nds9_ipc.fifo_incoming, sizeof(nds9_ipc.fifo_incoming));
+	state.write((char*)&nds7_ipc.sync, sizeof(nds7_ipc.sync));
+	state.write((char*)&nds7_ipc.cnt, sizeof(nds7_ipc.cnt));
+	state.write_queue(nds7_ipc.fifo);
+	state.write((char*)&nds7_ipc.fifo_latest, sizeof(nds7_ipc.fifo_latest));
+	state.write((char*)&nds7_ipc.fifo_incoming, sizeof(nds7_ipc.fifo_incoming));
+
+	state.write((char*)&nds9_ipc.sync, sizeof(nds9_ipc.sync));
+	state.write((char*)&nds9_ipc.cnt, sizeof(nds9_ipc.cnt));
+	state.write_queue(nds9_ipc.fifo);
+	state.write((char*)&nds9_ipc.fifo_latest, sizeof(nds9_ipc.fifo_latest));
+	state.write((char*)&nds9_ipc.fifo_incoming, sizeof(nds9_ipc.fifo_incoming));
 
 	//Serialize SPI, AUX_SPI, Game Card, RTC, NDS9 Math, and Touchscreen to save state
-	file.write((char*)&nds7_spi, sizeof(nds7_spi));
-	file.write((char*)&nds_aux_spi, sizeof(nds_aux_spi));
-	file.write((char*)&nds_card, sizeof(nds_card));
-	file.write((char*)&nds7_rtc, sizeof(nds7_rtc));
-	file.write((char*)&nds9_math, sizeof(nds9_math));
-	file.write((char*)&touchscreen, sizeof(touchscreen));
+	state.write((char*)&nds7_spi, sizeof(nds7_spi));
+	state.write((char*)&nds_aux_spi, sizeof(nds_aux_spi));
+	state.write((char*)&nds_card, sizeof(nds_card));
+	state.write((char*)&nds7_rtc, sizeof(nds7_rtc));
+	state.write((char*)&nds9_math, sizeof(nds9_math));
+	state.write((char*)&touchscreen, sizeof(touchscreen));
 
 	//Serialize GX data to save state
-	file.write((char*)&nds9_gx_fifo, sizeof(nds9_gx_fifo));
-	file.write((char*)&gx_fifo_entry, sizeof(gx_fifo_entry));
-	file.write((char*)&gx_fifo_param_length, sizeof(gx_fifo_param_length));
+	state.write_queue(nds9_gx_fifo);
+	state.write((char*)&gx_fifo_entry, sizeof(gx_fifo_entry));
+	state.write((char*)&gx_fifo_param_length, sizeof(gx_fifo_param_length));
 
 	//Serialize more misc data from MMU to save state
-	file.write((char*)&n_clock, sizeof(n_clock));
-	file.write((char*)&s_clock, sizeof(s_clock));
-	file.write((char*)&nds9_bios_vector, sizeof(nds9_bios_vector));
-	file.write((char*)&nds9_irq_handler, sizeof(nds9_irq_handler));
-	file.write((char*)&nds7_bios_vector, sizeof(nds7_bios_vector));
-	file.write((char*)&nds7_irq_handler, sizeof(nds7_irq_handler));
-	file.write((char*)&access_mode, sizeof(access_mode));
-	file.write((char*)&wram_mode, sizeof(wram_mode));
-	file.write((char*)&rumble_state, sizeof(rumble_state));
-	file.write((char*)&do_save, sizeof(do_save));
-	file.write((char*)&fetch_request, sizeof(fetch_request));
-	file.write((char*)&gx_command, sizeof(gx_command));
-	file.write((char*)&header, sizeof(header));
+	state.write((char*)&n_clock, sizeof(n_clock));
+	state.write((char*)&s_clock, sizeof(s_clock));
+	state.write((char*)&nds9_bios_vector, sizeof(nds9_bios_vector));
+	state.write((char*)&nds9_irq_handler, sizeof(nds9_irq_handler));
+	state.write((char*)&nds7_bios_vector, sizeof(nds7_bios_vector));
+	state.write((char*)&nds7_irq_handler, sizeof(nds7_irq_handler));
+	state.write((char*)&access_mode, sizeof(access_mode));
+	state.write((char*)&wram_mode, sizeof(wram_mode));
+	state.write((char*)&rumble_state, sizeof(rumble_state));
+	state.write((char*)&do_save, sizeof(do_save));
+	state.write((char*)&fetch_request, sizeof(fetch_request));
+	state.write((char*)&gx_command, sizeof(gx_command));
 
 	//Serialize DMA data to save state
-	for(u32 x = 0; x < 8; x++) { file.write((char*)&dma[x], sizeof(dma[x])); }
+	for(u32 x = 0; x < 8; x++) { state.write((char*)&dma[x], sizeof(dma[x])); }
 
 	//Serialize even more misc data to MMU to save state
-	file.write((char*)&nds9_ie, sizeof(nds9_ie));
-	file.write((char*)&nds9_if, sizeof(nds9_if));
-	file.write((char*)&nds9_temp_if, sizeof(nds9_temp_if));
-	file.write((char*)&nds9_ime, sizeof(nds9_ime));
-	file.write((char*)&power_cnt1, sizeof(power_cnt1));
-	file.write((char*)&nds9_exmem, sizeof(nds9_exmem));
-
-	file.write((char*)&nds7_ie, sizeof(nds7_ie));
-	file.write((char*)&nds7_if, sizeof(nds7_if));
-	file.write((char*)&nds7_temp_if, sizeof(nds7_temp_if));
-	file.write((char*)&nds7_ime, sizeof(nds7_ime));
-	file.write((char*)&power_cnt2, sizeof(power_cnt2));
-	file.write((char*)&nds7_exmem, sizeof(nds7_exmem));
-
-	file.write((char*)&firmware_status, sizeof(firmware_status));
-	file.write((char*)&firmware_state, sizeof(firmware_state));
-	file.write((char*)&firmware_count, sizeof(firmware_count));
-	file.write((char*)&firmware_index, sizeof(firmware_index));
-	file.write((char*)&in_firmware, sizeof(in_firmware));
-	file.write((char*)&touchscreen_state, sizeof(touchscreen_state));
-	file.write((char*)&apu_io_id, sizeof(apu_io_id));
-	file.write((char*)&dtcm_addr, sizeof(dtcm_addr));
-	file.write((char*)&itcm_addr, sizeof(itcm_addr));
-	file.write((char*)&pal_a_bg_slot, sizeof(pal_a_bg_slot));
-	file.write((char*)&pal_a_obj_slot, sizeof(pal_a_obj_slot));
-	file.write((char*)&pal_b_bg_slot, sizeof(pal_b_bg_slot));
-	file.write((char*)&pal_b_obj_slot, sizeof(pal_b_obj_slot));
-	file.write((char*)&vram_tex_slot, sizeof(vram_tex_slot));
+	state.write((char*)&nds9_ie, sizeof(nds9_ie));
+	state.write((char*)&nds9_if, sizeof(nds9_if));
+	state.write((char*)&nds9_temp_if, sizeof(nds9_temp_if));
+	state.write((char*)&nds9_ime, sizeof(nds9_ime));
+	state.write((char*)&power_cnt1, sizeof(power_cnt1));
+	state.write((char*)&nds9_exmem, sizeof(nds9_exmem));
+
+	state.write((char*)&nds7_ie, sizeof(nds7_ie));
+	state.write((char*)&nds7_if, sizeof(nds7_if));
+	state.write((char*)&nds7_temp_if, sizeof(nds7_temp_if));
+	state.write((char*)&nds7_ime, sizeof(nds7_ime));
+	state.write((char*)&power_cnt2, sizeof(power_cnt2));
+	state.write((char*)&nds7_exmem, sizeof(nds7_exmem));
+
+	state.write((char*)&firmware_status, sizeof(firmware_status));
+	state.write((char*)&firmware_state, sizeof(firmware_state));
+	state.write((char*)&firmware_count, sizeof(firmware_count));
+	state.write((char*)&firmware_index, sizeof(firmware_index));
+	state.write((char*)&in_firmware, sizeof(in_firmware));
+	state.write((char*)&touchscreen_state, sizeof(touchscreen_state));
+	state.write((char*)&apu_io_id, sizeof(apu_io_id));
+	state.write((char*)&dtcm_addr, sizeof(dtcm_addr));
+	state.write((char*)&itcm_addr, sizeof(itcm_addr));
+	state.write((char*)&pal_a_bg_slot, sizeof(pal_a_bg_slot));
+	state.write((char*)&pal_a_obj_slot, sizeof(pal_a_obj_slot));
+	state.write((char*)&pal_b_bg_slot, sizeof(pal_b_bg_slot));
+	state.write((char*)&pal_b_obj_slot, sizeof(pal_b_obj_slot));
+	state.write((char*)&vram_tex_slot, sizeof(vram_tex_slot));
+	state.write((char*)&vram_bank_log, sizeof(vram_bank_log));
+	state.write((char*)&bg_vram_bank_enable_a, sizeof(bg_vram_bank_enable_a));
+	state.write((char*)&bg_vram_bank_enable_b, sizeof(bg_vram_bank_enable_b));
+	state.write((char*)&dtcm_end, sizeof(dtcm_end));
+	state.write((char*)&dtcm_load_mode, sizeof(dtcm_load_mode));
+	state.write((char*)&itcm_load_mode, sizeof(itcm_load_mode));
+	state.write((char*)&gx_if, sizeof(gx_if));
+	state.write((char*)&current_slot1_device, sizeof(current_slot1_device));
+
+	//Serialize KEY1 and KEY2 encryption state
+	state.write_vector(key_code);
+	state.write((char*)&key_level, sizeof(key_level));
+	state.write((char*)&key_id, sizeof(key_id));
+	state.write((char*)&key_2_x, sizeof(key_2_x));
+	state.write((char*)&key_2_y, sizeof(key_2_y));
 
-	file.close();
 	return true;
 }
 
@@ -6920,19 +7178,24 @@ u32 NTR_MMU::size()
 {
 	u32 mmu_size = 0x5C1778;
 
+	mmu_size += 0x8000;
+	mmu_size += nds7_vwram.size();
+	mmu_size += (capture_buffer.size() * sizeof(u32));
+	mmu_size += sizeof(u32) + save_data.size();
+
 	mmu_size += sizeof(current_save_type);
 	mmu_size += sizeof(gba_save_type);
 	mmu_size += sizeof(current_slot2_device);
 
 	mmu_size += sizeof(nds7_ipc.sync);
 	mmu_size += sizeof(nds7_ipc.cnt);
-	mmu_size += sizeof(nds7_ipc.fifo);
+	mmu_size += sizeof(u32) + (nds7_ipc.fifo.size() * sizeof(u32));
 	mmu_size += sizeof(nds7_ipc.fifo_latest);
 	mmu_size += sizeof(nds7_ipc.fifo_incoming);
 
 	mmu_size += sizeof(nds9_ipc.sync);
 	mmu_size += sizeof(nds9_ipc.cnt);
-	mmu_size += sizeof(nds9_ipc.fifo);
+	mmu_size += sizeof(u32) + (nds9_ipc.fifo.size() * sizeof(u32));
 	mmu_size += sizeof(nds9_ipc.fifo_latest);
 	mmu_size += sizeof(nds9_ipc.fifo_incoming);
 
@@ -6943,7 +7206,7 @@ u32 NTR_MMU::size()
 	mmu_size += sizeof(nds9_math);
 	mmu_size += sizeof(touchscreen);
 
-	mmu_size += sizeof(nds9_gx_fifo);
+	mmu_size += sizeof(u32) + (nds9_gx_fifo.size() * sizeof(u32));
 	mmu_size += sizeof(gx_fifo_entry);
 	mmu_size += sizeof(gx_fifo_param_length);
 
@@ -6959,7 +7222,6 @@ u32 NTR_MMU::size()
 	mmu_size += sizeof(do_save);
 	mmu_size += sizeof(fetch_request);
 	mmu_size += sizeof(gx_command);
-	mmu_size += sizeof(header);
 
 	for(u32 x = 0; x < 8; x++) { mmu_size += sizeof(dma[x]); }
 
@@ -6991,6 +7253,20 @@ u32 NTR_MMU::size()
 	mmu_size += sizeof(pal_b_bg_slot);
 	mmu_size += sizeof(pal_b_obj_slot);
 	mmu_size += sizeof(vram_tex_slot);
+	mmu_size += sizeof(vram_bank_log);
+	mmu_size += sizeof(bg_vram_bank_enable_a);
+	mmu_size += sizeof(bg_vram_bank_enable_b);
+	mmu_size += sizeof(dtcm_end);
+	mmu_size += sizeof(dtcm_load_mode);
+	mmu_size += sizeof(itcm_load_mode);
+	mmu_size += sizeof(gx_if);
+	mmu_size += sizeof(current_slot1_device);
+
+	mmu_size += sizeof(u32) + (key_code.size() * sizeof(u32));
+	mmu_size += sizeof(key_level);
+	mmu_size += sizeof(key_id);
+	mmu_size += sizeof(key_2_x);
+	mmu_size += sizeof(key_2_y);
 
 	return mmu_size;
 }
@@ -21,6 +21,10 @@
 #include "gamepad.h"
 #include "timer.h"
 #include "common/config.h"
+#include "common/paged_memory.h"
+#include "common/mapped_file.h"
+#include "common/backup_journal.h"
+#include "common/save_state.h"
 #include "lcd_data.h"
 #include "apu_data.h"
 
@@ -75,8 +79,9 @@ class NTR_MMU
 	slot1_types current_slot1_device;
 	slot2_types current_slot2_device;
 
-	std::vector <u8> memory_map;
-	std::vector <u8> cart_data;
+	paged_memory_map memory_map;
+	mapped_file cart_data;
+	backup_journal backup;
 	std::vector <u8> nds7_bios;
 	std::vector <u8> nds9_bios;
 	std::vector <u8> firmware;
@@ -379,6 +384,9 @@ class NTR_MMU
 	u32 vram_tex_slot[4];
 	u32 vram_bank_log[9][5];
 
+	//Write generations for texture and texture palette VRAM (0x6800000 - 0x68A3FFF), one per 16KB block
+	u32 tex_vram_gen[0x29];
+
 	bool bg_vram_bank_enable_a;
 	bool bg_vram_bank_enable_b;
 
@@ -395,6 +403,8 @@ class NTR_MMU
 
 	void reset();
 
+	void sync_timer(nds_timer* timer);
+
 	void start_hblank_dma();
 	void start_vblank_dma();
 	void start_gxfifo_dma();
@@ -415,6 +425,10 @@ class NTR_MMU
 	void write_u32_fast(u32 address, u32 value);
 	void write_u64_fast(u32 address, u64 value);
 
+	u8* get_plain_block(u32 address, u32& length, bool write);
+	u32 copy_block(u32 dest_addr, u32 src_addr, u32 length);
+	u32 fill_block(u32 dest_addr, u32 value, u32 length);
+
 	u16 read_cart_u16(u32 address) const;
 	u32 read_cart_u32(u32 address) const;
 
@@ -425,6 +439,7 @@ class NTR_MMU
 	bool read_firmware(std::string filename);
 	bool save_backup(std::string filename);
 	bool load_backup(std::string filename);
+	void update_backup_journal();
 
 	void process_spi_bus();
 	void process_aux_spi_bus();
@@ -449,6 +464,11 @@ class NTR_MMU
 	void copy_capture_buffer(u32 capture_addr);
 	void deallocate_vram(u8 bank_id, u8 mst);
 
+	//Tracks writes to VRAM that may hold textures or texture palettes
+	void mark_tex_vram(u32 address) { if((address >= 0x6800000) && (address < 0x68A4000)) { tex_vram_gen[(address - 0x6800000) >> 14]++; } }
+	void mark_tex_vram_all();
+	u32 get_tex_vram_stamp(u32 address, u32 length) const;
+
 	void set_lcd_data(ntr_lcd_data* ex_lcd_stat);
 	void set_lcd_3D_data(ntr_lcd_3D_data* ex_lcd_3D_stat);
 	void set_apu_data(ntr_apu_data* ex_apu_stat);
@@ -471,8 +491,8 @@ class NTR_MMU
 	std::vector<nds_timer>* nds9_timer;
 
 	//Serialize data for save state loading/saving
-	bool mmu_read(u32 offset, std::string filename);
-	bool mmu_write(std::string filename);
+	bool mmu_read(save_state_buffer& state);
+	bool mmu_write(save_state_buffer& state);
 	u32 size();
 
 	private:
@@ -14,6 +14,7 @@
 
 #include "common.h"
 
+//Running timers count clock down to the next overflow, counter is only updated when read or written
 struct nds_timer
 {
 	u32 clock;
@@ -1228,25 +1228,20 @@ void dmg_debug::close_debug()
 
 	qt_gui::draw_surface->findChild<QAction*>("pause_action")->setEnabled(true);
 
-	if(main_menu::gbe_plus->db_unit.last_command != "c")
-	{
-		main_menu::gbe_plus->db_unit.debug_mode = false;
-		main_menu::gbe_plus->db_unit.last_command = "dq";
-	}
+	//When stopped at a step, the step itself restores the pause state after seeing "dq"
+	bool stepping = qt_gui::draw_surface->emu->is_debug_stepping();
 
-	else
-	{
-		main_menu::gbe_plus->db_unit.debug_mode = false;
-		main_menu::gbe_plus->db_unit.last_command = "dq";
+	//Also clears existing breakpoints
+	qt_gui::draw_surface->emu->stop_debugging();
 
+	if(!stepping)
+	{
 		main_menu::dmg_debugger->pause = false;
 		config::pause_emu = main_menu::dmg_debugger->old_pause;
 		qt_gui::draw_surface->pause_emu();
 	}
 
-	//Clear existing breakpoints on close
 	main_menu::dmg_debugger->dasm->setText(main_menu::dmg_debugger->dasm_text);
-	main_menu::gbe_plus->db_unit.breakpoints.clear();
 
 	//Clear format manually
 	QTextCursor cursor(dasm->textCursor());
@@ -1603,7 +1598,7 @@ void dmg_debug::refresh()
 	text_select = true;
 	highlight();
 
-	if(main_menu::gbe_plus->db_unit.last_command != "c") { main_menu::gbe_plus->db_unit.last_command = ""; }
+	if((qt_gui::draw_surface->emu->is_debug_stepping()) && (main_menu::gbe_plus->db_unit.last_command != "c")) { main_menu::gbe_plus->db_unit.last_command = ""; }
 
 	//Update OBJ
 	for(int x = 0; x < 40; x++)
@@ -1890,28 +1885,28 @@ void dmg_debug::clear_format()
 }
 
 /****** Moves the debugger one instruction in disassembly ******/
-void dmg_debug::db_next() { main_menu::gbe_plus->db_unit.last_command = "n"; }
+void dmg_debug::db_next() { qt_gui::draw_surface->emu->debug_command("n"); }
 
 /****** Continues emulation until debugger hits breakpoint ******/
-void dmg_debug::db_continue() { main_menu::gbe_plus->db_unit.last_command = "c"; }
+void dmg_debug::db_continue() { qt_gui::draw_surface->emu->debug_command("c"); }
 
 /****** Sets breakpoint at current PC ******/
 void dmg_debug::db_set_bp() 
 {
-	if(main_menu::gbe_plus->db_unit.last_command != "c") { main_menu::gbe_plus->db_unit.last_command = "bp"; }
+	if((qt_gui::draw_surface->emu->is_debug_stepping()) && (main_menu::gbe_plus->db_unit.last_command != "c")) { qt_gui::draw_surface->emu->debug_command("bp"); }
 }
 
 /****** Clears all breakpoints ******/
 void dmg_debug::db_clear_bp()
 {
-	if(main_menu::gbe_plus->db_unit.last_command != "c") { main_menu::gbe_plus->db_unit.last_command = "cbp"; }
+	if((qt_gui::draw_surface->emu->is_debug_stepping()) && (main_menu::gbe_plus->db_unit.last_command != "c")) { qt_gui::draw_surface->emu->debug_command("cbp"); }
 }
 
 /****** Resets emulation then stops ******/
-void dmg_debug::db_reset() { main_menu::gbe_plus->db_unit.last_command = "rs"; }
+void dmg_debug::db_reset() { qt_gui::draw_surface->emu->debug_command("rs"); }
 
 /****** Resets emulation and runs in continue mode ******/
-void dmg_debug::db_reset_run() { main_menu::gbe_plus->db_unit.last_command = "rsr"; }
+void dmg_debug::db_reset_run() { qt_gui::draw_surface->emu->debug_command("rsr"); }
 
 /****** Steps through the debugger via the GUI ******/
 void dmg_debug_step()
@@ -1945,6 +1940,9 @@ void dmg_debug_step()
 	{
 		SDL_Delay(16);
 		QApplication::processEvents();
+
+		//The core may have been closed from the GUI while waiting here
+		if(!qt_gui::draw_surface->emu->is_started()) { return; }
 		if(SDL_GetAudioStatus() != SDL_AUDIO_PAUSED) { SDL_PauseAudio(1); }
 
 		//Step once
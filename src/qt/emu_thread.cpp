@@ -0,0 +1,249 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : emu_thread.cpp
+// Date : October 16, 2026
+// Description : Qt emulation thread
+//
+// Runs the active core outside of the GUI thread
+// Input and other requests from the GUI are queued and handled by the core once per frame
+
+#include "emu_thread.h"
+#include "render.h"
+#include "debug_dmg.h"
+
+#include "common/config.h"
+
+/****** Emulation thread constructor ******/
+emu_thread::emu_thread(QObject* parent) : QThread(parent)
+{
+	current_core = NULL;
+	started = false;
+	quit = false;
+	touch_by_mouse = false;
+	debug_waiting = false;
+	debug_stepping = false;
+}
+
+/****** Starts running a core that has already been started ******/
+void emu_thread::boot(core_emu* core)
+{
+	stop();
+
+	current_core = core;
+	started = true;
+	quit = false;
+	touch_by_mouse = false;
+	debug_waiting = false;
+
+	start();
+}
+
+/****** Stops emulation and waits for the core to shut itself down ******/
+void emu_thread::stop()
+{
+	if(!started) { return; }
+
+	//Release the core if it is waiting on a debugger step, otherwise it never sees the request to stop
+	debug_lock.lock();
+	quit = true;
+	debug_done.wakeAll();
+	debug_lock.unlock();
+
+	current_core->running = false;
+	wait();
+
+	//Requests for this core are dropped, anything queued before the next boot goes to the next core
+	command_lock.lock();
+	commands.clear();
+	command_lock.unlock();
+
+	started = false;
+	current_core = NULL;
+}
+
+/****** Thread entry point ******/
+void emu_thread::run()
+{
+	current_core->run_core();
+}
+
+/****** Queues a key or touchscreen input for the core ******/
+void emu_thread::feed_key_input(int input, bool pressed) { push_command(KEY_INPUT, input, pressed); }
+
+/****** Queues saving a save state ******/
+void emu_thread::save_state(u8 slot) { push_command(SAVE_STATE, slot, true); }
+
+/****** Queues loading a save state ******/
+void emu_thread::load_state(u8 slot) { push_command(LOAD_STATE, slot, true); }
+
+/****** Queues starting netplay ******/
+void emu_thread::start_netplay() { push_command(START_NETPLAY, 0, true); }
+
+/****** Queues stopping netplay ******/
+void emu_thread::stop_netplay() { push_command(STOP_NETPLAY, 0, true); }
+
+/****** Queues a volume change ******/
+void emu_thread::set_volume(u8 volume) { push_command(SET_VOLUME, volume, true); }
+
+/****** Queues loading a new card file - Emits card_file_failed() if the core rejects it ******/
+void emu_thread::load_card_file(std::string filename) { push_command(LOAD_CARD_FILE, 0, true, filename); }
+
+/****** Queues switching the external data file - Soul Doll data is saved and reloaded around the switch ******/
+void emu_thread::swap_data_file(std::string filename, bool soul_doll) { push_command(SWAP_DATA_FILE, 0, soul_doll, filename); }
+
+/****** Queues turning on the debugger ******/
+void emu_thread::start_debugging() { push_command(START_DEBUGGING, 0, true); }
+
+/****** Turns off the debugger - Applied immediately while stopped at a step, queued otherwise ******/
+void emu_thread::stop_debugging()
+{
+	if(debug_stepping) { run_debug_command(STOP_DEBUGGING, ""); }
+	else { push_command(STOP_DEBUGGING, 0, true); }
+}
+
+/****** Sends a command to the debugger - Applied immediately while stopped at a step, queued otherwise ******/
+void emu_thread::debug_command(std::string command)
+{
+	if(debug_stepping) { run_debug_command(DEBUG_COMMAND, command); }
+	else { push_command(DEBUG_COMMAND, 0, true, command); }
+}
+
+/****** Changes the core's debugging state - Only safe on the emulation thread or while it waits on a step ******/
+void emu_thread::run_debug_command(command_type type, std::string text)
+{
+	switch(type)
+	{
+		case START_DEBUGGING:
+			current_core->db_unit.debug_mode = true;
+			break;
+
+		case STOP_DEBUGGING:
+			current_core->db_unit.debug_mode = false;
+			current_core->db_unit.last_command = "dq";
+			current_core->db_unit.breakpoints.clear();
+			break;
+
+		case DEBUG_COMMAND:
+			current_core->db_unit.last_command = text;
+			break;
+
+		default: break;
+	}
+}
+
+/****** Adds a request from the GUI thread ******/
+void emu_thread::push_command(command_type type, int value, bool pressed, std::string text)
+{
+	command cmd;
+	cmd.type = type;
+	cmd.value = value;
+	cmd.pressed = pressed;
+	cmd.text = text;
+
+	command_lock.lock();
+	commands.push_back(cmd);
+	command_lock.unlock();
+}
+
+/****** Runs all queued requests on the emulation thread ******/
+void emu_thread::process_commands()
+{
+	//Take the whole queue at once so the GUI thread is never held up by the core
+	command_lock.lock();
+	current_commands.swap(commands);
+	command_lock.unlock();
+
+	for(u32 x = 0; x < current_commands.size(); x++)
+	{
+		command& cmd = current_commands[x];
+
+		switch(cmd.type)
+		{
+			case KEY_INPUT: current_core->feed_key_input(cmd.value, cmd.pressed); break;
+			case SAVE_STATE: current_core->save_state(cmd.value); break;
+			case START_NETPLAY: current_core->start_netplay(); break;
+			case STOP_NETPLAY: current_core->stop_netplay(); break;
+			case SET_VOLUME: current_core->update_volume(cmd.value); break;
+
+			case LOAD_CARD_FILE:
+				config::external_card_file = cmd.text;
+				if(current_core->get_core_data(1) == 0) { emit card_file_failed(QString::fromStdString(cmd.text)); }
+				break;
+
+			case SWAP_DATA_FILE:
+				if(cmd.pressed) { current_core->get_core_data(1); }
+				config::external_data_file = cmd.text;
+				if(cmd.pressed) { current_core->get_core_data(2); }
+				break;
+
+			case START_DEBUGGING:
+			case STOP_DEBUGGING:
+			case DEBUG_COMMAND:
+				run_debug_command(cmd.type, cmd.text);
+				break;
+
+			case LOAD_STATE:
+				current_core->load_state(cmd.value);
+				emit state_loaded();
+				break;
+		}
+	}
+
+	current_commands.clear();
+}
+
+/****** Called by the core after every frame ******/
+void emu_thread::end_frame()
+{
+	process_commands();
+
+	if(config::gb_type == 4) { touch_by_mouse = (current_core->get_core_data(2) != 0); }
+
+	//Hold emulation while paused from the GUI, but keep handling requests
+	while((config::pause_emu) && (!quit))
+	{
+		SDL_Delay(16);
+		process_commands();
+	}
+}
+
+/****** Runs the GUI debugger on the GUI thread while the core waits ******/
+void emu_thread::debug_step()
+{
+	emu_thread* emu = qt_gui::draw_surface->emu;
+
+	emu->debug_lock.lock();
+
+	if(!emu->quit)
+	{
+		emu->debug_waiting = true;
+		emit emu->debug_step_requested();
+
+		while((emu->debug_waiting) && (!emu->quit)) { emu->debug_done.wait(&emu->debug_lock); }
+	}
+
+	emu->debug_waiting = false;
+	emu->debug_lock.unlock();
+}
+
+/****** Handles one debugger step on the GUI thread, then lets the core continue ******/
+void emu_thread::run_debug_step()
+{
+	//Steps requested by a core that has since stopped are dropped
+	debug_lock.lock();
+	bool waiting = (debug_waiting) && (!quit);
+	debug_lock.unlock();
+
+	if(!waiting) { return; }
+
+	debug_stepping = true;
+	dmg_debug_step();
+	debug_stepping = false;
+
+	debug_lock.lock();
+	debug_waiting = false;
+	debug_done.wakeAll();
+	debug_lock.unlock();
+}
@@ -0,0 +1,111 @@
+// GB Enhanced+ Copyright Daniel Baxter 2026
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : emu_thread.h
+// Date : October 16, 2026
+// Description : Qt emulation thread
+//
+// Runs the active core outside of the GUI thread
+// Input and other requests from the GUI are queued and handled by the core once per frame
+
+#ifndef EMUTHREAD_GBE_QT
+#define EMUTHREAD_GBE_QT
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QString>
+
+#include <atomic>
+#include <vector>
+
+#include "common/core_emu.h"
+
+class emu_thread : public QThread
+{
+	Q_OBJECT
+
+	public:
+	emu_thread(QObject* parent = 0);
+
+	void boot(core_emu* core);
+	void stop();
+	bool is_started() const { return started; }
+
+	void feed_key_input(int input, bool pressed);
+	void save_state(u8 slot);
+	void load_state(u8 slot);
+	void start_netplay();
+	void stop_netplay();
+	void set_volume(u8 volume);
+	void load_card_file(std::string filename);
+	void swap_data_file(std::string filename, bool soul_doll);
+
+	void start_debugging();
+	void stop_debugging();
+	void debug_command(std::string command);
+
+	bool get_touch_by_mouse() const { return touch_by_mouse; }
+	bool is_debug_stepping() const { return debug_stepping; }
+
+	void end_frame();
+
+	static void debug_step();
+	void run_debug_step();
+
+	signals:
+	void debug_step_requested();
+	void state_loaded();
+	void card_file_failed(QString filename);
+
+	protected:
+	void run();
+
+	private:
+	enum command_type
+	{
+		KEY_INPUT,
+		SAVE_STATE,
+		LOAD_STATE,
+		START_NETPLAY,
+		STOP_NETPLAY,
+		SET_VOLUME,
+		LOAD_CARD_FILE,
+		SWAP_DATA_FILE,
+		START_DEBUGGING,
+		STOP_DEBUGGING,
+		DEBUG_COMMAND,
+	};
+
+	struct command
+	{
+		command_type type;
+		int value;
+		bool pressed;
+		std::string text;
+	};
+
+	void push_command(command_type type, int value, bool pressed, std::string text = "");
+	void process_commands();
+	void run_debug_command(command_type type, std::string text);
+
+	core_emu* current_core;
+	bool started;
+	std::atomic<bool> quit;
+
+	//Only the NDS core reports this, polled once per frame for mouse motion
+	std::atomic<bool> touch_by_mouse;
+
+	//The core waits here while the GUI thread runs one debugger step, stop() breaks the wait
+	QMutex debug_lock;
+	QWaitCondition debug_done;
+	bool debug_waiting;
+	bool debug_stepping;
+
+	QMutex command_lock;
+	std::vector<command> commands;
+	std::vector<command> current_commands;
+};
+
+#endif //EMUTHREAD_GBE_QT
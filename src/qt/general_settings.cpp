@@ -2305,7 +2305,7 @@ void gen_settings::volume_change()
 	//Update volume while playing
 	if((main_menu::gbe_plus != NULL) && (sound_on->isChecked()))
 	{
-		main_menu::gbe_plus->update_volume(volume->value());
+		qt_gui::draw_surface->emu->set_volume(volume->value());
 	}
 
 	//Update the volume while using only the GUI
@@ -2324,14 +2324,14 @@ void gen_settings::mute()
 		//Unmute, use slider volume
 		if(sound_on->isChecked())
 		{
-			main_menu::gbe_plus->update_volume(volume->value());
+			qt_gui::draw_surface->emu->set_volume(volume->value());
 			volume->setEnabled(true);
 		}
 
 		//Mute
 		else
 		{
-			main_menu::gbe_plus->update_volume(0);
+			qt_gui::draw_surface->emu->set_volume(0);
 			volume->setEnabled(false);
 		}
 	}
@@ -169,6 +169,12 @@ main_menu::main_menu(QWidget *parent) : QWidget(parent)
 	hw_screen->setMouseTracking(true);
 	hw_screen->installEventFilter(this);
 
+	//Setup emulation thread
+	emu = new emu_thread(this);
+	connect(emu, SIGNAL(debug_step_requested()), this, SLOT(run_debug_step()), Qt::QueuedConnection);
+	connect(emu, SIGNAL(state_loaded()), this, SLOT(update_volume()));
+	connect(emu, SIGNAL(card_file_failed(QString)), this, SLOT(show_card_file_error(QString)));
+
 	QVBoxLayout* layout = new QVBoxLayout;
 	layout->setContentsMargins(0, 0, 0, 0);
 	layout->addWidget(sw_screen);
@@ -366,11 +372,7 @@ void main_menu::open_file()
 	SDL_PauseAudio(0);
 
 	//Close the core
-	if(main_menu::gbe_plus != NULL) 
-	{
-		main_menu::gbe_plus->shutdown();
-		main_menu::gbe_plus->core_emu::~core_emu();
-	}
+	close_core();
 
 	if(use_next_files)
 	{
@@ -427,11 +429,7 @@ void main_menu::open_file()
 void main_menu::open_am3_fldr()
 {
 	//Close the core
-	if(main_menu::gbe_plus != NULL) 
-	{
-		main_menu::gbe_plus->shutdown();
-		main_menu::gbe_plus->core_emu::~core_emu();
-	}
+	close_core();
 
 	config::sdl_render = false;
 	config::render_external_sw = render_screen_sw;
@@ -457,11 +455,7 @@ void main_menu::open_am3_fldr()
 void main_menu::open_no_cart()
 {
 	//Close the core
-	if(main_menu::gbe_plus != NULL) 
-	{
-		main_menu::gbe_plus->shutdown();
-		main_menu::gbe_plus->core_emu::~core_emu();
-	}
+	close_core();
 
 	config::sdl_render = false;
 	config::render_external_sw = render_screen_sw;
@@ -548,22 +542,21 @@ void main_menu::select_card_file()
 	QString filename = QFileDialog::getOpenFileName(this, tr("Open"), "", tr("Binary card data (*.bin)"));
 	if(filename.isNull()) { SDL_PauseAudio(0); return; }
 
-	config::external_card_file = filename.toStdString();
-
 	//Tell DMG-GBC core to update data
-	if((config::gb_type >= 0) && (config::gb_type <= 2) && (main_menu::gbe_plus != NULL))
-	{
-		if(main_menu::gbe_plus->get_core_data(1) == 0)
-		{
-			std::string mesg_text = "The card file: '" + config::external_card_file + "' could not be loaded"; 
-			warning_box->setText(QString::fromStdString(mesg_text));
-			warning_box->show();
-		}
-	}
+	if((config::gb_type >= 0) && (config::gb_type <= 2) && (main_menu::gbe_plus != NULL)) { emu->load_card_file(filename.toStdString()); }
+	else { config::external_card_file = filename.toStdString(); }
 
 	SDL_PauseAudio(0);
 }
 
+/****** Warns about a card file the DMG-GBC core could not load ******/
+void main_menu::show_card_file_error(QString filename)
+{
+	std::string mesg_text = "The card file: '" + filename.toStdString() + "' could not be loaded"; 
+	warning_box->setText(QString::fromStdString(mesg_text));
+	warning_box->show();
+}
+
 /****** Opens GB Camera image file ******/
 void main_menu::select_cam_file()
 {
@@ -598,13 +591,9 @@ void main_menu::select_data_file()
 	QString filename = QFileDialog::getOpenFileName(this, tr("Open"), "", tr("Binary File(*.bin)"));
 	if(filename.isNull()) { SDL_PauseAudio(0); return; }
 
-	//Automatically save Soul Doll data when switching
-	if((main_menu::gbe_plus != NULL) && (config::gb_type == 3) && (config::sio_device == 9)) { gbe_plus->get_core_data(1); }
-
-	config::external_data_file = filename.toStdString();
-
-	//Automatically load Soul Doll data when switching
-	if((main_menu::gbe_plus != NULL) && (config::gb_type == 3) && (config::sio_device == 9)) { gbe_plus->get_core_data(2); }
+	//Automatically save and reload Soul Doll data when switching
+	if(main_menu::gbe_plus != NULL) { emu->swap_data_file(filename.toStdString(), ((config::gb_type == 3) && (config::sio_device == 9))); }
+	else { config::external_data_file = filename.toStdString(); }
 
 	SDL_PauseAudio(0);
 }
@@ -613,11 +602,7 @@ void main_menu::select_data_file()
 void main_menu::quit()
 {
 	//Close the core
-	if(main_menu::gbe_plus != NULL) 
-	{
-		main_menu::gbe_plus->shutdown();
-		main_menu::gbe_plus->core_emu::~core_emu();
-	}
+	close_core();
 
 	//Save .ini options
 	config::gb_type = settings->sys_type->currentIndex();
@@ -983,10 +968,49 @@ void main_menu::boot_game()
 
 	if(main_menu::gbe_plus->db_unit.debug_mode) { SDL_CloseAudio(); }
 
-	//Actually run the core
-	main_menu::gbe_plus->run_core();
+	//Actually run the core on the emulation thread
+	stop_screen_filter();
+	qt_gui::frames.reset();
+	qt_gui::draw_pending = false;
+	emu->boot(main_menu::gbe_plus);
+}
+
+/****** Stops the emulation thread and closes the current core ******/
+void main_menu::close_core()
+{
+	if(main_menu::gbe_plus == NULL) { return; }
+
+	//Cores shut themselves down once run_core() returns
+	if(emu->is_started()) { emu->stop(); }
+	else { main_menu::gbe_plus->shutdown(); }
+
+	//Nothing else submits frames, so the filter thread can go
+	stop_screen_filter();
+
+	main_menu::gbe_plus->core_emu::~core_emu();
+}
+
+/****** Draws the newest frame from the emulation thread ******/
+void main_menu::draw_frame()
+{
+	qt_gui::draw_pending = false;
+
+	//OpenGL screen draws directly, paintEvent only handles resizing here
+	if(config::use_opengl)
+	{
+		if(config::request_resize) { update(); }
+		hw_screen->updateGL();
+	}
+
+	else { update(); }
 }
 
+/****** Runs one step of the GUI debugger while the emulation thread waits ******/
+void main_menu::run_debug_step() { emu->run_debug_step(); }
+
+/****** Applies current volume settings to the core ******/
+void main_menu::update_volume() { settings->update_volume(); }
+
 /****** Updates the main window ******/
 void main_menu::paintEvent(QPaintEvent* event)
 {
@@ -1027,11 +1051,7 @@ void main_menu::paintEvent(QPaintEvent* event)
 void main_menu::closeEvent(QCloseEvent* event)
 {
 	//Close the core
-	if(main_menu::gbe_plus != NULL) 
-	{
-		main_menu::gbe_plus->shutdown();
-		main_menu::gbe_plus->core_emu::~core_emu();
-	}
+	close_core();
 
 	//Save .ini options
 	config::gb_type = settings->sys_type->currentIndex();
@@ -1084,7 +1104,7 @@ void main_menu::keyPressEvent(QKeyEvent* event)
 	//Force input processing in the core
 	if(main_menu::gbe_plus != NULL)
 	{
-		gbe_plus->feed_key_input(sdl_key, true);
+		emu->feed_key_input(sdl_key, true);
 
 		//Handle fullscreen hotkeys if necessary
 		if(findChild<QAction*>("fullscreen_action")->isChecked())
@@ -1151,7 +1171,7 @@ void main_menu::keyReleaseEvent(QKeyEvent* event)
 	//Force input processing in the core
 	if(main_menu::gbe_plus != NULL)
 	{
-		gbe_plus->feed_key_input(sdl_key, false);
+		emu->feed_key_input(sdl_key, false);
 	}
 }
 
@@ -1221,7 +1241,7 @@ bool main_menu::eventFilter(QObject* target, QEvent* event)
 
 				u32 pack = (pad << 16) | (y << 8) | (x);
 
-				main_menu::gbe_plus->feed_key_input(pack, true);
+				emu->feed_key_input(pack, true);
 			}
 		}
 	}
@@ -1286,7 +1306,7 @@ bool main_menu::eventFilter(QObject* target, QEvent* event)
 
 				u32 pack = (pad << 16) | (y << 8) | (x);
 
-				main_menu::gbe_plus->feed_key_input(pack, false);
+				emu->feed_key_input(pack, false);
 			}
 		}
 	}
@@ -1297,7 +1317,7 @@ bool main_menu::eventFilter(QObject* target, QEvent* event)
 		if((target == sw_screen) || (target == hw_screen))
 		{
 			//Only process mouse motion if touch_by_mouse has been set in NDS core
-			if(main_menu::gbe_plus->get_core_data(2) == 0) { return QWidget::eventFilter(target, event); }
+			if(!emu->get_touch_by_mouse()) { return QWidget::eventFilter(target, event); }
 
 			QMouseEvent* mouse_event = static_cast<QMouseEvent*>(event);
 			float x_scaling_factor, y_scaling_factor = 0.0;
@@ -1349,7 +1369,7 @@ bool main_menu::eventFilter(QObject* target, QEvent* event)
 				u8 pad = 4;
 				u32 pack = (pad << 16) | (y << 8) | (x);
 
-				main_menu::gbe_plus->feed_key_input(pack, true);
+				emu->feed_key_input(pack, true);
 			}
 		}
 	}
@@ -1365,7 +1385,8 @@ void main_menu::pause()
 		//Unpause
 		if(config::pause_emu) 
 		{
-			config::pause_emu = false; 
+			config::pause_emu = false;
+			SDL_PauseAudio(0);
 		}
 
 		//Pause
@@ -1377,15 +1398,13 @@ void main_menu::pause()
 	}
 }
 
-/****** Pauses the emulator ******/
+/****** Pauses the emulator - The emulation thread waits at the end of its current frame ******/
 void main_menu::pause_emu()
 {
-	SDL_PauseAudio(1);
-
-	while(config::pause_emu) 
+	if(config::pause_emu)
 	{
-		SDL_Delay(16);
-		QApplication::processEvents();
+		SDL_PauseAudio(1);
+		return;
 	}
 
 	SDL_PauseAudio(0);
@@ -1404,12 +1423,11 @@ void main_menu::reset()
 		//When emulating the GB Memory Cartridge, let the DMG-GBC or SGB cores handle resetting
 		if((config::cart_type == DMG_GBMEM) && (config::gb_type != 3) && (config::gb_type != 4) && (config::gb_type != 7))
 		{
-			gbe_plus->feed_key_input(SDLK_F8, true);
+			emu->feed_key_input(SDLK_F8, true);
 			return;
 		}
 
-		main_menu::gbe_plus->shutdown();
-		main_menu::gbe_plus->core_emu::~core_emu();
+		close_core();
 
 		QFile test_file;
 		std::string test_bios_path = "";
@@ -1530,7 +1548,11 @@ void main_menu::screenshot()
 		if(config::use_opengl) { hw_screen->grabFrameBuffer().save(qt_save_name, "PNG"); }
 
 		//Save software screen
-		else { qt_gui::screen->save(qt_save_name, "PNG"); }
+		else
+		{
+			update_screen_image();
+			if(qt_gui::screen != NULL) { qt_gui::screen->save(qt_save_name, "PNG"); }
+		}
 
 		//OSD
 		config::osd_message = "SAVED SCREENSHOT";
@@ -1601,10 +1623,10 @@ void main_menu::show_debugger()
 			main_menu::dmg_debugger->pause = true;
 			config::pause_emu = false;
 
-			config::debug_external = dmg_debug_step;
+			config::debug_external = emu_thread::debug_step;
 			main_menu::dmg_debugger->auto_refresh();
 			main_menu::dmg_debugger->show();
-			main_menu::gbe_plus->db_unit.debug_mode = true;
+			emu->start_debugging();
 		}
 	}
 }
@@ -1691,11 +1713,7 @@ void main_menu::load_recent(int file_id)
 	}
 
 	//Close the core
-	if(main_menu::gbe_plus != NULL) 
-	{
-		main_menu::gbe_plus->shutdown();
-		main_menu::gbe_plus->core_emu::~core_emu();
-	}
+	close_core();
 
 	config::rom_file = config::recent_files[file_id];
 	config::save_file = util::get_filename_no_ext(config::rom_file) + ".sav";
@@ -1737,7 +1755,7 @@ void main_menu::load_recent(int file_id)
 /****** Saves a save state ******/
 void main_menu::save_state(int slot)
 {
-	if(main_menu::gbe_plus != NULL)  { main_menu::gbe_plus->save_state(slot); }
+	if(main_menu::gbe_plus != NULL)  { emu->save_state(slot); }
 }
 
 /****** Loads a save state ******/
@@ -1745,10 +1763,8 @@ void main_menu::load_state(int slot)
 {
 	if(main_menu::gbe_plus != NULL)
 	{
-		main_menu::gbe_plus->load_state(slot);
-
-		//Apply current volume settings
-		settings->update_volume();
+		//Current volume settings are applied once the core has loaded the state
+		emu->load_state(slot);
 	}
 }
 
@@ -1757,7 +1773,7 @@ void main_menu::start_netplay()
 {
 	if(main_menu::gbe_plus != NULL)
 	{
-		main_menu::gbe_plus->start_netplay();
+		emu->start_netplay();
 	}
 }
 
@@ -1766,7 +1782,7 @@ void main_menu::stop_netplay()
 {
 	if(main_menu::gbe_plus != NULL)
 	{
-		main_menu::gbe_plus->stop_netplay();
+		emu->stop_netplay();
 	}
 }
 
@@ -1776,7 +1792,7 @@ void main_menu::start_special_comm()
 	if(main_menu::gbe_plus != NULL)
 	{
 		//This just feeds a simulated F3 keypress to the core
-		gbe_plus->feed_key_input(SDLK_F3, true);
+		emu->feed_key_input(SDLK_F3, true);
 	}
 }
 
@@ -17,6 +17,7 @@
 #include "general_settings.h"
 #include "debug_dmg.h"
 #include "screens.h"
+#include "emu_thread.h"
 
 #include "gba/core.h"
 #include "dmg/core.h"
@@ -40,6 +41,8 @@ class main_menu : public QWidget
 
 	soft_screen* sw_screen;
 	hard_screen* hw_screen;
+
+	emu_thread* emu;
 	
 	u32 screen_height;
 	u32 screen_width;
@@ -91,6 +94,10 @@ class main_menu : public QWidget
 	void start_netplay();
 	void stop_netplay();
 	void start_special_comm();
+	void draw_frame();
+	void run_debug_step();
+	void show_card_file_error(QString filename);
+	void update_volume();
 
 	private:
 	QWidget* about_box;
@@ -107,6 +114,7 @@ class main_menu : public QWidget
 	u32 base_height;
 
 	void boot_game();
+	void close_core();
 };
 
 #endif //MAINMENU_GBE_QT
@@ -8,56 +8,188 @@
 //
 // Renders the screen for an emulated system using Qt
 
+#include <cstring>
+
 #include "render.h"
 
 #include "common/config.h"
+#include "common/sw_filter.h"
 
 namespace qt_gui
 {
 	QImage* screen = NULL;
 	main_menu* draw_surface = NULL;
-	SDL_Surface* final_screen = NULL;
+	frame_exchange frames;
+	std::atomic<bool> draw_pending(false);
+	sw_filter filter;
+
+	//Last software filter requested by the emulation thread, so a failed start is not retried every frame
+	u8 filter_request = SW_FILTER_NONE;
+	u32 filter_request_width = 0;
+	u32 filter_request_height = 0;
 }
 
-/****** Renders an LCD's screen buffer to a QImage ******/
-void render_screen_sw(std::vector<u32>& image) 
+/****** Frame exchange constructor ******/
+frame_exchange::frame_exchange() : ready_id(2)
 {
-	//Manually request screen size before PaintEvent takes effect
-	//Used for DMG/GBC games on GBA
-	if(config::request_resize)
+	reset();
+}
+
+/****** Drops all frames - Only call while the emulation thread is stopped ******/
+void frame_exchange::reset()
+{
+	for(u32 x = 0; x < 3; x++)
 	{
-		if(qt_gui::screen != NULL) { delete qt_gui::screen; }
-		qt_gui::screen = new QImage(config::sys_width, config::sys_height, QImage::Format_ARGB32);
+		frames[x].pixels.clear();
+		frames[x].width = 0;
+		frames[x].height = 0;
 	}
 
-	int width, height = 0;
+	write_id = 0;
+	read_id = 1;
+	ready_id = 2;
+}
+
+/****** Returns the buffer owned by the emulation thread ******/
+frame_exchange::frame& frame_exchange::get_write_frame() { return frames[write_id]; }
+
+/****** Makes the finished write buffer the newest frame, takes the old middle buffer for writing ******/
+void frame_exchange::publish()
+{
+	write_id = ready_id.exchange(write_id | FRESH_FRAME) & 0x3;
+}
+
+/****** Takes the newest frame for reading if one arrived since the last call ******/
+bool frame_exchange::acquire()
+{
+	if((ready_id.load() & FRESH_FRAME) == 0) { return false; }
 
+	read_id = ready_id.exchange(read_id) & 0x3;
+	return true;
+}
+
+/****** Returns the buffer owned by the GUI thread ******/
+const frame_exchange::frame& frame_exchange::get_read_frame() const { return frames[read_id]; }
+
+/****** Asks the GUI thread to draw once, without piling up requests if it falls behind ******/
+void request_draw()
+{
+	if(!qt_gui::draw_pending.exchange(true))
+	{
+		QMetaObject::invokeMethod(qt_gui::draw_surface, "draw_frame", Qt::QueuedConnection);
+	}
+}
+
+/****** Hands a filtered frame to the GUI - Runs on the software filter thread ******/
+void publish_filtered_frame(const u32* pixels, u32 width, u32 height)
+{
+	frame_exchange::frame& output = qt_gui::frames.get_write_frame();
+	output.width = width;
+	output.height = height;
+	output.pixels.assign(pixels, pixels + (width * height));
+
+	qt_gui::frames.publish();
+	request_draw();
+}
+
+/****** Hands an LCD's screen buffer to the GUI - Runs on the emulation thread ******/
+void render_screen_sw(std::vector<u32>& image) 
+{
 	//Determine the dimensions of the source image
 	//GBA = 240x160, GB-GBC = 160x144, NDS = 256x384, SGB = 256x224, MIN = 96x64
-	width = config::sys_width;
-	height = config::sys_height;
+	u32 width = config::sys_width;
+	u32 height = config::sys_height;
+	u32 size = width * height;
+
+	if(size > image.size()) { size = image.size(); }
 
-	//Fill in image with pixels from the emulated LCD
-	for(int y = 0; y < height; y++)
+	//Start, stop, or resize the software filter when its settings or the screen change
+	u8 filter_type = (config::use_sw_filters) ? sw_filter::get_type(config::fragment_shader) : SW_FILTER_NONE;
+
+	if((filter_type != qt_gui::filter_request) || (width != qt_gui::filter_request_width) || (height != qt_gui::filter_request_height))
 	{
-		u32* pixel_data = (u32*)qt_gui::screen->scanLine(y);
+		qt_gui::filter_request = filter_type;
+		qt_gui::filter_request_width = width;
+		qt_gui::filter_request_height = height;
 
-		for(int x = 0; x < width; x++) { pixel_data[x] = image[x + (y*width)]; }
+		if(filter_type == SW_FILTER_NONE) { qt_gui::filter.stop(); }
+		else { qt_gui::filter.start(filter_type, width, height, publish_filtered_frame); }
 	}
 
-	if(qt_gui::draw_surface != NULL) { qt_gui::draw_surface->update(); }
+	//Filtered frames reach the GUI from the filter thread instead
+	if((qt_gui::filter.is_active()) && (size == (width * height)))
+	{
+		qt_gui::filter.submit(&image[0]);
+		qt_gui::draw_surface->emu->end_frame();
+		return;
+	}
+
+	frame_exchange::frame& output = qt_gui::frames.get_write_frame();
+	output.width = width;
+	output.height = height;
+	output.pixels.resize(width * height, 0);
+
+	if(size) { memcpy(&output.pixels[0], &image[0], size * 4); }
 
-	QApplication::processEvents();
+	qt_gui::frames.publish();
+	request_draw();
+
+	qt_gui::draw_surface->emu->end_frame();
 }
 
-/****** Renders an LCD's screen buffer to an SDL Surface ******/
+/****** Hands an LCD's SDL Surface to the GUI - Runs on the emulation thread ******/
 void render_screen_hw(SDL_Surface* image) 
 {
-	if(config::request_resize) { qt_gui::draw_surface->update(); }
+	u32 width = image->w;
+	u32 height = image->h;
+
+	frame_exchange::frame& output = qt_gui::frames.get_write_frame();
+	output.width = width;
+	output.height = height;
+	output.pixels.resize(width * height, 0);
 
-	qt_gui::final_screen = image;
+	if(SDL_MUSTLOCK(image)) { SDL_LockSurface(image); }
 
-	if(qt_gui::draw_surface != NULL) { qt_gui::draw_surface->hw_screen->updateGL(); }
+	for(u32 y = 0; y < height; y++)
+	{
+		u8* line = (u8*)image->pixels + (y * image->pitch);
+		memcpy(&output.pixels[y * width], line, width * 4);
+	}
 
-	QApplication::processEvents();
+	if(SDL_MUSTLOCK(image)) { SDL_UnlockSurface(image); }
+
+	qt_gui::frames.publish();
+	request_draw();
+
+	qt_gui::draw_surface->emu->end_frame();
+}
+
+/****** Copies the newest frame into the QImage used for drawing and screenshots - Runs on the GUI thread ******/
+void update_screen_image()
+{
+	qt_gui::frames.acquire();
+
+	const frame_exchange::frame& input = qt_gui::frames.get_read_frame();
+	if(input.pixels.empty()) { return; }
+
+	//Frame dimensions change when cores resize the screen
+	if((qt_gui::screen == NULL) || ((u32)qt_gui::screen->width() != input.width) || ((u32)qt_gui::screen->height() != input.height))
+	{
+		if(qt_gui::screen != NULL) { delete qt_gui::screen; }
+		qt_gui::screen = new QImage(input.width, input.height, QImage::Format_ARGB32);
+	}
+
+	for(u32 y = 0; y < input.height; y++)
+	{
+		memcpy(qt_gui::screen->scanLine(y), &input.pixels[y * input.width], input.width * 4);
+	}
+}
+
+/****** Stops the software filter - Only call while the emulation thread is stopped ******/
+void stop_screen_filter()
+{
+	qt_gui::filter.stop();
+	qt_gui::filter_request = SW_FILTER_NONE;
+	qt_gui::filter_request_width = 0;
+	qt_gui::filter_request_height = 0;
 }
@@ -14,17 +14,53 @@
 #include "main_menu.h"
 
 #include <vector>
+#include <atomic>
 
 #include "common/common.h"
 
+//Triple-buffered exchange of finished frames between the emulation thread and the GUI
+//The core writes one buffer, the GUI reads another, and the third holds the newest finished frame
+class frame_exchange
+{
+	public:
+
+	struct frame
+	{
+		std::vector<u32> pixels;
+		u32 width;
+		u32 height;
+	};
+
+	frame_exchange();
+
+	void reset();
+
+	frame& get_write_frame();
+	void publish();
+
+	bool acquire();
+	const frame& get_read_frame() const;
+
+	private:
+	static const u8 FRESH_FRAME = 0x4;
+
+	frame frames[3];
+	u8 write_id;
+	u8 read_id;
+	std::atomic<u8> ready_id;
+};
+
 void render_screen_sw(std::vector<u32>& image);
 void render_screen_hw(SDL_Surface* image);
+void update_screen_image();
+void stop_screen_filter();
 
 namespace qt_gui
 {
 	extern QImage* screen;
 	extern main_menu* draw_surface;
-	extern SDL_Surface* final_screen;
+	extern frame_exchange frames;
+	extern std::atomic<bool> draw_pending;
 }
 
 #endif // QT_RENDER 
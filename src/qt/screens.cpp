@@ -24,6 +24,9 @@ void soft_screen::paintEvent(QPaintEvent* event)
 	painter.setBrush(Qt::black);
 	painter.drawRect(0, 0, width(), height());
 
+	//Grab the newest frame from the emulation thread
+	update_screen_image();
+
 	if(qt_gui::screen != NULL)
 	{
 		//Maintain aspect ratio
@@ -165,7 +168,14 @@ void hard_screen::paintGL()
 			default: break;
 		}
 
-		gwin.pixel_data = qt_gui::final_screen->pixels;
+		//Grab the newest frame from the emulation thread
+		qt_gui::frames.acquire();
+		const frame_exchange::frame& input = qt_gui::frames.get_read_frame();
+
+		//Skip frames from before a resize, the texture is sized by the current system dimensions
+		if(input.pixels.size() < (config::sys_width * config::sys_height)) { return; }
+
+		gwin.pixel_data = (void*)&input.pixels[0];
 		gwin.paint();
 	}
 }
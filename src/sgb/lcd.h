@@ -33,8 +33,8 @@ class SGB_LCD
 	bool opengl_init();
 
 	//Serialize data for save state loading/saving
-	bool lcd_read(u32 offset, std::string filename);
-	bool lcd_write(std::string filename);
+	bool lcd_read(save_state_buffer& state);
+	bool lcd_write(save_state_buffer& state);
 
 	//Screen data
 	SDL_Window *window;
@@ -122,13 +122,16 @@ class SGB_Z80
 	void exec_op(u16 opcode);
 
 	//Serialize data for save state loading/saving
-	bool cpu_read(u32 offset, std::string filename);
-	bool cpu_write(std::string filename);
+	bool cpu_read(save_state_buffer& state);
+	bool cpu_write(save_state_buffer& state);
 	u32 size();
 
 	//Interrupt handling
 	bool handle_interrupts();
 
+	//Cycles until the LCD or timers next need updating
+	u32 get_event_cycles();
+
 	inline void jr(u8 reg_one);
 
 	//Math functions